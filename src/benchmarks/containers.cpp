@@ -0,0 +1,234 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Container.h"
+#include "PoolContainer.h"
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Benchmark item, which meets the requirements of both containers
+*********************************************************************/
+struct Item
+{
+  Item(double x, double y) : xy_ { x, y } {}
+
+  const Vec2d& xy() const { return xy_; }
+  void container_destructor() {}
+
+  Vec2d xy_;
+
+  // Required by Container
+  Container<Item>::iterator pos_;
+  bool in_container_ { false };
+};
+
+/*********************************************************************
+* Timings of a container
+*********************************************************************/
+struct ContainerResult
+{
+  std::string name;
+  double      insert  { 0.0 };
+  double      iterate { 0.0 };
+  double      access  { 0.0 };
+  double      remove  { 0.0 };
+  double      checksum { 0.0 };
+};
+
+/*********************************************************************
+* Insert all points, iterate over all items, access n_access items
+* by index and remove every second item
+*********************************************************************/
+template <typename C>
+ContainerResult run(const std::string& name, C& container,
+                    const std::vector<Vec2d>& points, int n_access)
+{
+  ContainerResult result { name };
+  Timer timer {};
+
+  // Insert
+  timer.count();
+
+  for ( const auto& p : points )
+    container.push_back( p.x, p.y );
+
+  timer.count();
+  result.insert = timer.delta(0);
+
+  // Iterate
+  double sum = 0.0;
+
+  for ( const auto& item : container )
+    sum += item->xy().x;
+
+  timer.count();
+  result.iterate = timer.delta(1);
+
+  // Indexed access
+  std::mt19937 gen { 3 };
+  std::uniform_int_distribution<size_t> dist { 0, points.size() - 1 };
+
+  for ( int n = 0; n < n_access; ++n )
+    sum += container[ dist( gen ) ].xy().y;
+
+  timer.count();
+  result.access = timer.delta(2) / n_access;
+
+  // Remove every second item
+  std::vector<Item*> removed {};
+  size_t i = 0;
+
+  for ( const auto& item : container )
+    if ( i++ % 2 == 0 )
+      removed.push_back( &(*item) );
+
+  timer.count();
+
+  for ( Item* item : removed )
+    container.remove( *item );
+
+  timer.count();
+  result.remove = timer.delta(4);
+
+  result.checksum = sum + container.size();
+
+  return result;
+
+} // run()
+
+/*********************************************************************
+* Reference for the quad tree share of the container timings:
+* Preallocated items are inserted into and removed from a quad tree
+*********************************************************************/
+ContainerResult run_quad_tree(const std::vector<Vec2d>& points)
+{
+  ContainerResult result { "QuadTree only" };
+
+  std::vector<Item> items {};
+  items.reserve( points.size() );
+
+  for ( const auto& p : points )
+    items.emplace_back( p.x, p.y );
+
+  QuadTree<Item,double> qtree { ContainerQuadTreeScale,
+                                ContainerQuadTreeItems,
+                                ContainerQuadTreeDepth };
+  Timer timer {};
+  timer.count();
+
+  for ( auto& item : items )
+    qtree.add( &item );
+
+  timer.count();
+
+  for ( size_t i = 0; i < items.size(); i += 2 )
+    qtree.remove( &items[i] );
+
+  timer.count();
+
+  result.insert = timer.delta(0);
+  result.remove = timer.delta(1);
+
+  return result;
+
+} // run_quad_tree()
+
+/*********************************************************************
+* Benchmark of the object containers
+*
+* Usage: containers [items] [accesses]
+*
+* Random points are inserted into a Container (linked list of
+* individually allocated items) and into a PoolContainer (slab
+* storage with dense pointer array). Afterwards, all items are
+* iterated, random items are accessed by their index and every
+* second item is removed. Both containers keep a quad tree of their
+* items, which is included in the insertion and removal times.
+* The quad tree share is measured separately as a reference.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int n_items  = ( argc > 1 ) ? std::atoi( argv[1] ) : 10000000;
+  const int n_access = ( argc > 2 ) ? std::atoi( argv[2] ) : 100;
+
+  if ( n_items < 1 || n_access < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0] << " [items] [accesses]";
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 gen { 1 };
+  std::uniform_real_distribution<double> coord { -1000.0, 1000.0 };
+
+  std::vector<Vec2d> points ( n_items );
+
+  for ( auto& p : points )
+    p = { coord( gen ), coord( gen ) };
+
+  std::vector<ContainerResult> results {};
+
+  const ContainerResult qtree_only = run_quad_tree( points );
+
+  {
+    Container<Item> list_container {};
+    results.push_back( run( "Container", list_container,
+                            points, n_access ) );
+    list_container.clear_waste();
+  }
+
+  {
+    PoolContainer<Item> pool_container {};
+    results.push_back( run( "PoolContainer", pool_container,
+                            points, n_access ) );
+  }
+
+  // -----------------------------------------------------------------
+  // Output
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << n_items << " items";
+  LOG(INFO) << "";
+  LOG(INFO) << "  Container       Insert [s]     Iterate [s]    Access [s]     Remove [s]";
+  LOG(INFO) << "  -------------   ------------   ------------   ------------   ------------";
+
+  for ( const auto& r : results )
+  {
+    char line[160];
+    std::snprintf( line, sizeof(line),
+                   "  %-13s   %12.6e   %12.6e   %12.6e   %12.6e",
+                   r.name.c_str(), r.insert, r.iterate, r.access, r.remove );
+    LOG(INFO) << line;
+  }
+
+  char line[160];
+  std::snprintf( line, sizeof(line),
+                 "  %-13s   %12.6e   %12s   %12s   %12.6e",
+                 qtree_only.name.c_str(), qtree_only.insert, "-", "-",
+                 qtree_only.remove );
+  LOG(INFO) << line;
+
+  LOG(INFO) << "";
+
+  if ( results[0].checksum != results[1].checksum )
+    LOG(WARNING) << "Containers differ in their contents.";
+
+  return EXIT_SUCCESS;
+
+} // main()
@@ -0,0 +1,305 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+#include "Log.h"
+#include "Timer.h"
+#include "ThreadPool.h"
+#include "MathUtility.h"
+#include "PerfCounter.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeColoring.h"
+#include "EdgeResidual.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Results of a single accumulation strategy
+*********************************************************************/
+struct AccumulationResult
+{
+  std::string name;
+  double      time      { 0.0 };
+  double      deviation { 0.0 };
+  double      traffic   { 0.0 };
+};
+
+/*********************************************************************
+* Measure the mean wall time and the memory traffic of n_repeats
+* calls of func(). The traffic is estimated from the last-level
+* cache misses of the calling thread, if hardware counters are
+* available, and is zero otherwise.
+*********************************************************************/
+template <typename Func>
+std::pair<double,double> measure(int n_repeats, Func&& func)
+{
+  func();
+
+  PerfCounter misses { PerfEvent::CACHE_MISSES };
+
+  Timer timer {};
+  timer.count();
+  misses.start();
+
+  for ( int n = 0; n < n_repeats; ++n )
+    func();
+
+  misses.stop();
+  timer.count();
+
+  const double cache_line = 64.0;
+
+  return { timer.delta(0) / n_repeats,
+           cache_line * misses.value() / n_repeats };
+
+} // measure()
+
+/*********************************************************************
+* Serial reference: Loop over all faces, which scatters the fluxes
+* into both adjacent elements
+*********************************************************************/
+void serial_scatter(const DualGrid& dgrid, const DMat& U, DMat& R)
+{
+  const DMat& xy      = dgrid.coords();
+  const DMat& normals = dgrid.face_normals();
+  const IMat& nbrs    = dgrid.face_neighbors();
+
+  const double beta2 = CONSTANTS.art_compressibility();
+  const double nu    = CONSTANTS.viscosity();
+
+  for ( int i = 0; i < dgrid.n_elements(); ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      R[i][k] = 0.0;
+
+  for ( int f = 0; f < dgrid.n_intr_faces(); ++f )
+  {
+    const int i = nbrs[f][0];
+    const int j = nbrs[f][1];
+
+    double flux[N_FLOW_VARS];
+
+    edge_flux( U[i], U[j], xy[i], xy[j],
+               normals[f][0], normals[f][1], beta2, nu, flux );
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      R[i][k] += flux[k];
+      R[j][k] -= flux[k];
+    }
+  }
+
+} // serial_scatter()
+
+/*********************************************************************
+* Atomics baseline: Parallel loop over all faces, which scatters the
+* fluxes with atomic compare-and-swap updates
+*********************************************************************/
+void atomic_scatter(const DualGrid& dgrid, const DMat& U,
+                    std::vector<std::atomic<double>>& R)
+{
+  const DMat& xy      = dgrid.coords();
+  const DMat& normals = dgrid.face_normals();
+  const IMat& nbrs    = dgrid.face_neighbors();
+
+  const double beta2 = CONSTANTS.art_compressibility();
+  const double nu    = CONSTANTS.viscosity();
+
+  auto atomic_add = [](std::atomic<double>& r, double value)
+  {
+    double old = r.load( std::memory_order_relaxed );
+    while ( !r.compare_exchange_weak( old, old + value,
+                                      std::memory_order_relaxed ) )
+    {}
+  };
+
+  THREAD_POOL.parallel_for(0, static_cast<int>( R.size() ), [&](int i)
+  {
+    R[i].store( 0.0, std::memory_order_relaxed );
+  });
+
+  THREAD_POOL.parallel_for(0, dgrid.n_intr_faces(), [&](int f)
+  {
+    const int i = nbrs[f][0];
+    const int j = nbrs[f][1];
+
+    double flux[N_FLOW_VARS];
+
+    edge_flux( U[i], U[j], xy[i], xy[j],
+               normals[f][0], normals[f][1], beta2, nu, flux );
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      atomic_add( R[i*N_FLOW_VARS+k],  flux[k] );
+      atomic_add( R[j*N_FLOW_VARS+k], -flux[k] );
+    }
+  });
+
+} // atomic_scatter()
+
+/*********************************************************************
+* Benchmark of the accumulation of the interior face fluxes
+*
+* Usage: flux_accumulation [cells] [threads] [repeats] [tile size]
+*
+* The interior fluxes of an unstructured grid of (cells x cells)
+* triangle pairs are accumulated with
+*
+*   serial:          Single-threaded scatter loop over all faces
+*   atomics:         Parallel scatter with atomic updates
+*   face gather:     Face flux storage + CSR gather (default)
+*   edge coloring:   Color-grouped parallel scatter loops
+*   owner computes:  Per-element flux evaluation via CSR
+*   tiled:           Cache-sized tiles, processed one per thread
+*
+* All strategies except the atomics baseline are evaluated through
+* EdgeResidual without the boundary fluxes, which are identical for
+* all of them. Zero threads use all available cores.
+*
+* If hardware counters are accessible, the memory traffic per
+* evaluation is estimated from the last-level cache misses. Only
+* the calling thread is counted, thus the traffic is complete for
+* a single thread only.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int cells     = ( argc > 1 ) ? std::atoi( argv[1] ) : 400;
+  int       n_threads = ( argc > 2 ) ? std::atoi( argv[2] ) : 0;
+  const int n_repeats = ( argc > 3 ) ? std::atoi( argv[3] ) : 20;
+  const int tile_size = ( argc > 4 ) ? std::atoi( argv[4] ) : 4096;
+
+  if ( cells < 1 || n_repeats < 1 || tile_size < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " [cells] [threads] [repeats] [tile size]";
+    return EXIT_FAILURE;
+  }
+
+  if ( n_threads < 1 )
+    n_threads = static_cast<int>( std::thread::hardware_concurrency() );
+
+  THREAD_POOL.n_threads( n_threads );
+
+  // No boundary definition, such that only interior faces remain
+  PrimaryGrid primgrid = GridGenerator::unstructured( cells, cells );
+  DualGrid    dgrid { primgrid, BoundaryDef {} };
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS, THREAD_POOL );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * std::sin( 3.0 * y );
+    U[i][IV] = 0.1 * std::cos( 2.0 * x );
+  }
+
+  std::vector<AccumulationResult> results;
+
+  DMat R_ref ( n_elements, N_FLOW_VARS, THREAD_POOL );
+  DMat R     ( n_elements, N_FLOW_VARS, THREAD_POOL );
+
+  auto deviation = [&](auto value)
+  {
+    double dev = 0.0;
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        dev = MAX( dev, std::fabs( value(i,k) - R_ref[i][k] ) );
+    return dev;
+  };
+
+  // -----------------------------------------------------------------
+  // Serial and atomic scatter
+  auto serial = measure( n_repeats,
+    [&]() { serial_scatter( dgrid, U, R_ref ); } );
+
+  results.push_back( { "serial", serial.first, 0.0, serial.second } );
+
+  std::vector<std::atomic<double>> R_atomic ( n_elements * N_FLOW_VARS );
+
+  auto atomics = measure( n_repeats,
+    [&]() { atomic_scatter( dgrid, U, R_atomic ); } );
+
+  results.push_back( { "atomics", atomics.first,
+    deviation( [&](int i, int k)
+    { return R_atomic[i*N_FLOW_VARS+k].load(); } ), atomics.second } );
+
+  // -----------------------------------------------------------------
+  // Accumulation strategies of the EdgeResidual
+  EdgeResidual residual { dgrid };
+  residual.tile_size( tile_size );
+
+  const std::pair<const char*, FluxAccumulation> modes[] = {
+    { "face gather",    FluxAccumulation::FACE_GATHER    },
+    { "edge coloring",  FluxAccumulation::EDGE_COLORING  },
+    { "owner computes", FluxAccumulation::OWNER_COMPUTES },
+    { "tiled",          FluxAccumulation::TILED          },
+  };
+
+  for ( const auto& mode : modes )
+  {
+    residual.accumulation( mode.second );
+
+    auto run = measure( n_repeats, [&]() { residual.compute( U, R ); } );
+
+    results.push_back( { mode.first, run.first,
+      deviation( [&](int i, int k) { return R[i][k]; } ), run.second } );
+  }
+
+  // -----------------------------------------------------------------
+  // Output
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << dgrid.n_intr_faces() << " faces, "
+            << n_elements << " elements, "
+            << THREAD_POOL.n_threads() << " threads";
+  LOG(INFO) << "";
+  LOG(INFO) << "  Strategy         Time [s]       Speedup   Max. deviation   Traffic [MB]";
+  LOG(INFO) << "  --------------   ------------   -------   --------------   ------------";
+
+  for ( const auto& r : results )
+  {
+    char traffic[32];
+
+    if ( r.traffic > 0.0 )
+      std::snprintf( traffic, sizeof(traffic), "%12.3f", 1.0E-6 * r.traffic );
+    else
+      std::snprintf( traffic, sizeof(traffic), "%12s", "n/a" );
+
+    char line[160];
+    std::snprintf( line, sizeof(line), "  %-14s   %12.6e   %7.3f   %14.6e   %s",
+                   r.name.c_str(), r.time, results.front().time / r.time,
+                   r.deviation, traffic );
+    LOG(INFO) << line;
+  }
+
+  LOG(INFO) << "";
+
+  return EXIT_SUCCESS;
+
+} // main()
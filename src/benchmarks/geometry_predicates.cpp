@@ -0,0 +1,159 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Geometry.h"
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Triangles and query points in structure of arrays
+*********************************************************************/
+struct TriangleSet
+{
+  std::vector<double> px, py, qx, qy, rx, ry, vx, vy;
+
+  TriangleSet(size_t n)
+  : px(n), py(n), qx(n), qy(n), rx(n), ry(n), vx(n), vy(n) {}
+};
+
+/*********************************************************************
+* Random counter-clockwise triangles with query points nearby. For
+* a degenerate set, the coordinates lie on a coarse lattice, such
+* that many points lie exactly on triangle edges.
+*********************************************************************/
+TriangleSet random_triangles(size_t n, bool degenerate)
+{
+  TriangleSet t { n };
+
+  std::mt19937 gen { 1 };
+  std::uniform_real_distribution<double> coord { -1.0, 1.0 };
+  std::uniform_int_distribution<int>     lattice { -4, 4 };
+
+  auto sample = [&]()
+  { return degenerate ? 0.25 * lattice( gen ) : coord( gen ); };
+
+  for ( size_t i = 0; i < n; ++i )
+  {
+    t.px[i] = sample(); t.py[i] = sample();
+    t.qx[i] = sample(); t.qy[i] = sample();
+    t.rx[i] = sample(); t.ry[i] = sample();
+    t.vx[i] = sample(); t.vy[i] = sample();
+
+    if ( orient2d( t.px[i], t.py[i], t.qx[i], t.qy[i],
+                   t.rx[i], t.ry[i] ) < 0 )
+    {
+      std::swap( t.qx[i], t.rx[i] );
+      std::swap( t.qy[i], t.ry[i] );
+    }
+  }
+
+  return t;
+}
+
+/*********************************************************************
+* Benchmark of the batched geometric predicates
+*
+* Usage: geometry_predicates [lanes]
+*
+* Point-in-triangle tests are evaluated by the scalar predicate
+* in_on_triangle() (tolerance-based), by three scalar calls of the
+* exact orient2d() and by the batched in_on_triangle_batch(). The
+* lanes are generated randomly (well-conditioned) and on a coarse
+* lattice (many exactly degenerate lanes).
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int n = ( argc > 1 ) ? std::atoi( argv[1] ) : 10000000;
+
+  if ( n < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0] << " [lanes]";
+    return EXIT_FAILURE;
+  }
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << n << " point-in-triangle tests";
+  LOG(INFO) << "";
+  LOG(INFO) << "  Input        Scalar [ns]    Exact [ns]     Batched [ns]   Inside (tol.)  Inside (exact)";
+  LOG(INFO) << "  ----------   ------------   ------------   ------------   ------------   ------------";
+
+  std::unique_ptr<bool[]> inside { new bool[n] };
+
+  for ( int degenerate = 0; degenerate < 2; ++degenerate )
+  {
+    const TriangleSet t = random_triangles( n, degenerate );
+
+    Timer timer {};
+    timer.count();
+
+    // Scalar predicates with tolerance
+    size_t n_scalar = 0;
+
+    for ( int i = 0; i < n; ++i )
+      n_scalar += in_on_triangle( Vec2d { t.vx[i], t.vy[i] },
+                                  Vec2d { t.px[i], t.py[i] },
+                                  Vec2d { t.qx[i], t.qy[i] },
+                                  Vec2d { t.rx[i], t.ry[i] } );
+
+    timer.count();
+
+    // Scalar exact predicates
+    size_t n_exact = 0;
+
+    for ( int i = 0; i < n; ++i )
+      n_exact +=
+        ( orient2d( t.px[i], t.py[i], t.qx[i], t.qy[i], t.vx[i], t.vy[i] ) >= 0 )
+     && ( orient2d( t.qx[i], t.qy[i], t.rx[i], t.ry[i], t.vx[i], t.vy[i] ) >= 0 )
+     && ( orient2d( t.rx[i], t.ry[i], t.px[i], t.py[i], t.vx[i], t.vy[i] ) >= 0 );
+
+    timer.count();
+
+    // Batched exact predicates
+    in_on_triangle_batch( Vec2Array { t.vx.data(), t.vy.data() },
+                          Vec2Array { t.px.data(), t.py.data() },
+                          Vec2Array { t.qx.data(), t.qy.data() },
+                          Vec2Array { t.rx.data(), t.ry.data() },
+                          n, inside.get() );
+
+    timer.count();
+
+    size_t n_batched = 0;
+    for ( int i = 0; i < n; ++i )
+      n_batched += inside[i];
+
+    char line[160];
+    std::snprintf( line, sizeof(line),
+                   "  %-10s   %12.3f   %12.3f   %12.3f   %12zu   %12zu",
+                   degenerate ? "lattice" : "random",
+                   1.0E9 * timer.delta(0) / n,
+                   1.0E9 * timer.delta(1) / n,
+                   1.0E9 * timer.delta(2) / n, n_scalar, n_batched );
+    LOG(INFO) << line;
+
+    if ( n_exact != n_batched )
+      LOG(WARNING) << "Exact predicates differ in their results.";
+  }
+
+  LOG(INFO) << "";
+
+  return EXIT_SUCCESS;
+
+} // main()
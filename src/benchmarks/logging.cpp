@@ -0,0 +1,130 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+#include "Log.h"
+#include "Timer.h"
+
+using namespace CppUtils;
+
+/*********************************************************************
+* A threaded kernel, which logs a message every few iterations
+* (never for log_every = 0)
+*********************************************************************/
+double kernel(int n_threads, int n_iter, int log_every, LogLevel level)
+{
+  std::vector<std::thread> threads {};
+  std::vector<double>      sums ( n_threads, 0.0 );
+
+  Timer timer {};
+  timer.count();
+
+  for ( int t = 0; t < n_threads; ++t )
+    threads.emplace_back( [&, t]
+    {
+      double sum = 0.0;
+
+      for ( int i = 0; i < n_iter; ++i )
+      {
+        sum += std::sqrt( static_cast<double>( i + t ) );
+
+        if ( log_every > 0 && i % log_every == 0 )
+          LOG(level) << "Thread " << t << ", iteration " << i
+                     << ", partial sum " << sum;
+      }
+
+      sums[t] = sum;
+    });
+
+  for ( auto& thread : threads )
+    thread.join();
+
+  timer.count();
+
+  if ( sums[0] < 0.0 )
+    LOG(ERROR) << "Invalid sum";
+
+  return timer.delta(0);
+}
+
+/*********************************************************************
+* Benchmark of the logging backends
+*
+* Usage: logging [threads] [messages per thread] [output file]
+*
+* The same threaded kernel runs without logging, with messages of a
+* disabled level, with synchronous and with asynchronous output to
+* the given file (default: /dev/null).
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int n_threads  = ( argc > 1 ) ? std::atoi( argv[1] ) : 4;
+  const int n_messages = ( argc > 2 ) ? std::atoi( argv[2] ) : 200000;
+  const std::string file { ( argc > 3 ) ? argv[3] : "/dev/null" };
+
+  if ( n_threads < 1 || n_messages < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " [threads] [messages per thread] [output file]";
+    return EXIT_FAILURE;
+  }
+
+  constexpr int log_every = 16;
+  const int n_iter = n_messages * log_every;
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << n_threads << " threads, " << n_messages
+            << " messages per thread";
+  LOG(INFO) << "";
+  LOG(INFO) << "  Output             Time [s]       Per message [ns]";
+  LOG(INFO) << "  ----------------   ------------   ------------";
+
+  // Timings are reported to cout, messages are written to the file
+  auto report = [&](const char* name, double t, double t_ref)
+  {
+    char line[120];
+    std::snprintf( line, sizeof(line), "  %-16s   %12.6e   %12.2f",
+                   name, t, 1.0E9 * ( t - t_ref ) / n_threads / n_messages );
+    LOG(INFO) << line;
+  };
+
+  const double t_none = kernel( n_threads, n_iter, 0, INFO );
+  report( "none", t_none, t_none );
+
+  report( "disabled level", kernel( n_threads, n_iter, log_every, DEBUG ),
+          t_none );
+
+  LOG_PROPERTIES.set_info_ostream( TO_FILE, file );
+  const double t_sync = kernel( n_threads, n_iter, log_every, INFO );
+  LOG_PROPERTIES.set_info_ostream( TO_COUT );
+  report( "synchronous", t_sync, t_none );
+
+  LOG_PROPERTIES.set_info_ostream( TO_FILE, file );
+  LOG_PROPERTIES.use_async( true );
+  const double t_async = kernel( n_threads, n_iter, log_every, INFO );
+  LOG_PROPERTIES.use_async( false );
+  LOG_PROPERTIES.set_info_ostream( TO_COUT );
+  report( "asynchronous", t_async, t_none );
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  Producer waits: " << ASYNC_LOGGER.n_waits();
+  LOG(INFO) << "";
+
+  return EXIT_SUCCESS;
+
+} // main()
@@ -0,0 +1,255 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+
+#include "Log.h"
+#include "Timer.h"
+#include "QuadTree.h"
+#include "LinearQuadTree.h"
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Benchmark item
+*********************************************************************/
+struct Item
+{
+  Item(double x, double y) : xy_ { x, y } {}
+
+  const Vec2d& xy() const { return xy_; }
+
+  Vec2d xy_;
+};
+
+/*********************************************************************
+* Timings of a quad tree
+*********************************************************************/
+struct TreeResult
+{
+  std::string name;
+  double      build  { 0.0 };
+  double      rect   { 0.0 };
+  double      circle { 0.0 };
+  size_t      n_rect   { 0 };
+  size_t      n_circle { 0 };
+};
+
+/*********************************************************************
+* Query rectangles and circles, both with the given edge length
+*********************************************************************/
+struct Query
+{
+  Vec2d lowleft;
+  Vec2d upright;
+  Vec2d center;
+  double radius;
+};
+
+/*********************************************************************
+* Run all queries and return the time per query
+*********************************************************************/
+template <typename Tree>
+double run_rect_queries(const Tree& tree, const std::vector<Query>& queries,
+                        size_t& n_found)
+{
+  Timer timer {};
+  timer.count();
+
+  std::vector<Item*> found {};
+
+  for ( const auto& q : queries )
+  {
+    found.clear();
+    n_found += tree.get_items( q.lowleft, q.upright, found );
+  }
+
+  timer.count();
+  return timer.delta(0) / queries.size();
+}
+
+template <typename Tree>
+double run_circle_queries(const Tree& tree, const std::vector<Query>& queries,
+                          size_t& n_found)
+{
+  Timer timer {};
+  timer.count();
+
+  std::vector<Item*> found {};
+
+  for ( const auto& q : queries )
+  {
+    found.clear();
+    n_found += tree.get_items( q.center, q.radius, found );
+  }
+
+  timer.count();
+  return timer.delta(0) / queries.size();
+}
+
+/*********************************************************************
+* Benchmark of the pointer-based QuadTree against the bulk-loaded
+* LinearQuadTree
+*
+* Usage: quad_trees [items] [queries] [query size]
+*
+* Random points in [-1000,1000]^2 are inserted one by one into a
+* QuadTree and bulk-loaded into a LinearQuadTree. Afterwards, random
+* rectangles and circles are queried. The QuadTree collects results
+* in a vector, the LinearQuadTree reports them through a callback,
+* which is given both as vector insertion (as used above) and as
+* plain counting.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int    n_items   = ( argc > 1 ) ? std::atoi( argv[1] ) : 10000000;
+  const int    n_queries = ( argc > 2 ) ? std::atoi( argv[2] ) : 100000;
+  const double size      = ( argc > 3 ) ? std::atof( argv[3] ) : 2.0;
+
+  if ( n_items < 1 || n_queries < 1 || size <= 0.0 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0] << " [items] [queries] [query size]";
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 gen { 1 };
+  std::uniform_real_distribution<double> coord { -1000.0, 1000.0 };
+
+  std::vector<Item> items {};
+  items.reserve( n_items );
+
+  for ( int i = 0; i < n_items; ++i )
+    items.emplace_back( coord( gen ), coord( gen ) );
+
+  std::vector<Item*> ptrs {};
+  ptrs.reserve( n_items );
+
+  for ( auto& item : items )
+    ptrs.push_back( &item );
+
+  std::vector<Query> queries ( n_queries );
+
+  for ( auto& q : queries )
+  {
+    q.lowleft = { coord( gen ), coord( gen ) };
+    q.upright = q.lowleft + size;
+    q.center  = q.lowleft;
+    q.radius  = 0.5 * size;
+  }
+
+  std::vector<TreeResult> results {};
+  Timer timer {};
+
+  // -----------------------------------------------------------------
+  // Pointer-based quad tree
+  {
+    TreeResult result { "QuadTree" };
+
+    QuadTree<Item,double> qtree { 2000.0, 100, 25 };
+
+    timer.count();
+
+    for ( Item* item : ptrs )
+      qtree.add( item );
+
+    timer.count();
+    result.build = timer.delta(0);
+
+    result.rect   = run_rect_queries( qtree, queries, result.n_rect );
+    result.circle = run_circle_queries( qtree, queries, result.n_circle );
+
+    results.push_back( result );
+  }
+
+  // -----------------------------------------------------------------
+  // Linear quad tree
+  {
+    TreeResult result { "LinearQuadTree" };
+
+    LinearQuadTree<Item,double> qtree { 100, 25 };
+
+    Timer build_timer {};
+    build_timer.count();
+    qtree.build( ptrs );
+    build_timer.count();
+
+    result.build = build_timer.delta(0);
+
+    result.rect   = run_rect_queries( qtree, queries, result.n_rect );
+    result.circle = run_circle_queries( qtree, queries, result.n_circle );
+
+    results.push_back( result );
+
+    // Counting callbacks without any result storage
+    TreeResult counting { "  (callback)" };
+    counting.build = result.build;
+
+    Timer query_timer {};
+    query_timer.count();
+
+    for ( const auto& q : queries )
+      qtree.get_items( q.lowleft, q.upright,
+                       [&](Item*) { ++counting.n_rect; } );
+
+    query_timer.count();
+
+    for ( const auto& q : queries )
+      qtree.get_items( q.center, q.radius,
+                       [&](Item*) { ++counting.n_circle; } );
+
+    query_timer.count();
+
+    counting.rect   = query_timer.delta(0) / n_queries;
+    counting.circle = query_timer.delta(1) / n_queries;
+
+    results.push_back( counting );
+  }
+
+  // -----------------------------------------------------------------
+  // Output
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << n_items << " items, " << n_queries
+            << " queries of size " << size;
+  LOG(INFO) << "";
+  LOG(INFO) << "  Tree             Build [s]      Rect [s]       Circle [s]     Found";
+  LOG(INFO) << "  --------------   ------------   ------------   ------------   ------------";
+
+  for ( const auto& r : results )
+  {
+    char line[160];
+    std::snprintf( line, sizeof(line),
+                   "  %-14s   %12.6e   %12.6e   %12.6e   %12zu",
+                   r.name.c_str(), r.build, r.rect, r.circle,
+                   r.n_rect + r.n_circle );
+    LOG(INFO) << line;
+  }
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  Build speedup: "
+            << results[0].build / results[1].build;
+  LOG(INFO) << "  Query speedup: "
+            << ( results[0].rect + results[0].circle )
+             / ( results[2].rect + results[2].circle );
+  LOG(INFO) << "";
+
+  for ( size_t i = 1; i < results.size(); ++i )
+    if ( results[i].n_rect != results[0].n_rect
+      || results[i].n_circle != results[0].n_circle )
+      LOG(WARNING) << "Quad trees differ in their results.";
+
+  return EXIT_SUCCESS;
+
+} // main()
@@ -0,0 +1,473 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+#include <IncomFlowConfig.h>
+
+#include "Log.h"
+#include "Timer.h"
+#include "ThreadPool.h"
+#include "MathUtility.h"
+#include "VtkIO.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "PrimaryGridWriter.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "BoundaryList.h"
+#include "Reconstruction.h"
+#include "EdgeResidual.h"
+#include "SparseMatrix.h"
+#include "FluxJacobian.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Timings of a single benchmark case and their statistics
+*********************************************************************/
+struct BenchmarkResult
+{
+  std::string         name;
+  std::string         grid;
+  int                 n_vertices { 0 };
+  int                 n_elements { 0 };
+  std::vector<double> samples    {};
+
+  double min    { 0.0 };
+  double max    { 0.0 };
+  double mean   { 0.0 };
+  double median { 0.0 };
+  double stddev { 0.0 };
+
+  // Processed grid vertices per second, based on the median
+  double throughput() const
+  { return ( median > 0.0 ) ? n_vertices / median : 0.0; }
+
+  void compute_statistics()
+  {
+    std::vector<double> sorted { samples };
+    std::sort( sorted.begin(), sorted.end() );
+
+    const size_t n = sorted.size();
+
+    min    = sorted.front();
+    max    = sorted.back();
+    median = ( n % 2 == 1 ) ? sorted[n/2]
+                            : 0.5 * ( sorted[n/2-1] + sorted[n/2] );
+
+    mean = 0.0;
+    for ( double t : sorted )
+      mean += t;
+    mean /= static_cast<double>( n );
+
+    stddev = 0.0;
+    for ( double t : sorted )
+      stddev += ( t - mean ) * ( t - mean );
+    stddev = ( n > 1 ) ? std::sqrt( stddev / static_cast<double>( n-1 ) )
+                       : 0.0;
+  }
+
+}; // BenchmarkResult
+
+/*********************************************************************
+* Measure n_repeats calls of func() after a single warm-up call
+*********************************************************************/
+std::vector<double> measure(int n_repeats, const std::function<void()>& func)
+{
+  func();
+
+  std::vector<double> samples ( n_repeats, 0.0 );
+
+  for ( int n = 0; n < n_repeats; ++n )
+  {
+    Timer timer {};
+    timer.count();
+    func();
+    timer.count();
+
+    samples[n] = timer.delta(0);
+  }
+
+  return samples;
+
+} // measure()
+
+/*********************************************************************
+* Boundary definition of the generated grids
+*********************************************************************/
+BoundaryDef boundary_definition()
+{
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  return bdry_def;
+
+} // boundary_definition()
+
+/*********************************************************************
+* Run all benchmark cases on a single grid
+*********************************************************************/
+void benchmark_grid(const std::string& grid_name, PrimaryGrid& primgrid,
+                    int n_repeats, const std::string& tmp_prefix,
+                    std::vector<BenchmarkResult>& results)
+{
+  const BoundaryDef bdry_def = boundary_definition();
+
+  const int n_vertices = primgrid.n_vertices();
+  const int n_elements = primgrid.n_tris() + primgrid.n_quads();
+
+  auto add_result = [&](const char* name, std::vector<double> samples)
+  {
+    BenchmarkResult r {};
+    r.name       = name;
+    r.grid       = grid_name;
+    r.n_vertices = n_vertices;
+    r.n_elements = n_elements;
+    r.samples    = std::move( samples );
+    r.compute_statistics();
+
+    results.push_back( std::move(r) );
+
+    LOG(INFO) << "  " << grid_name << " / " << name << ": median "
+              << results.back().median << " s";
+  };
+
+  // -----------------------------------------------------------------
+  // Grid reading, the grid file is written once beforehand.
+  // The reader reports its progress, which is muted here.
+  const std::string grid_file { tmp_prefix + "_" + grid_name + ".dat" };
+
+  PrimaryGridWriter writer {};
+
+  if ( !writer.write( primgrid, grid_file ) )
+    TERMINATE();
+
+  LOG_PROPERTIES.set_level( WARNING );
+
+  add_result( "read", measure( n_repeats, [&]()
+  {
+    PrimaryGridReader reader {};
+    PrimaryGrid copy = reader.read( grid_file );
+  }));
+
+  LOG_PROPERTIES.set_level( INFO );
+
+  std::remove( grid_file.c_str() );
+
+  // -----------------------------------------------------------------
+  // Dual grid construction and boundary extraction
+  add_result( "dual_grid", measure( n_repeats, [&]()
+  {
+    DualGrid dgrid { primgrid, bdry_def };
+  }));
+
+  add_result( "boundaries", measure( n_repeats, [&]()
+  {
+    BoundaryList boundaries { primgrid, bdry_def };
+  }));
+
+  DualGrid dgrid { primgrid, bdry_def };
+
+  DMat U ( n_vertices, N_FLOW_VARS, THREAD_POOL );
+  DMat R ( n_vertices, N_FLOW_VARS, THREAD_POOL );
+
+  for ( int i = 0; i < n_vertices; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * std::sin( 3.0 * y );
+    U[i][IV] = 0.1 * std::cos( 2.0 * x );
+  }
+
+  // -----------------------------------------------------------------
+  // Limited gradients and first-order residual
+  Reconstruction reconstruction { dgrid };
+
+  add_result( "gradient", measure( n_repeats, [&]()
+  {
+    reconstruction.compute( U );
+  }));
+
+  EdgeResidual residual { dgrid };
+
+  add_result( "flux", measure( n_repeats, [&]()
+  {
+    residual.compute( U, R );
+  }));
+
+  // -----------------------------------------------------------------
+  // Block sparse matrix-vector product with the flux Jacobian
+  SparseMatrix jacobian { dgrid, N_FLOW_VARS };
+  FluxJacobian { dgrid }.assemble( U, jacobian );
+
+  DVec x ( n_vertices * N_FLOW_VARS, 1.0 );
+  DVec y ( n_vertices * N_FLOW_VARS, 0.0 );
+
+  add_result( "spmv", measure( n_repeats, [&]()
+  {
+    jacobian.multiply( x, y );
+  }));
+
+  // -----------------------------------------------------------------
+  // Output of the solution on the primary grid
+  const std::string vtu_file { tmp_prefix + "_" + grid_name + ".vtu" };
+
+  add_result( "output", measure( n_repeats, [&]()
+  {
+    std::vector<double> points ( 3 * n_vertices, 0.0 );
+    std::vector<double> solution ( N_FLOW_VARS * n_vertices );
+
+    for ( int i = 0; i < n_vertices; ++i )
+    {
+      points[3*i]   = primgrid.vertex_coords()[i][0];
+      points[3*i+1] = primgrid.vertex_coords()[i][1];
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        solution[N_FLOW_VARS*i+k] = U[i][k];
+    }
+
+    std::vector<size_t> connectivity {};
+    std::vector<size_t> offsets {};
+    std::vector<size_t> types {};
+
+    connectivity.reserve( 4 * primgrid.n_quads() + 3 * primgrid.n_tris() );
+    offsets.reserve( n_elements );
+    types.reserve( n_elements );
+
+    for ( int i = 0; i < primgrid.n_quads(); ++i )
+    {
+      for ( int k = 0; k < 4; ++k )
+        connectivity.push_back( primgrid.quads()[i][k] );
+      offsets.push_back( connectivity.size() );
+      types.push_back( 9 );
+    }
+
+    for ( int i = 0; i < primgrid.n_tris(); ++i )
+    {
+      for ( int k = 0; k < 3; ++k )
+        connectivity.push_back( primgrid.tris()[i][k] );
+      offsets.push_back( connectivity.size() );
+      types.push_back( 5 );
+    }
+
+    VtuWriter vtu { points, connectivity, offsets, types };
+    vtu.add_point_data( solution, "solution", N_FLOW_VARS );
+    vtu.write( vtu_file );
+  }));
+
+  std::remove( vtu_file.c_str() );
+
+} // benchmark_grid()
+
+/*********************************************************************
+* Write the results as JSON file
+*********************************************************************/
+bool write_json(const std::string& file_path,
+                const std::vector<BenchmarkResult>& results,
+                int n_repeats)
+{
+  std::ofstream file ( file_path, std::ios::trunc );
+
+  if ( file.fail() )
+  {
+    LOG(ERROR) << "Failed to open benchmark output file:\n"
+                  "  \"" << file_path << "\"";
+    return false;
+  }
+
+  char timestamp[32];
+  const std::time_t now = std::time( nullptr );
+  std::strftime( timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+                 std::gmtime( &now ) );
+
+  file.precision( 9 );
+
+  file << "{\n"
+       << "  \"version\": \"" << INCOMFLOW_VERSION_MAJOR << "."
+                              << INCOMFLOW_VERSION_MINOR << "\",\n"
+       << "  \"timestamp\": \"" << timestamp << "\",\n"
+       << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+       << "  \"threads\": " << THREAD_POOL.n_threads() << ",\n"
+       << "  \"repetitions\": " << n_repeats << ",\n"
+       << "  \"benchmarks\": [";
+
+  for ( size_t i = 0; i < results.size(); ++i )
+  {
+    const BenchmarkResult& r = results[i];
+
+    file << ( i == 0 ? "\n" : ",\n" )
+         << "    {\n"
+         << "      \"name\": \"" << r.name << "\",\n"
+         << "      \"grid\": \"" << r.grid << "\",\n"
+         << "      \"vertices\": " << r.n_vertices << ",\n"
+         << "      \"elements\": " << r.n_elements << ",\n"
+         << "      \"unit\": \"s\",\n"
+         << "      \"samples\": [";
+
+    for ( size_t n = 0; n < r.samples.size(); ++n )
+      file << ( n == 0 ? "" : ", " ) << r.samples[n];
+
+    file << "],\n"
+         << "      \"min\": " << r.min << ",\n"
+         << "      \"max\": " << r.max << ",\n"
+         << "      \"mean\": " << r.mean << ",\n"
+         << "      \"median\": " << r.median << ",\n"
+         << "      \"stddev\": " << r.stddev << ",\n"
+         << "      \"vertices_per_second\": " << r.throughput() << "\n"
+         << "    }";
+  }
+
+  file << "\n  ]\n}\n";
+
+  if ( file.fail() )
+  {
+    LOG(ERROR) << "Failed to write benchmark output file:\n"
+                  "  \"" << file_path << "\"";
+    return false;
+  }
+
+  return true;
+
+} // write_json()
+
+/*********************************************************************
+* Benchmark suite of the solver stages on generated grids
+*
+* Usage: run_benchmarks [vertices] [grid] [repeats] [threads] [output]
+*
+*   vertices:  Approximate number of grid vertices (default 10^5)
+*   grid:      structured (quads), unstructured (triangles) or
+*              all (default)
+*   repeats:   Number of timed repetitions (default 10)
+*   threads:   Number of threads, zero uses all cores (default)
+*   output:    JSON result file (default run_benchmarks.json)
+*
+* The grids of the rectangle [0,2] x [0,1] are generated in memory,
+* such that any size from 10^3 to 10^8 vertices can be benchmarked.
+* Every case is called once before the timed repetitions. The
+* grid and solution files of the reading and output cases are
+* written to the temporary directory and removed afterwards.
+*
+* Cases:
+*   read:        PrimaryGridReader of the grid file
+*   dual_grid:   Construction of the median dual grid
+*   boundaries:  Extraction of the boundaries of the primary grid
+*   gradient:    Limited gradients of the reconstruction
+*   flux:        First-order residual with boundary fluxes
+*   spmv:        Product of the block flux Jacobian with a vector
+*   output:      VTU output of the solution
+*
+* The JSON file contains all samples and their min, max, mean,
+* median and standard deviation, such that the results of different
+* versions can be compared.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const double n_target  = ( argc > 1 ) ? std::atof( argv[1] ) : 1.0E+05;
+  const std::string grid { ( argc > 2 ) ? argv[2] : "all" };
+  const int n_repeats    = ( argc > 3 ) ? std::atoi( argv[3] ) : 10;
+  int n_threads          = ( argc > 4 ) ? std::atoi( argv[4] ) : 0;
+  const std::string output { ( argc > 5 ) ? argv[5] : "run_benchmarks.json" };
+
+  const bool valid_grid = ( grid == "all" || grid == "structured"
+                         || grid == "unstructured" );
+
+  if ( n_target < 4.0 || n_target > 5.0E+08 || !valid_grid || n_repeats < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " [vertices] [structured|unstructured|all] [repeats]"
+         " [threads] [output]";
+    return EXIT_FAILURE;
+  }
+
+  if ( n_threads < 1 )
+    n_threads = static_cast<int>( std::thread::hardware_concurrency() );
+
+  THREAD_POOL.n_threads( n_threads );
+
+  // (nx+1) x (ny+1) vertices with nx = 2 ny for the rectangle [0,2] x [0,1]
+  const int ny = MAX( 1, static_cast<int>(
+    std::lround( std::sqrt( 0.5 * n_target ) ) ) - 1 );
+  const int nx = 2 * ny;
+
+  const std::string tmp_prefix {
+    ( std::filesystem::temp_directory_path() / "incomflow_benchmark" ).string() };
+
+  std::vector<BenchmarkResult> results {};
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << (nx+1) * (ny+1) << " vertices, "
+            << n_repeats << " repetitions, "
+            << THREAD_POOL.n_threads() << " threads";
+  LOG(INFO) << "";
+
+  if ( grid != "unstructured" )
+  {
+    PrimaryGrid primgrid = GridGenerator::structured( nx, ny, 2.0, 1.0 );
+    benchmark_grid( "structured", primgrid, n_repeats, tmp_prefix, results );
+  }
+
+  if ( grid != "structured" )
+  {
+    PrimaryGrid primgrid = GridGenerator::unstructured( nx, ny, 2.0, 1.0 );
+    benchmark_grid( "unstructured", primgrid, n_repeats, tmp_prefix, results );
+  }
+
+  // -----------------------------------------------------------------
+  // Output
+  LOG(INFO) << "";
+  LOG(INFO) << "  Grid           Case         Median [s]     Mean [s]       Std. dev. [%]   Vertices/s";
+  LOG(INFO) << "  ------------   ----------   ------------   ------------   -------------   ------------";
+
+  for ( const auto& r : results )
+  {
+    char line[160];
+    std::snprintf( line, sizeof(line),
+                   "  %-12s   %-10s   %12.6e   %12.6e   %13.2f   %12.6e",
+                   r.grid.c_str(), r.name.c_str(), r.median, r.mean,
+                   100.0 * r.stddev / r.mean, r.throughput() );
+    LOG(INFO) << line;
+  }
+
+  LOG(INFO) << "";
+
+  if ( !write_json( output, results, n_repeats ) )
+    return EXIT_FAILURE;
+
+  LOG(INFO) << "  Results written to " << output;
+  LOG(INFO) << "";
+
+  return EXIT_SUCCESS;
+
+} // main()
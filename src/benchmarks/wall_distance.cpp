@@ -0,0 +1,148 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+#include "Log.h"
+#include "Timer.h"
+#include "ThreadPool.h"
+#include "Geometry.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "WallDistance.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Benchmark of the wall distance computation
+*
+* Usage: wall_distance [cells] [threads] [samples]
+*
+* The wall distances of an unstructured grid of (cells x cells)
+* triangle pairs with walls on all sides are computed with 1, 2, 4,
+* ... up to the given number of threads. Zero threads use all
+* available cores.
+*
+* The brute force search over all wall edges is evaluated for the
+* given number of sampled elements, which are used to check the
+* results and to extrapolate its time to the entire grid.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  const int cells     = ( argc > 1 ) ? std::atoi( argv[1] ) : 1000;
+  int       n_threads = ( argc > 2 ) ? std::atoi( argv[2] ) : 0;
+  const int n_samples = ( argc > 3 ) ? std::atoi( argv[3] ) : 1000;
+
+  if ( cells < 1 || n_samples < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0] << " [cells] [threads] [samples]";
+    return EXIT_FAILURE;
+  }
+
+  if ( n_threads < 1 )
+    n_threads = static_cast<int>( std::thread::hardware_concurrency() );
+
+  BoundaryDef bdry_def {};
+  for ( int marker = 1; marker <= 4; ++marker )
+    bdry_def.add_marker( marker, BdryType::WALL );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( cells, cells );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  // -----------------------------------------------------------------
+  // Quad tree search
+  LOG(INFO) << "";
+  LOG(INFO) << "  Threads   Build [s]      Query [s]      Points/s";
+  LOG(INFO) << "  -------   ------------   ------------   ------------";
+
+  DVec   dist {};
+  int    n_walls    = 0;
+  double query_time = 0.0;
+
+  for ( int n = 1; n <= n_threads; n *= 2 )
+  {
+    THREAD_POOL.n_threads( n );
+
+    WallDistance wall_dist { dgrid };
+    dist       = wall_dist.compute();
+    n_walls    = wall_dist.n_wall_edges();
+    query_time = wall_dist.query_time();
+
+    char line[160];
+    std::snprintf( line, sizeof(line), "  %7d   %12.6e   %12.6e   %12.6e",
+                   n, wall_dist.build_time(), query_time,
+                   n_elements / query_time );
+    LOG(INFO) << line;
+  }
+
+  // -----------------------------------------------------------------
+  // Brute force search for sampled elements
+  const DMat& xy     = dgrid.coords();
+  const int   stride = MAX( 1, n_elements / n_samples );
+
+  std::vector<std::pair<Vec2d,Vec2d>> walls;
+
+  for ( const auto& bdry : dgrid.boundaries() )
+    for ( int e = 0; e < bdry.n_prim_edges(); ++e )
+    {
+      const int v = bdry.prim_edges()[e][0];
+      const int w = bdry.prim_edges()[e][1];
+      walls.push_back( { Vec2d { xy[v][0], xy[v][1] },
+                         Vec2d { xy[w][0], xy[w][1] } } );
+    }
+
+  Timer timer {};
+  timer.count();
+
+  double deviation = 0.0;
+  int    n_checked = 0;
+
+  for ( int i = 0; i < n_elements; i += stride )
+  {
+    const Vec2d p { xy[i][0], xy[i][1] };
+    double d2 = 1.0E+100;
+
+    for ( const auto& wall : walls )
+      d2 = MIN( d2, vertex_edge_dist_sqr( p, wall.first, wall.second ) );
+
+    deviation = MAX( deviation, std::fabs( std::sqrt( d2 ) - dist[i] ) );
+    ++n_checked;
+  }
+
+  timer.count();
+
+  const double brute_force = timer.delta(0) * n_elements / n_checked;
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  " << n_elements << " elements, " << n_walls
+            << " wall edges";
+  LOG(INFO) << "  Brute force (extrapolated): " << brute_force << "s, "
+            << "speedup " << brute_force / query_time;
+  LOG(INFO) << "  Max. deviation of " << n_checked << " samples: "
+            << deviation;
+  LOG(INFO) << "";
+
+  return EXIT_SUCCESS;
+
+} // main()
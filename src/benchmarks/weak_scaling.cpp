@@ -0,0 +1,259 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Communicator.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "GraphPartitioner.h"
+#include "DomainDecomposition.h"
+#include "SubGridIO.h"
+#include "HaloExchange.h"
+#include "EdgeResidual.h"
+#include "RungeKutta.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Results of a single run
+*********************************************************************/
+struct ScalingResult
+{
+  int    n_ranks      { 0 };
+  int    n_elements   { 0 };
+  int    max_ghosts   { 0 };
+  double load_time    { 0.0 };
+  double step_time    { 0.0 };
+};
+
+/*********************************************************************
+* Advance a flow on a grid of (cells x cells) triangle pairs per
+* rank with explicit Runge-Kutta steps and measure the maximum
+* wall time per step over all ranks. The grid is pre-partitioned
+* by rank 0, such that every rank only loads its own sub-grid file.
+*********************************************************************/
+ScalingResult run_case(Communicator& comm, int cells, int n_steps)
+{
+  // Arrange the ranks on a (px x py) grid
+  int px = static_cast<int>( std::sqrt( comm.size() ) );
+  while ( comm.size() % px != 0 )
+    --px;
+  const int py = comm.size() / px;
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  // Rank 0 pre-partitions the global grid into sub-grid files
+  const std::string prefix { "weak_scaling_grid" };
+
+  if ( comm.rank() == 0 )
+  {
+    PrimaryGrid primgrid = GridGenerator::unstructured(
+      cells * px, cells * py, static_cast<double>( px ),
+      static_cast<double>( py ) );
+
+    DualGrid dgrid { primgrid, bdry_def };
+    GraphPartitioner partitioner { dgrid };
+    const IVec& parts = partitioner.partition( comm.size() );
+
+    DomainDecomposition decomp { primgrid, parts, comm.size() };
+    SubGridWriter writer {};
+
+    if ( !writer.write( decomp, prefix ) )
+      TERMINATE();
+  }
+
+  comm.barrier();
+
+  // Every rank only loads its own sub-grid
+  Timer startup {};
+  startup.count();
+
+  SubGridReader reader {};
+  SubGrid sub = reader.read( prefix, comm.rank(), comm.size() );
+
+  startup.count();
+
+  comm.barrier();
+  std::remove( subgrid_file_path( prefix, comm.rank() ).c_str() );
+
+  DualGrid local { sub.primary_grid(), bdry_def };
+
+  HaloExchange halo { sub, local, comm };
+  EdgeResidual residual { local };
+  RungeKutta   rk { RKScheme::LSRK4, local.n_elements(), N_FLOW_VARS };
+
+  DMat U ( local.n_elements(), N_FLOW_VARS );
+
+  for ( int i = 0; i < local.n_elements(); ++i )
+  {
+    const double x = local.coords()[i][0];
+    const double y = local.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.01 * x * y;
+    U[i][IU] = 1.0;
+    U[i][IV] = 0.01 * std::sin( x );
+  }
+
+  auto residual_func = [&](DMat& u, DMat& r)
+  { residual.compute( u, r, halo ); };
+
+  const double dt = 1.0E-4;
+
+  // Warm-up
+  rk.step( U, local.volumes(), dt, residual_func );
+  comm.barrier();
+
+  Timer timer {};
+  timer.count();
+
+  for ( int n = 0; n < n_steps; ++n )
+    rk.step( U, local.volumes(), dt, residual_func );
+
+  timer.count();
+
+  ScalingResult result {};
+
+  result.n_ranks    = comm.size();
+  result.n_elements = reader.n_global_vertices();
+  result.step_time  = comm.all_reduce_max( timer.delta(0) / n_steps );
+  result.load_time  = comm.all_reduce_max( startup.delta(0) );
+  result.max_ghosts = static_cast<int>(
+    comm.all_reduce_max( static_cast<double>( sub.n_ghosts() ) ) );
+
+  return result;
+
+} // run_case()
+
+/*********************************************************************
+* Print the results
+*********************************************************************/
+void print_results(const std::vector<ScalingResult>& results)
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "  Ranks   Elements   Max. ghosts   Load time [s]   Time/step [s]   Efficiency";
+  LOG(INFO) << "  -----   --------   -----------   -------------   -------------   ----------";
+
+  for ( const auto& r : results )
+  {
+    char line[160];
+    std::snprintf( line, sizeof(line),
+                   "  %5d   %8d   %11d   %13.6e   %13.6e   %10.3f",
+                   r.n_ranks, r.n_elements, r.max_ghosts, r.load_time,
+                   r.step_time,
+                   results.front().step_time / r.step_time );
+    LOG(INFO) << line;
+  }
+
+  LOG(INFO) << "";
+
+} // print_results()
+
+/*********************************************************************
+* Weak-scaling benchmark of the distributed solver
+*
+* Usage: weak_scaling [--mpi] [cells per rank] [max. ranks] [steps]
+*
+* Without --mpi, the benchmark is repeated for 1, 2, 4, ... local
+* processes up to the maximum number of ranks. With --mpi, a single
+* run is performed on all ranks of MPI_COMM_WORLD, e.g.
+*
+*   mpirun -np 8 weak_scaling --mpi 200
+*
+* Every rank owns about 2 x cells x cells dual elements.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  bool use_mpi = false;
+  std::vector<int> args;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    const std::string arg { argv[i] };
+
+    if ( arg == "--mpi" )
+      use_mpi = true;
+    else
+      args.push_back( std::atoi( argv[i] ) );
+  }
+
+  const int cells     = ( args.size() > 0 ) ? args[0] : 100;
+  const int max_ranks = ( args.size() > 1 ) ? args[1] : 4;
+  const int n_steps   = ( args.size() > 2 ) ? args[2] : 20;
+
+  if ( cells < 1 || max_ranks < 1 || n_steps < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " [--mpi] [cells per rank] [max. ranks] [steps]";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<ScalingResult> results;
+
+  if ( use_mpi )
+  {
+#ifdef CPPUTILS_USE_MPI
+    MPICommunicator comm { &argc, &argv };
+
+    ScalingResult result = run_case( comm, cells, n_steps );
+
+    if ( comm.rank() == 0 )
+    {
+      results.push_back( result );
+      print_results( results );
+    }
+
+    return EXIT_SUCCESS;
+#else
+    LOG(ERROR) << "IncomFlow was built without MPI support.";
+    return EXIT_FAILURE;
+#endif
+  }
+
+  for ( int n_ranks = 1; n_ranks <= max_ranks; n_ranks *= 2 )
+  {
+    // Rank 0 runs in this process and stores the result
+    const bool success = run_local_ranks( n_ranks, [&](Communicator& comm)
+    {
+      ScalingResult result = run_case( comm, cells, n_steps );
+
+      if ( comm.rank() == 0 )
+        results.push_back( result );
+    });
+
+    if ( !success )
+    {
+      LOG(ERROR) << "Weak-scaling run on " << n_ranks << " ranks failed.";
+      return EXIT_FAILURE;
+    }
+  }
+
+  print_results( results );
+
+  return EXIT_SUCCESS;
+
+} // main()
@@ -50,6 +50,23 @@ public:
   Boundary(const PrimaryGrid& pgrid, int marker, BdryType type) 
   : marker_          { marker     }
   , type_            { type       }
+  {
+    init( pgrid );
+  }
+
+  /*------------------------------------------------------------------
+  | Constructor for an empty boundary, whose structure is set up 
+  | later on with init()
+  ------------------------------------------------------------------*/
+  Boundary(int marker, BdryType type) 
+  : marker_          { marker     }
+  , type_            { type       }
+  {}
+
+  /*------------------------------------------------------------------
+  | Set up the boundary structure and its normals
+  ------------------------------------------------------------------*/
+  void init(const PrimaryGrid& pgrid)
   {
     init_structure( pgrid );
     compute_normals( pgrid );
@@ -222,13 +239,6 @@ private:
       dual_normals_[i1][1] += ny;
     }
 
-    std::cout << "BOUNDARY: " << marker_ << std::endl;
-    for ( int i_elem = 0; i_elem < n_dual_elements_; ++i_elem )
-      std::cout << dual_elements_[i_elem] << " - ("
-        << dual_normals_[i_elem][0] << ", " 
-        << dual_normals_[i_elem][1] << ")\n"; 
-    std::cout << "-----------------\n\n";
-
   } // compute_normals()
 
   /*------------------------------------------------------------------
@@ -237,8 +247,8 @@ private:
   int          marker_;
   BdryType     type_;
 
-  int          n_dual_elements_;
-  int          n_prim_edges_;
+  int          n_dual_elements_ { 0 };
+  int          n_prim_edges_    { 0 };
 
   IVec         dual_elements_;
   IMat         prim_edges_local_;  // Edges in local frame
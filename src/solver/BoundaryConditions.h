@@ -0,0 +1,363 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <map>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Physical flux of the artificial compressibility equations
+* through a face with (non-normalized) normal (nx,ny)
+*********************************************************************/
+inline void physical_flux(const double* u, double nx, double ny,
+                          double beta2, double* f)
+{
+  const double un = u[IU] * nx + u[IV] * ny;
+
+  f[IP] = beta2 * un;
+  f[IU] = u[IU] * un + u[IP] * nx;
+  f[IV] = u[IV] * un + u[IP] * ny;
+
+} // physical_flux()
+
+/*********************************************************************
+* Viscous coefficient of a wall face with (non-normalized) normal
+* (nx,ny), which closes the dual element of the given volume. The
+* wall distance of the element is approximated by volume / |n|,
+* such that the wall shear flux through the face becomes
+*
+*   f_uv = -kv * ( u_wall - u_i ),   kv = nu * |n|^2 / volume
+*********************************************************************/
+inline double wall_viscous_coefficient(double nx, double ny,
+                                       double volume, double nu)
+{
+  return nu * ( nx*nx + ny*ny ) / volume;
+
+} // wall_viscous_coefficient()
+
+/*********************************************************************
+* Prescribed values of a boundary
+*********************************************************************/
+struct BdryValues
+{
+  double p { 0.0 };
+  double u { 0.0 };
+  double v { 0.0 };
+};
+
+/*********************************************************************
+* Kernels for the boundary states of every boundary type.
+* The boundary state ub is computed from the state ui of the adjacent
+* dual element, the unit normal (ex,ey) pointing out of the domain
+* and the prescribed boundary values.
+*********************************************************************/
+template <BdryType Type>
+struct BdryKernel;
+
+/*--------------------------------------------------------------------
+| Inlet: Velocity is prescribed, pressure is extrapolated
+--------------------------------------------------------------------*/
+template <>
+struct BdryKernel<BdryType::INLET>
+{
+  static void state(const double* ui, double, double,
+                    const BdryValues& val, double* ub)
+  {
+    ub[IP] = ui[IP];
+    ub[IU] = val.u;
+    ub[IV] = val.v;
+  }
+};
+
+/*--------------------------------------------------------------------
+| Outlet: Pressure is prescribed, velocity is extrapolated
+--------------------------------------------------------------------*/
+template <>
+struct BdryKernel<BdryType::OUTLET>
+{
+  static void state(const double* ui, double, double,
+                    const BdryValues& val, double* ub)
+  {
+    ub[IP] = val.p;
+    ub[IU] = ui[IU];
+    ub[IV] = ui[IV];
+  }
+};
+
+/*--------------------------------------------------------------------
+| Wall: No-slip with the tangential component of the prescribed wall
+| velocity, such that moving walls do not generate a mass flux,
+| pressure is extrapolated. The wall velocity enters the momentum
+| equations through the viscous wall flux (see apply_kernel()).
+--------------------------------------------------------------------*/
+template <>
+struct BdryKernel<BdryType::WALL>
+{
+  static void state(const double* ui, double ex, double ey,
+                    const BdryValues& val, double* ub)
+  {
+    const double un = val.u * ex + val.v * ey;
+
+    ub[IP] = ui[IP];
+    ub[IU] = val.u - un * ex;
+    ub[IV] = val.v - un * ey;
+  }
+};
+
+/*--------------------------------------------------------------------
+| Symmetry: The normal velocity component is removed,
+| pressure is extrapolated
+--------------------------------------------------------------------*/
+template <>
+struct BdryKernel<BdryType::SYMMETRY>
+{
+  static void state(const double* ui, double ex, double ey,
+                    const BdryValues&, double* ub)
+  {
+    const double un = ui[IU] * ex + ui[IV] * ey;
+
+    ub[IP] = ui[IP];
+    ub[IU] = ui[IU] - un * ex;
+    ub[IV] = ui[IV] - un * ey;
+  }
+};
+
+/*--------------------------------------------------------------------
+| Periodic: The state of the adjacent element is used. The fluxes
+| of paired boundaries cancel, once their residuals are merged
+| (see PeriodicBoundaries.h)
+--------------------------------------------------------------------*/
+template <>
+struct BdryKernel<BdryType::PERIODIC>
+{
+  static void state(const double* ui, double, double,
+                    const BdryValues&, double* ub)
+  {
+    ub[IP] = ui[IP];
+    ub[IU] = ui[IU];
+    ub[IV] = ui[IV];
+  }
+};
+
+/*********************************************************************
+* This class applies the boundary conditions of all boundaries of a
+* dual grid. For every boundary element, the boundary state and the
+* flux through the boundary face, which leaves the domain, are
+* stored in the BoundaryData of its boundary:
+*
+*   bdry_data().var(k)[i]   -> Boundary state of variable k
+*   bdry_data().mflux(k)[i] -> Boundary flux of variable k
+*
+* The type of a boundary is resolved once per boundary, which then
+* runs the loop over its elements with the kernel of its type
+* (see BdryKernel). Thus, the element loops are free of branches on
+* the boundary type.
+*
+* Walls additionally add the viscous shear flux between the wall
+* velocity and the element velocity (see wall_viscous_coefficient()),
+* which imposes the no-slip condition weakly.
+*
+* Prescribed values are set per marker with values(). The wall time
+* of all boundaries of a type is accumulated in type_time().
+*********************************************************************/
+class BoundaryConditions
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  BoundaryConditions(DualGrid& dgrid)
+  : dgrid_      { dgrid              }
+  , type_times_ ( N_BDRY_TYPES, 0.0 )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void values(int marker, const BdryValues& val)
+  { values_[marker] = val; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const DualGrid& dual_grid() const { return dgrid_; }
+
+  BdryValues values(int marker) const
+  {
+    auto it = values_.find( marker );
+    return ( it == values_.end() ) ? BdryValues {} : it->second;
+  }
+
+  double type_time(BdryType type) const
+  { return type_times_[ static_cast<int>(type) ]; }
+
+  /*------------------------------------------------------------------
+  | Compute the boundary states and fluxes of the solution U
+  ------------------------------------------------------------------*/
+  void apply(const DMat& U)
+  {
+    PROFILE_SCOPE( "BoundaryConditions::apply" );
+
+    ASSERT( U.rows() == dgrid_.n_elements(),
+      "BoundaryConditions: Invalid size of solution matrix.");
+
+    for ( auto& bdry : dgrid_.boundaries() )
+    {
+      Timer timer {};
+      timer.count();
+
+      switch ( bdry.type() )
+      {
+        case BdryType::INLET:
+          apply_kernel<BdryType::INLET>( bdry, U );
+          break;
+
+        case BdryType::OUTLET:
+          apply_kernel<BdryType::OUTLET>( bdry, U );
+          break;
+
+        case BdryType::WALL:
+          apply_kernel<BdryType::WALL>( bdry, U );
+          break;
+
+        case BdryType::SYMMETRY:
+          apply_kernel<BdryType::SYMMETRY>( bdry, U );
+          break;
+
+        case BdryType::PERIODIC:
+          apply_kernel<BdryType::PERIODIC>( bdry, U );
+          break;
+
+        default:
+          LOG(ERROR) << "BoundaryConditions: Invalid type of boundary "
+                     << bdry.marker() << ".";
+          TERMINATE();
+      }
+
+      timer.count();
+      type_times_[ static_cast<int>( bdry.type() ) ] += timer.delta(0);
+    }
+
+  } // apply()
+
+  /*------------------------------------------------------------------
+  | Add the boundary fluxes of the last apply() to the residual R.
+  | Corner elements belong to several boundaries, hence only the
+  | elements of a single boundary are processed in parallel.
+  ------------------------------------------------------------------*/
+  void add_fluxes(DMat& R) const
+  {
+    PROFILE_SCOPE( "BoundaryConditions::add_fluxes" );
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec&         elements = bdry.dual_elements();
+      const BoundaryData& data     = bdry.bdry_data();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          R[i][k] += data.mflux(k)[i_elem];
+      });
+    }
+
+  } // add_fluxes()
+
+  /*------------------------------------------------------------------
+  | Reset the timings
+  ------------------------------------------------------------------*/
+  void reset_timings()
+  { std::fill( type_times_.begin(), type_times_.end(), 0.0 ); }
+
+private:
+  /*------------------------------------------------------------------
+  | Boundary states and fluxes of a boundary of the given type.
+  | Boundary normals point into the domain.
+  ------------------------------------------------------------------*/
+  template <BdryType Type>
+  void apply_kernel(Boundary& bdry, const DMat& U)
+  {
+    const IVec&      elements = bdry.dual_elements();
+    const DMat&      normals  = bdry.dual_normals();
+    const DVec&      volumes  = dgrid_.volumes();
+    const BdryValues val      = values( bdry.marker() );
+    const double     beta2    = CONSTANTS.art_compressibility();
+    const double     nu       = CONSTANTS.viscosity();
+
+    BoundaryData& data = bdry.bdry_data();
+
+    double* var[N_FLOW_VARS];
+    double* flux[N_FLOW_VARS];
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      var[k]  = data.var(k).data();
+      flux[k] = data.mflux(k).data();
+    }
+
+    THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+    {
+      const int    i   = elements[i_elem];
+      const double nx  = -normals[i_elem][0];
+      const double ny  = -normals[i_elem][1];
+      const double len = std::sqrt( nx*nx + ny*ny );
+
+      double ub[N_FLOW_VARS];
+      double f[N_FLOW_VARS];
+
+      BdryKernel<Type>::state( U[i], nx / len, ny / len, val, ub );
+      physical_flux( ub, nx, ny, beta2, f );
+
+      if constexpr ( Type == BdryType::WALL )
+      {
+        const double kv
+          = wall_viscous_coefficient( nx, ny, volumes[i], nu );
+
+        f[IU] -= kv * ( ub[IU] - U[i][IU] );
+        f[IV] -= kv * ( ub[IV] - U[i][IV] );
+      }
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+      {
+        var[k][i_elem]  = ub[k];
+        flux[k][i_elem] = f[k];
+      }
+    });
+
+  } // apply_kernel()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  static constexpr int N_BDRY_TYPES
+    = static_cast<int>( BdryType::WALL ) + 1;
+
+  DualGrid&                 dgrid_;
+  std::map<int, BdryValues> values_;
+  DVec                      type_times_;
+
+}; // BoundaryConditions
+
+} // namespace Solver
+} // namespace IncomFlow
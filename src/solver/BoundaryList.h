@@ -52,8 +52,15 @@ public:
     {
       int marker    = key_val.first;
       BdryType type = key_val.second;
-      boundaries_.push_back( { pgrid, marker, type } );
+      boundaries_.push_back( { marker, type } );
     }
+
+    // The boundaries are independent of each other and 
+    // are set up in parallel
+    THREAD_POOL.parallel_for(0, size(), 1, [&](int i)
+    {
+      boundaries_[i].init( pgrid );
+    });
   }
 
   /*------------------------------------------------------------------
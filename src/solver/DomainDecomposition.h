@@ -0,0 +1,375 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "Log.h"
+#include "Helpers.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Marker of the primary boundary edges, which are introduced at the
+* outer rim of the ghost layer of a sub-grid. Negative markers are
+* ignored by BoundaryDef, hence no boundary is created for them.
+*********************************************************************/
+constexpr int GHOST_MARKER { -1 };
+
+/*********************************************************************
+* This class represents the part of a primary grid, which is owned
+* by a single rank of a distributed run, including a layer of
+* ghost vertices.
+*
+* The sub-grid contains all primary elements, which are adjacent
+* to at least one owned vertex. Thus, the median dual elements of
+* all owned vertices are complete and the fluxes of all their faces
+* are available locally. The remaining vertices of these elements
+* are the ghosts, whose solution is received from their owners.
+*
+* Local vertex numbering:
+* -----------------------
+*   [ 0 ... n_owned-1 ]          Owned vertices (ascending global id)
+*   [ n_owned ... n_vertices-1 ] Ghost vertices, grouped by owner
+*
+* Communication pattern:
+* ----------------------
+* For every neighbor rank, send_elements() holds the local indices
+* of all owned vertices, which are ghosts on the neighbor, and
+* recv_elements() holds the local indices of all ghosts owned by
+* the neighbor. Both lists are sorted by global vertex id, such
+* that the send list of rank p to rank q matches the receive list
+* of rank q from rank p.
+*********************************************************************/
+class SubGrid
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  SubGrid(PrimaryGrid&& grid, int rank, int n_owned,
+          IVec&& local_to_global, IVec&& neighbor_ranks,
+          std::vector<IVec>&& send_elements,
+          std::vector<IVec>&& recv_elements)
+  : grid_            { std::move(grid)            }
+  , rank_            { rank                       }
+  , n_owned_         { n_owned                    }
+  , local_to_global_ { std::move(local_to_global) }
+  , neighbor_ranks_  { std::move(neighbor_ranks)  }
+  , send_elements_   { std::move(send_elements)   }
+  , recv_elements_   { std::move(recv_elements)   }
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  PrimaryGrid& primary_grid() { return grid_; }
+  const PrimaryGrid& primary_grid() const { return grid_; }
+
+  int rank() const { return rank_; }
+  int n_owned() const { return n_owned_; }
+  int n_ghosts() const { return grid_.n_vertices() - n_owned_; }
+  int n_vertices() const { return grid_.n_vertices(); }
+
+  const IVec& local_to_global() const { return local_to_global_; }
+  const IVec& neighbor_ranks() const { return neighbor_ranks_; }
+  int n_neighbors() const { return neighbor_ranks_.size(); }
+
+  const std::vector<IVec>& send_elements() const { return send_elements_; }
+  const std::vector<IVec>& recv_elements() const { return recv_elements_; }
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  PrimaryGrid       grid_;
+  int               rank_;
+  int               n_owned_;
+
+  IVec              local_to_global_;
+  IVec              neighbor_ranks_;
+  std::vector<IVec> send_elements_;
+  std::vector<IVec> recv_elements_;
+
+}; // SubGrid
+
+/*********************************************************************
+* This class splits a primary grid into sub-grids with ghost layers
+* for a given partition of its vertices, i.e. of the dual elements
+* (see GraphPartitioner.h).
+*
+* Interior edges of the global grid, for which only one adjacent
+* element is part of a sub-grid, become boundary edges with the
+* GHOST_MARKER. They only touch ghost vertices. All other boundary
+* edges keep their markers, such that every rank sets up the
+* boundaries of its local dual grid on its own.
+*********************************************************************/
+class DomainDecomposition
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  DomainDecomposition(const PrimaryGrid& pgrid, const IVec& parts,
+                      int n_parts)
+  : pgrid_   { pgrid   }
+  , parts_   { parts   }
+  , n_parts_ { n_parts }
+  {
+    ASSERT( static_cast<int>( parts.size() ) == pgrid.n_vertices(),
+      "DomainDecomposition: Invalid size of partition vector.");
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_parts() const { return n_parts_; }
+  const IVec& parts() const { return parts_; }
+
+  /*------------------------------------------------------------------
+  | Extract the sub-grid of the given rank
+  ------------------------------------------------------------------*/
+  SubGrid subgrid(int rank) const
+  {
+    ASSERT( rank >= 0 && rank < n_parts_,
+      "DomainDecomposition: Invalid rank.");
+
+    const int n_quads = pgrid_.n_quads();
+    const int n_elems = n_quads + pgrid_.n_tris();
+    const int n_verts = pgrid_.n_vertices();
+
+    auto elem_vertices = [&](int e, const int*& v, int& n)
+    {
+      v = ( e < n_quads ) ? pgrid_.quads()[e] : pgrid_.tris()[e-n_quads];
+      n = ( e < n_quads ) ? 4 : 3;
+    };
+
+    // Elements adjacent to owned vertices and their global to
+    // local index map (quads first, followed by triangles)
+    IVec elem_map ( n_elems, -1 );
+    IVec elements;
+    int  n_local_quads = 0;
+
+    for ( int e = 0; e < n_elems; ++e )
+    {
+      const int* v; int n;
+      elem_vertices( e, v, n );
+
+      for ( int k = 0; k < n; ++k )
+        if ( parts_[v[k]] == rank )
+        {
+          elem_map[e] = static_cast<int>( elements.size() );
+          elements.push_back( e );
+          if ( e < n_quads )
+            ++n_local_quads;
+          break;
+        }
+    }
+
+    // Owned vertices, ghosts and the vertices to send
+    IVec vert_map ( n_verts, -1 );
+    IVec ghosts;
+    std::vector<IVec> sends ( n_parts_ );
+
+    for ( int e : elements )
+    {
+      const int* v; int n;
+      elem_vertices( e, v, n );
+
+      for ( int k = 0; k < n; ++k )
+      {
+        const int q = parts_[v[k]];
+
+        if ( q == rank )
+          continue;
+
+        if ( vert_map[v[k]] < 0 )
+        {
+          vert_map[v[k]] = 0;
+          ghosts.push_back( v[k] );
+        }
+
+        for ( int l = 0; l < n; ++l )
+          if ( parts_[v[l]] == rank )
+            sends[q].push_back( v[l] );
+      }
+    }
+
+    IVec local_to_global;
+
+    for ( int i = 0; i < n_verts; ++i )
+      if ( parts_[i] == rank )
+        local_to_global.push_back( i );
+
+    const int n_owned = static_cast<int>( local_to_global.size() );
+
+    std::sort( ghosts.begin(), ghosts.end(), [&](int a, int b)
+    {
+      return ( parts_[a] != parts_[b] ) ? parts_[a] < parts_[b] : a < b;
+    });
+
+    local_to_global.insert( local_to_global.end(),
+                            ghosts.begin(), ghosts.end() );
+
+    for ( std::size_t i = 0; i < local_to_global.size(); ++i )
+      vert_map[ local_to_global[i] ] = static_cast<int>( i );
+
+    // Communication pattern
+    IVec neighbor_ranks;
+    std::vector<IVec> send_elements;
+    std::vector<IVec> recv_elements;
+
+    for ( int q = 0; q < n_parts_; ++q )
+    {
+      if ( sends[q].empty() )
+        continue;
+
+      IVec& s = sends[q];
+      std::sort( s.begin(), s.end() );
+      s.erase( std::unique( s.begin(), s.end() ), s.end() );
+
+      for ( int& v : s )
+        v = vert_map[v];
+
+      IVec r;
+      for ( int i = n_owned; i < static_cast<int>( local_to_global.size() ); ++i )
+        if ( parts_[ local_to_global[i] ] == q )
+          r.push_back( i );
+
+      neighbor_ranks.push_back( q );
+      send_elements.push_back( std::move(s) );
+      recv_elements.push_back( std::move(r) );
+    }
+
+    // Classify the edges of the sub-grid
+    IVec intr_edges;
+    IVec bdry_edges;
+    IVec bdry_markers;
+
+    for ( int i = 0; i < pgrid_.n_intr_edges(); ++i )
+    {
+      const int l = elem_map[ pgrid_.intr_edge_neighbors()[i][0] ];
+      const int r = elem_map[ pgrid_.intr_edge_neighbors()[i][1] ];
+
+      if ( l >= 0 && r >= 0 )
+        intr_edges.push_back( i );
+      else if ( l >= 0 || r >= 0 )
+      {
+        bdry_edges.push_back( i );
+        bdry_markers.push_back( GHOST_MARKER );
+      }
+    }
+
+    IVec global_bdry_edges;
+
+    for ( int i = 0; i < pgrid_.n_bdry_edges(); ++i )
+      if ( elem_map[ pgrid_.bdry_edge_neighbors()[i] ] >= 0 )
+        global_bdry_edges.push_back( i );
+
+    PrimaryGrid grid { static_cast<int>( local_to_global.size() ),
+                       static_cast<int>( elements.size() ) - n_local_quads,
+                       n_local_quads,
+                       static_cast<int>( intr_edges.size() ),
+                       static_cast<int>( bdry_edges.size()
+                                       + global_bdry_edges.size() ) };
+
+    for ( std::size_t i = 0; i < local_to_global.size(); ++i )
+    {
+      grid.vertex_coords()[i][0] = pgrid_.vertex_coords()[local_to_global[i]][0];
+      grid.vertex_coords()[i][1] = pgrid_.vertex_coords()[local_to_global[i]][1];
+    }
+
+    auto local_elem = [&](int e) { return ( e < 0 ) ? -1 : elem_map[e]; };
+
+    for ( std::size_t i = 0; i < elements.size(); ++i )
+    {
+      const int e = elements[i];
+      const int* v; int n;
+      elem_vertices( e, v, n );
+
+      const int* nbrs = ( e < n_quads ) ? pgrid_.quad_neighbors()[e]
+                                        : pgrid_.tri_neighbors()[e-n_quads];
+
+      int* lv = ( e < n_quads ) ? grid.quads()[i]
+                                : grid.tris()[i-n_local_quads];
+      int* ln = ( e < n_quads ) ? grid.quad_neighbors()[i]
+                                : grid.tri_neighbors()[i-n_local_quads];
+
+      for ( int k = 0; k < n; ++k )
+      {
+        lv[k] = vert_map[ v[k] ];
+        ln[k] = local_elem( nbrs[k] );
+      }
+    }
+
+    for ( std::size_t i = 0; i < intr_edges.size(); ++i )
+    {
+      const int g = intr_edges[i];
+      grid.intr_edges()[i][0] = vert_map[ pgrid_.intr_edges()[g][0] ];
+      grid.intr_edges()[i][1] = vert_map[ pgrid_.intr_edges()[g][1] ];
+      grid.intr_edge_neighbors()[i][0]
+        = elem_map[ pgrid_.intr_edge_neighbors()[g][0] ];
+      grid.intr_edge_neighbors()[i][1]
+        = elem_map[ pgrid_.intr_edge_neighbors()[g][1] ];
+    }
+
+    // Cut edges are oriented with the local element on their left
+    for ( std::size_t i = 0; i < bdry_edges.size(); ++i )
+    {
+      const int g = bdry_edges[i];
+      const int l = elem_map[ pgrid_.intr_edge_neighbors()[g][0] ];
+      const int r = elem_map[ pgrid_.intr_edge_neighbors()[g][1] ];
+
+      const int v0 = vert_map[ pgrid_.intr_edges()[g][0] ];
+      const int v1 = vert_map[ pgrid_.intr_edges()[g][1] ];
+
+      grid.bdry_edges()[i][0] = ( l >= 0 ) ? v0 : v1;
+      grid.bdry_edges()[i][1] = ( l >= 0 ) ? v1 : v0;
+      grid.bdry_edge_neighbors()[i] = ( l >= 0 ) ? l : r;
+      grid.bdry_edge_markers()[i] = GHOST_MARKER;
+    }
+
+    const int offset = static_cast<int>( bdry_edges.size() );
+
+    for ( std::size_t i = 0; i < global_bdry_edges.size(); ++i )
+    {
+      const int g = global_bdry_edges[i];
+      grid.bdry_edges()[offset+i][0] = vert_map[ pgrid_.bdry_edges()[g][0] ];
+      grid.bdry_edges()[offset+i][1] = vert_map[ pgrid_.bdry_edges()[g][1] ];
+      grid.bdry_edge_neighbors()[offset+i]
+        = elem_map[ pgrid_.bdry_edge_neighbors()[g] ];
+      grid.bdry_edge_markers()[offset+i] = pgrid_.bdry_edge_markers()[g];
+    }
+
+    return SubGrid { std::move(grid), rank, n_owned,
+                     std::move(local_to_global), std::move(neighbor_ranks),
+                     std::move(send_elements), std::move(recv_elements) };
+
+  } // subgrid()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const PrimaryGrid& pgrid_;
+  IVec               parts_;
+  int                n_parts_;
+
+}; // DomainDecomposition
+
+} // namespace Solver
+} // namespace IncomFlow
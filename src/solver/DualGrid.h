@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "Log.h"
+#include "Helpers.h"
 
 #include "definitions.h"
 #include "PrimaryGrid.h"
@@ -24,6 +25,9 @@ using namespace CppUtils;
 
 /*********************************************************************
 * This class represents a median dual grid
+*
+* The grid metrics are computed in parallel loops of the global 
+* thread pool (see ThreadPool.h).
 *********************************************************************/
 class DualGrid
 {
@@ -33,13 +37,18 @@ public:
   ------------------------------------------------------------------*/
   DualGrid(const PrimaryGrid& pg, const BoundaryDef& bd) 
   : n_elements_     { pg.n_vertices()      }
-  , n_intr_faces_   { pg.n_intr_edges()    }
-  , coords_         ( pg.n_vertices(),   2 )
-  , face_normals_   ( pg.n_intr_edges(), 2 )
-  , face_neighbors_ ( pg.n_intr_edges(), 2 )
+  , n_intr_faces_   { pg.n_intr_edges() + pg.n_bdry_edges() }
+  , coords_         ( pg.n_vertices(),   2, THREAD_POOL )
+  , face_normals_   ( n_intr_faces_,     2, THREAD_POOL )
+  , face_neighbors_ ( n_intr_faces_,     2, THREAD_POOL )
   , volumes_        ( pg.n_vertices()      )
   , boundaries_     { pg, bd }
-  {}
+  {
+    init_coords( pg );
+    compute_volumes( pg );
+    compute_face_normals( pg );
+    init_adjacency();
+  }
 
   /*------------------------------------------------------------------
   | Getters
@@ -65,8 +74,259 @@ public:
   BoundaryList& boundaries() { return boundaries_; }
   const BoundaryList& boundaries() const { return boundaries_; }
 
+  IVec& adj_offsets() { return adj_offsets_; }
+  const IVec& adj_offsets() const { return adj_offsets_; }
+
+  IVec& adj_elements() { return adj_elements_; }
+  const IVec& adj_elements() const { return adj_elements_; }
+
+  IVec& adj_faces() { return adj_faces_; }
+  const IVec& adj_faces() const { return adj_faces_; }
+
 
 private:
+  /*------------------------------------------------------------------
+  | The median dual elements are located at the primary grid 
+  | vertices
+  ------------------------------------------------------------------*/
+  void init_coords(const PrimaryGrid& pg)
+  {
+    const DMat& xy = pg.vertex_coords();
+
+    THREAD_POOL.parallel_for(0, n_elements_, [&](int i)
+    {
+      coords_[i][0] = xy[i][0];
+      coords_[i][1] = xy[i][1];
+    });
+
+  } // init_coords()
+
+  /*------------------------------------------------------------------
+  | Compute the volumes of the median dual elements.
+  | Every primary element is split into sub-quads that are spanned 
+  | by a vertex, its adjacent edge midpoints and the element 
+  | centroid:
+  |
+  |      v3 x------o------x v2
+  |         |      :      |
+  |         |      :      |
+  |         o......c......o
+  |         |      :      |
+  |         |      :      |
+  |      v0 x------o------x v1
+  |
+  | Each sub-quad is added to the dual element of its vertex.
+  | The sub-quad areas are computed in parallel and gathered 
+  | afterwards in the order of the primary elements.
+  ------------------------------------------------------------------*/
+  void compute_volumes(const PrimaryGrid& pg)
+  {
+    for ( int i = 0; i < n_elements_; ++i )
+      volumes_[i] = 0.0;
+
+    const DMat& xy = pg.vertex_coords();
+
+    const int n_tris = pg.n_tris();
+
+    // Sub-quad areas: 3 per triangle, followed by 4 per quad
+    DVec sub_areas ( 3 * n_tris + 4 * pg.n_quads() );
+
+    auto sub_quad_areas = [&](const int* v, int n_verts, double* area)
+    {
+      double cx = 0.0;
+      double cy = 0.0;
+
+      for ( int k = 0; k < n_verts; ++k )
+      {
+        cx += xy[v[k]][0];
+        cy += xy[v[k]][1];
+      }
+
+      cx /= static_cast<double>( n_verts );
+      cy /= static_cast<double>( n_verts );
+
+      for ( int k = 0; k < n_verts; ++k )
+      {
+        const int vp = v[(k+n_verts-1) % n_verts];
+        const int vq = v[(k+1) % n_verts];
+
+        const double px = xy[v[k]][0];
+        const double py = xy[v[k]][1];
+
+        const double ax = 0.5 * ( px + xy[vq][0] );
+        const double ay = 0.5 * ( py + xy[vq][1] );
+
+        const double bx = 0.5 * ( px + xy[vp][0] );
+        const double by = 0.5 * ( py + xy[vp][1] );
+
+        // Shoelace formula for the sub-quad (v, a, c, b)
+        area[k] = 0.5 * ( (px*ay - ax*py) + (ax*cy - cx*ay) 
+                        + (cx*by - bx*cy) + (bx*py - px*by) );
+      }
+    };
+
+    THREAD_POOL.parallel_for(0, n_tris, [&](int i)
+    { sub_quad_areas( pg.tris()[i], 3, &sub_areas[3*i] ); });
+
+    THREAD_POOL.parallel_for(0, pg.n_quads(), [&](int i)
+    { sub_quad_areas( pg.quads()[i], 4, &sub_areas[3*n_tris + 4*i] ); });
+
+    for ( int i = 0; i < n_tris; ++i )
+      for ( int k = 0; k < 3; ++k )
+        volumes_[ pg.tris()[i][k] ] += sub_areas[3*i + k];
+
+    for ( int i = 0; i < pg.n_quads(); ++i )
+      for ( int k = 0; k < 4; ++k )
+        volumes_[ pg.quads()[i][k] ] += sub_areas[3*n_tris + 4*i + k];
+
+  } // compute_volumes()
+
+  /*------------------------------------------------------------------
+  | Compute the normals of all interior median dual faces. 
+  | Every face belongs to a primary grid edge (v0,v1) and connects
+  | the centroids of its adjacent primary elements via the edge 
+  | midpoint. Primary boundary edges have only one adjacent element,
+  | but their dual faces still separate two dual elements:
+  |
+  |             c_l                          c 
+  |              o                           o
+  |   v0 x-------o-------x v1     v0 x-------o-------x v1  
+  |              m                           m     
+  |              o                       
+  |             c_r                      
+  |
+  | The faces of all interior primary edges are stored first, 
+  | followed by the faces of all boundary primary edges.
+  | -> Normals point from the dual element at v0 towards the 
+  |    dual element at v1
+  ------------------------------------------------------------------*/
+  void compute_face_normals(const PrimaryGrid& pg)
+  {
+    const DMat& xy          = pg.vertex_coords();
+    const IMat& intr_edges  = pg.intr_edges();
+    const IMat& intr_nbrs   = pg.intr_edge_neighbors();
+    const IMat& bdry_edges  = pg.bdry_edges();
+    const IVec& bdry_nbrs   = pg.bdry_edge_neighbors();
+    const int   n_quads     = pg.n_quads();
+
+    // Element indices refer to quads first, followed by triangles
+    auto centroid = [&](int i_elem, double& cx, double& cy)
+    {
+      const int* v = (i_elem < n_quads) 
+                   ? pg.quads()[i_elem] 
+                   : pg.tris()[i_elem-n_quads];
+      const int n_verts = (i_elem < n_quads) ? 4 : 3;
+
+      cx = 0.0;
+      cy = 0.0;
+
+      for ( int k = 0; k < n_verts; ++k )
+      {
+        cx += xy[v[k]][0];
+        cy += xy[v[k]][1];
+      }
+
+      cx /= static_cast<double>( n_verts );
+      cy /= static_cast<double>( n_verts );
+    };
+
+    // The normal of a polyline equals its rotated chord
+    auto set_face = [&](int i_face, int v0, int v1, 
+                        double ax, double ay, double bx, double by)
+    {
+      face_neighbors_[i_face][0] = v0;
+      face_neighbors_[i_face][1] = v1;
+
+      double nx =  ( by - ay );
+      double ny = -( bx - ax );
+
+      const double dx = xy[v1][0] - xy[v0][0];
+      const double dy = xy[v1][1] - xy[v0][1];
+
+      if ( nx * dx + ny * dy < 0.0 )
+      {
+        nx = -nx;
+        ny = -ny;
+      }
+
+      face_normals_[i_face][0] = nx;
+      face_normals_[i_face][1] = ny;
+    };
+
+    const int n_intr_edges = pg.n_intr_edges();
+
+    THREAD_POOL.parallel_for(0, n_intr_edges, [&](int i_edge)
+    {
+      ASSERT( intr_nbrs[i_edge][0] >= 0 && intr_nbrs[i_edge][1] >= 0,
+      "Interior primary grid edge without two adjacent elements.");
+
+      double lx, ly, rx, ry;
+      centroid( intr_nbrs[i_edge][0], lx, ly );
+      centroid( intr_nbrs[i_edge][1], rx, ry );
+
+      set_face( i_edge, intr_edges[i_edge][0], intr_edges[i_edge][1],
+                rx, ry, lx, ly );
+    });
+
+    THREAD_POOL.parallel_for(0, pg.n_bdry_edges(), [&](int i_edge)
+    {
+      ASSERT( bdry_nbrs[i_edge] >= 0,
+      "Boundary primary grid edge without adjacent element.");
+
+      const int v0 = bdry_edges[i_edge][0];
+      const int v1 = bdry_edges[i_edge][1];
+
+      double cx, cy;
+      centroid( bdry_nbrs[i_edge], cx, cy );
+
+      const double mx = 0.5 * ( xy[v0][0] + xy[v1][0] );
+      const double my = 0.5 * ( xy[v0][1] + xy[v1][1] );
+
+      set_face( n_intr_edges + i_edge, v0, v1, mx, my, cx, cy );
+    });
+
+  } // compute_face_normals()
+
+  /*------------------------------------------------------------------
+  | Set up the element adjacency in compressed sparse row format.
+  | The neighbors of element i are located at 
+  |
+  |   adj_elements_[ adj_offsets_[i] ... adj_offsets_[i+1]-1 ]
+  |
+  | and adj_faces_ holds the associated dual faces. 
+  ------------------------------------------------------------------*/
+  void init_adjacency()
+  {
+    adj_offsets_.assign( n_elements_ + 1, 0 );
+
+    for ( int i_face = 0; i_face < n_intr_faces_; ++i_face )
+    {
+      ++adj_offsets_[ face_neighbors_[i_face][0] + 1 ];
+      ++adj_offsets_[ face_neighbors_[i_face][1] + 1 ];
+    }
+
+    for ( int i = 0; i < n_elements_; ++i )
+      adj_offsets_[i+1] += adj_offsets_[i];
+
+    adj_elements_.resize( adj_offsets_[n_elements_] );
+    adj_faces_.resize( adj_offsets_[n_elements_] );
+
+    IVec fill ( adj_offsets_.begin(), adj_offsets_.end()-1 );
+
+    for ( int i_face = 0; i_face < n_intr_faces_; ++i_face )
+    {
+      const int i = face_neighbors_[i_face][0];
+      const int j = face_neighbors_[i_face][1];
+
+      adj_elements_[ fill[i] ] = j;
+      adj_faces_[ fill[i]++ ]  = i_face;
+
+      adj_elements_[ fill[j] ] = i;
+      adj_faces_[ fill[j]++ ]  = i_face;
+    }
+
+  } // init_adjacency()
+
   /*------------------------------------------------------------------
   | Attributes
   ------------------------------------------------------------------*/
@@ -82,6 +342,9 @@ private:
 
   BoundaryList boundaries_;
 
+  IVec         adj_offsets_;
+  IVec         adj_elements_;
+  IVec         adj_faces_;
 
 }; // DualGrid
 
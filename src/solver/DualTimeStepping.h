@@ -0,0 +1,301 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "EdgeResidual.h"
+#include "FluxJacobian.h"
+#include "LocalTimeStep.h"
+#include "SparseMatrix.h"
+#include "LinearSolver.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class advances the artificial compressibility equations in
+* physical time with the second-order backward difference formula
+* (BDF2) and dual time stepping. Every physical step drives the
+* unsteady residual
+*
+*   R*(U) = V / dt * ( c0 * U + c1 * U^n + c2 * U^n-1 ) + R(U)
+*
+* to zero with implicit pseudo-time iterations
+*
+*   ( V/dtau + c0 * V/dt + dR/dU ) * dU = -R*(U)
+*
+* The coefficients account for a varying step size with the ratio
+* w = dt / dt_prev of the current and the previous physical step:
+*
+*   c0 = (1 + 2w) / (1 + w),   c1 = -(1 + w),   c2 = w^2 / (1 + w)
+*
+* The first physical step uses the implicit Euler scheme (w = 0).
+*
+* The spatial residual R(U) is configured via residual(), e.g. with
+* boundary conditions or a second-order reconstruction. The system
+* matrix always holds the first-order Jacobian, such that the inner
+* iterations become a defect correction for second-order residuals.
+*
+* Jacobian reuse:
+* ---------------
+* The system matrix and its block Gauss-Seidel preconditioner are
+* only rebuilt, if the residual reduction of an inner iteration
+* is worse than the refresh rate, or if the physical time step
+* changed. Otherwise, the frozen matrix of an earlier inner
+* iteration (or physical step) is used. The ratio of matrix
+* rebuilds to inner iterations is available via rebuild_ratio().
+*********************************************************************/
+class DualTimeStepping
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  DualTimeStepping(const DualGrid& dgrid, double pseudo_cfl=50.0)
+  : dgrid_       { dgrid                           }
+  , residual_    { dgrid                           }
+  , jacobian_    { dgrid                           }
+  , pseudo_dt_   { dgrid, pseudo_cfl               }
+  , system_      { dgrid, N_FLOW_VARS              }
+  , R_           ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , U_n_         ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , U_nm1_       ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , diag_        ( dgrid.n_elements()              )
+  , rhs_         ( dgrid.n_elements() * N_FLOW_VARS )
+  , dU_          ( dgrid.n_elements() * N_FLOW_VARS )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void pseudo_cfl(double c) { pseudo_dt_.cfl(c); }
+  void max_inner_iter(int n) { max_inner_iter_ = n; }
+  void inner_tolerance(double t) { inner_tol_ = t; }
+  void refresh_rate(double r) { refresh_rate_ = r; }
+  void reuse_jacobian(bool r) { reuse_jacobian_ = r; }
+  void n_sweeps(int n) { preconditioner_.n_sweeps(n); }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  EdgeResidual& residual() { return residual_; }
+  const EdgeResidual& residual() const { return residual_; }
+
+  double pseudo_cfl() const { return pseudo_dt_.cfl(); }
+  int max_inner_iter() const { return max_inner_iter_; }
+  double inner_tolerance() const { return inner_tol_; }
+  double refresh_rate() const { return refresh_rate_; }
+  bool reuse_jacobian() const { return reuse_jacobian_; }
+
+  int n_steps() const { return n_steps_; }
+  int n_inner_iterations() const { return n_inner_iter_; }
+  int n_jacobian_builds() const { return n_builds_; }
+  double inner_residual() const { return inner_res_; }
+
+  /*------------------------------------------------------------------
+  | Ratio of Jacobian rebuilds to inner iterations
+  ------------------------------------------------------------------*/
+  double rebuild_ratio() const
+  {
+    if ( n_inner_iter_ < 1 )
+      return 0.0;
+
+    return static_cast<double>( n_builds_ )
+         / static_cast<double>( n_inner_iter_ );
+  }
+
+  /*------------------------------------------------------------------
+  | Advance the solution U by one physical time step dt
+  ------------------------------------------------------------------*/
+  void step(DMat& U, double dt)
+  {
+    PROFILE_SCOPE( "DualTimeStepping::step" );
+
+    ASSERT( U.rows() == dgrid_.n_elements() && U.columns() == N_FLOW_VARS,
+      "DualTimeStepping: Invalid size of solution matrix.");
+
+    // Shift the solution history together with the size of the
+    // step from U^n-1 to U^n
+    if ( n_steps_ > 0 )
+    {
+      U_nm1_   = U_n_;
+      dt_prev_ = dt_;
+    }
+    U_n_ = U;
+
+    const double w  = ( n_steps_ > 0 ) ? dt / dt_prev_ : 0.0;
+    const double c0 = ( 1.0 + 2.0 * w ) / ( 1.0 + w );
+    const double c1 = -( 1.0 + w );
+    const double c2 = w * w / ( 1.0 + w );
+
+    // A changed time step alters the system matrix
+    if ( dt != dt_ || c0 != c0_ )
+      valid_system_ = false;
+
+    dt_ = dt;
+    c0_ = c0;
+
+    double res_0    = 0.0;
+    double res_prev = 0.0;
+
+    for ( int iter = 0; iter < max_inner_iter_; ++iter )
+    {
+      inner_res_ = unsteady_residual( U, dt, c0, c1, c2 );
+
+      if ( iter == 0 )
+        res_0 = MAX( inner_res_, INCOMFLOW_SMALL );
+      else if ( inner_res_ <= inner_tol_ * res_0 )
+        break;
+
+      const bool slow = ( iter > 0
+                       && inner_res_ > refresh_rate_ * res_prev );
+
+      if ( !reuse_jacobian_ || !valid_system_ || slow )
+        build_system( U, dt, c0 );
+
+      preconditioner_.solve( system_, rhs_, dU_ );
+
+      THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+      [&](int i0, int i1)
+      {
+        for ( int i = i0; i < i1; ++i )
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+            U[i][k] += dU_[i*N_FLOW_VARS+k];
+      });
+
+      res_prev = inner_res_;
+      ++n_inner_iter_;
+    }
+
+    ++n_steps_;
+
+    DEBUG_LOG( "DualTimeStepping: step " << n_steps_
+      << ", inner residual " << inner_res_ / MAX(res_0, INCOMFLOW_SMALL)
+      << ", rebuild ratio " << rebuild_ratio() );
+
+  } // step()
+
+private:
+  /*------------------------------------------------------------------
+  | Evaluate the unsteady residual, store its negative as right hand
+  | side of the linear system and return its L2-norm
+  ------------------------------------------------------------------*/
+  double unsteady_residual(const DMat& U, double dt,
+                           double c0, double c1, double c2)
+  {
+    const DVec& volumes = dgrid_.volumes();
+
+    residual_.compute( U, R_ );
+
+    const double norm
+      = THREAD_POOL.parallel_reduce(0, dgrid_.n_elements(), 0.0,
+      [&](int i0, int i1)
+      {
+        double sum = 0.0;
+
+        for ( int i = i0; i < i1; ++i )
+        {
+          const double v_dt = volumes[i] / dt;
+
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+          {
+            const double r = R_[i][k] + v_dt * ( c0 * U[i][k]
+                                               + c1 * U_n_[i][k]
+                                               + c2 * U_nm1_[i][k] );
+            rhs_[i*N_FLOW_VARS+k] = -r;
+            sum += r * r;
+          }
+        }
+
+        return sum;
+      },
+      [](double x, double y) { return x + y; });
+
+    return std::sqrt( norm );
+
+  } // unsteady_residual()
+
+  /*------------------------------------------------------------------
+  | Assemble the implicit system matrix at the state U and set up
+  | its preconditioner
+  ------------------------------------------------------------------*/
+  void build_system(const DMat& U, double dt, double c0)
+  {
+    PROFILE_SCOPE( "DualTimeStepping::build_system" );
+
+    const DVec& volumes = dgrid_.volumes();
+    const DVec& dtau    = pseudo_dt_.compute( U );
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        diag_[i] = volumes[i] / dtau[i] + c0 * volumes[i] / dt;
+    });
+
+    // Walls impose the no-slip condition through their shear flux,
+    // if boundary conditions are attached to the residual
+    jacobian_.wall_shear( residual_.boundary_conditions() != nullptr );
+    jacobian_.assemble( U, diag_, system_ );
+    preconditioner_.setup( system_ );
+
+    valid_system_ = true;
+    ++n_builds_;
+
+  } // build_system()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&  dgrid_;
+
+  EdgeResidual     residual_;
+  FluxJacobian     jacobian_;
+  LocalTimeStep    pseudo_dt_;
+  SparseMatrix     system_;
+  BlockGaussSeidel preconditioner_ { 2 };
+
+  DMat             R_;
+  DMat             U_n_;
+  DMat             U_nm1_;
+  DVec             diag_;
+  DVec             rhs_;
+  DVec             dU_;
+
+  int              max_inner_iter_ { 50 };
+  double           inner_tol_      { 1.0E-6 };
+  double           refresh_rate_   { 0.5 };
+  bool             reuse_jacobian_ { true };
+
+  bool             valid_system_   { false };
+  double           dt_             { 0.0 };
+  double           dt_prev_        { 0.0 };
+  double           c0_             { 0.0 };
+  double           inner_res_      { 0.0 };
+
+  int              n_steps_        { 0 };
+  int              n_inner_iter_   { 0 };
+  int              n_builds_       { 0 };
+
+}; // DualTimeStepping
+
+} // namespace Solver
+} // namespace IncomFlow
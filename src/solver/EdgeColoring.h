@@ -0,0 +1,314 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Helpers.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class computes a coloring of the edges of a graph, such that
+* no two edges of the same color share a vertex. Applied to the
+* interior faces of a dual grid, all faces of one color scatter
+* their fluxes into distinct dual elements and can be processed in
+* a parallel loop without atomics or locks.
+*
+* The coloring is computed in two steps:
+*
+*   1) Greedy:    Every edge in turn receives the smallest color,
+*                 which is not yet used at both of its vertices.
+*                 This requires at most 2*max_degree-1 colors.
+*
+*   2) Balancing: Greedy colorings are biased towards the first
+*                 colors. Edges of colors above the mean size are
+*                 moved to the smallest color, which is free at both
+*                 of their vertices, within a few passes over all
+*                 edges. If the colors are still unbalanced,
+*                 e.g. since all colors are used at vertices of
+*                 maximum degree, up to two empty colors are added
+*                 and the balancing is repeated.
+*
+* Afterwards, the edges are grouped by color, i.e. the edges of
+* color c are given by
+*
+*   edge_order()[ color_offsets()[c] ... color_offsets()[c+1]-1 ]
+*
+* Within a color, the original edge order is retained to preserve
+* the locality of the grid numbering.
+*********************************************************************/
+class EdgeColoring
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor for the first n_edges rows of an edge matrix
+  ------------------------------------------------------------------*/
+  EdgeColoring(int n_vertices, const IMat& edges, int n_edges)
+  : n_vertices_ { n_vertices }
+  , n_edges_    { n_edges    }
+  {
+    ASSERT( n_edges <= edges.rows(),
+      "EdgeColoring: Invalid number of edges.");
+
+    Timer timer {};
+    timer.count();
+
+    greedy_coloring( edges );
+    balance_coloring( edges );
+
+    // Additional colors relieve vertices, at which all colors of
+    // the greedy coloring are in use
+    for ( int k = 0; k < max_extra_colors_
+                     && imbalance() > imbalance_tolerance_; ++k )
+    {
+      color_sizes_.push_back( 0 );
+      ++n_colors_;
+      balance_coloring( edges );
+    }
+
+    group_edges();
+
+    timer.count();
+    time_ = timer.delta(0);
+
+    LOG(INFO) << "EdgeColoring: " << n_colors_ << " colors for "
+      << n_edges_ << " edges, imbalance " << imbalance()
+      << ", time " << time_ << "s";
+  }
+
+  /*------------------------------------------------------------------
+  | Constructor for the interior faces of a dual grid
+  ------------------------------------------------------------------*/
+  EdgeColoring(const DualGrid& dgrid)
+  : EdgeColoring( dgrid.n_elements(), dgrid.face_neighbors(),
+                  dgrid.n_intr_faces() )
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_colors() const { return n_colors_; }
+  int n_edges() const { return n_edges_; }
+  int n_vertices() const { return n_vertices_; }
+
+  const IVec& colors() const { return colors_; }
+  const IVec& color_offsets() const { return color_offsets_; }
+  const IVec& edge_order() const { return edge_order_; }
+
+  int color_size(int c) const { return color_sizes_[c]; }
+
+  double coloring_time() const { return time_; }
+
+  /*------------------------------------------------------------------
+  | Ratio of the largest color size to the mean color size
+  ------------------------------------------------------------------*/
+  double imbalance() const
+  {
+    if ( n_colors_ < 1 || n_edges_ < 1 )
+      return 1.0;
+
+    const int max_size = *std::max_element( color_sizes_.begin(),
+                                            color_sizes_.end() );
+
+    return static_cast<double>( max_size ) * n_colors_ / n_edges_;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Greedy first-fit coloring. The colors at every vertex are stored
+  | in CSR slots, which are sized by the vertex degrees.
+  ------------------------------------------------------------------*/
+  void greedy_coloring(const IMat& edges)
+  {
+    slot_offsets_.assign( n_vertices_ + 1, 0 );
+
+    for ( int e = 0; e < n_edges_; ++e )
+    {
+      ++slot_offsets_[ edges[e][0] + 1 ];
+      ++slot_offsets_[ edges[e][1] + 1 ];
+    }
+
+    for ( int v = 0; v < n_vertices_; ++v )
+      slot_offsets_[v+1] += slot_offsets_[v];
+
+    slot_colors_.assign( slot_offsets_.back(), -1 );
+
+    IVec n_slots ( n_vertices_, 0 );
+    IVec mark;
+    int  stamp = 0;
+
+    colors_.assign( n_edges_, -1 );
+    color_sizes_.clear();
+
+    for ( int e = 0; e < n_edges_; ++e )
+    {
+      const int a = edges[e][0];
+      const int b = edges[e][1];
+
+      ++stamp;
+
+      for ( int s = 0; s < n_slots[a]; ++s )
+        mark[ slot_colors_[ slot_offsets_[a] + s ] ] = stamp;
+      for ( int s = 0; s < n_slots[b]; ++s )
+        mark[ slot_colors_[ slot_offsets_[b] + s ] ] = stamp;
+
+      int c = 0;
+      while ( c < static_cast<int>( mark.size() ) && mark[c] == stamp )
+        ++c;
+
+      if ( c == static_cast<int>( mark.size() ) )
+      {
+        mark.push_back( 0 );
+        color_sizes_.push_back( 0 );
+      }
+
+      colors_[e] = c;
+      ++color_sizes_[c];
+
+      slot_colors_[ slot_offsets_[a] + n_slots[a]++ ] = c;
+      slot_colors_[ slot_offsets_[b] + n_slots[b]++ ] = c;
+    }
+
+    n_colors_ = static_cast<int>( color_sizes_.size() );
+
+  } // greedy_coloring()
+
+  /*------------------------------------------------------------------
+  | Move edges from over-full colors to colors below the mean size,
+  | which are free at both of their vertices
+  ------------------------------------------------------------------*/
+  void balance_coloring(const IMat& edges)
+  {
+    if ( n_colors_ < 2 )
+      return;
+
+    const int target = ( n_edges_ + n_colors_ - 1 ) / n_colors_;
+
+    auto has_color = [&](int v, int c)
+    {
+      for ( int s = slot_offsets_[v]; s < slot_offsets_[v+1]; ++s )
+        if ( slot_colors_[s] == c )
+          return true;
+      return false;
+    };
+
+    auto replace_color = [&](int v, int c_old, int c_new)
+    {
+      for ( int s = slot_offsets_[v]; s < slot_offsets_[v+1]; ++s )
+        if ( slot_colors_[s] == c_old )
+        {
+          slot_colors_[s] = c_new;
+          return;
+        }
+    };
+
+    bool moved = true;
+
+    for ( int pass = 0; pass < n_balance_passes_ && moved; ++pass )
+    {
+      moved = false;
+
+      for ( int e = 0; e < n_edges_; ++e )
+      {
+        const int c = colors_[e];
+
+        if ( color_sizes_[c] <= target )
+          continue;
+
+        const int a = edges[e][0];
+        const int b = edges[e][1];
+
+        // Move to the smallest free color, if this reduces the
+        // size difference of both colors
+        int best = -1;
+
+        for ( int d = 0; d < n_colors_; ++d )
+        {
+          if ( d == c || color_sizes_[d] + 1 >= color_sizes_[c] )
+            continue;
+
+          if ( best >= 0 && color_sizes_[d] >= color_sizes_[best] )
+            continue;
+
+          if ( !has_color( a, d ) && !has_color( b, d ) )
+            best = d;
+        }
+
+        if ( best < 0 )
+          continue;
+
+        replace_color( a, c, best );
+        replace_color( b, c, best );
+
+        colors_[e] = best;
+        --color_sizes_[c];
+        ++color_sizes_[best];
+
+        moved = true;
+      }
+    }
+
+  } // balance_coloring()
+
+  /*------------------------------------------------------------------
+  | Group the edges by color (stable counting sort)
+  ------------------------------------------------------------------*/
+  void group_edges()
+  {
+    color_offsets_.assign( n_colors_ + 1, 0 );
+
+    for ( int c = 0; c < n_colors_; ++c )
+      color_offsets_[c+1] = color_offsets_[c] + color_sizes_[c];
+
+    IVec pos ( color_offsets_.begin(), color_offsets_.end() - 1 );
+    edge_order_.assign( n_edges_, -1 );
+
+    for ( int e = 0; e < n_edges_; ++e )
+      edge_order_[ pos[ colors_[e] ]++ ] = e;
+
+    // Temporary data is no longer needed
+    slot_offsets_ = IVec {};
+    slot_colors_  = IVec {};
+
+  } // group_edges()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int    n_vertices_ { 0 };
+  int    n_edges_    { 0 };
+  int    n_colors_   { 0 };
+  double time_       { 0.0 };
+
+  int    n_balance_passes_    { 8 };
+  int    max_extra_colors_    { 2 };
+  double imbalance_tolerance_ { 1.05 };
+
+  IVec   colors_;
+  IVec   color_sizes_;
+  IVec   color_offsets_;
+  IVec   edge_order_;
+
+  IVec   slot_offsets_;
+  IVec   slot_colors_;
+
+}; // EdgeColoring
+
+} // namespace Solver
+} // namespace IncomFlow
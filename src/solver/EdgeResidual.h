@@ -0,0 +1,703 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+
+#include "Log.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "EdgeColoring.h"
+#include "EdgeTiling.h"
+#include "Reconstruction.h"
+#include "BoundaryConditions.h"
+#include "PeriodicBoundaries.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Numerical flux of the artificial compressibility equations
+* through a face with (non-normalized) normal (nx,ny),
+* evaluated with the Rusanov scheme
+*
+*   f = 0.5 * ( F(ul) + F(ur) ) - 0.5 * lambda * ( ur - ul )
+*
+* with the physical fluxes
+*
+*   F(u) = [ beta^2 * un, u * un + p * nx, v * un + p * ny ]
+*
+*********************************************************************/
+inline void rusanov_flux(const double* ul, const double* ur,
+                         double nx, double ny, double beta2,
+                         double* f)
+{
+  const double len = std::sqrt( nx*nx + ny*ny );
+
+  const double unl = ul[IU] * nx + ul[IV] * ny;
+  const double unr = ur[IU] * nx + ur[IV] * ny;
+
+  const double ql = unl / len;
+  const double qr = unr / len;
+
+  const double lambda_l = std::fabs( ql ) + std::sqrt( ql*ql + beta2 );
+  const double lambda_r = std::fabs( qr ) + std::sqrt( qr*qr + beta2 );
+  const double lambda   = 0.5 * len * MAX( lambda_l, lambda_r );
+
+  f[IP] = 0.5 * beta2 * ( unl + unr )
+        - lambda * ( ur[IP] - ul[IP] );
+
+  f[IU] = 0.5 * ( ul[IU]*unl + ur[IU]*unr + (ul[IP]+ur[IP])*nx )
+        - lambda * ( ur[IU] - ul[IU] );
+
+  f[IV] = 0.5 * ( ul[IV]*unl + ur[IV]*unr + (ul[IP]+ur[IP])*ny )
+        - lambda * ( ur[IV] - ul[IV] );
+
+} // rusanov_flux()
+
+/*********************************************************************
+* Subtract the viscous flux through the interior face between the
+* dual elements i and j with states ui, uj and centroids xi, xj
+* from f. The flux is approximated along the edge between both
+* centroids.
+*********************************************************************/
+inline void viscous_edge_flux(const double* ui, const double* uj,
+                              const double* xi, const double* xj,
+                              double nx, double ny, double nu,
+                              double* f)
+{
+  const double dx = xj[0] - xi[0];
+  const double dy = xj[1] - xi[1];
+  const double kv = nu * (nx*nx + ny*ny) / (nx*dx + ny*dy);
+
+  f[IU] -= kv * ( uj[IU] - ui[IU] );
+  f[IV] -= kv * ( uj[IV] - ui[IV] );
+
+} // viscous_edge_flux()
+
+/*********************************************************************
+* Convective and viscous flux through the interior face between the
+* dual elements i and j with states ui, uj and centroids xi, xj.
+* The face normal (nx,ny) points from i to j.
+* Swapping i and j together with the normal negates the flux.
+*********************************************************************/
+inline void edge_flux(const double* ui, const double* uj,
+                      const double* xi, const double* xj,
+                      double nx, double ny, double beta2, double nu,
+                      double* f)
+{
+  rusanov_flux( ui, uj, nx, ny, beta2, f );
+  viscous_edge_flux( ui, uj, xi, xj, nx, ny, nu, f );
+
+} // edge_flux()
+
+/*********************************************************************
+* Strategies to accumulate the interior face fluxes into the
+* residuals of the dual elements without data races
+*
+*   FACE_GATHER:    Fluxes are computed in a parallel loop over all
+*                   faces and stored per face. Every element gathers
+*                   the fluxes of its faces via the CSR adjacency.
+*   EDGE_COLORING:  The faces are grouped by the colors of an edge
+*                   coloring (see EdgeColoring.h). The faces of one
+*                   color are processed in a parallel loop, which
+*                   scatters directly into both adjacent elements.
+*   OWNER_COMPUTES: Every element computes the fluxes of all its
+*                   faces via the CSR adjacency. Each flux is
+*                   evaluated twice, but no face storage is needed.
+*   TILED:          The grid is split into cache-sized tiles (see
+*                   EdgeTiling.h), which are processed completely
+*                   by a single thread each, while their data stays
+*                   in the L2 cache. Only the fluxes of faces
+*                   between tiles are evaluated twice.
+*********************************************************************/
+enum class FluxAccumulation
+{
+  FACE_GATHER,
+  EDGE_COLORING,
+  OWNER_COMPUTES,
+  TILED,
+};
+
+/*********************************************************************
+* This class evaluates the spatial residual of the artificial
+* compressibility equations on a median dual grid.
+* The residual of a dual element is the sum of all fluxes that
+* leave the element:
+*
+*   V_i * dU_i/dt + R_i(U) = 0
+*
+* By default, interior fluxes are evaluated in a parallel loop over
+* all dual faces and stored per face. Afterwards, every element
+* gathers the fluxes of its adjacent faces via the CSR adjacency of
+* the dual grid, such that no two threads write to the same element.
+* The alternative strategies of FluxAccumulation are chosen with
+* accumulation(). Boundary faces are closed with the physical flux
+* of the adjacent element's state, or with the fluxes of the
+* boundary conditions, which are set with boundary_conditions().
+* The residuals of paired periodic boundaries are merged at the end
+* (see PeriodicBoundaries.h).
+*
+* With second_order(), the convective fluxes are evaluated with the
+* face states of a limited linear reconstruction (see
+* Reconstruction.h), which is updated at the beginning of every
+* evaluation. The viscous fluxes always use the element states.
+*
+* The solution and residual matrices store one row per dual
+* element and one column per flow variable (see definitions.h).
+*********************************************************************/
+class EdgeResidual
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  EdgeResidual(const DualGrid& dgrid)
+  : dgrid_       { dgrid                                         }
+  , face_fluxes_ ( dgrid.n_intr_faces(), N_FLOW_VARS, THREAD_POOL )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void accumulation(FluxAccumulation mode)
+  {
+    mode_ = mode;
+
+    if ( mode_ == FluxAccumulation::EDGE_COLORING
+        && color_offsets_.empty() )
+      color_faces();
+
+    if ( mode_ == FluxAccumulation::TILED
+        && tile_face_offsets_.empty() )
+      tile_faces();
+  }
+
+  void tile_size(int n)
+  {
+    tile_size_ = n;
+    tile_face_offsets_.clear();
+
+    if ( mode_ == FluxAccumulation::TILED )
+      tile_faces();
+  }
+
+  void boundary_conditions(BoundaryConditions& bc)
+  {
+    ASSERT( &bc.dual_grid() == &dgrid_,
+      "EdgeResidual: Boundary conditions of a different grid.");
+    bdry_conds_ = &bc;
+  }
+
+  void periodic_boundaries(const PeriodicBoundaries& periodic)
+  { periodic_ = &periodic; }
+
+  void second_order(bool s)
+  {
+    if ( s && !reconstruction_ )
+      reconstruction_ = std::make_unique<Reconstruction>( dgrid_ );
+
+    second_order_ = s;
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const DualGrid& dual_grid() const { return dgrid_; }
+  FluxAccumulation accumulation() const { return mode_; }
+  int tile_size() const { return tile_size_; }
+  bool second_order() const { return second_order_; }
+
+  // Null, if no boundary conditions are set
+  const BoundaryConditions* boundary_conditions() const
+  { return bdry_conds_; }
+
+  // Only available after second_order(true)
+  Reconstruction& reconstruction()
+  {
+    ASSERT( reconstruction_ != nullptr,
+      "EdgeResidual: No reconstruction defined.");
+    return *reconstruction_;
+  }
+
+  /*------------------------------------------------------------------
+  | Evaluate the residual R(U)
+  ------------------------------------------------------------------*/
+  void compute(const DMat& U, DMat& R)
+  {
+    PROFILE_SCOPE( "EdgeResidual::compute" );
+
+    ASSERT( U.rows() == dgrid_.n_elements(),
+      "EdgeResidual: Invalid size of solution matrix.");
+    ASSERT( R.rows() == dgrid_.n_elements(),
+      "EdgeResidual: Invalid size of residual matrix.");
+
+    if ( second_order_ )
+      reconstruction_->compute( U );
+
+    switch ( mode_ )
+    {
+      case FluxAccumulation::EDGE_COLORING:
+        colored_fluxes( U, R );
+        break;
+
+      case FluxAccumulation::OWNER_COMPUTES:
+        owner_fluxes( U, R );
+        break;
+
+      case FluxAccumulation::TILED:
+        tiled_fluxes( U, R );
+        break;
+
+      default:
+        interior_fluxes( U );
+        gather_fluxes( R );
+    }
+
+    boundary_fluxes( U, R );
+
+    if ( periodic_ )
+      periodic_->merge( R );
+
+  } // compute()
+
+  void operator()(const DMat& U, DMat& R)
+  { compute(U, R); }
+
+  /*------------------------------------------------------------------
+  | Evaluate the residual R(U) on a sub-grid of a distributed run,
+  | while the ghost rows of U are updated (see HaloExchange.h).
+  | The fluxes of all faces between owned elements are computed
+  | during the communication. Only the owned rows of R are valid.
+  | The face fluxes are always gathered (FACE_GATHER), since they
+  | are split into the faces before and after the exchange.
+  | The second-order reconstruction is not supported, since its
+  | gradients would require a second exchange.
+  ------------------------------------------------------------------*/
+  template <typename Halo>
+  void compute(DMat& U, DMat& R, Halo& halo)
+  {
+    PROFILE_SCOPE( "EdgeResidual::compute" );
+
+    ASSERT( U.rows() == dgrid_.n_elements(),
+      "EdgeResidual: Invalid size of solution matrix.");
+    ASSERT( R.rows() == dgrid_.n_elements(),
+      "EdgeResidual: Invalid size of residual matrix.");
+    ASSERT( !second_order_,
+      "EdgeResidual: Second order is not supported on sub-grids.");
+    ASSERT( !periodic_,
+      "EdgeResidual: Periodic boundaries are not supported on sub-grids.");
+
+    halo.begin( U );
+    interior_fluxes( U, halo.inner_faces() );
+    halo.finish( U );
+    interior_fluxes( U, halo.ghost_faces() );
+
+    gather_fluxes( R );
+    boundary_fluxes( U, R );
+
+  } // compute()
+
+private:
+  /*------------------------------------------------------------------
+  | Compute the convective and viscous fluxes of all interior faces
+  ------------------------------------------------------------------*/
+  void interior_fluxes(const DMat& U)
+  {
+    PROFILE_SCOPE( "EdgeResidual::interior_fluxes" );
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_intr_faces(), [&](int i_face)
+    {
+      face_flux( U, i_face );
+    });
+
+  } // interior_fluxes()
+
+  /*------------------------------------------------------------------
+  | Compute the fluxes of the given interior faces
+  ------------------------------------------------------------------*/
+  void interior_fluxes(const DMat& U, const IVec& faces)
+  {
+    PROFILE_SCOPE( "EdgeResidual::interior_fluxes" );
+
+    const int n_faces = static_cast<int>( faces.size() );
+
+    THREAD_POOL.parallel_for(0, n_faces, [&](int i)
+    {
+      face_flux( U, faces[i] );
+    });
+
+  } // interior_fluxes()
+
+  /*------------------------------------------------------------------
+  | Flux of a single interior face
+  ------------------------------------------------------------------*/
+  void face_flux(const DMat& U, int i_face)
+  {
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+
+    pair_flux( U, nbrs[i_face][0], nbrs[i_face][1],
+               normals[i_face][0], normals[i_face][1],
+               CONSTANTS.art_compressibility(), CONSTANTS.viscosity(),
+               face_fluxes_[i_face] );
+
+  } // face_flux()
+
+  /*------------------------------------------------------------------
+  | Flux between the elements i and j with the normal (nx,ny)
+  | pointing from i to j, of first or second order
+  ------------------------------------------------------------------*/
+  void pair_flux(const DMat& U, int i, int j, double nx, double ny,
+                 double beta2, double nu, double* f) const
+  {
+    const DMat& xy = dgrid_.coords();
+
+    if ( !second_order_ )
+    {
+      edge_flux( U[i], U[j], xy[i], xy[j], nx, ny, beta2, nu, f );
+      return;
+    }
+
+    double ul[N_FLOW_VARS];
+    double ur[N_FLOW_VARS];
+
+    reconstruction_->face_states( U, i, j, ul, ur );
+
+    rusanov_flux( ul, ur, nx, ny, beta2, f );
+    viscous_edge_flux( U[i], U[j], xy[i], xy[j], nx, ny, nu, f );
+
+  } // pair_flux()
+
+  /*------------------------------------------------------------------
+  | Compute the edge coloring of the interior faces and store their
+  | neighbors and normals grouped by color
+  ------------------------------------------------------------------*/
+  void color_faces()
+  {
+    EdgeColoring coloring { dgrid_ };
+
+    const int   n_faces = dgrid_.n_intr_faces();
+    const IVec& order   = coloring.edge_order();
+
+    IMat neighbors ( n_faces, 2, THREAD_POOL );
+    DMat normals   ( n_faces, 2, THREAD_POOL );
+
+    colored_neighbors_.swap( neighbors );
+    colored_normals_.swap( normals );
+    color_offsets_ = coloring.color_offsets();
+
+    THREAD_POOL.parallel_for(0, n_faces, [&](int p)
+    {
+      const int i_face = order[p];
+
+      colored_neighbors_[p][0] = dgrid_.face_neighbors()[i_face][0];
+      colored_neighbors_[p][1] = dgrid_.face_neighbors()[i_face][1];
+      colored_normals_[p][0]   = dgrid_.face_normals()[i_face][0];
+      colored_normals_[p][1]   = dgrid_.face_normals()[i_face][1];
+    });
+
+  } // color_faces()
+
+  /*------------------------------------------------------------------
+  | Scatter the interior fluxes color by color. The faces of a color
+  | do not share any element, hence the updates of R are race-free.
+  ------------------------------------------------------------------*/
+  void colored_fluxes(const DMat& U, DMat& R) const
+  {
+    PROFILE_SCOPE( "EdgeResidual::interior_fluxes" );
+
+    const double beta2 = CONSTANTS.art_compressibility();
+    const double nu    = CONSTANTS.viscosity();
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        R[i][k] = 0.0;
+    });
+
+    const int n_colors = static_cast<int>( color_offsets_.size() ) - 1;
+
+    for ( int c = 0; c < n_colors; ++c )
+    {
+      THREAD_POOL.parallel_for(color_offsets_[c], color_offsets_[c+1],
+      [&](int p)
+      {
+        const int i = colored_neighbors_[p][0];
+        const int j = colored_neighbors_[p][1];
+
+        double f[N_FLOW_VARS];
+
+        pair_flux( U, i, j,
+                   colored_normals_[p][0], colored_normals_[p][1],
+                   beta2, nu, f );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+        {
+          R[i][k] += f[k];
+          R[j][k] -= f[k];
+        }
+      });
+    }
+
+  } // colored_fluxes()
+
+  /*------------------------------------------------------------------
+  | Every element computes the fluxes of all its faces, oriented
+  | away from itself
+  ------------------------------------------------------------------*/
+  void owner_fluxes(const DMat& U, DMat& R) const
+  {
+    PROFILE_SCOPE( "EdgeResidual::interior_fluxes" );
+
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    const double beta2 = CONSTANTS.art_compressibility();
+    const double nu    = CONSTANTS.viscosity();
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      double r[N_FLOW_VARS] = { 0.0 };
+      double f[N_FLOW_VARS];
+
+      for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+      {
+        const int    i_face = faces[a];
+        const int    j      = adj[a];
+        const double sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+
+        pair_flux( U, i, j,
+                   sign * normals[i_face][0], sign * normals[i_face][1],
+                   beta2, nu, f );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          r[k] += f[k];
+      }
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        R[i][k] = r[k];
+    });
+
+  } // owner_fluxes()
+
+  /*------------------------------------------------------------------
+  | Compute the tiling of the grid and store the neighbors and
+  | normals of the faces in tile order. Cut faces are stored with
+  | the element of the tile first and their normal pointing away
+  | from it.
+  ------------------------------------------------------------------*/
+  void tile_faces()
+  {
+    EdgeTiling tiling { dgrid_, tile_size_ };
+
+    const IVec& faces   = tiling.faces();
+    const IVec& tiles   = tiling.element_tiles();
+    const int   n_tiles = tiling.n_tiles();
+
+    const int n_faces = static_cast<int>( faces.size() );
+
+    IMat neighbors ( n_faces, 2, THREAD_POOL );
+    DMat normals   ( n_faces, 2, THREAD_POOL );
+
+    THREAD_POOL.parallel_for(0, n_tiles, 1, [&](int t)
+    {
+      for ( int p = tiling.face_offsets()[t];
+            p < tiling.face_offsets()[t+1]; ++p )
+      {
+        const int    i_face = faces[p];
+        const int    i      = dgrid_.face_neighbors()[i_face][0];
+        const int    j      = dgrid_.face_neighbors()[i_face][1];
+        const bool   flip   = ( tiles[i] != t );
+        const double sign   = flip ? -1.0 : 1.0;
+
+        neighbors[p][0] = flip ? j : i;
+        neighbors[p][1] = flip ? i : j;
+        normals[p][0]   = sign * dgrid_.face_normals()[i_face][0];
+        normals[p][1]   = sign * dgrid_.face_normals()[i_face][1];
+      }
+    });
+
+    tiled_neighbors_.swap( neighbors );
+    tiled_normals_.swap( normals );
+
+    tile_face_offsets_    = tiling.face_offsets();
+    tile_inner_end_       = tiling.inner_end();
+    tile_element_offsets_ = tiling.element_offsets();
+    tile_elements_        = tiling.elements();
+
+  } // tile_faces()
+
+  /*------------------------------------------------------------------
+  | Process the grid tile by tile. Every tile resets the residuals
+  | of its elements, adds the fluxes of its inner faces to both
+  | elements and the fluxes of its cut faces to its own element.
+  ------------------------------------------------------------------*/
+  void tiled_fluxes(const DMat& U, DMat& R) const
+  {
+    PROFILE_SCOPE( "EdgeResidual::interior_fluxes" );
+
+    const double beta2 = CONSTANTS.art_compressibility();
+    const double nu    = CONSTANTS.viscosity();
+
+    const int n_tiles = static_cast<int>( tile_inner_end_.size() );
+
+    THREAD_POOL.parallel_for(0, n_tiles, 1, [&](int t)
+    {
+      for ( int p = tile_element_offsets_[t];
+            p < tile_element_offsets_[t+1]; ++p )
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          R[ tile_elements_[p] ][k] = 0.0;
+
+      double f[N_FLOW_VARS];
+
+      for ( int p = tile_face_offsets_[t]; p < tile_inner_end_[t]; ++p )
+      {
+        const int i = tiled_neighbors_[p][0];
+        const int j = tiled_neighbors_[p][1];
+
+        pair_flux( U, i, j,
+                   tiled_normals_[p][0], tiled_normals_[p][1],
+                   beta2, nu, f );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+        {
+          R[i][k] += f[k];
+          R[j][k] -= f[k];
+        }
+      }
+
+      for ( int p = tile_inner_end_[t]; p < tile_face_offsets_[t+1]; ++p )
+      {
+        const int i = tiled_neighbors_[p][0];
+        const int j = tiled_neighbors_[p][1];
+
+        pair_flux( U, i, j,
+                   tiled_normals_[p][0], tiled_normals_[p][1],
+                   beta2, nu, f );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          R[i][k] += f[k];
+      }
+    });
+
+  } // tiled_fluxes()
+
+  /*------------------------------------------------------------------
+  | Sum up the face fluxes of every element. Fluxes are oriented 
+  | from face_neighbors[f][0] to face_neighbors[f][1].
+  ------------------------------------------------------------------*/
+  void gather_fluxes(DMat& R) const
+  {
+    PROFILE_SCOPE( "EdgeResidual::gather_fluxes" );
+
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      double r[N_FLOW_VARS] = { 0.0 };
+
+      for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+      {
+        const int     i_face = faces[a];
+        const double* f      = face_fluxes_[i_face];
+        const double  sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          r[k] += sign * f[k];
+      }
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        R[i][k] = r[k];
+    });
+
+  } // gather_fluxes()
+
+  /*------------------------------------------------------------------
+  | Add the fluxes through all boundary faces.
+  | -> Boundary normals point into the domain
+  | -> Corner elements belong to several boundaries, hence only 
+  |    the elements of a single boundary are processed in parallel
+  ------------------------------------------------------------------*/
+  void boundary_fluxes(const DMat& U, DMat& R) const
+  {
+    PROFILE_SCOPE( "EdgeResidual::boundary_fluxes" );
+
+    if ( bdry_conds_ )
+    {
+      bdry_conds_->apply( U );
+      bdry_conds_->add_fluxes( R );
+      return;
+    }
+
+    const double beta2 = CONSTANTS.art_compressibility();
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& normals  = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+
+        double f[N_FLOW_VARS];
+
+        physical_flux( U[i], -normals[i_elem][0], -normals[i_elem][1],
+                       beta2, f );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          R[i][k] += f[k];
+      });
+    }
+
+  } // boundary_fluxes()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&  dgrid_;
+  DMat             face_fluxes_;
+
+  FluxAccumulation mode_ { FluxAccumulation::FACE_GATHER };
+
+  IMat             colored_neighbors_;
+  DMat             colored_normals_;
+  IVec             color_offsets_;
+
+  int              tile_size_ { 4096 };
+  IMat             tiled_neighbors_;
+  DMat             tiled_normals_;
+  IVec             tile_face_offsets_;
+  IVec             tile_inner_end_;
+  IVec             tile_element_offsets_;
+  IVec             tile_elements_;
+
+  BoundaryConditions* bdry_conds_ { nullptr };
+  const PeriodicBoundaries* periodic_ { nullptr };
+
+  bool             second_order_ { false };
+  std::unique_ptr<Reconstruction> reconstruction_;
+
+}; // EdgeResidual
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,218 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+#include "GraphPartitioner.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class groups the dual elements and interior faces of a dual
+* grid into cache-sized tiles. The tiles are the parts of a graph
+* partition of the dual elements (see GraphPartitioner.h) with about
+* tile_size elements each, such that the states, residuals and
+* coordinates of a tile (roughly 100 bytes per element) fit into
+* the L2 cache.
+*
+* Every interior face is assigned to the tiles of its elements:
+*
+*   inner faces: Both elements belong to the tile. The flux is
+*                added to both elements.
+*   cut faces:   Only one element belongs to the tile. The face is
+*                listed in both tiles and every tile only updates
+*                its own element.
+*
+* Thus, every tile only writes to its own elements and all tiles
+* can be processed concurrently without atomics or colors, at the
+* cost of evaluating the fluxes of the cut faces twice.
+*
+* The faces of tile t are stored in
+*
+*   faces()[ face_offsets()[t] ... inner_end()[t]-1 ]       inner
+*   faces()[ inner_end()[t]    ... face_offsets()[t+1]-1 ]  cut
+*
+* and the elements of tile t in
+*
+*   elements()[ element_offsets()[t] ... element_offsets()[t+1]-1 ]
+*
+* Within every list, the grid order is retained. The elements are
+* not renumbered, hence the rows of a tile are only contiguous in
+* memory as far as the grid numbering is spatially local.
+*********************************************************************/
+class EdgeTiling
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  EdgeTiling(const DualGrid& dgrid, int tile_size=4096)
+  {
+    ASSERT( tile_size > 0, "EdgeTiling: Invalid tile size.");
+
+    Timer timer {};
+    timer.count();
+
+    const int n_elements = dgrid.n_elements();
+    n_tiles_ = MAX( 1, ( n_elements + tile_size - 1 ) / tile_size );
+
+    // Tile sizes do not need to be balanced exactly
+    GraphPartitioner partitioner { dgrid };
+    partitioner.imbalance_tolerance( 0.1 );
+    partitioner.n_initial_trials( 2 );
+    partitioner.n_refinement_passes( 2 );
+
+    element_tiles_ = partitioner.partition( n_tiles_ );
+
+    group_elements( n_elements );
+    group_faces( dgrid );
+
+    timer.count();
+    time_ = timer.delta(0);
+
+    LOG(INFO) << "EdgeTiling: " << n_tiles_ << " tiles of up to "
+      << max_tile_elements() << " elements, " << n_cut_faces_
+      << " cut faces of " << dgrid.n_intr_faces()
+      << ", time " << time_ << "s";
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_tiles() const { return n_tiles_; }
+  int n_cut_faces() const { return n_cut_faces_; }
+  double tiling_time() const { return time_; }
+
+  const IVec& element_tiles() const { return element_tiles_; }
+  const IVec& element_offsets() const { return element_offsets_; }
+  const IVec& elements() const { return elements_; }
+
+  const IVec& face_offsets() const { return face_offsets_; }
+  const IVec& inner_end() const { return inner_end_; }
+  const IVec& faces() const { return faces_; }
+
+  int max_tile_elements() const
+  {
+    int n = 0;
+    for ( int t = 0; t < n_tiles_; ++t )
+      n = MAX( n, element_offsets_[t+1] - element_offsets_[t] );
+    return n;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Group the elements by tile (stable counting sort)
+  ------------------------------------------------------------------*/
+  void group_elements(int n_elements)
+  {
+    element_offsets_.assign( n_tiles_ + 1, 0 );
+
+    for ( int i = 0; i < n_elements; ++i )
+      ++element_offsets_[ element_tiles_[i] + 1 ];
+
+    for ( int t = 0; t < n_tiles_; ++t )
+      element_offsets_[t+1] += element_offsets_[t];
+
+    IVec pos ( element_offsets_.begin(), element_offsets_.end() - 1 );
+    elements_.assign( n_elements, -1 );
+
+    for ( int i = 0; i < n_elements; ++i )
+      elements_[ pos[ element_tiles_[i] ]++ ] = i;
+
+  } // group_elements()
+
+  /*------------------------------------------------------------------
+  | Group the interior faces by tile, inner faces first
+  ------------------------------------------------------------------*/
+  void group_faces(const DualGrid& dgrid)
+  {
+    const IMat& nbrs    = dgrid.face_neighbors();
+    const int   n_faces = dgrid.n_intr_faces();
+
+    IVec n_inner ( n_tiles_, 0 );
+    IVec n_cut   ( n_tiles_, 0 );
+
+    n_cut_faces_ = 0;
+
+    for ( int f = 0; f < n_faces; ++f )
+    {
+      const int t0 = element_tiles_[ nbrs[f][0] ];
+      const int t1 = element_tiles_[ nbrs[f][1] ];
+
+      if ( t0 == t1 )
+        ++n_inner[t0];
+      else
+      {
+        ++n_cut[t0];
+        ++n_cut[t1];
+        ++n_cut_faces_;
+      }
+    }
+
+    face_offsets_.assign( n_tiles_ + 1, 0 );
+    inner_end_.assign( n_tiles_, 0 );
+
+    for ( int t = 0; t < n_tiles_; ++t )
+    {
+      face_offsets_[t+1] = face_offsets_[t] + n_inner[t] + n_cut[t];
+      inner_end_[t]      = face_offsets_[t] + n_inner[t];
+    }
+
+    IVec inner_pos ( face_offsets_.begin(), face_offsets_.end() - 1 );
+    IVec cut_pos   ( inner_end_ );
+
+    faces_.assign( face_offsets_.back(), -1 );
+
+    for ( int f = 0; f < n_faces; ++f )
+    {
+      const int t0 = element_tiles_[ nbrs[f][0] ];
+      const int t1 = element_tiles_[ nbrs[f][1] ];
+
+      if ( t0 == t1 )
+        faces_[ inner_pos[t0]++ ] = f;
+      else
+      {
+        faces_[ cut_pos[t0]++ ] = f;
+        faces_[ cut_pos[t1]++ ] = f;
+      }
+    }
+
+  } // group_faces()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int    n_tiles_     { 0 };
+  int    n_cut_faces_ { 0 };
+  double time_        { 0.0 };
+
+  IVec   element_tiles_;
+  IVec   element_offsets_;
+  IVec   elements_;
+
+  IVec   face_offsets_;
+  IVec   inner_end_;
+  IVec   faces_;
+
+}; // EdgeTiling
+
+} // namespace Solver
+} // namespace IncomFlow
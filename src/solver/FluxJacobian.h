@@ -0,0 +1,250 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "SparseMatrix.h"
+#include "BoundaryConditions.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Flux Jacobian A = dF/dU of the artificial compressibility
+* equations for a face with (non-normalized) normal (nx,ny).
+* The (3x3) matrix is added to the row-major block a with the
+* given scaling factor.
+*********************************************************************/
+inline void add_flux_jacobian(const double* u, double nx, double ny,
+                              double beta2, double scale, double* a)
+{
+  const double un = u[IU] * nx + u[IV] * ny;
+
+  a[IP*N_FLOW_VARS+IU] += scale * beta2 * nx;
+  a[IP*N_FLOW_VARS+IV] += scale * beta2 * ny;
+
+  a[IU*N_FLOW_VARS+IP] += scale * nx;
+  a[IU*N_FLOW_VARS+IU] += scale * ( un + u[IU] * nx );
+  a[IU*N_FLOW_VARS+IV] += scale * u[IU] * ny;
+
+  a[IV*N_FLOW_VARS+IP] += scale * ny;
+  a[IV*N_FLOW_VARS+IU] += scale * u[IV] * nx;
+  a[IV*N_FLOW_VARS+IV] += scale * ( un + u[IV] * ny );
+
+} // add_flux_jacobian()
+
+/*********************************************************************
+* This class assembles the first-order Jacobian dR/dU of the
+* edge-based residual (see EdgeResidual.h) into a block sparse
+* matrix with (3x3) blocks. The Rusanov dissipation coefficient
+* is frozen during the linearization, such that every face adds
+*
+*   dF_ij/dU_i = 0.5 * A(U_i) + lambda * I + kv * I_uv
+*   dF_ij/dU_j = 0.5 * A(U_j) - lambda * I - kv * I_uv
+*
+* to the rows of both adjacent elements, where I_uv is the
+* identity of the velocity components. Every row is assembled
+* by a single thread from the faces of its dual element.
+* An additional diagonal term (e.g. V/dt) can be passed for every
+* element, which turns the matrix into the system matrix of an
+* implicit (pseudo) time step.
+*********************************************************************/
+class FluxJacobian
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  FluxJacobian(const DualGrid& dgrid)
+  : dgrid_ { dgrid }
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  // Linearize the viscous wall flux, which is added by the
+  // BoundaryConditions of a residual
+  void wall_shear(bool w) { wall_shear_ = w; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  bool wall_shear() const { return wall_shear_; }
+
+  /*------------------------------------------------------------------
+  | Assemble the Jacobian of the residual at the state U into J
+  ------------------------------------------------------------------*/
+  void assemble(const DMat& U, SparseMatrix& J) const
+  {
+    PROFILE_SCOPE( "FluxJacobian::assemble" );
+
+    ASSERT( J.block_size() == N_FLOW_VARS,
+      "FluxJacobian: Invalid block size of Jacobian matrix.");
+    ASSERT( J.n_rows() == dgrid_.n_elements(),
+      "FluxJacobian: Invalid size of Jacobian matrix.");
+
+    J.set_zero();
+
+    interior_jacobian( U, J );
+    boundary_jacobian( U, J );
+
+  } // assemble()
+
+  /*------------------------------------------------------------------
+  | Assemble the Jacobian and add diag[i] * I to every diagonal block
+  ------------------------------------------------------------------*/
+  void assemble(const DMat& U, const DVec& diag, SparseMatrix& J) const
+  {
+    PROFILE_SCOPE( "FluxJacobian::assemble" );
+
+    assemble( U, J );
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double* a = J.diagonal(i);
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          a[k*N_FLOW_VARS+k] += diag[i];
+      }
+    });
+
+  } // assemble()
+
+private:
+  /*------------------------------------------------------------------
+  | Contributions of all interior faces, which are gathered by the
+  | rows with the face normals pointing out of the row element
+  ------------------------------------------------------------------*/
+  void interior_jacobian(const DMat& U, SparseMatrix& J) const
+  {
+    const DMat& xy      = dgrid_.coords();
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    const double beta2  = CONSTANTS.art_compressibility();
+    const double nu     = CONSTANTS.viscosity();
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double* a_ii = J.diagonal(i);
+
+        for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+        {
+          const int    j      = adj[a];
+          const int    i_face = faces[a];
+          const double sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+
+          const double nx = sign * normals[i_face][0];
+          const double ny = sign * normals[i_face][1];
+          const double dx = xy[j][0] - xy[i][0];
+          const double dy = xy[j][1] - xy[i][1];
+
+          const double len = std::sqrt( nx*nx + ny*ny );
+          const double qi  = ( U[i][IU] * nx + U[i][IV] * ny ) / len;
+          const double qj  = ( U[j][IU] * nx + U[j][IV] * ny ) / len;
+
+          const double lambda
+            = 0.5 * len * MAX( std::fabs(qi) + std::sqrt(qi*qi + beta2),
+                               std::fabs(qj) + std::sqrt(qj*qj + beta2) );
+
+          const double kv = nu * (nx*nx + ny*ny) / (nx*dx + ny*dy);
+
+          double* a_ij = J.block( J.find(i,j) );
+
+          add_flux_jacobian( U[i], nx, ny, beta2, 0.5, a_ii );
+          add_flux_jacobian( U[j], nx, ny, beta2, 0.5, a_ij );
+
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+          {
+            const double d  = ( k == IP ) ? lambda : lambda + kv;
+            const int    kk = k * N_FLOW_VARS + k;
+
+            a_ii[kk] += d;
+            a_ij[kk] -= d;
+          }
+        }
+      }
+    });
+
+  } // interior_jacobian()
+
+  /*------------------------------------------------------------------
+  | Contributions of all boundary faces, where walls add the
+  | derivative of their viscous shear flux, if enabled
+  | -> Boundary normals point into the domain
+  | -> Corner elements belong to several boundaries, hence only 
+  |    the elements of a single boundary are processed in parallel
+  ------------------------------------------------------------------*/
+  void boundary_jacobian(const DMat& U, SparseMatrix& J) const
+  {
+    const DVec&  volumes = dgrid_.volumes();
+    const double beta2   = CONSTANTS.art_compressibility();
+    const double nu      = CONSTANTS.viscosity();
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& normals  = bdry.dual_normals();
+      const bool  wall     = wall_shear_
+                          && ( bdry.type() == BdryType::WALL );
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int    i  = elements[i_elem];
+        const double nx = -normals[i_elem][0];
+        const double ny = -normals[i_elem][1];
+
+        double* a = J.diagonal(i);
+
+        add_flux_jacobian( U[i], nx, ny, beta2, 1.0, a );
+
+        if ( wall )
+        {
+          const double kv
+            = wall_viscous_coefficient( nx, ny, volumes[i], nu );
+
+          a[IU*N_FLOW_VARS+IU] += kv;
+          a[IV*N_FLOW_VARS+IV] += kv;
+        }
+      });
+    }
+
+  } // boundary_jacobian()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid& dgrid_;
+  bool            wall_shear_ { false };
+
+}; // FluxJacobian
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,556 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "Timer.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "SparseMatrix.h"
+#include "LinearSolver.h"
+#include "BoundaryConditions.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class advances the incompressible Navier-Stokes equations
+* on a median dual grid with a (non-incremental) pressure
+* projection method:
+*
+* 1) Momentum predictor:
+*      u* = u^n - dt / V * R_conv,visc(u^n)
+*
+* 2) Pressure Poisson equation:
+*      div( grad(p) ) = div( u* ) / dt
+*
+* 3) Velocity correction:
+*      u^n+1 = u* - dt * grad(p)
+*
+* The Poisson matrix only depends on the grid, thus it is assembled
+* once and reused in every time step. The pressure of the previous
+* step serves as initial guess for the Poisson solver.
+* All three stages are separate kernels, which are timed
+* individually. Interior faces are evaluated in gather form over the
+* dual grid adjacency, such that every element is updated by a
+* single thread.
+*
+* Boundary treatment:
+* -------------------
+*   WALL   -> No-slip velocity, i.e. the tangential component of
+*             the prescribed wall velocity
+*   INLET  -> Prescribed velocity
+*   OUTLET -> Zero pressure
+* If no outlet is defined, the pressure is fixed at element 0.
+* The velocities are read per boundary marker from the values of
+* boundary_conditions(). Without boundary conditions, all prescribed
+* velocities are zero.
+*********************************************************************/
+class FractionalStep
+{
+public:
+  using Clock  = Timer::Clock;
+  using Second = Timer::Second;
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  FractionalStep(const DualGrid& dgrid)
+  : dgrid_         { dgrid                        }
+  , poisson_       { dgrid                        }
+  , poisson_solver_{ dgrid.n_elements()           }
+  , velocity_star_ ( dgrid.n_elements(), 2, THREAD_POOL )
+  , momentum_res_  ( dgrid.n_elements(), 2, THREAD_POOL )
+  , pressure_      ( dgrid.n_elements(), 0.0      )
+  , rhs_           ( dgrid.n_elements(), 0.0      )
+  , dirichlet_     ( dgrid.n_elements(), 0        )
+  {
+    init_dirichlet_elements();
+    assemble_poisson();
+  }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void boundary_conditions(const BoundaryConditions& bc)
+  {
+    ASSERT( &bc.dual_grid() == &dgrid_,
+      "FractionalStep: Boundary conditions of a different grid.");
+    bdry_conds_ = &bc;
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const SparseMatrix& poisson_matrix() const { return poisson_; }
+
+  ConjugateGradient& poisson_solver() { return poisson_solver_; }
+  const ConjugateGradient& poisson_solver() const
+  { return poisson_solver_; }
+
+  const DMat& velocity_star() const { return velocity_star_; }
+  const DVec& pressure() const { return pressure_; }
+
+  double predictor_time() const { return predictor_time_; }
+  double pressure_time() const { return pressure_time_; }
+  double correction_time() const { return correction_time_; }
+
+  int n_steps() const { return n_steps_; }
+
+  /*------------------------------------------------------------------
+  | Advance the solution U = (p,u,v) by one time step
+  ------------------------------------------------------------------*/
+  void step(DMat& U, double dt)
+  {
+    PROFILE_SCOPE( "FractionalStep::step" );
+
+    predictor( U, dt );
+    pressure_solve( dt );
+    correction( U, dt );
+
+    ++n_steps_;
+  }
+
+  /*------------------------------------------------------------------
+  | Stage 1: Compute the intermediate velocity u*
+  ------------------------------------------------------------------*/
+  void predictor(const DMat& U, double dt)
+  {
+    PROFILE_SCOPE( "FractionalStep::predictor" );
+
+    const auto t0 = Clock::now();
+
+    momentum_residual( U );
+
+    const DVec& volumes = dgrid_.volumes();
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        const double dt_vol = dt / volumes[i];
+        velocity_star_[i][0] = U[i][IU] - dt_vol * momentum_res_[i][0];
+        velocity_star_[i][1] = U[i][IV] - dt_vol * momentum_res_[i][1];
+      }
+    });
+
+    apply_velocity_bcs( velocity_star_, 0 );
+
+    predictor_time_ += Second( Clock::now() - t0 ).count();
+
+  } // predictor()
+
+  /*------------------------------------------------------------------
+  | Stage 2: Solve the pressure Poisson equation
+  ------------------------------------------------------------------*/
+  void pressure_solve(double dt)
+  {
+    PROFILE_SCOPE( "FractionalStep::pressure_solve" );
+
+    const auto t0 = Clock::now();
+
+    divergence( velocity_star_, rhs_ );
+
+    const double scale = -1.0 / dt;
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        rhs_[i] = dirichlet_[i] ? 0.0 : scale * rhs_[i];
+    });
+
+    if ( !poisson_solver_.solve( poisson_, rhs_, pressure_ ) )
+    {
+      LOG(WARNING) << "Pressure Poisson solver did not converge after "
+                   << poisson_solver_.iterations() << " iterations "
+                   << "(residual: " << poisson_solver_.residual_norm()
+                   << ")";
+    }
+
+    pressure_time_ += Second( Clock::now() - t0 ).count();
+
+  } // pressure_solve()
+
+  /*------------------------------------------------------------------
+  | Stage 3: Project the intermediate velocity onto a divergence
+  | free field and store the new pressure
+  ------------------------------------------------------------------*/
+  void correction(DMat& U, double dt)
+  {
+    PROFILE_SCOPE( "FractionalStep::correction" );
+
+    const auto t0 = Clock::now();
+
+    // The momentum residual array is reused for the pressure gradient
+    pressure_gradient( pressure_, momentum_res_ );
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        U[i][IP] = pressure_[i];
+        U[i][IU] = velocity_star_[i][0] - dt * momentum_res_[i][0];
+        U[i][IV] = velocity_star_[i][1] - dt * momentum_res_[i][1];
+      }
+    });
+
+    apply_velocity_bcs( U, IU );
+
+    correction_time_ += Second( Clock::now() - t0 ).count();
+
+  } // correction()
+
+  /*------------------------------------------------------------------
+  | Compute the net volume flux of a velocity field out of every
+  | dual element. The velocity components are located in the
+  | columns (col, col+1) of the matrix vel.
+  ------------------------------------------------------------------*/
+  void divergence(const DMat& vel, DVec& div, int col=0) const
+  {
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double d = 0.0;
+
+        for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+        {
+          const int    j      = adj[a];
+          const int    i_face = faces[a];
+          const double sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+
+          d += sign * (
+              0.5 * ( vel[i][col]   + vel[j][col]   ) * normals[i_face][0]
+            + 0.5 * ( vel[i][col+1] + vel[j][col+1] ) * normals[i_face][1] );
+        }
+
+        div[i] = d;
+      }
+    });
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& bnormals = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+
+        div[i] -= vel[i][col]   * bnormals[i_elem][0]
+                + vel[i][col+1] * bnormals[i_elem][1];
+      });
+    }
+
+  } // divergence()
+
+private:
+  /*------------------------------------------------------------------
+  | Mark all elements with a prescribed pressure
+  ------------------------------------------------------------------*/
+  void init_dirichlet_elements()
+  {
+    bool found = false;
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( bdry.type() != BdryType::OUTLET )
+        continue;
+
+      for ( int i : bdry.dual_elements() )
+      {
+        dirichlet_[i] = 1;
+        found = true;
+      }
+    }
+
+    if ( !found && dgrid_.n_elements() > 0 )
+      dirichlet_[0] = 1;
+
+  } // init_dirichlet_elements()
+
+  /*------------------------------------------------------------------
+  | Assemble the (positive definite) Poisson matrix
+  |
+  |   A_ii =  sum_f k_f,   A_ij = -k_f,   k_f = |n_f|^2 / (n_f.d_ij)
+  |
+  | Rows and columns of Dirichlet elements are replaced by the
+  | identity, which keeps the matrix symmetric.
+  ------------------------------------------------------------------*/
+  void assemble_poisson()
+  {
+    const DMat& xy      = dgrid_.coords();
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+
+    poisson_.set_zero();
+
+    for ( int i_face = 0; i_face < dgrid_.n_intr_faces(); ++i_face )
+    {
+      const int i = nbrs[i_face][0];
+      const int j = nbrs[i_face][1];
+
+      const double nx = normals[i_face][0];
+      const double ny = normals[i_face][1];
+      const double dx = xy[j][0] - xy[i][0];
+      const double dy = xy[j][1] - xy[i][1];
+
+      const double k = (nx*nx + ny*ny) / (nx*dx + ny*dy);
+
+      if ( !dirichlet_[i] )
+      {
+        poisson_.diagonal(i)[0] += k;
+        if ( !dirichlet_[j] )
+          *poisson_.block( poisson_.find(i,j) ) -= k;
+      }
+
+      if ( !dirichlet_[j] )
+      {
+        poisson_.diagonal(j)[0] += k;
+        if ( !dirichlet_[i] )
+          *poisson_.block( poisson_.find(j,i) ) -= k;
+      }
+    }
+
+    for ( int i = 0; i < dgrid_.n_elements(); ++i )
+      if ( dirichlet_[i] )
+        poisson_.diagonal(i)[0] = 1.0;
+
+  } // assemble_poisson()
+
+  /*------------------------------------------------------------------
+  | Convective and viscous momentum fluxes with first-order
+  | upwinding of the convected velocity
+  ------------------------------------------------------------------*/
+  void momentum_residual(const DMat& U)
+  {
+    const DMat& xy      = dgrid_.coords();
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+    const double nu     = CONSTANTS.viscosity();
+
+    // Every element gathers the fluxes of its faces with the face
+    // normals pointing out of the element
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double ru = 0.0;
+        double rv = 0.0;
+
+        for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+        {
+          const int    j      = adj[a];
+          const int    i_face = faces[a];
+          const double sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+
+          const double nx = sign * normals[i_face][0];
+          const double ny = sign * normals[i_face][1];
+          const double dx = xy[j][0] - xy[i][0];
+          const double dy = xy[j][1] - xy[i][1];
+
+          const double m  = 0.5 * ( U[i][IU] + U[j][IU] ) * nx
+                          + 0.5 * ( U[i][IV] + U[j][IV] ) * ny;
+          const int    up = ( m > 0.0 ) ? i : j;
+          const double kv = nu * (nx*nx + ny*ny) / (nx*dx + ny*dy);
+
+          ru += m * U[up][IU] - kv * ( U[j][IU] - U[i][IU] );
+          rv += m * U[up][IV] - kv * ( U[j][IV] - U[i][IV] );
+        }
+
+        momentum_res_[i][0] = ru;
+        momentum_res_[i][1] = rv;
+      }
+    });
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& bnormals = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+
+        const double m = -( U[i][IU] * bnormals[i_elem][0]
+                          + U[i][IV] * bnormals[i_elem][1] );
+
+        momentum_res_[i][0] += m * U[i][IU];
+        momentum_res_[i][1] += m * U[i][IV];
+      });
+    }
+
+  } // momentum_residual()
+
+  /*------------------------------------------------------------------
+  | Green-Gauss gradient of the pressure
+  ------------------------------------------------------------------*/
+  void pressure_gradient(const DVec& p, DMat& grad) const
+  {
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const DVec& volumes = dgrid_.volumes();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double gx = 0.0;
+        double gy = 0.0;
+
+        for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+        {
+          const int    j      = adj[a];
+          const int    i_face = faces[a];
+          const double sign   = ( nbrs[i_face][0] == i ) ? 1.0 : -1.0;
+          const double pf     = 0.5 * sign * ( p[i] + p[j] );
+
+          gx += pf * normals[i_face][0];
+          gy += pf * normals[i_face][1];
+        }
+
+        grad[i][0] = gx;
+        grad[i][1] = gy;
+      }
+    });
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& bnormals = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+        grad[i][0] -= p[i] * bnormals[i_elem][0];
+        grad[i][1] -= p[i] * bnormals[i_elem][1];
+      });
+    }
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        grad[i][0] /= volumes[i];
+        grad[i][1] /= volumes[i];
+      }
+    });
+
+  } // pressure_gradient()
+
+  /*------------------------------------------------------------------
+  | Impose the velocity at walls and inlets. The velocity
+  | components are located in the columns (col, col+1).
+  ------------------------------------------------------------------*/
+  void apply_velocity_bcs(DMat& vel, int col) const
+  {
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( bdry.type() == BdryType::INLET )
+      {
+        const IVec&      elements = bdry.dual_elements();
+        const BdryValues val      = boundary_values( bdry.marker() );
+
+        THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int k)
+        {
+          vel[ elements[k] ][col]   = val.u;
+          vel[ elements[k] ][col+1] = val.v;
+        });
+      }
+    }
+
+    // Walls are treated last, such that corners are no-slip.
+    // Only the tangential component of the wall velocity is
+    // imposed (see BdryKernel<BdryType::WALL>).
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( bdry.type() == BdryType::WALL )
+      {
+        const IVec&      elements = bdry.dual_elements();
+        const DMat&      bnormals = bdry.dual_normals();
+        const BdryValues val      = boundary_values( bdry.marker() );
+
+        THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int k)
+        {
+          const double nx  = bnormals[k][0];
+          const double ny  = bnormals[k][1];
+          const double len = std::sqrt( nx*nx + ny*ny );
+          const double ex  = nx / MAX( len, INCOMFLOW_SMALL );
+          const double ey  = ny / MAX( len, INCOMFLOW_SMALL );
+          const double un  = val.u * ex + val.v * ey;
+
+          vel[ elements[k] ][col]   = val.u - un * ex;
+          vel[ elements[k] ][col+1] = val.v - un * ey;
+        });
+      }
+    }
+
+  } // apply_velocity_bcs()
+
+  /*------------------------------------------------------------------
+  | Prescribed values of the boundary with the given marker
+  ------------------------------------------------------------------*/
+  BdryValues boundary_values(int marker) const
+  {
+    return bdry_conds_ ? bdry_conds_->values( marker ) : BdryValues {};
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&   dgrid_;
+
+  const BoundaryConditions* bdry_conds_ { nullptr };
+
+  SparseMatrix      poisson_;
+  ConjugateGradient poisson_solver_;
+
+  DMat              velocity_star_;
+  DMat              momentum_res_;
+  DVec              pressure_;
+  DVec              rhs_;
+  IVec              dirichlet_;
+
+  double            predictor_time_  { 0.0 };
+  double            pressure_time_   { 0.0 };
+  double            correction_time_ { 0.0 };
+  int               n_steps_         { 0 };
+
+}; // FractionalStep
+
+} // namespace Solver
+} // namespace IncomFlow
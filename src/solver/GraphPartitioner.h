@@ -0,0 +1,864 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <utility>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Timer.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class splits the vertices of an undirected graph in CSR
+* format into K parts of balanced weight, such that the number of
+* cut edges is small. Typically, the graph is the element adjacency
+* of a dual grid, whose parts are used for the cache blocking of
+* threads or for the distribution among processes.
+*
+* The K parts are obtained with recursive multilevel bisection
+* following Karypis & Kumar (METIS). Every bisection consists of
+*
+*   1) Coarsening: The graph is contracted repeatedly with a
+*      heavy-edge matching (HEM), i.e. every vertex is merged with
+*      the unmatched neighbor of the heaviest connecting edge.
+*
+*   2) Initial bisection: The coarsest graph is grown greedily from
+*      random seeds and improved with Fiduccia-Mattheyses (FM)
+*      passes.
+*
+*   3) Uncoarsening: The bisection is projected back to the finer
+*      graphs, where it is improved by FM refinement.
+*
+* Finally, the K-way partition of the original graph is smoothed by
+* greedy boundary refinement, which moves vertices to the adjacent
+* part of largest edge cut reduction as long as the balance is kept.
+*
+* The partitioner is deterministic for a given random seed.
+*********************************************************************/
+class GraphPartitioner
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor for a generic CSR graph, where the neighbors of
+  | vertex i are adjacency[offsets[i] ... offsets[i+1]-1].
+  | Vertex weights are optional and default to one.
+  ------------------------------------------------------------------*/
+  GraphPartitioner(const IVec& offsets, const IVec& adjacency,
+                   const IVec& vertex_weights = {})
+  {
+    ASSERT( offsets.size() > 0,
+      "GraphPartitioner: Invalid graph offsets.");
+    ASSERT( offsets.back() == static_cast<int>( adjacency.size() ),
+      "GraphPartitioner: Invalid graph adjacency.");
+
+    Graph& g = graph_;
+    const int n = static_cast<int>( offsets.size() ) - 1;
+
+    g.xadj   = offsets;
+    g.adjncy = adjacency;
+    g.adjwgt.assign( adjacency.size(), 1 );
+
+    if ( vertex_weights.size() > 0 )
+    {
+      ASSERT( static_cast<int>( vertex_weights.size() ) == n,
+        "GraphPartitioner: Invalid number of vertex weights.");
+      g.vwgt = vertex_weights;
+    }
+    else
+      g.vwgt.assign( n, 1 );
+  }
+
+  /*------------------------------------------------------------------
+  | Constructor for the element adjacency of a dual grid
+  ------------------------------------------------------------------*/
+  GraphPartitioner(const DualGrid& dgrid)
+  : GraphPartitioner( dgrid.adj_offsets(), dgrid.adj_elements() )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void imbalance_tolerance(double t) { ub_factor_ = 1.0 + t; }
+  void coarsening_limit(int n) { coarse_limit_ = n; }
+  void n_refinement_passes(int n) { n_passes_ = n; }
+  void n_initial_trials(int n) { n_trials_ = n; }
+  void seed(unsigned s) { seed_ = s; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_vertices() const { return graph_.n_vertices(); }
+  int n_parts() const { return n_parts_; }
+  int n_levels() const { return n_levels_; }
+
+  const IVec& parts() const { return parts_; }
+  const IVec& part_weights() const { return part_weights_; }
+
+  int edge_cut() const { return edge_cut_; }
+  double imbalance() const { return imbalance_; }
+  double partition_time() const { return time_; }
+
+  /*------------------------------------------------------------------
+  | Split the graph into n_parts parts and return the part index
+  | of every vertex
+  ------------------------------------------------------------------*/
+  const IVec& partition(int n_parts)
+  {
+    ASSERT( n_parts > 0,
+      "GraphPartitioner: Invalid number of parts.");
+    ASSERT( n_parts <= n_vertices(),
+      "GraphPartitioner: More parts than graph vertices.");
+
+    Timer timer {};
+    timer.count();
+
+    n_parts_ = n_parts;
+    rng_.seed( seed_ );
+
+    if ( n_parts == 1 )
+    {
+      parts_.assign( n_vertices(), 0 );
+      n_levels_ = 1;
+    }
+    else
+      multilevel_partition();
+
+    evaluate_quality();
+
+    timer.count();
+    time_ = timer.delta(0);
+
+    LOG(INFO) << "GraphPartitioner: " << n_parts_ << " parts of "
+      << n_vertices() << " vertices, " << n_levels_ << " levels, "
+      << "edge cut " << edge_cut_ << ", imbalance " << imbalance_
+      << ", time " << time_ << "s";
+
+    return parts_;
+
+  } // partition()
+
+  /*------------------------------------------------------------------
+  | Edge cut of an arbitrary partition of the graph
+  ------------------------------------------------------------------*/
+  int edge_cut(const IVec& parts) const
+  {
+    return compute_edge_cut( graph_, parts );
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Weighted graph in CSR format
+  ------------------------------------------------------------------*/
+  struct Graph
+  {
+    IVec xadj;
+    IVec adjncy;
+    IVec adjwgt;
+    IVec vwgt;
+
+    int n_vertices() const
+    { return static_cast<int>( xadj.size() ) - 1; }
+
+    int total_weight() const
+    { return std::accumulate( vwgt.begin(), vwgt.end(), 0 ); }
+
+    int max_weight() const
+    { return vwgt.empty() ? 0
+           : *std::max_element( vwgt.begin(), vwgt.end() ); }
+  };
+
+  using GainQueue = std::priority_queue<std::pair<int,int>>;
+
+  /*------------------------------------------------------------------
+  | Split the graph with recursive multilevel bisection and smooth
+  | the resulting K-way partition
+  ------------------------------------------------------------------*/
+  void multilevel_partition()
+  {
+    parts_.assign( n_vertices(), 0 );
+
+    IVec ids ( n_vertices() );
+    std::iota( ids.begin(), ids.end(), 0 );
+
+    n_levels_ = 0;
+
+    recursive_bisection( graph_, ids, n_parts_, 0, parts_ );
+    kway_refine( graph_, parts_ );
+
+  } // multilevel_partition()
+
+  /*------------------------------------------------------------------
+  | Bisect the graph g, such that side 0 holds the weight fraction
+  | frac0: The graph is coarsened, the coarsest graph is bisected
+  | and the bisection is refined with FM on every finer level.
+  ------------------------------------------------------------------*/
+  IVec multilevel_bisect(const Graph& g, double frac0)
+  {
+    const int total   = g.total_weight();
+    const int target0 = static_cast<int>( frac0 * total + 0.5 );
+    const int limit   = MAX( coarse_limit_, 2 );
+    const int max_vwgt
+      = MAX( 1, static_cast<int>( 1.5 * total / limit ) );
+
+    std::vector<Graph> coarse;
+    std::vector<IVec>  cmaps;
+
+    const Graph* gc = &g;
+
+    while ( gc->n_vertices() > limit )
+    {
+      IVec cmap;
+      Graph next = coarsen( *gc, max_vwgt, cmap );
+
+      // Stop, if the matching got stuck
+      if ( next.n_vertices() > 0.95 * gc->n_vertices() )
+        break;
+
+      cmaps.push_back( std::move(cmap) );
+      coarse.push_back( std::move(next) );
+      gc = &coarse.back();
+    }
+
+    n_levels_ = MAX( n_levels_, static_cast<int>( coarse.size() ) + 1 );
+
+    IVec side = bisect( *gc, target0 );
+
+    // Project back and refine
+    for ( int level = static_cast<int>( coarse.size() ) - 1;
+          level >= 0; --level )
+    {
+      const Graph& fine = ( level == 0 ) ? g : coarse[level-1];
+      const IVec&  cmap = cmaps[level];
+
+      IVec fine_side ( fine.n_vertices() );
+
+      for ( int v = 0; v < fine.n_vertices(); ++v )
+        fine_side[v] = side[ cmap[v] ];
+
+      side = std::move( fine_side );
+      fm_refine( fine, target0, side );
+    }
+
+    return side;
+
+  } // multilevel_bisect()
+
+  /*------------------------------------------------------------------
+  | Contract the graph g with a heavy-edge matching. The coarse
+  | vertex of every fine vertex is stored in cmap.
+  ------------------------------------------------------------------*/
+  Graph coarsen(const Graph& g, int max_vwgt, IVec& cmap)
+  {
+    const int n = g.n_vertices();
+
+    IVec order ( n );
+    std::iota( order.begin(), order.end(), 0 );
+    std::shuffle( order.begin(), order.end(), rng_ );
+
+    IVec match ( n, -1 );
+
+    for ( int v : order )
+    {
+      if ( match[v] >= 0 )
+        continue;
+
+      int best   = v;
+      int best_w = -1;
+
+      for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+      {
+        const int u = g.adjncy[k];
+
+        if ( match[u] >= 0 || u == v )
+          continue;
+
+        if ( g.vwgt[v] + g.vwgt[u] > max_vwgt )
+          continue;
+
+        if ( g.adjwgt[k] > best_w )
+        {
+          best   = u;
+          best_w = g.adjwgt[k];
+        }
+      }
+
+      match[v]    = best;
+      match[best] = v;
+    }
+
+    // Number the coarse vertices
+    cmap.assign( n, -1 );
+    IVec cvert;
+    cvert.reserve( n );
+
+    for ( int v = 0; v < n; ++v )
+    {
+      if ( cmap[v] >= 0 )
+        continue;
+
+      const int c = static_cast<int>( cvert.size() );
+      cmap[v]        = c;
+      cmap[match[v]] = c;
+      cvert.push_back( v );
+    }
+
+    const int nc = static_cast<int>( cvert.size() );
+
+    // Assemble the coarse adjacency with summed edge weights
+    Graph gc;
+    gc.xadj.assign( nc + 1, 0 );
+    gc.vwgt.assign( nc, 0 );
+    gc.adjncy.reserve( g.adjncy.size() );
+    gc.adjwgt.reserve( g.adjncy.size() );
+
+    IVec slot ( nc, -1 );
+
+    for ( int c = 0; c < nc; ++c )
+    {
+      const int v0 = cvert[c];
+      const int v1 = match[v0];
+      const int begin = static_cast<int>( gc.adjncy.size() );
+
+      for ( int v : { v0, v1 } )
+      {
+        gc.vwgt[c] += g.vwgt[v];
+
+        for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        {
+          const int cu = cmap[ g.adjncy[k] ];
+
+          if ( cu == c )
+            continue;
+
+          if ( slot[cu] < begin )
+          {
+            slot[cu] = static_cast<int>( gc.adjncy.size() );
+            gc.adjncy.push_back( cu );
+            gc.adjwgt.push_back( g.adjwgt[k] );
+          }
+          else
+            gc.adjwgt[ slot[cu] ] += g.adjwgt[k];
+        }
+
+        if ( v1 == v0 )
+          break;
+      }
+
+      gc.xadj[c+1] = static_cast<int>( gc.adjncy.size() );
+    }
+
+    return gc;
+
+  } // coarsen()
+
+  /*------------------------------------------------------------------
+  | Split the vertices ids of graph g into k parts, which are
+  | numbered from first_part on. Every side of a bisection keeps at
+  | least as many vertices as it has parts, such that no part ends
+  | up empty for k close to the number of vertices.
+  ------------------------------------------------------------------*/
+  void recursive_bisection(const Graph& g, const IVec& ids,
+                           int k, int first_part, IVec& parts)
+  {
+    if ( k == 1 )
+    {
+      for ( int v : ids )
+        parts[v] = first_part;
+      return;
+    }
+
+    // One vertex per part
+    if ( k >= g.n_vertices() )
+    {
+      for ( int i = 0; i < g.n_vertices(); ++i )
+        parts[ ids[i] ] = first_part + i;
+      return;
+    }
+
+    const int k0 = k / 2;
+    const double frac0 = static_cast<double>( k0 )
+                       / static_cast<double>( k );
+
+    IVec side = multilevel_bisect( g, frac0 );
+
+    fill_side( g, side, 0, k0 );
+    fill_side( g, side, 1, k-k0 );
+
+    for ( int s = 0; s < 2; ++s )
+    {
+      IVec sub_ids;
+      Graph sub = extract_subgraph( g, side, s, ids, sub_ids );
+
+      if ( s == 0 )
+        recursive_bisection( sub, sub_ids, k0, first_part, parts );
+      else
+        recursive_bisection( sub, sub_ids, k-k0, first_part+k0, parts );
+    }
+
+  } // recursive_bisection()
+
+  /*------------------------------------------------------------------
+  | Move vertices to side s, until it holds at least n_min vertices.
+  | Vertices adjacent to side s are preferred to keep the cut small.
+  ------------------------------------------------------------------*/
+  static void fill_side(const Graph& g, IVec& side, int s, int n_min)
+  {
+    const int n = g.n_vertices();
+
+    int n_side = static_cast<int>( std::count( side.begin(), side.end(), s ) );
+
+    for ( int pass = 0; pass < 2 && n_side < n_min; ++pass )
+      for ( int v = 0; v < n && n_side < n_min; ++v )
+      {
+        if ( side[v] == s )
+          continue;
+
+        bool adjacent = ( pass > 0 );
+
+        for ( int k = g.xadj[v]; k < g.xadj[v+1] && !adjacent; ++k )
+          adjacent = ( side[ g.adjncy[k] ] == s );
+
+        if ( adjacent )
+        {
+          side[v] = s;
+          ++n_side;
+        }
+      }
+
+  } // fill_side()
+
+  /*------------------------------------------------------------------
+  | Extract the subgraph of all vertices of the given side
+  ------------------------------------------------------------------*/
+  static Graph extract_subgraph(const Graph& g, const IVec& side,
+                                int s, const IVec& ids, IVec& sub_ids)
+  {
+    const int n = g.n_vertices();
+
+    IVec local ( n, -1 );
+    sub_ids.clear();
+
+    for ( int v = 0; v < n; ++v )
+      if ( side[v] == s )
+      {
+        local[v] = static_cast<int>( sub_ids.size() );
+        sub_ids.push_back( ids[v] );
+      }
+
+    Graph sub;
+    sub.xadj.assign( sub_ids.size() + 1, 0 );
+
+    int i = 0;
+    for ( int v = 0; v < n; ++v )
+    {
+      if ( side[v] != s )
+        continue;
+
+      sub.vwgt.push_back( g.vwgt[v] );
+
+      for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        if ( side[ g.adjncy[k] ] == s )
+        {
+          sub.adjncy.push_back( local[ g.adjncy[k] ] );
+          sub.adjwgt.push_back( g.adjwgt[k] );
+        }
+
+      sub.xadj[++i] = static_cast<int>( sub.adjncy.size() );
+    }
+
+    return sub;
+
+  } // extract_subgraph()
+
+  /*------------------------------------------------------------------
+  | Initial bisection of the coarsest graph with side 0 of weight
+  | target0: The best of several greedy graph growing trials is
+  | chosen after FM refinement.
+  ------------------------------------------------------------------*/
+  IVec bisect(const Graph& g, int target0)
+  {
+    const int n = g.n_vertices();
+
+    IVec best_side;
+    int  best_cut = -1;
+
+    std::uniform_int_distribution<int> dist { 0, MAX(n-1, 0) };
+
+    for ( int trial = 0; trial < MAX(n_trials_, 1); ++trial )
+    {
+      IVec side = grow_bisection( g, target0, dist(rng_) );
+      fm_refine( g, target0, side );
+
+      const int cut = compute_edge_cut( g, side );
+
+      if ( best_cut < 0 || cut < best_cut )
+      {
+        best_cut  = cut;
+        best_side = std::move( side );
+      }
+    }
+
+    return best_side;
+
+  } // bisect()
+
+  /*------------------------------------------------------------------
+  | Greedy graph growing: Starting from the seed vertex, side 0 is
+  | grown by the vertex, whose move reduces the edge cut the most,
+  | until the target weight is reached
+  ------------------------------------------------------------------*/
+  IVec grow_bisection(const Graph& g, int target0, int seed)
+  {
+    const int n = g.n_vertices();
+
+    IVec side ( n, 1 );
+    IVec gain ( n, 0 );
+
+    for ( int v = 0; v < n; ++v )
+      for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        gain[v] -= g.adjwgt[k];
+
+    GainQueue queue;
+    queue.push( { gain[seed], seed } );
+
+    int weight0 = 0;
+    int next    = 0;
+
+    while ( weight0 < target0 )
+    {
+      // Restart from an unassigned vertex for disconnected graphs
+      if ( queue.empty() )
+      {
+        while ( next < n && side[next] == 0 )
+          ++next;
+        if ( next == n )
+          break;
+        queue.push( { gain[next], next } );
+      }
+
+      const auto [g_v, v] = queue.top();
+      queue.pop();
+
+      if ( side[v] == 0 || g_v != gain[v] )
+        continue;
+
+      // Do not overshoot the target by more than half a vertex
+      if ( weight0 > 0
+        && weight0 + g.vwgt[v] - target0 > target0 - weight0 )
+        break;
+
+      side[v]  = 0;
+      weight0 += g.vwgt[v];
+
+      for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+      {
+        const int u = g.adjncy[k];
+
+        if ( side[u] == 0 )
+          continue;
+
+        gain[u] += 2 * g.adjwgt[k];
+        queue.push( { gain[u], u } );
+      }
+    }
+
+    return side;
+
+  } // grow_bisection()
+
+  /*------------------------------------------------------------------
+  | Fiduccia-Mattheyses refinement of a bisection: Boundary vertices
+  | are moved in order of decreasing gain (also with negative gain
+  | to escape local minima) and every vertex is moved at most once
+  | per pass. Finally, all moves after the best intermediate
+  | partition are reverted.
+  ------------------------------------------------------------------*/
+  void fm_refine(const Graph& g, int target0, IVec& side)
+  {
+    const int n       = g.n_vertices();
+    const int target1 = g.total_weight() - target0;
+
+    // Every bisection gets half of the imbalance tolerance
+    const double tol  = 0.5 * ( ub_factor_ - 1.0 );
+    const int max_w[2] =
+    { target0 + MAX( g.max_weight(), static_cast<int>( tol * target0 ) ),
+      target1 + MAX( g.max_weight(), static_cast<int>( tol * target1 ) ) };
+
+    IVec gain ( n );
+    IVec locked ( n );
+    IVec moves;
+
+    for ( int pass = 0; pass < n_passes_; ++pass )
+    {
+      int w[2] = { 0, 0 };
+      for ( int v = 0; v < n; ++v )
+        w[ side[v] ] += g.vwgt[v];
+
+      GainQueue queue;
+
+      for ( int v = 0; v < n; ++v )
+      {
+        gain[v]   = 0;
+        locked[v] = 0;
+        bool bdry = false;
+
+        for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        {
+          const bool ext = ( side[ g.adjncy[k] ] != side[v] );
+          gain[v] += ext ? g.adjwgt[k] : -g.adjwgt[k];
+          bdry |= ext;
+        }
+
+        if ( bdry )
+          queue.push( { gain[v], v } );
+      }
+
+      int  cut       = compute_edge_cut( g, side );
+      int  best_cut  = cut;
+      int  best_dev  = std::abs( w[0] - target0 );
+      bool best_bal  = ( w[0] <= max_w[0] && w[1] <= max_w[1] );
+      int  best_move = 0;
+
+      const int max_bad_moves = MAX( 25, n / 50 );
+
+      moves.clear();
+
+      while ( !queue.empty()
+          && static_cast<int>( moves.size() ) - best_move < max_bad_moves )
+      {
+        const auto [g_v, v] = queue.top();
+        queue.pop();
+
+        if ( locked[v] || g_v != gain[v] )
+          continue;
+
+        const int from = side[v];
+        const int to   = 1 - from;
+
+        // Respect the balance, unless the source side is overweight
+        if ( w[to] + g.vwgt[v] > max_w[to] && w[from] <= max_w[from] )
+          continue;
+
+        side[v]   = to;
+        locked[v] = 1;
+        w[from]  -= g.vwgt[v];
+        w[to]    += g.vwgt[v];
+        cut      -= gain[v];
+        gain[v]   = -gain[v];
+        moves.push_back( v );
+
+        for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        {
+          const int u = g.adjncy[k];
+
+          if ( locked[u] )
+            continue;
+
+          gain[u] += ( side[u] == to ) ? -2 * g.adjwgt[k]
+                                       :  2 * g.adjwgt[k];
+          queue.push( { gain[u], u } );
+        }
+
+        // Balanced partitions are preferred over smaller edge cuts
+        const int  dev = std::abs( w[0] - target0 );
+        const bool bal = ( w[0] <= max_w[0] && w[1] <= max_w[1] );
+
+        const bool better = ( bal != best_bal ) ? bal
+          : ( bal ? ( cut < best_cut || ( cut == best_cut && dev < best_dev ) )
+                  : ( dev < best_dev ) );
+
+        if ( better )
+        {
+          best_cut  = cut;
+          best_dev  = dev;
+          best_bal  = bal;
+          best_move = static_cast<int>( moves.size() );
+        }
+      }
+
+      // Revert all moves after the best partition
+      for ( int i = static_cast<int>( moves.size() ) - 1;
+            i >= best_move; --i )
+        side[ moves[i] ] = 1 - side[ moves[i] ];
+
+      if ( best_move == 0 )
+        break;
+    }
+
+  } // fm_refine()
+
+  /*------------------------------------------------------------------
+  | Greedy K-way refinement: Boundary vertices are moved to the
+  | adjacent part of maximum gain, if the move reduces the edge
+  | cut, or if it improves the balance without increasing the cut.
+  | Vertices of overweight parts are moved regardless of the gain.
+  | The last vertex of a part is never moved.
+  ------------------------------------------------------------------*/
+  void kway_refine(const Graph& g, IVec& parts)
+  {
+    const int n = g.n_vertices();
+    const int total = g.total_weight();
+    const int max_pw = MAX( static_cast<int>( ub_factor_ * total / n_parts_ ),
+                            total / n_parts_ + g.max_weight() );
+
+    IVec pw ( n_parts_, 0 );
+    IVec pn ( n_parts_, 0 );
+    for ( int v = 0; v < n; ++v )
+    {
+      pw[ parts[v] ] += g.vwgt[v];
+      ++pn[ parts[v] ];
+    }
+
+    IVec conn ( n_parts_, 0 );
+    IVec touched;
+    IVec order ( n );
+    std::iota( order.begin(), order.end(), 0 );
+
+    for ( int pass = 0; pass < 2 * n_passes_; ++pass )
+    {
+      std::shuffle( order.begin(), order.end(), rng_ );
+
+      int n_moved = 0;
+
+      for ( int v : order )
+      {
+        const int p = parts[v];
+
+        if ( pn[p] == 1 )
+          continue;
+
+        touched.clear();
+        for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        {
+          const int q = parts[ g.adjncy[k] ];
+          if ( conn[q] == 0 )
+            touched.push_back( q );
+          conn[q] += g.adjwgt[k];
+        }
+
+        const int internal = conn[p];
+        int best      = -1;
+        int best_gain = 0;
+
+        for ( int q : touched )
+        {
+          if ( q == p || pw[q] + g.vwgt[v] > max_pw )
+            continue;
+
+          const int gain = conn[q] - internal;
+
+          if ( best < 0 || gain > best_gain
+            || ( gain == best_gain && pw[q] < pw[best] ) )
+          {
+            best      = q;
+            best_gain = gain;
+          }
+        }
+
+        for ( int q : touched )
+          conn[q] = 0;
+
+        if ( best < 0 )
+          continue;
+
+        const bool reduce_cut  = ( best_gain > 0 );
+        const bool balance     = ( best_gain == 0
+                                && pw[best] + g.vwgt[v] < pw[p] );
+        const bool over_weight = ( pw[p] > max_pw );
+
+        if ( reduce_cut || balance || over_weight )
+        {
+          parts[v]  = best;
+          pw[p]    -= g.vwgt[v];
+          pw[best] += g.vwgt[v];
+          --pn[p];
+          ++pn[best];
+          ++n_moved;
+        }
+      }
+
+      if ( n_moved == 0 )
+        break;
+    }
+
+  } // kway_refine()
+
+  /*------------------------------------------------------------------
+  | Weight of all edges, whose vertices belong to different parts
+  ------------------------------------------------------------------*/
+  static int compute_edge_cut(const Graph& g, const IVec& parts)
+  {
+    int cut = 0;
+
+    for ( int v = 0; v < g.n_vertices(); ++v )
+      for ( int k = g.xadj[v]; k < g.xadj[v+1]; ++k )
+        if ( g.adjncy[k] > v && parts[ g.adjncy[k] ] != parts[v] )
+          cut += g.adjwgt[k];
+
+    return cut;
+
+  } // compute_edge_cut()
+
+  /*------------------------------------------------------------------
+  | Compute edge cut, part weights and imbalance of the partition
+  ------------------------------------------------------------------*/
+  void evaluate_quality()
+  {
+    edge_cut_ = compute_edge_cut( graph_, parts_ );
+
+    part_weights_.assign( n_parts_, 0 );
+    for ( int v = 0; v < n_vertices(); ++v )
+      part_weights_[ parts_[v] ] += graph_.vwgt[v];
+
+    const double mean = static_cast<double>( graph_.total_weight() )
+                      / static_cast<double>( n_parts_ );
+
+    imbalance_ = *std::max_element( part_weights_.begin(),
+                                    part_weights_.end() ) / mean;
+
+  } // evaluate_quality()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  Graph        graph_;
+
+  double       ub_factor_    { 1.03 };
+  int          coarse_limit_ { 100 };
+  int          n_passes_     { 4 };
+  int          n_trials_     { 8 };
+  unsigned     seed_         { 1 };
+  std::mt19937 rng_          { 1 };
+
+  IVec         parts_;
+  IVec         part_weights_;
+  int          n_parts_      { 0 };
+  int          n_levels_     { 0 };
+  int          edge_cut_     { 0 };
+  double       imbalance_    { 0.0 };
+  double       time_         { 0.0 };
+
+}; // GraphPartitioner
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,299 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <random>
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class generates synthetic primary grids of the rectangle
+* [0,lx] x [0,ly], e.g. for tests and benchmarks of large grids.
+* The boundary edges obtain the same markers as the test grid:
+*
+*              3
+*        x-----------x
+*        |           |
+*      4 |           | 2
+*        |           |
+*        x-----------x
+*              1
+*
+* Grid entities follow the conventions of PrimaryGridReader:
+*   - Elements are oriented counter-clockwise
+*   - Element indices refer to quads first, followed by triangles
+*   - Interior edges store (v0, v1, left element, right element)
+*   - Boundary edges are oriented with the domain on their left
+*   - Neighbor k of an element lies across its edge (k+1, k+2)
+*********************************************************************/
+class GridGenerator
+{
+public:
+  using Quad = std::array<int,4>;
+  using Tri  = std::array<int,3>;
+
+  /*------------------------------------------------------------------
+  | Structured grid of (nx x ny) quads
+  ------------------------------------------------------------------*/
+  static PrimaryGrid structured(int nx, int ny,
+                                double lx=1.0, double ly=1.0)
+  {
+    ASSERT( nx > 0 && ny > 0,
+      "GridGenerator: Invalid number of grid cells.");
+
+    DMat xy = lattice( nx, ny, lx, ly, 0.0, 0 );
+
+    std::vector<Quad> quads ( nx * ny );
+
+    for ( int j = 0; j < ny; ++j )
+      for ( int i = 0; i < nx; ++i )
+      {
+        const int v0 = j * (nx+1) + i;
+        quads[j*nx+i] = { v0, v0+1, v0+nx+2, v0+nx+1 };
+      }
+
+    return build( xy, quads, {}, lx, ly );
+
+  } // structured()
+
+  /*------------------------------------------------------------------
+  | Unstructured grid of (2 x nx x ny) triangles, whose interior
+  | vertices are randomly displaced by up to jitter times the
+  | cell size. The cell diagonals alternate in a checkerboard
+  | pattern, such that the vertex valences vary.
+  ------------------------------------------------------------------*/
+  static PrimaryGrid unstructured(int nx, int ny,
+                                  double lx=1.0, double ly=1.0,
+                                  double jitter=0.25, unsigned seed=1)
+  {
+    ASSERT( nx > 0 && ny > 0,
+      "GridGenerator: Invalid number of grid cells.");
+
+    DMat xy = lattice( nx, ny, lx, ly, jitter, seed );
+
+    std::vector<Tri> tris ( 2 * nx * ny );
+
+    for ( int j = 0; j < ny; ++j )
+      for ( int i = 0; i < nx; ++i )
+      {
+        const int v0 = j * (nx+1) + i;
+        const int v1 = v0 + 1;
+        const int v2 = v0 + nx + 2;
+        const int v3 = v0 + nx + 1;
+        const int k  = 2 * ( j*nx + i );
+
+        if ( (i + j) % 2 == 0 )
+        {
+          tris[k]   = { v0, v1, v2 };
+          tris[k+1] = { v0, v2, v3 };
+        }
+        else
+        {
+          tris[k]   = { v0, v1, v3 };
+          tris[k+1] = { v1, v2, v3 };
+        }
+      }
+
+    return build( xy, {}, tris, lx, ly );
+
+  } // unstructured()
+
+private:
+  /*------------------------------------------------------------------
+  | Vertices of a (nx+1) x (ny+1) lattice with optionally
+  | displaced interior vertices
+  ------------------------------------------------------------------*/
+  static DMat lattice(int nx, int ny, double lx, double ly,
+                      double jitter, unsigned seed)
+  {
+    DMat xy ( (nx+1) * (ny+1), 2 );
+
+    const double dx = lx / static_cast<double>( nx );
+    const double dy = ly / static_cast<double>( ny );
+
+    std::mt19937 gen { seed };
+    std::uniform_real_distribution<double> dist { -jitter, jitter };
+
+    for ( int j = 0; j <= ny; ++j )
+      for ( int i = 0; i <= nx; ++i )
+      {
+        double x = i * dx;
+        double y = j * dy;
+
+        if ( jitter > 0.0 && i > 0 && i < nx && j > 0 && j < ny )
+        {
+          x += dist( gen ) * dx;
+          y += dist( gen ) * dy;
+        }
+
+        xy[j*(nx+1)+i][0] = x;
+        xy[j*(nx+1)+i][1] = y;
+      }
+
+    return xy;
+
+  } // lattice()
+
+  /*------------------------------------------------------------------
+  | Set up the edge structure and the element neighbors of a grid
+  ------------------------------------------------------------------*/
+  static PrimaryGrid build(const DMat& xy,
+                           const std::vector<Quad>& quads,
+                           const std::vector<Tri>& tris,
+                           double lx, double ly)
+  {
+    const int n_verts = xy.rows();
+    const int n_quads = static_cast<int>( quads.size() );
+    const int n_tris  = static_cast<int>( tris.size() );
+    const int n_elems = n_quads + n_tris;
+
+    auto elem_vertex = [&](int e, int k)
+    {
+      return ( e < n_quads ) ? quads[e][k] : tris[e-n_quads][k];
+    };
+
+    auto elem_size = [&](int e) { return ( e < n_quads ) ? 4 : 3; };
+
+    // Collect all edges: the first element, that contains an edge,
+    // lies on its left side
+    struct EdgeInfo { int v0; int v1; int left; int right; };
+
+    std::vector<EdgeInfo> edges;
+    std::unordered_map<long long, int> edge_map;
+
+    edges.reserve( 2 * n_verts + n_elems );
+    edge_map.reserve( 2 * ( 2 * n_verts + n_elems ) );
+
+    for ( int e = 0; e < n_elems; ++e )
+    {
+      const int n = elem_size( e );
+
+      for ( int k = 0; k < n; ++k )
+      {
+        const int a = elem_vertex( e, k );
+        const int b = elem_vertex( e, (k+1) % n );
+
+        const long long key = static_cast<long long>( MIN(a,b) )
+                            * n_verts + MAX(a,b);
+
+        auto it = edge_map.find( key );
+
+        if ( it == edge_map.end() )
+        {
+          edge_map[key] = static_cast<int>( edges.size() );
+          edges.push_back( { a, b, e, -1 } );
+        }
+        else
+          edges[it->second].right = e;
+      }
+    }
+
+    int n_intr_edges = 0;
+    for ( const auto& edge : edges )
+      if ( edge.right >= 0 )
+        ++n_intr_edges;
+
+    const int n_bdry_edges
+      = static_cast<int>( edges.size() ) - n_intr_edges;
+
+    PrimaryGrid grid { n_verts, n_tris, n_quads,
+                       n_intr_edges, n_bdry_edges };
+
+    for ( int i = 0; i < n_verts; ++i )
+    {
+      grid.vertex_coords()[i][0] = xy[i][0];
+      grid.vertex_coords()[i][1] = xy[i][1];
+    }
+
+    for ( int e = 0; e < n_quads; ++e )
+      for ( int k = 0; k < 4; ++k )
+        grid.quads()[e][k] = quads[e][k];
+
+    for ( int e = 0; e < n_tris; ++e )
+      for ( int k = 0; k < 3; ++k )
+        grid.tris()[e][k] = tris[e][k];
+
+    // Interior and boundary edges
+    const double tol = 1.0E-10 * MAX( lx, ly );
+
+    int i_intr = 0;
+    int i_bdry = 0;
+
+    for ( const auto& edge : edges )
+    {
+      if ( edge.right >= 0 )
+      {
+        grid.intr_edges()[i_intr][0] = edge.v0;
+        grid.intr_edges()[i_intr][1] = edge.v1;
+        grid.intr_edge_neighbors()[i_intr][0] = edge.left;
+        grid.intr_edge_neighbors()[i_intr][1] = edge.right;
+        ++i_intr;
+        continue;
+      }
+
+      const double mx = 0.5 * ( xy[edge.v0][0] + xy[edge.v1][0] );
+      const double my = 0.5 * ( xy[edge.v0][1] + xy[edge.v1][1] );
+
+      int marker = 4;
+      if      ( my < tol )      marker = 1;
+      else if ( mx > lx - tol ) marker = 2;
+      else if ( my > ly - tol ) marker = 3;
+
+      grid.bdry_edges()[i_bdry][0] = edge.v0;
+      grid.bdry_edges()[i_bdry][1] = edge.v1;
+      grid.bdry_edge_neighbors()[i_bdry] = edge.left;
+      grid.bdry_edge_markers()[i_bdry] = marker;
+      ++i_bdry;
+    }
+
+    // Element neighbors
+    for ( int e = 0; e < n_elems; ++e )
+    {
+      const int n = elem_size( e );
+
+      for ( int k = 0; k < n; ++k )
+      {
+        const int a = elem_vertex( e, (k+1) % n );
+        const int b = elem_vertex( e, (k+2) % n );
+
+        const long long key = static_cast<long long>( MIN(a,b) )
+                            * n_verts + MAX(a,b);
+
+        const EdgeInfo& edge = edges[ edge_map[key] ];
+        const int nbr = ( edge.left == e ) ? edge.right : edge.left;
+
+        if ( e < n_quads )
+          grid.quad_neighbors()[e][k] = nbr;
+        else
+          grid.tri_neighbors()[e-n_quads][k] = nbr;
+      }
+    }
+
+    return grid;
+
+  } // build()
+
+}; // GridGenerator
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,726 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <unordered_set>
+#include <cstdint>
+#include <cstdio>
+
+#include "Vec2.h"
+#include "Geometry.h"
+#include "LinearQuadTree.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Log.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Defects, which are detected by the GridValidator
+*********************************************************************/
+enum class GridDefect
+{
+  INVERTED_ELEMENT,   // Element is not strictly convex and CCW
+  NEIGHBOR_MISMATCH,  // Element neighbors are not reciprocal
+  EDGE_MISMATCH,      // Edge neighbors do not match the elements
+  DUPLICATE_VERTEX,   // Two vertices coincide
+  OPEN_BOUNDARY,      // Boundary edges do not form closed loops
+  OVERLAPPING,        // Two elements overlap
+};
+
+constexpr int N_GRID_DEFECTS { 6 };
+
+/*********************************************************************
+* A defect and the entities it refers to:
+*
+*   INVERTED_ELEMENT    a = element
+*   NEIGHBOR_MISMATCH   a = element,       b = its neighbor
+*   EDGE_MISMATCH       a = edge,          b = element
+*                       (boundary edges with n_intr_edges offset)
+*   DUPLICATE_VERTEX    a, b = vertices
+*   OPEN_BOUNDARY       a = vertex,        b = -1, or
+*                       a = element,       b = local edge without
+*                                              boundary edge
+*   OVERLAPPING         a, b = elements
+*
+* Elements are indexed with quads first, followed by triangles.
+*********************************************************************/
+struct GridOffender
+{
+  GridDefect defect;
+  int        a { -1 };
+  int        b { -1 };
+};
+
+/*********************************************************************
+* This class verifies the consistency of a primary grid, e.g. at the
+* start of a simulation. The following checks are available:
+*
+* - Orientation:  All element corners are counter-clockwise, which
+*                 is evaluated exactly by the batched predicates
+* - Neighbors:    Neighbor k of every element lies across its edge
+*                 (k+1, k+2) and refers back to the element
+* - Edges:        Interior edges (v0,v1) are contained in their left
+*                 element and in reverse in their right element,
+*                 boundary edges in their element without neighbor
+* - Duplicates:   No two vertices are closer than the tolerance
+*                 relative to the grid extent
+* - Boundary:     Every vertex has as many incoming as outgoing
+*                 boundary edges and every element edge without
+*                 neighbor is a boundary edge (watertight)
+* - Overlaps:     Every pair of elements is separated by one of
+*                 their edges (exact separating axis test), which
+*                 also detects folded fans around shared vertices.
+*                 Candidates are obtained from a LinearQuadTree of
+*                 the element centroids.
+*
+* All checks are parallelized with the global thread pool. The
+* offenders of each check are reported in the order of their
+* entities.
+*
+* Usage:
+* ------
+*   GridValidator validator { primgrid };
+*
+*   if ( !validator.validate() )
+*     for ( const auto& o : validator.offenders() ) ...
+*********************************************************************/
+class GridValidator
+{
+public:
+  using Offenders = std::vector<GridOffender>;
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  GridValidator(const PrimaryGrid& grid)
+  : grid_ { grid }
+  , check_times_ ( N_GRID_DEFECTS, 0.0 )
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const Offenders& offenders() const { return offenders_; }
+  double tolerance() const { return tolerance_; }
+  int max_reported() const { return max_reported_; }
+
+  int n_elements() const { return grid_.n_quads() + grid_.n_tris(); }
+
+  size_t n_offenders(GridDefect defect) const
+  {
+    return std::count_if( offenders_.begin(), offenders_.end(),
+      [defect](const GridOffender& o) { return o.defect == defect; });
+  }
+
+  double check_time(GridDefect defect) const
+  { return check_times_[ static_cast<int>( defect ) ]; }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  // Distance of duplicate vertices relative to the grid extent
+  void tolerance(double t) { tolerance_ = t; }
+
+  // Number of offenders per defect, which are logged
+  void max_reported(int n) { max_reported_ = n; }
+
+  /*------------------------------------------------------------------
+  | Run all checks, log a summary and return true, if the grid is
+  | valid
+  ------------------------------------------------------------------*/
+  bool validate()
+  {
+    offenders_.clear();
+
+    check_orientation();
+    check_neighbors();
+    check_edges();
+    check_duplicate_vertices();
+    check_boundary();
+    check_overlaps();
+
+    log_summary();
+
+    return offenders_.empty();
+  }
+
+  /*------------------------------------------------------------------
+  | Strictly convex and counter-clockwise elements, whose corners
+  | are evaluated in blocks by the batched orientation predicate
+  ------------------------------------------------------------------*/
+  size_t check_orientation()
+  {
+    return run_check( GridDefect::INVERTED_ELEMENT,
+    [&](int i0, int i1, Offenders& found)
+    {
+      constexpr int BLOCK = 64;
+
+      double px[4*BLOCK], py[4*BLOCK], qx[4*BLOCK], qy[4*BLOCK];
+      double rx[4*BLOCK], ry[4*BLOCK];
+      Orientation orient[4*BLOCK];
+
+      for ( int b0 = i0; b0 < i1; b0 += BLOCK )
+      {
+        const int b1 = MIN( b0 + BLOCK, i1 );
+        int m = 0;
+
+        for ( int e = b0; e < b1; ++e )
+        {
+          int v[4];
+          const int n = element( e, v );
+
+          for ( int k = 0; k < n; ++k, ++m )
+          {
+            px[m] = x( v[(k+n-1) % n] ); py[m] = y( v[(k+n-1) % n] );
+            qx[m] = x( v[k] );           qy[m] = y( v[k] );
+            rx[m] = x( v[(k+1) % n] );   ry[m] = y( v[(k+1) % n] );
+          }
+        }
+
+        orientation_batch( Vec2Array { px, py }, Vec2Array { qx, qy },
+                           Vec2Array { rx, ry }, m, orient );
+
+        m = 0;
+
+        for ( int e = b0; e < b1; ++e )
+        {
+          const int n = element_size( e );
+          bool valid  = true;
+
+          for ( int k = 0; k < n; ++k, ++m )
+            valid &= ( orient[m] == Orientation::CCW );
+
+          if ( !valid )
+            found.push_back( { GridDefect::INVERTED_ELEMENT, e } );
+        }
+      }
+    });
+  }
+
+  /*------------------------------------------------------------------
+  | Reciprocal element neighbors
+  ------------------------------------------------------------------*/
+  size_t check_neighbors()
+  {
+    return run_check( GridDefect::NEIGHBOR_MISMATCH,
+    [&](int i0, int i1, Offenders& found)
+    {
+      const int n_elems = n_elements();
+
+      for ( int e = i0; e < i1; ++e )
+      {
+        int v[4];
+        const int n = element( e, v );
+
+        for ( int k = 0; k < n; ++k )
+        {
+          const int nbr = neighbor( e, k );
+
+          if ( nbr < 0 )
+            continue;
+
+          // The neighbor contains the edge in reverse and refers
+          // back across it
+          const int a = v[(k+1) % n];
+          const int b = v[(k+2) % n];
+
+          const bool valid = ( nbr < n_elems )
+                          && ( nbr != e )
+                          && ( neighbor_across( nbr, b, a ) == e );
+
+          if ( !valid )
+            found.push_back( { GridDefect::NEIGHBOR_MISMATCH, e, nbr } );
+        }
+      }
+    });
+  }
+
+  /*------------------------------------------------------------------
+  | Interior and boundary edges, which match their elements
+  ------------------------------------------------------------------*/
+  size_t check_edges()
+  {
+    const int n_intr = grid_.n_intr_edges();
+
+    return run_check( GridDefect::EDGE_MISMATCH,
+      n_intr + grid_.n_bdry_edges(),
+    [&](int i0, int i1, Offenders& found)
+    {
+      const int n_elems = n_elements();
+
+      auto valid_element = [n_elems](int e)
+      { return e >= 0 && e < n_elems; };
+
+      for ( int i = i0; i < i1; ++i )
+      {
+        if ( i < n_intr )
+        {
+          const int v0 = grid_.intr_edges()[i][0];
+          const int v1 = grid_.intr_edges()[i][1];
+          const int l  = grid_.intr_edge_neighbors()[i][0];
+          const int r  = grid_.intr_edge_neighbors()[i][1];
+
+          if ( !valid_element( l ) || neighbor_across( l, v0, v1 ) != r )
+            found.push_back( { GridDefect::EDGE_MISMATCH, i, l } );
+          else if ( !valid_element( r ) || neighbor_across( r, v1, v0 ) != l )
+            found.push_back( { GridDefect::EDGE_MISMATCH, i, r } );
+        }
+        else
+        {
+          const int j  = i - n_intr;
+          const int v0 = grid_.bdry_edges()[j][0];
+          const int v1 = grid_.bdry_edges()[j][1];
+          const int l  = grid_.bdry_edge_neighbors()[j];
+
+          if ( !valid_element( l ) || neighbor_across( l, v0, v1 ) != -1 )
+            found.push_back( { GridDefect::EDGE_MISMATCH, i, l } );
+        }
+      }
+    });
+  }
+
+  /*------------------------------------------------------------------
+  | Duplicate vertices, which are found through a quad tree
+  ------------------------------------------------------------------*/
+  size_t check_duplicate_vertices()
+  {
+    const auto start = Timer::Clock::now();
+
+    const int n_verts = grid_.n_vertices();
+
+    std::vector<IndexedPoint>  points ( n_verts );
+    std::vector<IndexedPoint*> ptrs ( n_verts );
+
+    for ( int i = 0; i < n_verts; ++i )
+    {
+      points[i] = { { x(i), y(i) }, i };
+      ptrs[i]   = &points[i];
+    }
+
+    LinearQuadTree<IndexedPoint,double> qtree { 32 };
+    qtree.build( ptrs );
+
+    const double tol = tolerance_ * extent();
+
+    return run_check( GridDefect::DUPLICATE_VERTEX, n_verts,
+    [&](int i0, int i1, Offenders& found)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        const Vec2d lowleft = points[i].xy() - tol;
+        const Vec2d upright = points[i].xy() + tol;
+
+        qtree.get_items( lowleft, upright, [&](const IndexedPoint* p)
+        {
+          if ( p->index > i )
+            found.push_back( { GridDefect::DUPLICATE_VERTEX, i, p->index } );
+        });
+      }
+    }, start );
+  }
+
+  /*------------------------------------------------------------------
+  | Closed boundary loops and element edges without neighbors,
+  | which are boundary edges
+  ------------------------------------------------------------------*/
+  size_t check_boundary()
+  {
+    const auto start = Timer::Clock::now();
+
+    const int n_verts = grid_.n_vertices();
+    const int n_bdry  = grid_.n_bdry_edges();
+
+    IVec degree ( n_verts, 0 );
+    std::unordered_set<std::uint64_t> bdry_edges {};
+    bdry_edges.reserve( 2 * n_bdry );
+
+    for ( int i = 0; i < n_bdry; ++i )
+    {
+      const int v0 = grid_.bdry_edges()[i][0];
+      const int v1 = grid_.bdry_edges()[i][1];
+
+      if ( v0 < 0 || v0 >= n_verts || v1 < 0 || v1 >= n_verts )
+        continue;
+
+      ++degree[v0];
+      --degree[v1];
+      bdry_edges.insert( edge_key( v0, v1 ) );
+    }
+
+    const int n_elems = n_elements();
+
+    return run_check( GridDefect::OPEN_BOUNDARY, n_verts + n_elems,
+    [&](int i0, int i1, Offenders& found)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        if ( i < n_verts )
+        {
+          if ( degree[i] != 0 )
+            found.push_back( { GridDefect::OPEN_BOUNDARY, i, -1 } );
+          continue;
+        }
+
+        const int e = i - n_verts;
+        int v[4];
+        const int n = element( e, v );
+
+        for ( int k = 0; k < n; ++k )
+        {
+          if ( neighbor( e, k ) >= 0 )
+            continue;
+
+          const int a = v[(k+1) % n];
+          const int b = v[(k+2) % n];
+
+          if ( bdry_edges.find( edge_key( a, b ) ) == bdry_edges.end() )
+            found.push_back( { GridDefect::OPEN_BOUNDARY, e, k } );
+        }
+      }
+    }, start );
+  }
+
+  /*------------------------------------------------------------------
+  | Overlapping elements. Candidates are elements, whose centroids
+  | are within the maximum centroid-vertex distance of the element
+  | bounding box. Elements, which share a vertex, are tested as
+  | well, since a fan of counter-clockwise elements may fold over
+  | itself at a boundary vertex without an inverted element.
+  ------------------------------------------------------------------*/
+  size_t check_overlaps()
+  {
+    const auto start = Timer::Clock::now();
+
+    const int n_elems = n_elements();
+
+    std::vector<IndexedPoint>  centroids ( n_elems );
+    std::vector<IndexedPoint*> ptrs ( n_elems );
+    std::vector<Box>           boxes ( n_elems );
+
+    double max_radius = 0.0;
+
+    for ( int e = 0; e < n_elems; ++e )
+    {
+      int   v[4];
+      Vec2d xy[4];
+      const int n = element( e, v, xy );
+
+      Vec2d c { 0.0, 0.0 };
+      Box   box { xy[0], xy[0] };
+
+      for ( int k = 0; k < n; ++k )
+      {
+        c += xy[k];
+        box.lowleft = bbox_min( box.lowleft, xy[k] );
+        box.upright = bbox_max( box.upright, xy[k] );
+      }
+
+      c *= 1.0 / n;
+
+      for ( int k = 0; k < n; ++k )
+        max_radius = MAX( max_radius, ( xy[k] - c ).length() );
+
+      centroids[e] = { c, e };
+      ptrs[e]      = &centroids[e];
+      boxes[e]     = box;
+    }
+
+    LinearQuadTree<IndexedPoint,double> qtree { 32 };
+    qtree.build( ptrs );
+
+    // Elements are processed in blocks of consecutive tree items,
+    // which are close to each other. Each block queries the tree
+    // only once for the candidates of all its elements.
+    constexpr int BLOCK = 8;
+
+    const auto& items    = qtree.items();
+    const int   n_blocks = ( n_elems + BLOCK - 1 ) / BLOCK;
+
+    return run_check( GridDefect::OVERLAPPING, n_blocks,
+    [&](int i0, int i1, Offenders& found)
+    {
+      IVec candidates {};
+
+      for ( int i = i0; i < i1; ++i )
+      {
+        const int b0 = i * BLOCK;
+        const int b1 = MIN( b0 + BLOCK, n_elems );
+
+        Box block = boxes[ items[b0]->index ];
+
+        for ( int j = b0+1; j < b1; ++j )
+        {
+          block.lowleft = bbox_min( block.lowleft, boxes[items[j]->index].lowleft );
+          block.upright = bbox_max( block.upright, boxes[items[j]->index].upright );
+        }
+
+        candidates.clear();
+
+        qtree.get_items( block.lowleft - max_radius, block.upright + max_radius,
+          [&](const IndexedPoint* p) { candidates.push_back( p->index ); });
+
+        for ( int j = b0; j < b1; ++j )
+        {
+          const int  e   = items[j]->index;
+          const Box& box = boxes[e];
+
+          int   ve[4];
+          Vec2d a[4];
+          const int ne = element( e, ve, a );
+
+          for ( const int c : candidates )
+          {
+            if ( c <= e || !rect_overlap( box.lowleft, box.upright,
+                                          boxes[c].lowleft, boxes[c].upright ) )
+              continue;
+
+            if ( overlap( a, ne, c ) )
+              found.push_back( { GridDefect::OVERLAPPING, e, c } );
+          }
+        }
+      }
+    }, start );
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Helper structures
+  ------------------------------------------------------------------*/
+  struct IndexedPoint
+  {
+    Vec2d xy_;
+    int   index;
+
+    const Vec2d& xy() const { return xy_; }
+  };
+
+  struct Box
+  {
+    Vec2d lowleft;
+    Vec2d upright;
+  };
+
+  /*------------------------------------------------------------------
+  | Vertex coordinates
+  ------------------------------------------------------------------*/
+  double x(int v) const { return grid_.vertex_coords()[v][0]; }
+  double y(int v) const { return grid_.vertex_coords()[v][1]; }
+
+  double extent() const
+  {
+    const int n_verts = grid_.n_vertices();
+
+    if ( n_verts == 0 )
+      return 0.0;
+
+    Vec2d lowleft { x(0), y(0) };
+    Vec2d upright { x(0), y(0) };
+
+    for ( int i = 1; i < n_verts; ++i )
+    {
+      lowleft = bbox_min( lowleft, Vec2d { x(i), y(i) } );
+      upright = bbox_max( upright, Vec2d { x(i), y(i) } );
+    }
+
+    return ( upright - lowleft ).length();
+  }
+
+  /*------------------------------------------------------------------
+  | Element vertices and neighbors
+  ------------------------------------------------------------------*/
+  int element_size(int e) const { return ( e < grid_.n_quads() ) ? 4 : 3; }
+
+  int element(int e, int* v) const
+  {
+    const int  n_quads = grid_.n_quads();
+    const int  n       = element_size( e );
+    const int* verts   = ( e < n_quads ) ? grid_.quads()[e]
+                                         : grid_.tris()[e-n_quads];
+    for ( int k = 0; k < n; ++k )
+      v[k] = verts[k];
+
+    return n;
+  }
+
+  int element(int e, int* v, Vec2d* xy) const
+  {
+    const int n = element( e, v );
+
+    for ( int k = 0; k < n; ++k )
+      xy[k] = { x( v[k] ), y( v[k] ) };
+
+    return n;
+  }
+
+  int neighbor(int e, int k) const
+  {
+    const int n_quads = grid_.n_quads();
+    return ( e < n_quads ) ? grid_.quad_neighbors()[e][k]
+                           : grid_.tri_neighbors()[e-n_quads][k];
+  }
+
+  /*------------------------------------------------------------------
+  | Neighbor across the directed edge (a,b) of an element, which
+  | returns -2, if the element does not contain the edge
+  ------------------------------------------------------------------*/
+  int neighbor_across(int e, int a, int b) const
+  {
+    int v[4];
+    const int n = element( e, v );
+
+    for ( int k = 0; k < n; ++k )
+      if ( v[(k+1) % n] == a && v[(k+2) % n] == b )
+        return neighbor( e, k );
+
+    return -2;
+  }
+
+  static std::uint64_t edge_key(int a, int b)
+  {
+    return ( static_cast<std::uint64_t>( static_cast<std::uint32_t>( a ) ) << 32 )
+         | static_cast<std::uint32_t>( b );
+  }
+
+  /*------------------------------------------------------------------
+  | Check if the interiors of two elements overlap. Valid elements
+  | are convex, hence their interiors are disjoint, if an edge of
+  | either element separates it from all vertices of the other one
+  | (separating axis test). Shared vertices lie exactly on such an
+  | edge and count as separated, so neighbors, which touch in a
+  | vertex or an edge, pass the test. The orientations are exact,
+  | since the tolerance of orientation() exceeds the size of small
+  | elements, such that line_line_intersection() reports close
+  | elements as intersecting.
+  ------------------------------------------------------------------*/
+  bool overlap(const Vec2d* a, int ne, int c) const
+  {
+    int   vc[4];
+    Vec2d b[4];
+    const int nc = element( c, vc, b );
+
+    return !separated( a, ne, b, nc ) && !separated( b, nc, a, ne );
+  }
+
+  static bool separated(const Vec2d* a, int na, const Vec2d* b, int nb)
+  {
+    for ( int k = 0; k < na; ++k )
+    {
+      const Vec2d& p = a[k];
+      const Vec2d& q = a[(k+1) % na];
+
+      bool outside = true;
+
+      for ( int j = 0; j < nb && outside; ++j )
+        outside = ( orient2d( p.x, p.y, q.x, q.y, b[j].x, b[j].y ) <= 0 );
+
+      if ( outside )
+        return true;
+    }
+
+    return false;
+  }
+
+  /*------------------------------------------------------------------
+  | Run a check in parallel over [0,n), collect its offenders and
+  | measure its time
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  size_t run_check(GridDefect defect, int n, Function&& check,
+                   Timer::Timepoint start = Timer::Clock::now())
+  {
+    Offenders found = THREAD_POOL.parallel_reduce( 0, n, Offenders {},
+      [&](int i0, int i1)
+      {
+        Offenders local {};
+        check( i0, i1, local );
+        return local;
+      },
+      [](Offenders a, const Offenders& b)
+      {
+        a.insert( a.end(), b.begin(), b.end() );
+        return a;
+      });
+
+    std::sort( found.begin(), found.end(),
+      [](const GridOffender& l, const GridOffender& r)
+      { return l.a < r.a || ( l.a == r.a && l.b < r.b ); });
+
+    offenders_.insert( offenders_.end(), found.begin(), found.end() );
+
+    check_times_[ static_cast<int>( defect ) ]
+      = Timer::Second( Timer::Clock::now() - start ).count();
+
+    return found.size();
+  }
+
+  template <typename Function>
+  size_t run_check(GridDefect defect, Function&& check)
+  { return run_check( defect, n_elements(), check ); }
+
+  /*------------------------------------------------------------------
+  | Log the number of offenders of every check and some of them
+  ------------------------------------------------------------------*/
+  void log_summary() const
+  {
+    static const char* names[N_GRID_DEFECTS] =
+    { "Inverted elements", "Neighbor mismatches", "Edge mismatches",
+      "Duplicate vertices", "Open boundaries", "Overlapping elements" };
+
+    LOG(INFO) << "Grid validation: " << n_elements() << " elements, "
+              << grid_.n_vertices() << " vertices";
+
+    for ( int d = 0; d < N_GRID_DEFECTS; ++d )
+    {
+      const GridDefect defect = static_cast<GridDefect>( d );
+      const size_t n = n_offenders( defect );
+
+      char line[120];
+      std::snprintf( line, sizeof(line), "  %-22s %10zu   (%.3fs)",
+                     names[d], n, check_times_[d] );
+
+      if ( n == 0 )
+      {
+        LOG(INFO) << line;
+        continue;
+      }
+
+      LOG(WARNING) << line;
+
+      int n_reported = 0;
+
+      for ( const auto& o : offenders_ )
+        if ( o.defect == defect && n_reported++ < max_reported_ )
+          LOG(WARNING) << "    (" << o.a << ", " << o.b << ")";
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const PrimaryGrid& grid_;
+
+  Offenders          offenders_;
+  DVec               check_times_;
+  double             tolerance_    { 1.0E-12 };
+  int                max_reported_ { 10 };
+
+}; // GridValidator
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,185 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "Communicator.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+#include "DomainDecomposition.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class updates the ghost rows of solution matrices on a
+* sub-grid (see DomainDecomposition.h) with the values of their
+* owners.
+*
+* The exchange is split into begin() and finish(), such that
+* computations, which only depend on owned rows, overlap with the
+* communication. For this purpose, the interior faces of the local
+* dual grid are classified into
+*
+*   inner_faces(): Faces between two owned elements
+*   ghost_faces(): Faces between an owned and a ghost element
+*
+* Faces between two ghost elements are not needed by any owned
+* element and are skipped (see EdgeResidual::compute()).
+*********************************************************************/
+class HaloExchange
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  HaloExchange(const SubGrid& subgrid, const DualGrid& dgrid,
+               Communicator& comm)
+  : subgrid_ { subgrid }
+  , comm_    { comm    }
+  {
+    ASSERT( dgrid.n_elements() == subgrid.n_vertices(),
+      "HaloExchange: Dual grid does not match the sub-grid.");
+
+    const int  n_owned = subgrid.n_owned();
+    const IMat& nbrs   = dgrid.face_neighbors();
+
+    for ( int i_face = 0; i_face < dgrid.n_intr_faces(); ++i_face )
+    {
+      const bool owned_0 = ( nbrs[i_face][0] < n_owned );
+      const bool owned_1 = ( nbrs[i_face][1] < n_owned );
+
+      if ( owned_0 && owned_1 )
+        inner_faces_.push_back( i_face );
+      else if ( owned_0 || owned_1 )
+        ghost_faces_.push_back( i_face );
+    }
+
+    send_buffers_.resize( subgrid.n_neighbors() );
+    recv_buffers_.resize( subgrid.n_neighbors() );
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const SubGrid& subgrid() const { return subgrid_; }
+  Communicator& communicator() { return comm_; }
+
+  int n_owned() const { return subgrid_.n_owned(); }
+
+  const IVec& inner_faces() const { return inner_faces_; }
+  const IVec& ghost_faces() const { return ghost_faces_; }
+
+  /*------------------------------------------------------------------
+  | Post the exchange of the ghost rows of U
+  ------------------------------------------------------------------*/
+  void begin(const DMat& U)
+  {
+    PROFILE_SCOPE( "HaloExchange::begin" );
+
+    const int n_cols = U.columns();
+
+    for ( int k = 0; k < subgrid_.n_neighbors(); ++k )
+    {
+      const IVec& send = subgrid_.send_elements()[k];
+      const IVec& recv = subgrid_.recv_elements()[k];
+      const int   rank = subgrid_.neighbor_ranks()[k];
+
+      DVec& send_buf = send_buffers_[k];
+      DVec& recv_buf = recv_buffers_[k];
+
+      send_buf.resize( send.size() * n_cols );
+      recv_buf.resize( recv.size() * n_cols );
+
+      for ( std::size_t i = 0; i < send.size(); ++i )
+        for ( int j = 0; j < n_cols; ++j )
+          send_buf[i*n_cols+j] = U[ send[i] ][j];
+
+      comm_.irecv( rank, recv_buf.data(),
+                   static_cast<int>( recv_buf.size() ) );
+      comm_.isend( rank, send_buf.data(),
+                   static_cast<int>( send_buf.size() ) );
+    }
+
+  } // begin()
+
+  /*------------------------------------------------------------------
+  | Complete the exchange and copy the received ghost rows into U
+  ------------------------------------------------------------------*/
+  void finish(DMat& U)
+  {
+    PROFILE_SCOPE( "HaloExchange::finish" );
+
+    comm_.wait_all();
+
+    const int n_cols = U.columns();
+
+    for ( int k = 0; k < subgrid_.n_neighbors(); ++k )
+    {
+      const IVec& recv     = subgrid_.recv_elements()[k];
+      const DVec& recv_buf = recv_buffers_[k];
+
+      for ( std::size_t i = 0; i < recv.size(); ++i )
+        for ( int j = 0; j < n_cols; ++j )
+          U[ recv[i] ][j] = recv_buf[i*n_cols+j];
+    }
+
+  } // finish()
+
+  /*------------------------------------------------------------------
+  | Blocking exchange of the ghost rows of U
+  ------------------------------------------------------------------*/
+  void exchange(DMat& U)
+  {
+    begin( U );
+    finish( U );
+  }
+
+  /*------------------------------------------------------------------
+  | Global L2-norm of the owned rows of R
+  ------------------------------------------------------------------*/
+  double norm(const DMat& R)
+  {
+    PROFILE_SCOPE( "HaloExchange::norm" );
+
+    double sum = 0.0;
+
+    for ( int i = 0; i < subgrid_.n_owned(); ++i )
+      for ( int j = 0; j < R.columns(); ++j )
+        sum += R[i][j] * R[i][j];
+
+    return std::sqrt( comm_.all_reduce_sum( sum ) );
+
+  } // norm()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const SubGrid&    subgrid_;
+  Communicator&     comm_;
+
+  IVec              inner_faces_;
+  IVec              ghost_faces_;
+
+  std::vector<DVec> send_buffers_;
+  std::vector<DVec> recv_buffers_;
+
+}; // HaloExchange
+
+} // namespace Solver
+} // namespace IncomFlow
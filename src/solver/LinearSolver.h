@@ -0,0 +1,579 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <atomic>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "SparseMatrix.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Dot product of two vectors
+*********************************************************************/
+inline double dot_product(const DVec& a, const DVec& b)
+{
+  return THREAD_POOL.parallel_reduce(0, static_cast<int>(a.size()), 0.0,
+    [&](int i0, int i1)
+    {
+      double sum = 0.0;
+
+      for ( int i = i0; i < i1; ++i )
+        sum += a[i] * b[i];
+
+      return sum;
+    },
+    [](double x, double y) { return x + y; });
+}
+
+/*********************************************************************
+* This class solves symmetric positive definite systems A * x = b
+* with the Jacobi-preconditioned conjugate gradient method.
+* The work vectors are allocated once and reused for all solves,
+* while the provided solution vector serves as initial guess.
+*********************************************************************/
+class ConjugateGradient
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  ConjugateGradient(int n, double tolerance=1.0E-8, int max_iter=1000)
+  : tolerance_ { tolerance }
+  , max_iter_  { max_iter  }
+  , inv_diag_  ( n         )
+  , r_         ( n         )
+  , z_         ( n         )
+  , p_         ( n         )
+  , q_         ( n         )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void tolerance(double t) { tolerance_ = t; }
+  void max_iter(int n) { max_iter_ = n; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  double tolerance() const { return tolerance_; }
+  int max_iter() const { return max_iter_; }
+  int iterations() const { return iterations_; }
+  double residual_norm() const { return residual_norm_; }
+
+  /*------------------------------------------------------------------
+  | Solve A * x = b up to a relative residual of tolerance_.
+  | Returns true on convergence.
+  ------------------------------------------------------------------*/
+  bool solve(const SparseMatrix& A, const DVec& b, DVec& x)
+  {
+    PROFILE_SCOPE( "ConjugateGradient::solve" );
+
+    ASSERT( A.block_size() == 1,
+      "ConjugateGradient: Only scalar matrices are supported.");
+
+    const int n = A.n_rows();
+
+    THREAD_POOL.parallel_for(0, n, [&](int i)
+    { inv_diag_[i] = 1.0 / A.diagonal(i)[0]; });
+
+    // r = b - A * x
+    A.multiply( x, q_ );
+
+    THREAD_POOL.parallel_for(0, n, [&](int i)
+    {
+      r_[i] = b[i] - q_[i];
+      z_[i] = inv_diag_[i] * r_[i];
+      p_[i] = z_[i];
+    });
+
+    const double b_norm = MAX( std::sqrt( dot_product(b, b) ),
+                               INCOMFLOW_SMALL );
+
+    double rz = dot_product( r_, z_ );
+
+    residual_norm_ = std::sqrt( dot_product(r_, r_) ) / b_norm;
+    iterations_    = 0;
+
+    while ( residual_norm_ > tolerance_ && iterations_ < max_iter_ )
+    {
+      A.multiply( p_, q_ );
+
+      const double alpha = rz / dot_product( p_, q_ );
+
+      THREAD_POOL.parallel_for(0, n, [&](int i)
+      {
+        x[i]  += alpha * p_[i];
+        r_[i] -= alpha * q_[i];
+        z_[i]  = inv_diag_[i] * r_[i];
+      });
+
+      const double rz_new = dot_product( r_, z_ );
+      const double beta   = rz_new / rz;
+      rz = rz_new;
+
+      THREAD_POOL.parallel_for(0, n, [&](int i)
+      { p_[i] = z_[i] + beta * p_[i]; });
+
+      residual_norm_ = std::sqrt( dot_product(r_, r_) ) / b_norm;
+      ++iterations_;
+    }
+
+    return ( residual_norm_ <= tolerance_ );
+
+  } // solve()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  double tolerance_;
+  int    max_iter_;
+
+  int    iterations_    { 0 };
+  double residual_norm_ { 0.0 };
+
+  DVec   inv_diag_;
+  DVec   r_;
+  DVec   z_;
+  DVec   p_;
+  DVec   q_;
+
+}; // ConjugateGradient
+
+/*********************************************************************
+* Invert the dense (n x n) row-major matrix a with Gauss-Jordan
+* elimination and partial pivoting. Returns false if the matrix
+* is singular.
+*********************************************************************/
+inline bool invert_block(const double* a, double* inv, int n)
+{
+  std::vector<double> m ( a, a + n*n );
+
+  for ( int i = 0; i < n*n; ++i )
+    inv[i] = 0.0;
+  for ( int i = 0; i < n; ++i )
+    inv[i*n+i] = 1.0;
+
+  for ( int c = 0; c < n; ++c )
+  {
+    int pivot = c;
+    for ( int r = c+1; r < n; ++r )
+      if ( std::fabs(m[r*n+c]) > std::fabs(m[pivot*n+c]) )
+        pivot = r;
+
+    if ( std::fabs(m[pivot*n+c]) < INCOMFLOW_SMALL )
+      return false;
+
+    if ( pivot != c )
+    {
+      for ( int k = 0; k < n; ++k )
+      {
+        std::swap( m[c*n+k],   m[pivot*n+k] );
+        std::swap( inv[c*n+k], inv[pivot*n+k] );
+      }
+    }
+
+    const double d = 1.0 / m[c*n+c];
+
+    for ( int k = 0; k < n; ++k )
+    {
+      m[c*n+k]   *= d;
+      inv[c*n+k] *= d;
+    }
+
+    for ( int r = 0; r < n; ++r )
+    {
+      if ( r == c )
+        continue;
+
+      const double f = m[r*n+c];
+
+      for ( int k = 0; k < n; ++k )
+      {
+        m[r*n+k]   -= f * m[c*n+k];
+        inv[r*n+k] -= f * inv[c*n+k];
+      }
+    }
+  }
+
+  return true;
+
+} // invert_block()
+
+/*********************************************************************
+* This class solves block sparse systems A * x = b with symmetric
+* block Gauss-Seidel sweeps. The sweeps are inherently sequential,
+* only the inversion of the diagonal blocks runs in parallel.
+* The inverted diagonal blocks are computed in setup() and reused
+* by all following solves, until setup() is called again. Thus,
+* the same preconditioner can be applied to several right hand
+* sides or to (slightly) changed systems.
+*********************************************************************/
+class BlockGaussSeidel
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  BlockGaussSeidel(int n_sweeps=2)
+  : n_sweeps_ { n_sweeps }
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void n_sweeps(int n) { n_sweeps_ = n; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_sweeps() const { return n_sweeps_; }
+  int n_setups() const { return n_setups_; }
+
+  /*------------------------------------------------------------------
+  | Invert the diagonal blocks of A
+  ------------------------------------------------------------------*/
+  void setup(const SparseMatrix& A)
+  {
+    PROFILE_SCOPE( "BlockGaussSeidel::setup" );
+
+    const int bs = A.block_size();
+
+    block_size_ = bs;
+    inv_diag_.resize( A.n_rows() * bs * bs );
+    work_.resize( bs );
+
+    std::atomic<int> singular_row { -1 };
+
+    THREAD_POOL.parallel_for(0, A.n_rows(), [&](int i)
+    {
+      if ( !invert_block( A.diagonal(i), &inv_diag_[i*bs*bs], bs ) )
+        singular_row = i;
+    });
+
+    if ( singular_row >= 0 )
+    {
+      LOG(ERROR) << "BlockGaussSeidel: Singular diagonal block in row "
+                 << singular_row << ".";
+      TERMINATE();
+    }
+
+    ++n_setups_;
+
+  } // setup()
+
+  /*------------------------------------------------------------------
+  | Approximate the solution of A * x = b with n_sweeps_ 
+  | symmetric sweeps, starting from x = 0
+  ------------------------------------------------------------------*/
+  void solve(const SparseMatrix& A, const DVec& b, DVec& x)
+  {
+    PROFILE_SCOPE( "BlockGaussSeidel::solve" );
+
+    ASSERT( static_cast<int>(inv_diag_.size()) 
+         == A.n_rows() * A.block_size() * A.block_size(),
+      "BlockGaussSeidel: Preconditioner has not been set up.");
+
+    for ( double& xi : x )
+      xi = 0.0;
+
+    for ( int sweep = 0; sweep < n_sweeps_; ++sweep )
+    {
+      for ( int i = 0; i < A.n_rows(); ++i )
+        relax( A, b, x, i );
+
+      for ( int i = A.n_rows()-1; i >= 0; --i )
+        relax( A, b, x, i );
+    }
+
+  } // solve()
+
+private:
+  /*------------------------------------------------------------------
+  | Update the unknowns of row i
+  ------------------------------------------------------------------*/
+  void relax(const SparseMatrix& A, const DVec& b, DVec& x, int i)
+  {
+    const int   bs      = block_size_;
+    const IVec& offsets = A.offsets();
+    const IVec& columns = A.columns();
+
+    for ( int r = 0; r < bs; ++r )
+      work_[r] = b[i*bs+r];
+
+    // Skip the diagonal block, which is stored first
+    for ( int pos = offsets[i]+1; pos < offsets[i+1]; ++pos )
+    {
+      const double* a  = A.block( pos );
+      const double* xj = &x[ columns[pos] * bs ];
+
+      for ( int r = 0; r < bs; ++r )
+        for ( int c = 0; c < bs; ++c )
+          work_[r] -= a[r*bs+c] * xj[c];
+    }
+
+    const double* d = &inv_diag_[i*bs*bs];
+
+    for ( int r = 0; r < bs; ++r )
+    {
+      double sum = 0.0;
+      for ( int c = 0; c < bs; ++c )
+        sum += d[r*bs+c] * work_[c];
+      x[i*bs+r] = sum;
+    }
+
+  } // relax()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int  n_sweeps_;
+  int  n_setups_   { 0 };
+  int  block_size_ { 1 };
+
+  DVec inv_diag_;
+  DVec work_;
+
+}; // BlockGaussSeidel
+
+/*********************************************************************
+* This class solves general systems A * x = b with the restarted
+* GMRES method and right preconditioning. The operator A and the 
+* preconditioner M are passed as callables 
+*
+*   A(const DVec& v, DVec& Av)   and   M(const DVec& v, DVec& Mv)
+*
+* such that the system matrix never needs to be stored explicitly
+* (e.g. for Jacobian-free methods). The Krylov basis is allocated 
+* once and reused for all solves.
+*********************************************************************/
+class GMRES
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  GMRES(int n, int restart=30, double tolerance=1.0E-2, 
+        int max_iter=100)
+  : n_         { n         }
+  , restart_   { restart   }
+  , tolerance_ { tolerance }
+  , max_iter_  { max_iter  }
+  , basis_     ( restart+1, DVec(n) )
+  , z_         ( n         )
+  , w_         ( n         )
+  , H_         ( (restart+1) * restart )
+  , cs_        ( restart   )
+  , sn_        ( restart   )
+  , g_         ( restart+1 )
+  , y_         ( restart   )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void tolerance(double t) { tolerance_ = t; }
+  void max_iter(int n) { max_iter_ = n; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  double tolerance() const { return tolerance_; }
+  int max_iter() const { return max_iter_; }
+  int restart() const { return restart_; }
+  int iterations() const { return iterations_; }
+  double residual_norm() const { return residual_norm_; }
+
+  /*------------------------------------------------------------------
+  | Solve A * x = b up to a relative residual of tolerance_, 
+  | starting from the initial guess x. Returns true on convergence.
+  ------------------------------------------------------------------*/
+  template <typename Operator, typename Preconditioner>
+  bool solve(Operator&& A, Preconditioner&& M, const DVec& b, DVec& x)
+  {
+    PROFILE_SCOPE( "GMRES::solve" );
+
+    const double b_norm = MAX( std::sqrt( dot_product(b, b) ),
+                               INCOMFLOW_SMALL );
+    iterations_ = 0;
+
+    while ( true )
+    {
+      // r = b - A * x
+      A( x, w_ );
+
+      DVec& v0 = basis_[0];
+      THREAD_POOL.parallel_for(0, n_, [&](int i)
+      { v0[i] = b[i] - w_[i]; });
+
+      const double beta = std::sqrt( dot_product(v0, v0) );
+      residual_norm_ = beta / b_norm;
+
+      if ( residual_norm_ <= tolerance_ || iterations_ >= max_iter_ )
+        break;
+
+      THREAD_POOL.parallel_for(0, n_, [&](int i)
+      { v0[i] /= beta; });
+
+      for ( double& g : g_ )
+        g = 0.0;
+      g_[0] = beta;
+
+      int m = 0;
+
+      for ( ; m < restart_ && iterations_ < max_iter_; ++m )
+      {
+        arnoldi_step( A, M, m );
+        ++iterations_;
+
+        residual_norm_ = std::fabs( g_[m+1] ) / b_norm;
+
+        if ( residual_norm_ <= tolerance_ )
+        {
+          ++m;
+          break;
+        }
+      }
+
+      update_solution( M, m, x );
+
+      if ( residual_norm_ <= tolerance_ )
+        break;
+    }
+
+    return ( residual_norm_ <= tolerance_ );
+
+  } // solve()
+
+private:
+  /*------------------------------------------------------------------
+  | Extend the Krylov basis by the vector A * M^-1 * v_m and
+  | update the QR factorization of the Hessenberg matrix
+  ------------------------------------------------------------------*/
+  template <typename Operator, typename Preconditioner>
+  void arnoldi_step(Operator& A, Preconditioner& M, int m)
+  {
+    M( basis_[m], z_ );
+    A( z_, w_ );
+
+    // Modified Gram-Schmidt orthogonalization
+    for ( int k = 0; k <= m; ++k )
+    {
+      const double h = dot_product( w_, basis_[k] );
+      const DVec&  vk = basis_[k];
+      H(k,m) = h;
+
+      THREAD_POOL.parallel_for(0, n_, [&](int i)
+      { w_[i] -= h * vk[i]; });
+    }
+
+    const double h_next = std::sqrt( dot_product(w_, w_) );
+    H(m+1,m) = h_next;
+
+    DVec&        v_next = basis_[m+1];
+    const double scale  = 1.0 / MAX( h_next, INCOMFLOW_SMALL );
+
+    THREAD_POOL.parallel_for(0, n_, [&](int i)
+    { v_next[i] = w_[i] * scale; });
+
+    // Apply the previous Givens rotations to the new column
+    for ( int k = 0; k < m; ++k )
+    {
+      const double t = cs_[k] * H(k,m) + sn_[k] * H(k+1,m);
+      H(k+1,m) = -sn_[k] * H(k,m) + cs_[k] * H(k+1,m);
+      H(k,m)   = t;
+    }
+
+    // Compute the new rotation, which eliminates H(m+1,m)
+    const double r = std::sqrt( H(m,m)*H(m,m) + H(m+1,m)*H(m+1,m) );
+    cs_[m] = H(m,m) / MAX( r, INCOMFLOW_SMALL );
+    sn_[m] = H(m+1,m) / MAX( r, INCOMFLOW_SMALL );
+
+    H(m,m)   = r;
+    H(m+1,m) = 0.0;
+
+    g_[m+1] = -sn_[m] * g_[m];
+    g_[m]   =  cs_[m] * g_[m];
+
+  } // arnoldi_step()
+
+  /*------------------------------------------------------------------
+  | Solve the triangular least squares problem of size m and 
+  | update the solution x += M^-1 * V * y
+  ------------------------------------------------------------------*/
+  template <typename Preconditioner>
+  void update_solution(Preconditioner& M, int m, DVec& x)
+  {
+    for ( int k = m-1; k >= 0; --k )
+    {
+      double sum = g_[k];
+      for ( int l = k+1; l < m; ++l )
+        sum -= H(k,l) * y_[l];
+      y_[k] = sum / H(k,k);
+    }
+
+    THREAD_POOL.parallel_for(0, n_, [&](int i)
+    {
+      double sum = 0.0;
+      for ( int k = 0; k < m; ++k )
+        sum += y_[k] * basis_[k][i];
+      w_[i] = sum;
+    });
+
+    M( w_, z_ );
+
+    THREAD_POOL.parallel_for(0, n_, [&](int i)
+    { x[i] += z_[i]; });
+
+  } // update_solution()
+
+  /*------------------------------------------------------------------
+  | Access to the Hessenberg matrix
+  ------------------------------------------------------------------*/
+  double& H(int r, int c) { return H_[r * restart_ + c]; }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int               n_;
+  int               restart_;
+  double            tolerance_;
+  int               max_iter_;
+
+  int               iterations_    { 0 };
+  double            residual_norm_ { 0.0 };
+
+  std::vector<DVec> basis_;
+  DVec              z_;
+  DVec              w_;
+  DVec              H_;
+  DVec              cs_;
+  DVec              sn_;
+  DVec              g_;
+  DVec              y_;
+
+}; // GMRES
+
+} // namespace Solver
+} // namespace IncomFlow
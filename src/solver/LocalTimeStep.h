@@ -0,0 +1,248 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "PeriodicBoundaries.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class computes a pseudo time step for every dual element
+* that corresponds to a local CFL number:
+*
+*   dt_i = CFL * V_i / ( L_c,i + 4 * L_v,i )
+*
+* with the convective and viscous spectral radii
+*
+*   L_c,i = sum_f ( |u_f.n_f| + sqrt( (u_f.n_f)^2 + beta^2 |n_f|^2 ) )
+*   L_v,i = sum_f nu * |n_f|^2 / V_i
+*
+* which are summed over all faces of the dual element, including
+* its boundary faces. Thus, every element is advanced at its own
+* stable time step, instead of the step of the smallest element.
+*
+* With periodic_boundaries(), all copies of a periodic control
+* volume obtain the time step of the merged volume, i.e. the
+* volumes and spectral radii of the copies are summed, while their
+* periodic boundary faces are interior faces of the merged volume.
+* Together with the merged residual (see PeriodicBoundaries.h),
+* the copies thus remain identical.
+*********************************************************************/
+class LocalTimeStep
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  LocalTimeStep(const DualGrid& dgrid, double cfl=1.0)
+  : dgrid_          { dgrid               }
+  , cfl_            { cfl                 }
+  , time_steps_     ( dgrid.n_elements()  )
+  , spectral_radii_ ( dgrid.n_elements()  )
+  , visc_radii_     ( dgrid.n_elements()  )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void cfl(double c) { cfl_ = c; }
+
+  void periodic_boundaries(const PeriodicBoundaries& periodic)
+  { periodic_ = &periodic; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  double cfl() const { return cfl_; }
+
+  const DVec& time_steps() const { return time_steps_; }
+  const DVec& spectral_radii() const { return spectral_radii_; }
+
+  /*------------------------------------------------------------------
+  | Compute the local time steps for the solution U
+  ------------------------------------------------------------------*/
+  const DVec& compute(const DMat& U)
+  {
+    PROFILE_SCOPE( "LocalTimeStep::compute" );
+
+    const int n_elements = dgrid_.n_elements();
+
+    const DMat& normals  = dgrid_.face_normals();
+    const DVec& volumes  = dgrid_.volumes();
+    const IVec& offsets  = dgrid_.adj_offsets();
+    const IVec& adj      = dgrid_.adj_elements();
+    const IVec& faces    = dgrid_.adj_faces();
+
+    const double beta2   = CONSTANTS.art_compressibility();
+    const double nu      = CONSTANTS.viscosity();
+
+    // The face radius does not depend on the orientation of the 
+    // face normal, hence every element gathers the radii of its 
+    // faces without write conflicts
+    THREAD_POOL.parallel_for_range(0, n_elements, [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        double lc = 0.0;
+        double lv = 0.0;
+
+        for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+        {
+          const int j      = adj[a];
+          const int i_face = faces[a];
+
+          const double nx = normals[i_face][0];
+          const double ny = normals[i_face][1];
+
+          const double u  = 0.5 * ( U[i][IU] + U[j][IU] );
+          const double v  = 0.5 * ( U[i][IV] + U[j][IV] );
+
+          lc += face_radius( u, v, nx, ny, beta2 );
+          lv += nu * ( nx*nx + ny*ny );
+        }
+
+        spectral_radii_[i] = lc;
+        visc_radii_[i]     = lv;
+      }
+    });
+
+    // Corner elements belong to several boundaries, hence only 
+    // the elements of a single boundary are processed in parallel
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( periodic_ && bdry.type() == BdryType::PERIODIC )
+        continue;
+
+      const IVec& elements = bdry.dual_elements();
+      const DMat& bnormals = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+
+        const double nx = bnormals[i_elem][0];
+        const double ny = bnormals[i_elem][1];
+
+        spectral_radii_[i] += face_radius( U[i][IU], U[i][IV],
+                                           nx, ny, beta2 );
+      });
+    }
+
+    THREAD_POOL.parallel_for_range(0, n_elements, [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        const double radius = spectral_radii_[i]
+                            + 4.0 * visc_radii_[i] / volumes[i];
+
+        time_steps_[i] = cfl_ * volumes[i] / MAX( radius, INCOMFLOW_SMALL );
+      }
+    });
+
+    if ( periodic_ )
+      merge_periodic_copies();
+
+    return time_steps_;
+
+  } // compute()
+
+  /*------------------------------------------------------------------
+  | Return the smallest local time step, which is the largest
+  | stable global time step
+  ------------------------------------------------------------------*/
+  double min_time_step() const
+  {
+    double dt_min = INCOMFLOW_MAX;
+
+    for ( double dt : time_steps_ )
+      dt_min = MIN( dt_min, dt );
+
+    return dt_min;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Assign the spectral radii and the time step of the merged
+  | control volume to all of its periodic copies
+  ------------------------------------------------------------------*/
+  void merge_periodic_copies()
+  {
+    const DVec& volumes  = dgrid_.volumes();
+    const IVec& offsets  = periodic_->group_offsets();
+    const IVec& elements = periodic_->group_elements();
+
+    THREAD_POOL.parallel_for(0, periodic_->n_groups(), [&](int g)
+    {
+      double vol = 0.0;
+      double lc  = 0.0;
+      double lv  = 0.0;
+
+      for ( int p = offsets[g]; p < offsets[g+1]; ++p )
+      {
+        const int e = elements[p];
+        vol += volumes[e];
+        lc  += spectral_radii_[e];
+        lv  += visc_radii_[e];
+      }
+
+      const double radius = lc + 4.0 * lv / vol;
+      const double dt     = cfl_ * vol / MAX( radius, INCOMFLOW_SMALL );
+
+      for ( int p = offsets[g]; p < offsets[g+1]; ++p )
+      {
+        const int e = elements[p];
+        spectral_radii_[e] = lc;
+        visc_radii_[e]     = lv;
+        time_steps_[e]     = dt;
+      }
+    });
+
+  } // merge_periodic_copies()
+
+  /*------------------------------------------------------------------
+  | Convective spectral radius of a single face
+  ------------------------------------------------------------------*/
+  static inline double face_radius(double u, double v,
+                                   double nx, double ny,
+                                   double beta2)
+  {
+    const double un = u * nx + v * ny;
+    return std::fabs( un ) + std::sqrt( un*un + beta2 * (nx*nx+ny*ny) );
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid& dgrid_;
+  double          cfl_;
+
+  const PeriodicBoundaries* periodic_ { nullptr };
+
+  DVec            time_steps_;
+  DVec            spectral_radii_;
+  DVec            visc_radii_;
+
+}; // LocalTimeStep
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,334 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+#include "EdgeResidual.h"
+#include "FluxJacobian.h"
+#include "LocalTimeStep.h"
+#include "SparseMatrix.h"
+#include "LinearSolver.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class drives the steady residual R(U) = 0 to convergence
+* with a Jacobian-free Newton-Krylov (JFNK) method and
+* pseudo-transient continuation. Every Newton step solves
+*
+*   ( V/dtau + dR/dU ) * dU = -R(U)
+*
+* with GMRES, where the Jacobian-vector products are approximated
+* by finite differences of the edge-based residual:
+*
+*   dR/dU * v ~ ( R(U + eps*v) - R(U) ) / eps
+*
+* Thus, the Jacobian of the residual is never stored. Only the
+* first-order Jacobian (see FluxJacobian.h) is assembled as
+* preconditioner, which is applied with block Gauss-Seidel sweeps.
+* The pseudo CFL number grows with the residual reduction
+* (switched evolution relaxation), such that the scheme
+* approaches Newton's method near the steady state.
+* The residual is configured via residual(), e.g. with boundary
+* conditions or a second-order reconstruction. The residual norm of
+* every Newton iteration is passed to the reconstruction, such that
+* its limiters are frozen after Reconstruction::freeze_after().
+*********************************************************************/
+class NewtonKrylov
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  NewtonKrylov(const DualGrid& dgrid, double cfl=10.0)
+  : dgrid_          { dgrid                             }
+  , n_unknowns_     { dgrid.n_elements() * N_FLOW_VARS  }
+  , residual_       { dgrid                             }
+  , jacobian_       { dgrid                             }
+  , pseudo_dt_      { dgrid, cfl                        }
+  , precond_matrix_ { dgrid, N_FLOW_VARS                }
+  , gmres_          { n_unknowns_                       }
+  , cfl_init_       { cfl                               }
+  , R_              ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , R_eps_          ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , U_eps_          ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL )
+  , diag_           ( dgrid.n_elements()                )
+  , rhs_            ( n_unknowns_                       )
+  , dU_             ( n_unknowns_                       )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void max_cfl(double c) { max_cfl_ = c; }
+  void linear_tolerance(double t) { gmres_.tolerance( t ); }
+  void max_linear_iter(int n) { gmres_.max_iter( n ); }
+  void n_sweeps(int n) { preconditioner_.n_sweeps( n ); }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  EdgeResidual& residual() { return residual_; }
+  const EdgeResidual& residual() const { return residual_; }
+
+  double cfl() const { return pseudo_dt_.cfl(); }
+  double max_cfl() const { return max_cfl_; }
+
+  int n_newton_iterations() const { return n_newton_iter_; }
+  int n_linear_iterations() const { return n_linear_iter_; }
+  int n_residual_evaluations() const { return n_res_evals_; }
+
+  const DVec& residual_history() const { return res_history_; }
+
+  /*------------------------------------------------------------------
+  | Iterate until the residual norm is reduced by the factor tol
+  | or until max_iter Newton steps have been performed.
+  | Returns true on convergence.
+  ------------------------------------------------------------------*/
+  bool solve(DMat& U, double tol=1.0E-8, int max_iter=50)
+  {
+    PROFILE_SCOPE( "NewtonKrylov::solve" );
+
+    ASSERT( U.rows() == dgrid_.n_elements() && U.columns() == N_FLOW_VARS,
+      "NewtonKrylov: Invalid size of solution matrix.");
+
+    pseudo_dt_.cfl( cfl_init_ );
+    res_history_.clear();
+
+    double res = evaluate_residual( U );
+    const double res_0 = MAX( res, INCOMFLOW_SMALL );
+
+    res_history_.push_back( res );
+    monitor_residual( res );
+
+    for ( int iter = 0; iter < max_iter; ++iter )
+    {
+      if ( res <= tol * res_0 )
+        return true;
+
+      newton_step( U );
+
+      res = evaluate_residual( U );
+      res_history_.push_back( res );
+      monitor_residual( res );
+
+      // Switched evolution relaxation of the pseudo CFL number
+      pseudo_dt_.cfl( MIN( max_cfl_, cfl_init_ * res_0
+                                   / MAX( res, INCOMFLOW_SMALL ) ) );
+
+      DEBUG_LOG( "NewtonKrylov: iteration " << n_newton_iter_
+        << ", residual " << res / res_0
+        << ", GMRES iterations " << gmres_.iterations()
+        << ", CFL " << pseudo_dt_.cfl() );
+    }
+
+    return ( res <= tol * res_0 );
+
+  } // solve()
+
+private:
+  /*------------------------------------------------------------------
+  | Evaluate R(U), store -R(U) as right hand side and return its
+  | L2-norm
+  ------------------------------------------------------------------*/
+  double evaluate_residual(const DMat& U)
+  {
+    PROFILE_SCOPE( "NewtonKrylov::evaluate_residual" );
+
+    residual_.compute( U, R_ );
+    ++n_res_evals_;
+
+    const double norm
+      = THREAD_POOL.parallel_reduce(0, dgrid_.n_elements(), 0.0,
+      [&](int i0, int i1)
+      {
+        double sum = 0.0;
+
+        for ( int i = i0; i < i1; ++i )
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+          {
+            rhs_[i*N_FLOW_VARS+k] = -R_[i][k];
+            sum += R_[i][k] * R_[i][k];
+          }
+
+        return sum;
+      },
+      [](double x, double y) { return x + y; });
+
+    return std::sqrt( norm );
+
+  } // evaluate_residual()
+
+  /*------------------------------------------------------------------
+  | Pass the residual norm to the limiters of a second-order
+  | reconstruction
+  ------------------------------------------------------------------*/
+  void monitor_residual(double res)
+  {
+    if ( residual_.second_order() )
+      residual_.reconstruction().monitor_residual( res );
+  }
+
+  /*------------------------------------------------------------------
+  | Perform a single Newton step for the current residual R_
+  ------------------------------------------------------------------*/
+  void newton_step(DMat& U)
+  {
+    PROFILE_SCOPE( "NewtonKrylov::newton_step" );
+
+    const DVec& volumes = dgrid_.volumes();
+    const DVec& dtau    = pseudo_dt_.compute( U );
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        diag_[i] = volumes[i] / dtau[i];
+    });
+
+    // First-order preconditioner
+    // Walls impose the no-slip condition through their shear flux,
+    // if boundary conditions are attached to the residual
+    jacobian_.wall_shear( residual_.boundary_conditions() != nullptr );
+    jacobian_.assemble( U, diag_, precond_matrix_ );
+    preconditioner_.setup( precond_matrix_ );
+
+    const double u_norm = std::sqrt(
+      THREAD_POOL.parallel_reduce(0, dgrid_.n_elements(), 0.0,
+      [&](int i0, int i1)
+      {
+        double sum = 0.0;
+
+        for ( int i = i0; i < i1; ++i )
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+            sum += U[i][k] * U[i][k];
+
+        return sum;
+      },
+      [](double x, double y) { return x + y; }) );
+
+    auto jacobian_vector = [&](const DVec& v, DVec& Jv)
+    {
+      jacobian_vector_product( U, u_norm, v, Jv );
+    };
+
+    auto precondition = [&](const DVec& v, DVec& Mv)
+    {
+      preconditioner_.solve( precond_matrix_, v, Mv );
+    };
+
+    THREAD_POOL.parallel_for_range(0, n_unknowns_, [&](int i0, int i1)
+    {
+      std::fill( dU_.begin() + i0, dU_.begin() + i1, 0.0 );
+    });
+
+    gmres_.solve( jacobian_vector, precondition, rhs_, dU_ );
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          U[i][k] += dU_[i*N_FLOW_VARS+k];
+    });
+
+    n_linear_iter_ += gmres_.iterations();
+    ++n_newton_iter_;
+
+  } // newton_step()
+
+  /*------------------------------------------------------------------
+  | Finite difference approximation of ( V/dtau + dR/dU ) * v
+  ------------------------------------------------------------------*/
+  void jacobian_vector_product(const DMat& U, double u_norm,
+                               const DVec& v, DVec& Jv)
+  {
+    const double v_norm = std::sqrt( dot_product(v, v) );
+
+    if ( v_norm < INCOMFLOW_SMALL )
+    {
+      std::fill( Jv.begin(), Jv.end(), 0.0 );
+      return;
+    }
+
+    const double eps
+      = std::sqrt( std::numeric_limits<double>::epsilon() )
+      * ( 1.0 + u_norm ) / v_norm;
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          U_eps_[i][k] = U[i][k] + eps * v[i*N_FLOW_VARS+k];
+    });
+
+    residual_.compute( U_eps_, R_eps_ );
+    ++n_res_evals_;
+
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+        {
+          const int ik = i * N_FLOW_VARS + k;
+          Jv[ik] = ( R_eps_[i][k] - R_[i][k] ) / eps + diag_[i] * v[ik];
+        }
+    });
+
+  } // jacobian_vector_product()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&  dgrid_;
+  int              n_unknowns_;
+
+  EdgeResidual     residual_;
+  FluxJacobian     jacobian_;
+  LocalTimeStep    pseudo_dt_;
+  SparseMatrix     precond_matrix_;
+  BlockGaussSeidel preconditioner_ { 1 };
+  GMRES            gmres_;
+
+  double           cfl_init_;
+  double           max_cfl_        { 1.0E+6 };
+
+  DMat             R_;
+  DMat             R_eps_;
+  DMat             U_eps_;
+  DVec             diag_;
+  DVec             rhs_;
+  DVec             dU_;
+  DVec             res_history_;
+
+  int              n_newton_iter_  { 0 };
+  int              n_linear_iter_  { 0 };
+  int              n_res_evals_    { 0 };
+
+}; // NewtonKrylov
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,425 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <queue>
+#include <limits>
+
+#include "Log.h"
+#include "Timer.h"
+#include "Vec2.h"
+#include "QuadTree.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Transformation of a periodic boundary onto its partner: a rotation
+* by angle around center, followed by a translation
+*********************************************************************/
+struct PeriodicTransform
+{
+  Vec2d  translation { 0.0, 0.0 };
+  double angle       { 0.0 };
+  Vec2d  center      { 0.0, 0.0 };
+
+  Vec2d apply(const Vec2d& p) const
+  {
+    const double c = std::cos( angle );
+    const double s = std::sin( angle );
+    const Vec2d  d = p - center;
+
+    return Vec2d { center.x + c * d.x - s * d.y + translation.x,
+                   center.y + s * d.x + c * d.y + translation.y };
+  }
+};
+
+/*********************************************************************
+* This class couples pairs of periodic boundaries of a dual grid.
+*
+* The dual elements of the first boundary of a pair are transformed
+* onto the second boundary and matched with its elements through a
+* QuadTree once at setup. Matched elements, including the corners
+* of doubly periodic grids, form groups of copies of a single
+* control volume. The groups are stored in CSR format together with
+* the rotation of every copy into the frame of its group.
+*
+* merge() combines the residuals of every group, such that all
+* copies obtain the same update:
+*
+*   R_e = V_e / V_g * R(-phi_e) * sum_{c in g} R(phi_c) * R_c
+*
+* with the group volume V_g and the rotations R(phi) of the
+* velocity components. The boundary fluxes of the periodic faces
+* cancel in the sum, as long as the copies share the same state.
+* This holds for global time steps; synchronize() restores the
+* states otherwise, e.g. after the initialization.
+*********************************************************************/
+class PeriodicBoundaries
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  PeriodicBoundaries(const DualGrid& dgrid)
+  : dgrid_ { dgrid }
+  {}
+
+  /*------------------------------------------------------------------
+  | Pair the boundaries with the markers marker_a and marker_b, such
+  | that transform maps the vertices of marker_a onto those of
+  | marker_b. Vertices are matched within a distance of tolerance
+  | times the size of the boundary.
+  ------------------------------------------------------------------*/
+  void add_pair(int marker_a, int marker_b,
+                const PeriodicTransform& transform,
+                double tolerance=1.0E-8)
+  {
+    Timer timer {};
+    timer.count();
+
+    const Boundary& bdry_a = find_boundary( marker_a );
+    const Boundary& bdry_b = find_boundary( marker_b );
+
+    if ( bdry_a.n_dual_elements() != bdry_b.n_dual_elements() )
+    {
+      LOG(ERROR) << "PeriodicBoundaries: Boundaries " << marker_a
+                 << " and " << marker_b << " differ in size.";
+      TERMINATE();
+    }
+
+    const DMat& xy = dgrid_.coords();
+
+    // Insert the elements of the second boundary into a quad tree
+    const int n = bdry_b.n_dual_elements();
+
+    std::vector<Item> items;
+    items.reserve( n );
+
+    Vec2d lowleft  {  std::numeric_limits<double>::max(),
+                      std::numeric_limits<double>::max() };
+    Vec2d upright  { -std::numeric_limits<double>::max(),
+                     -std::numeric_limits<double>::max() };
+
+    for ( int e : bdry_b.dual_elements() )
+    {
+      items.push_back( { Vec2d { xy[e][0], xy[e][1] }, e } );
+
+      lowleft.x = MIN( lowleft.x, xy[e][0] );
+      lowleft.y = MIN( lowleft.y, xy[e][1] );
+      upright.x = MAX( upright.x, xy[e][0] );
+      upright.y = MAX( upright.y, xy[e][1] );
+    }
+
+    const double size   = MAX( upright.x - lowleft.x,
+                               upright.y - lowleft.y );
+    const double radius = MAX( tolerance * size, INCOMFLOW_SMALL );
+
+    QuadTree<Item,double> qtree { 1.1 * size + 2.0 * radius, 20, 25,
+                                  0.5 * ( lowleft + upright ) };
+
+    for ( auto& item : items )
+      if ( !qtree.add( &item ) )
+      {
+        LOG(ERROR) << "PeriodicBoundaries: Failed to insert vertex ("
+                   << item.xy().x << ", " << item.xy().y
+                   << ") of boundary " << marker_b << ".";
+        TERMINATE();
+      }
+
+    // Match the transformed elements of the first boundary
+    for ( int e : bdry_a.dual_elements() )
+    {
+      const Vec2d p = transform.apply( Vec2d { xy[e][0], xy[e][1] } );
+
+      std::vector<Item*> found {};
+      qtree.get_items( p, radius, found );
+
+      Item*  match  = nullptr;
+      double d2_min = std::numeric_limits<double>::max();
+
+      for ( Item* item : found )
+      {
+        const double d2 = ( item->xy() - p ).length_squared();
+
+        if ( d2 < d2_min )
+        {
+          d2_min = d2;
+          match  = item;
+        }
+      }
+
+      if ( !match || match->index == e )
+      {
+        LOG(ERROR) << "PeriodicBoundaries: Vertex (" << xy[e][0]
+                   << ", " << xy[e][1] << ") of boundary " << marker_a
+                   << " has no partner on boundary " << marker_b << ".";
+        TERMINATE();
+      }
+
+      pairs_.push_back( { e, match->index, transform.angle } );
+    }
+
+    build_groups();
+
+    timer.count();
+    setup_time_ += timer.delta(0);
+
+    LOG(INFO) << "PeriodicBoundaries: Paired " << n << " vertices of "
+              << "boundaries " << marker_a << " and " << marker_b
+              << ", time " << timer.delta(0) << "s";
+
+  } // add_pair()
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_pairs() const { return static_cast<int>( pairs_.size() ); }
+  int n_groups() const { return static_cast<int>( group_offsets_.size() ) - 1; }
+  double setup_time() const { return setup_time_; }
+
+  const IVec& group_offsets() const { return group_offsets_; }
+  const IVec& group_elements() const { return group_elements_; }
+
+  // Rotation of the velocity of every group element into the
+  // frame of its group
+  const DVec& group_angles() const { return group_angles_; }
+
+  /*------------------------------------------------------------------
+  | Combine the residuals of all copies of a control volume
+  ------------------------------------------------------------------*/
+  void merge(DMat& R) const
+  {
+    const DVec& volumes = dgrid_.volumes();
+
+    THREAD_POOL.parallel_for(0, n_groups(), [&](int g)
+    {
+      double sum[N_FLOW_VARS] = { 0.0 };
+      double vol = 0.0;
+
+      for ( int p = group_offsets_[g]; p < group_offsets_[g+1]; ++p )
+      {
+        const int e = group_elements_[p];
+        add_rotated( R[e], group_cos_[p], group_sin_[p], sum );
+        vol += volumes[e];
+      }
+
+      for ( int p = group_offsets_[g]; p < group_offsets_[g+1]; ++p )
+      {
+        const int    e     = group_elements_[p];
+        const double scale = volumes[e] / vol;
+
+        set_rotated( sum, group_cos_[p], -group_sin_[p], scale, R[e] );
+      }
+    });
+
+  } // merge()
+
+  /*------------------------------------------------------------------
+  | Replace the states of all copies of a control volume by their
+  | volume-weighted average
+  ------------------------------------------------------------------*/
+  void synchronize(DMat& U) const
+  {
+    const DVec& volumes = dgrid_.volumes();
+
+    THREAD_POOL.parallel_for(0, n_groups(), [&](int g)
+    {
+      double avg[N_FLOW_VARS] = { 0.0 };
+      double vol = 0.0;
+
+      for ( int p = group_offsets_[g]; p < group_offsets_[g+1]; ++p )
+      {
+        const int e = group_elements_[p];
+
+        double u[N_FLOW_VARS] = { 0.0 };
+        add_rotated( U[e], group_cos_[p], group_sin_[p], u );
+
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          avg[k] += volumes[e] * u[k];
+
+        vol += volumes[e];
+      }
+
+      for ( int p = group_offsets_[g]; p < group_offsets_[g+1]; ++p )
+      {
+        const int e = group_elements_[p];
+        set_rotated( avg, group_cos_[p], -group_sin_[p], 1.0 / vol, U[e] );
+      }
+    });
+
+  } // synchronize()
+
+private:
+  /*------------------------------------------------------------------
+  | Quad tree item of a boundary element
+  ------------------------------------------------------------------*/
+  struct Item
+  {
+    Vec2d xy_;
+    int   index;
+
+    const Vec2d& xy() const { return xy_; }
+  };
+
+  /*------------------------------------------------------------------
+  | Matched elements: The velocity of a rotated by angle equals the
+  | velocity of b
+  ------------------------------------------------------------------*/
+  struct Pair
+  {
+    int    a;
+    int    b;
+    double angle;
+  };
+
+  /*------------------------------------------------------------------
+  | Add the state u, whose velocity is rotated by (c,s), to sum
+  ------------------------------------------------------------------*/
+  static void add_rotated(const double* u, double c, double s,
+                          double* sum)
+  {
+    sum[IP] += u[IP];
+    sum[IU] += c * u[IU] - s * u[IV];
+    sum[IV] += s * u[IU] + c * u[IV];
+  }
+
+  /*------------------------------------------------------------------
+  | Set u to the scaled state v, whose velocity is rotated by (c,s)
+  ------------------------------------------------------------------*/
+  static void set_rotated(const double* v, double c, double s,
+                          double scale, double* u)
+  {
+    u[IP] = scale * v[IP];
+    u[IU] = scale * ( c * v[IU] - s * v[IV] );
+    u[IV] = scale * ( s * v[IU] + c * v[IV] );
+  }
+
+  /*------------------------------------------------------------------
+  | Get a boundary of the dual grid by its marker
+  ------------------------------------------------------------------*/
+  const Boundary& find_boundary(int marker) const
+  {
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( bdry.marker() != marker )
+        continue;
+
+      if ( bdry.type() != BdryType::PERIODIC )
+      {
+        LOG(ERROR) << "PeriodicBoundaries: Boundary " << marker
+                   << " is not periodic.";
+        TERMINATE();
+      }
+
+      return bdry;
+    }
+
+    LOG(ERROR) << "PeriodicBoundaries: Boundary " << marker
+               << " is not defined.";
+    TERMINATE();
+
+    return *dgrid_.boundaries().begin();
+
+  } // find_boundary()
+
+  /*------------------------------------------------------------------
+  | Group all elements, which are connected by pairs, and compute
+  | the rotation of every element into the frame of the first
+  | element of its group, where the velocity v_e of an element
+  | corresponds to R(phi_e) * v_e in the group frame
+  ------------------------------------------------------------------*/
+  void build_groups()
+  {
+    const int n_elements = dgrid_.n_elements();
+
+    std::vector<std::vector<std::pair<int,double>>> links ( n_elements );
+
+    for ( const auto& pair : pairs_ )
+    {
+      links[pair.a].push_back( { pair.b, -pair.angle } );
+      links[pair.b].push_back( { pair.a,  pair.angle } );
+    }
+
+    std::vector<bool> visited ( n_elements, false );
+
+    group_offsets_  = { 0 };
+    group_elements_.clear();
+    group_angles_.clear();
+
+    for ( int root = 0; root < n_elements; ++root )
+    {
+      if ( visited[root] || links[root].empty() )
+        continue;
+
+      std::queue<std::pair<int,double>> front {};
+      front.push( { root, 0.0 } );
+      visited[root] = true;
+
+      while ( !front.empty() )
+      {
+        const int    e   = front.front().first;
+        const double phi = front.front().second;
+        front.pop();
+
+        group_elements_.push_back( e );
+        group_angles_.push_back( phi );
+
+        for ( const auto& link : links[e] )
+        {
+          if ( visited[link.first] )
+            continue;
+
+          visited[link.first] = true;
+          front.push( { link.first, phi + link.second } );
+        }
+      }
+
+      group_offsets_.push_back( static_cast<int>( group_elements_.size() ) );
+    }
+
+    group_cos_.resize( group_angles_.size() );
+    group_sin_.resize( group_angles_.size() );
+
+    for ( size_t p = 0; p < group_angles_.size(); ++p )
+    {
+      group_cos_[p] = std::cos( group_angles_[p] );
+      group_sin_[p] = std::sin( group_angles_[p] );
+    }
+
+  } // build_groups()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&   dgrid_;
+
+  std::vector<Pair> pairs_;
+
+  IVec              group_offsets_ { 0 };
+  IVec              group_elements_;
+  DVec              group_angles_;
+  DVec              group_cos_;
+  DVec              group_sin_;
+
+  double            setup_time_ { 0.0 };
+
+}; // PeriodicBoundaries
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,482 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+
+#include "Vec2.h"
+#include "Geometry.h"
+#include "LinearQuadTree.h"
+#include "ThreadPool.h"
+#include "Log.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "PrimaryGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* The location of a point in the primary grid: the containing
+* element (quads first, followed by triangles) and the interpolation
+* weights of its vertices. Since the solution is stored at the
+* primary grid vertices, the weights interpolate it directly.
+*********************************************************************/
+struct PointLocation
+{
+  int                   element    { -1 };
+  int                   n_vertices { 0 };
+  std::array<int,4>     vertices   { { 0, 0, 0, 0 } };
+  std::array<double,4>  weights    { { 0.0, 0.0, 0.0, 0.0 } };
+
+  bool found() const { return element >= 0; }
+};
+
+/*********************************************************************
+* This class finds the elements of the primary grid, which contain
+* arbitrary query points, e.g. for probes or line samples.
+*
+* Search:
+* -------
+* The element centroids are stored in a LinearQuadTree. A query
+* tests the elements, whose centroids lie within the maximum
+* centroid-vertex distance of the point, with in_on_triangle() /
+* in_on_quad(). Since these predicates use an absolute tolerance,
+* the candidate is refined by a walk through the element neighbors,
+* which crosses every edge, that has the point strictly on its
+* right side. The walk also serves as fast path, if a nearby
+* element is known in advance.
+*
+* Batched queries:
+* ----------------
+* Batches of points are sorted along a Morton curve and split into
+* contiguous chunks, which are processed in parallel. Within a
+* chunk, every point starts its walk from the element of its
+* predecessor, such that most queries take only a few steps.
+*
+* Points outside of the grid yield an invalid location.
+*********************************************************************/
+class PointLocator
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  PointLocator(const PrimaryGrid& grid, size_t qtree_items=16)
+  : grid_  { grid }
+  , qtree_ { qtree_items }
+  {
+    const int n_quads = grid_.n_quads();
+    const int n_elems = n_quads + grid_.n_tris();
+
+    centroids_.resize( n_elems );
+
+    for ( int e = 0; e < n_elems; ++e )
+    {
+      Vec2d xy[4];
+      int   v[4];
+      const int n = element( e, v, xy );
+
+      Vec2d c { 0.0, 0.0 };
+      for ( int k = 0; k < n; ++k )
+        c += xy[k];
+      c *= 1.0 / n;
+
+      for ( int k = 0; k < n; ++k )
+        max_radius_ = MAX( max_radius_, ( xy[k] - c ).length() );
+
+      centroids_[e] = { c, e };
+    }
+
+    std::vector<Centroid*> items ( n_elems );
+
+    for ( int e = 0; e < n_elems; ++e )
+      items[e] = &centroids_[e];
+
+    qtree_.build( items );
+
+  } // PointLocator()
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  const PrimaryGrid& primary_grid() const { return grid_; }
+  int n_elements() const { return static_cast<int>( centroids_.size() ); }
+  double max_radius() const { return max_radius_; }
+
+  /*------------------------------------------------------------------
+  | Return the element, which contains the point p, or -1 if the
+  | point is outside of the grid. A hint is an element, from which
+  | the search starts, if it is not negative.
+  ------------------------------------------------------------------*/
+  int locate_element(const Vec2d& p, int hint=-1) const
+  {
+    if ( hint >= 0 )
+    {
+      const int e = walk( p, hint );
+      if ( e >= 0 )
+        return e;
+    }
+
+    // Candidate from the quad tree
+    int candidate = -1;
+
+    qtree_.get_items( p, max_radius_ * ( 1.0 + 1.0E-10 ),
+    [&](const Centroid* c)
+    {
+      if ( candidate < 0 && contains( c->index, p ) )
+        candidate = c->index;
+    });
+
+    if ( candidate < 0 )
+      return -1;
+
+    const int e = walk( p, candidate );
+
+    // Walks may end at concave boundaries
+    return ( e >= 0 ) ? e : candidate;
+
+  } // locate_element()
+
+  /*------------------------------------------------------------------
+  | Return the location of a point including its interpolation
+  | weights
+  ------------------------------------------------------------------*/
+  PointLocation locate(const Vec2d& p, int hint=-1) const
+  {
+    PointLocation loc {};
+    loc.element = locate_element( p, hint );
+
+    if ( loc.found() )
+      compute_weights( p, loc );
+
+    return loc;
+  }
+
+  /*------------------------------------------------------------------
+  | Locate a batch of points in parallel
+  ------------------------------------------------------------------*/
+  std::vector<PointLocation> locate(const std::vector<Vec2d>& points) const
+  {
+    const int n = static_cast<int>( points.size() );
+
+    std::vector<PointLocation> locations ( n );
+
+    if ( n == 0 )
+      return locations;
+
+    // Spatial order of the queries
+    std::vector<Query>  queries ( n );
+    std::vector<Query*> query_ptrs ( n );
+
+    for ( int i = 0; i < n; ++i )
+    {
+      queries[i]    = { points[i], i };
+      query_ptrs[i] = &queries[i];
+    }
+
+    LinearQuadTree<Query,double> order { 64 };
+    order.build( query_ptrs );
+
+    const std::vector<Query*>& sorted = order.items();
+
+    THREAD_POOL.parallel_for_range(0, n, [&](int i0, int i1)
+    {
+      int hint = -1;
+
+      for ( int i = i0; i < i1; ++i )
+      {
+        const Query* q = sorted[i];
+
+        PointLocation& loc = locations[q->index];
+        loc = locate( q->xy_, hint );
+
+        if ( loc.found() )
+          hint = loc.element;
+      }
+    });
+
+    return locations;
+
+  } // locate()
+
+  /*------------------------------------------------------------------
+  | Interpolate the vertex values U at a location
+  ------------------------------------------------------------------*/
+  static void interpolate(const DMat& U, const PointLocation& loc,
+                          double* values)
+  {
+    const int n_vars = static_cast<int>( U.columns() );
+
+    for ( int k = 0; k < n_vars; ++k )
+      values[k] = 0.0;
+
+    for ( int j = 0; j < loc.n_vertices; ++j )
+      for ( int k = 0; k < n_vars; ++k )
+        values[k] += loc.weights[j] * U[ loc.vertices[j] ][k];
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Items of the quad trees
+  ------------------------------------------------------------------*/
+  struct Centroid
+  {
+    Vec2d xy_;
+    int   index;
+
+    const Vec2d& xy() const { return xy_; }
+  };
+
+  using Query = Centroid;
+
+  /*------------------------------------------------------------------
+  | Vertices and coordinates of an element, returns the number of
+  | its vertices
+  ------------------------------------------------------------------*/
+  int element(int e, int* v, Vec2d* xy) const
+  {
+    const int  n_quads = grid_.n_quads();
+    const bool is_quad = ( e < n_quads );
+    const int  n       = is_quad ? 4 : 3;
+    const int* verts   = is_quad ? grid_.quads()[e]
+                                 : grid_.tris()[e-n_quads];
+
+    for ( int k = 0; k < n; ++k )
+    {
+      v[k]  = verts[k];
+      xy[k] = { grid_.vertex_coords()[v[k]][0],
+                grid_.vertex_coords()[v[k]][1] };
+    }
+
+    return n;
+  }
+
+  /*------------------------------------------------------------------
+  | Neighbor k of an element, which lies across its edge (k+1, k+2)
+  ------------------------------------------------------------------*/
+  int neighbor(int e, int k) const
+  {
+    const int n_quads = grid_.n_quads();
+    return ( e < n_quads ) ? grid_.quad_neighbors()[e][k]
+                           : grid_.tri_neighbors()[e-n_quads][k];
+  }
+
+  /*------------------------------------------------------------------
+  | Check if an element contains the point p
+  ------------------------------------------------------------------*/
+  bool contains(int e, const Vec2d& p) const
+  {
+    Vec2d xy[4];
+    int   v[4];
+
+    if ( element( e, v, xy ) == 4 )
+      return in_on_quad( p, xy[0], xy[1], xy[2], xy[3] );
+
+    return in_on_triangle( p, xy[0], xy[1], xy[2] );
+  }
+
+  /*------------------------------------------------------------------
+  | Walk from element e towards the point p. Every step crosses an
+  | edge, which has p strictly on its right side. The edges are
+  | tested with a rotating offset, which avoids cycles. Returns -1,
+  | if the walk leaves the grid.
+  ------------------------------------------------------------------*/
+  int walk(const Vec2d& p, int e) const
+  {
+    const int max_steps = n_elements();
+
+    for ( int step = 0; step < max_steps; ++step )
+    {
+      Vec2d xy[4];
+      int   v[4];
+      const int n = element( e, v, xy );
+
+      int next = e;
+
+      for ( int i = 0; i < n; ++i )
+      {
+        const int    j  = ( i + step ) % n;
+        const Vec2d& a  = xy[j];
+        const Vec2d  ab = xy[(j+1) % n] - a;
+        const Vec2d  ap = p - a;
+
+        const double cross = ab.x * ap.y - ab.y * ap.x;
+
+        if ( cross < -WALK_TOLERANCE * ab.length_squared() )
+        {
+          next = neighbor( e, ( j + n - 1 ) % n );
+          break;
+        }
+      }
+
+      if ( next == e )
+        return e;
+
+      if ( next < 0 )
+        return -1;
+
+      e = next;
+    }
+
+    return -1;
+
+  } // walk()
+
+  /*------------------------------------------------------------------
+  | Interpolation weights: barycentric coordinates for triangles
+  | and the inverse bilinear mapping for quads
+  ------------------------------------------------------------------*/
+  void compute_weights(const Vec2d& p, PointLocation& loc) const
+  {
+    Vec2d xy[4];
+    const int n = element( loc.element, loc.vertices.data(), xy );
+
+    loc.n_vertices = n;
+
+    auto cross = [](const Vec2d& a, const Vec2d& b)
+    { return a.x * b.y - a.y * b.x; };
+
+    if ( n == 3 )
+    {
+      const double area = cross( xy[1] - xy[0], xy[2] - xy[0] );
+
+      loc.weights[0] = cross( xy[1] - p, xy[2] - p ) / area;
+      loc.weights[1] = cross( xy[2] - p, xy[0] - p ) / area;
+      loc.weights[2] = 1.0 - loc.weights[0] - loc.weights[1];
+      loc.weights[3] = 0.0;
+      return;
+    }
+
+    // Newton iterations for x(s,t) = p, with (s,t) in [0,1]^2
+    double s = 0.5;
+    double t = 0.5;
+
+    for ( int iter = 0; iter < MAX_NEWTON_ITER; ++iter )
+    {
+      const Vec2d r = xy[0] * ((1.0-s)*(1.0-t)) + xy[1] * (s*(1.0-t))
+                    + xy[2] * (s*t)             + xy[3] * ((1.0-s)*t)
+                    - p;
+
+      const Vec2d d_s = ( xy[1] - xy[0] ) * (1.0-t) + ( xy[2] - xy[3] ) * t;
+      const Vec2d d_t = ( xy[3] - xy[0] ) * (1.0-s) + ( xy[2] - xy[1] ) * s;
+
+      const double det = cross( d_s, d_t );
+
+      if ( std::fabs( det ) < INCOMFLOW_SMALL )
+        break;
+
+      const double ds = cross( r, d_t ) / det;
+      const double dt = cross( d_s, r ) / det;
+
+      s -= ds;
+      t -= dt;
+
+      if ( ds*ds + dt*dt < NEWTON_TOLERANCE * NEWTON_TOLERANCE )
+        break;
+    }
+
+    s = MIN( 1.0, MAX( 0.0, s ) );
+    t = MIN( 1.0, MAX( 0.0, t ) );
+
+    loc.weights[0] = (1.0-s) * (1.0-t);
+    loc.weights[1] = s * (1.0-t);
+    loc.weights[2] = s * t;
+    loc.weights[3] = (1.0-s) * t;
+
+  } // compute_weights()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  static constexpr double WALK_TOLERANCE   = 1.0E-12;
+  static constexpr double NEWTON_TOLERANCE = 1.0E-13;
+  static constexpr int    MAX_NEWTON_ITER  = 20;
+
+  const PrimaryGrid&               grid_;
+  std::vector<Centroid>            centroids_;
+  LinearQuadTree<Centroid,double>  qtree_;
+  double                           max_radius_ { 0.0 };
+
+}; // PointLocator
+
+/*********************************************************************
+* A fixed set of probe points, whose locations and interpolation
+* weights are computed once, such that the sampling of a solution
+* only evaluates the cached weights.
+*
+* Usage:
+* ------
+*   PointLocator locator { primgrid };
+*   ProbeSet     probes  { locator, probe_points };
+*
+*   DMat values;
+*   probes.interpolate( U, values );
+*********************************************************************/
+class ProbeSet
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  ProbeSet(const PointLocator& locator, const std::vector<Vec2d>& points)
+  : points_    { points }
+  , locations_ { locator.locate( points ) }
+  {
+    for ( const auto& loc : locations_ )
+      n_outside_ += !loc.found();
+
+    if ( n_outside_ > 0 )
+      LOG(WARNING) << n_outside_ << " probes are located outside "
+                   << "of the grid.";
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int size() const { return static_cast<int>( points_.size() ); }
+  int n_outside() const { return n_outside_; }
+  const std::vector<Vec2d>& points() const { return points_; }
+  const std::vector<PointLocation>& locations() const
+  { return locations_; }
+
+  /*------------------------------------------------------------------
+  | Interpolate the vertex values U at all probes. Probes outside
+  | of the grid obtain zero values.
+  ------------------------------------------------------------------*/
+  void interpolate(const DMat& U, DMat& values) const
+  {
+    const int n_vars = static_cast<int>( U.columns() );
+
+    if ( static_cast<int>( values.rows() ) != size()
+      || static_cast<int>( values.columns() ) != n_vars )
+    {
+      DMat tmp ( size(), n_vars );
+      values.swap( tmp );
+    }
+
+    THREAD_POOL.parallel_for(0, size(), [&](int i)
+    {
+      PointLocator::interpolate( U, locations_[i], values[i] );
+    });
+  }
+
+private:
+  std::vector<Vec2d>          points_;
+  std::vector<PointLocation>  locations_;
+  int                         n_outside_ { 0 };
+
+}; // ProbeSet
+
+} // namespace Solver
+} // namespace IncomFlow
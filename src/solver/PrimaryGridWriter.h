@@ -0,0 +1,142 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class writes primary grids to the ASCII grid files, which are
+* read by PrimaryGridReader. The sections follow the order of the
+* test grid, since the reader scans the attributes sequentially.
+* Coordinates are written with full precision, such that a grid is
+* reproduced exactly after reading it again.
+*********************************************************************/
+class PrimaryGridWriter
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  PrimaryGridWriter() {}
+
+  /*------------------------------------------------------------------
+  | Write a grid to a file
+  ------------------------------------------------------------------*/
+  bool write(const PrimaryGrid& grid, const std::string& file_path)
+  {
+    std::ofstream file ( file_path, std::ios::trunc );
+
+    if ( file.fail() )
+    {
+      LOG(ERROR) << "Failed to open primary grid file:\n"
+                    "  \"" << file_path << "\"";
+      return false;
+    }
+
+    const DMat& xy = grid.vertex_coords();
+
+    file << "MESH 0\n";
+
+    file << "VERTICES " << grid.n_vertices() << "\n";
+    for ( int i = 0; i < grid.n_vertices(); ++i )
+      write_line( file, "%.17g,%.17g\n", xy[i][0], xy[i][1] );
+
+    const IMat& intr_edges = grid.intr_edges();
+    const IMat& intr_nbrs  = grid.intr_edge_neighbors();
+
+    file << "INTERIOREDGES " << grid.n_intr_edges() << "\n";
+    for ( int i = 0; i < grid.n_intr_edges(); ++i )
+      write_line( file, "%4d,%4d,%4d,%4d\n",
+                  intr_edges[i][0], intr_edges[i][1],
+                  intr_nbrs[i][0], intr_nbrs[i][1] );
+
+    const IMat& bdry_edges = grid.bdry_edges();
+    const IVec& bdry_nbrs  = grid.bdry_edge_neighbors();
+    const IVec& markers    = grid.bdry_edge_markers();
+
+    file << "BOUNDARYEDGES " << grid.n_bdry_edges() << "\n";
+    for ( int i = 0; i < grid.n_bdry_edges(); ++i )
+      write_line( file, "%4d,%4d,%4d,%4d\n",
+                  bdry_edges[i][0], bdry_edges[i][1],
+                  bdry_nbrs[i], markers[i] );
+
+    file << "INTERFACEEDGES 0\n";
+    file << "FRONT 0\n";
+
+    const IMat& quads = grid.quads();
+
+    file << "QUADS " << grid.n_quads() << "\n";
+    for ( int i = 0; i < grid.n_quads(); ++i )
+      write_line( file, "%4d,%4d,%4d,%4d,%4d\n",
+                  quads[i][0], quads[i][1], quads[i][2], quads[i][3], 0 );
+
+    const IMat& tris = grid.tris();
+
+    file << "TRIANGLES " << grid.n_tris() << "\n";
+    for ( int i = 0; i < grid.n_tris(); ++i )
+      write_line( file, "%4d,%4d,%4d,%4d,%4d\n",
+                  tris[i][0], tris[i][1], tris[i][2], 0, 1 );
+
+    const IMat& quad_nbrs = grid.quad_neighbors();
+
+    file << "QUADNEIGHBORS " << grid.n_quads() << "\n";
+    for ( int i = 0; i < grid.n_quads(); ++i )
+      write_line( file, "%4d,%4d,%4d,%4d\n",
+                  quad_nbrs[i][0], quad_nbrs[i][1],
+                  quad_nbrs[i][2], quad_nbrs[i][3] );
+
+    const IMat& tri_nbrs = grid.tri_neighbors();
+
+    file << "TRIANGLENEIGHBORS " << grid.n_tris() << "\n";
+    for ( int i = 0; i < grid.n_tris(); ++i )
+      write_line( file, "%4d,%4d,%4d\n",
+                  tri_nbrs[i][0], tri_nbrs[i][1], tri_nbrs[i][2] );
+
+    if ( file.fail() )
+    {
+      LOG(ERROR) << "Failed to write primary grid file:\n"
+                    "  \"" << file_path << "\"";
+      return false;
+    }
+
+    return true;
+
+  } // PrimaryGridWriter::write()
+
+private:
+  /*------------------------------------------------------------------
+  | Write a single formatted line without the overhead of the
+  | stream formatting
+  ------------------------------------------------------------------*/
+  template <typename... Args>
+  void write_line(std::ofstream& file, const char* format, Args... args)
+  {
+    char line[128];
+    const int n = std::snprintf( line, sizeof(line), format, args... );
+    file.write( line, n );
+  }
+
+}; // PrimaryGridWriter
+
+} // namespace Solver
+} // namespace IncomFlow
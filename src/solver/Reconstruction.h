@@ -0,0 +1,462 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "Log.h"
+#include "Timer.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Slope limiters of the reconstruction
+*********************************************************************/
+enum class LimiterType
+{
+  NONE,
+  BARTH_JESPERSEN,
+  VENKATAKRISHNAN,
+};
+
+/*********************************************************************
+* Barth-Jespersen limiter for the unlimited increment delta towards
+* a face and the admissible increment d_bound, which is the distance
+* to the neighbor maximum (delta > 0) or minimum (delta < 0).
+* Branch-free, such that element loops are vectorized.
+*********************************************************************/
+inline double barth_jespersen(double d_bound, double delta)
+{
+  const bool   active = ( std::fabs( delta ) > INCOMFLOW_SMALL );
+  const double ratio  = d_bound / ( active ? delta : 1.0 );
+
+  return active ? std::min( 1.0, ratio ) : 1.0;
+
+} // barth_jespersen()
+
+/*********************************************************************
+* Venkatakrishnan limiter with the smoothing parameter eps2, which
+* keeps the limiter active in smooth regions from clipping extrema.
+*********************************************************************/
+inline double venkatakrishnan(double d_bound, double delta, double eps2)
+{
+  const bool   active = ( std::fabs( delta ) > INCOMFLOW_SMALL );
+
+  const double dp2 = d_bound * d_bound;
+  const double dm2 = delta * delta;
+
+  const double num = dp2 + eps2 + 2.0 * delta * d_bound;
+  const double den = dp2 + 2.0 * dm2 + delta * d_bound + eps2;
+
+  return active ? std::min( 1.0, num / ( active ? den : 1.0 ) ) : 1.0;
+
+} // venkatakrishnan()
+
+/*********************************************************************
+* This class computes limited Green-Gauss gradients on a median dual
+* grid for the second-order reconstruction of the face states
+*
+*   u_f = u_i + phi_i * grad(u_i) * ( x_f - x_i )
+*
+* at the midpoints x_f of the primal edges.
+*
+* Every variable is processed separately in three sweeps over
+* structure-of-arrays data:
+*
+*   1) Gradient sweep: The Green-Gauss sums and the minimum and
+*      maximum of the neighbor values are gathered in the same
+*      pass over the CSR adjacency of every element.
+*   2) Increment sweep: The gradients are scaled by the volumes and
+*      the largest positive and negative increments towards the
+*      face midpoints are gathered.
+*   3) Limiter sweep: Both limiters are monotone in the increment,
+*      hence phi_i only depends on the extreme increments. This
+*      sweep is a contiguous, branch-free loop, which is vectorized
+*      by the compiler.
+*
+* The limited gradients of all variables are finally stored row-wise
+* per element (see slopes()), such that the flux loops access them
+* with a single row.
+*
+* Limiters can be frozen, either manually or automatically once the
+* residual, which is passed to monitor_residual(), has dropped by a
+* given number of orders. Afterwards, only the gradients are updated,
+* which often removes the limit cycles that stall the convergence.
+* NewtonKrylov::solve() passes the norm of every iteration. Drivers
+* of explicit schemes (see RungeKutta.h) evaluate the residual
+* themselves and must call monitor_residual() once per iteration.
+*
+* The wall time of every variable is accumulated in variable_times().
+*********************************************************************/
+class Reconstruction
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  Reconstruction(const DualGrid& dgrid, int n_vars=N_FLOW_VARS)
+  : dgrid_     { dgrid                                }
+  , n_vars_    { n_vars                               }
+  , values_    ( n_vars,   dgrid.n_elements()         )
+  , grad_x_    ( n_vars,   dgrid.n_elements()         )
+  , grad_y_    ( n_vars,   dgrid.n_elements()         )
+  , u_min_     ( n_vars,   dgrid.n_elements()         )
+  , u_max_     ( n_vars,   dgrid.n_elements()         )
+  , inc_max_   ( n_vars,   dgrid.n_elements()         )
+  , inc_min_   ( n_vars,   dgrid.n_elements()         )
+  , limiters_  ( n_vars,   dgrid.n_elements()         )
+  , slopes_    ( dgrid.n_elements(), 2 * n_vars, THREAD_POOL )
+  , eps2_      ( dgrid.n_elements(), 0.0              )
+  , var_times_ ( n_vars, 0.0                          )
+  {
+    for ( int k = 0; k < n_vars_; ++k )
+      std::fill( limiters_[k], limiters_[k] + dgrid.n_elements(), 1.0 );
+
+    venkatakrishnan_constant( venkat_k_ );
+  }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void limiter(LimiterType type) { type_ = type; }
+
+  // Venkatakrishnan: eps^2 = ( K * h )^3 with h = sqrt( volume )
+  void venkatakrishnan_constant(double k)
+  {
+    venkat_k_ = k;
+
+    const DVec& volumes = dgrid_.volumes();
+
+    for ( int i = 0; i < dgrid_.n_elements(); ++i )
+    {
+      const double kh = k * std::sqrt( volumes[i] );
+      eps2_[i] = kh * kh * kh;
+    }
+  }
+
+  // Freeze the limiters after a residual drop by the given orders
+  // of magnitude (zero disables the automatic freezing)
+  void freeze_after(double orders) { freeze_orders_ = orders; }
+
+  void freeze(bool f) { frozen_ = f; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  LimiterType limiter() const { return type_; }
+  double venkatakrishnan_constant() const { return venkat_k_; }
+  bool frozen() const { return frozen_; }
+  int n_variables() const { return n_vars_; }
+
+  // Structure-of-arrays data: row k holds variable k
+  const DMat& gradients_x() const { return grad_x_; }
+  const DMat& gradients_y() const { return grad_y_; }
+  const DMat& limiters() const { return limiters_; }
+
+  // Limited gradients (phi*du/dx, phi*du/dy) of all variables,
+  // stored row-wise per element
+  const DMat& slopes() const { return slopes_; }
+
+  const DVec& variable_times() const { return var_times_; }
+  int n_evaluations() const { return n_evals_; }
+
+  /*------------------------------------------------------------------
+  | Compute the limited gradients of all columns of U
+  ------------------------------------------------------------------*/
+  void compute(const DMat& U)
+  {
+    PROFILE_SCOPE( "Reconstruction::compute" );
+
+    ASSERT( U.rows() == dgrid_.n_elements() && U.columns() >= n_vars_,
+      "Reconstruction: Invalid size of solution matrix.");
+
+    const bool update_limiters
+      = ( type_ != LimiterType::NONE ) && !frozen_;
+
+    for ( int k = 0; k < n_vars_; ++k )
+    {
+      Timer timer {};
+      timer.count();
+
+      gradient_sweep( U, k );
+      boundary_gradients( k );
+      increment_sweep( k, update_limiters );
+      limiter_sweep( k, update_limiters );
+
+      timer.count();
+      var_times_[k] += timer.delta(0);
+    }
+
+    ++n_evals_;
+
+  } // compute()
+
+  /*------------------------------------------------------------------
+  | Track the residual norm and freeze the limiters, once it has
+  | dropped by freeze_after() orders of magnitude
+  ------------------------------------------------------------------*/
+  void monitor_residual(double norm)
+  {
+    if ( ref_norm_ < 0.0 )
+      ref_norm_ = norm;
+
+    if ( frozen_ || freeze_orders_ <= 0.0 )
+      return;
+
+    if ( norm <= ref_norm_ * std::pow( 10.0, -freeze_orders_ ) )
+    {
+      frozen_ = true;
+
+      LOG(INFO) << "Reconstruction: Limiters frozen after a residual "
+                << "drop by " << freeze_orders_ << " orders";
+    }
+
+  } // monitor_residual()
+
+  /*------------------------------------------------------------------
+  | Reconstructed states of the face between the elements i and j
+  ------------------------------------------------------------------*/
+  void face_states(const DMat& U, int i, int j,
+                   double* ul, double* ur) const
+  {
+    const DMat& xy = dgrid_.coords();
+
+    const double dx = 0.5 * ( xy[j][0] - xy[i][0] );
+    const double dy = 0.5 * ( xy[j][1] - xy[i][1] );
+
+    const double* si = slopes_[i];
+    const double* sj = slopes_[j];
+
+    for ( int k = 0; k < n_vars_; ++k )
+    {
+      ul[k] = U[i][k] + si[2*k] * dx + si[2*k+1] * dy;
+      ur[k] = U[j][k] - sj[2*k] * dx - sj[2*k+1] * dy;
+    }
+
+  } // face_states()
+
+  /*------------------------------------------------------------------
+  | Reset the timings
+  ------------------------------------------------------------------*/
+  void reset_timings()
+  {
+    std::fill( var_times_.begin(), var_times_.end(), 0.0 );
+    n_evals_ = 0;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Green-Gauss sums and neighbor extrema of variable k
+  ------------------------------------------------------------------*/
+  void gradient_sweep(const DMat& U, int k)
+  {
+    const DMat& normals = dgrid_.face_normals();
+    const IMat& nbrs    = dgrid_.face_neighbors();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+    const IVec& faces   = dgrid_.adj_faces();
+
+    double* u = values_[k];
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      u[i] = U[i][k];
+    });
+
+    double* gx   = grad_x_[k];
+    double* gy   = grad_y_[k];
+    double* umin = u_min_[k];
+    double* umax = u_max_[k];
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      const double ui = u[i];
+
+      double sx = 0.0, sy = 0.0;
+      double lo = ui, hi = ui;
+
+      for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+      {
+        const int    i_face = faces[a];
+        const double uj     = u[ adj[a] ];
+        const double sign   = ( nbrs[i_face][0] == i ) ? 0.5 : -0.5;
+
+        sx += sign * ( ui + uj ) * normals[i_face][0];
+        sy += sign * ( ui + uj ) * normals[i_face][1];
+
+        lo = std::min( lo, uj );
+        hi = std::max( hi, uj );
+      }
+
+      gx[i]   = sx;
+      gy[i]   = sy;
+      umin[i] = lo;
+      umax[i] = hi;
+    });
+
+  } // gradient_sweep()
+
+  /*------------------------------------------------------------------
+  | Close the Green-Gauss sums at the boundaries. Boundary normals
+  | point into the domain. Corner elements belong to several
+  | boundaries, hence the boundaries are processed one by one.
+  ------------------------------------------------------------------*/
+  void boundary_gradients(int k)
+  {
+    const double* u  = values_[k];
+    double*       gx = grad_x_[k];
+    double*       gy = grad_y_[k];
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      const IVec& elements = bdry.dual_elements();
+      const DMat& normals  = bdry.dual_normals();
+
+      THREAD_POOL.parallel_for(0, bdry.n_dual_elements(), [&](int i_elem)
+      {
+        const int i = elements[i_elem];
+        gx[i] -= u[i] * normals[i_elem][0];
+        gy[i] -= u[i] * normals[i_elem][1];
+      });
+    }
+
+  } // boundary_gradients()
+
+  /*------------------------------------------------------------------
+  | Scale the gradients of variable k by the volumes and gather the
+  | extreme increments towards the face midpoints
+  ------------------------------------------------------------------*/
+  void increment_sweep(int k, bool update_limiters)
+  {
+    const DMat& xy      = dgrid_.coords();
+    const DVec& volumes = dgrid_.volumes();
+    const IVec& offsets = dgrid_.adj_offsets();
+    const IVec& adj     = dgrid_.adj_elements();
+
+    double* gx      = grad_x_[k];
+    double* gy      = grad_y_[k];
+    double* inc_max = inc_max_[k];
+    double* inc_min = inc_min_[k];
+
+    THREAD_POOL.parallel_for(0, dgrid_.n_elements(), [&](int i)
+    {
+      gx[i] /= volumes[i];
+      gy[i] /= volumes[i];
+
+      if ( !update_limiters )
+        return;
+
+      double hi = 0.0, lo = 0.0;
+
+      for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+      {
+        const int j = adj[a];
+
+        const double delta = 0.5 * ( gx[i] * ( xy[j][0] - xy[i][0] )
+                                   + gy[i] * ( xy[j][1] - xy[i][1] ) );
+
+        hi = std::max( hi, delta );
+        lo = std::min( lo, delta );
+      }
+
+      inc_max[i] = hi;
+      inc_min[i] = lo;
+    });
+
+  } // increment_sweep()
+
+  /*------------------------------------------------------------------
+  | Evaluate the limiters of variable k and store the limited
+  | gradients
+  ------------------------------------------------------------------*/
+  void limiter_sweep(int k, bool update_limiters)
+  {
+    const int n_elements = dgrid_.n_elements();
+
+    const double* u       = values_[k];
+    const double* umin    = u_min_[k];
+    const double* umax    = u_max_[k];
+    const double* inc_max = inc_max_[k];
+    const double* inc_min = inc_min_[k];
+    const double* eps2    = eps2_.data();
+    const double* gx      = grad_x_[k];
+    const double* gy      = grad_y_[k];
+    double*       phi     = limiters_[k];
+
+    if ( update_limiters )
+    {
+      THREAD_POOL.parallel_for_range(0, n_elements, [&](int i0, int i1)
+      {
+        if ( type_ == LimiterType::BARTH_JESPERSEN )
+        {
+          for ( int i = i0; i < i1; ++i )
+            phi[i] = std::min(
+              barth_jespersen( umax[i] - u[i], inc_max[i] ),
+              barth_jespersen( umin[i] - u[i], inc_min[i] ) );
+        }
+        else
+        {
+          for ( int i = i0; i < i1; ++i )
+            phi[i] = std::min(
+              venkatakrishnan( umax[i] - u[i], inc_max[i], eps2[i] ),
+              venkatakrishnan( umin[i] - u[i], inc_min[i], eps2[i] ) );
+        }
+      });
+    }
+    else if ( type_ == LimiterType::NONE )
+      std::fill( phi, phi + n_elements, 1.0 );
+
+    THREAD_POOL.parallel_for(0, n_elements, [&](int i)
+    {
+      slopes_[i][2*k]   = phi[i] * gx[i];
+      slopes_[i][2*k+1] = phi[i] * gy[i];
+    });
+
+  } // limiter_sweep()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid& dgrid_;
+  int             n_vars_;
+
+  LimiterType     type_          { LimiterType::VENKATAKRISHNAN };
+  double          venkat_k_      { 5.0 };
+  double          freeze_orders_ { 0.0 };
+  double          ref_norm_      { -1.0 };
+  bool            frozen_        { false };
+
+  DMat            values_;
+  DMat            grad_x_;
+  DMat            grad_y_;
+  DMat            u_min_;
+  DMat            u_max_;
+  DMat            inc_max_;
+  DMat            inc_min_;
+  DMat            limiters_;
+  DMat            slopes_;
+  DVec            eps2_;
+
+  DVec            var_times_;
+  int             n_evals_       { 0 };
+
+}; // Reconstruction
+
+} // namespace Solver
+} // namespace IncomFlow
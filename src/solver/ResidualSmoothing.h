@@ -0,0 +1,149 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+#include "PeriodicBoundaries.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class applies implicit residual smoothing to a residual R
+* on the dual grid adjacency. The smoothed residual S solves
+*
+*   ( 1 + eps * n_i ) * S_i - eps * sum_j S_j = R_i
+*
+* where j runs over all n_i neighbors of the dual element i.
+* The system is solved approximately with a few Jacobi sweeps.
+* The smoothing increases the support of the explicit scheme, such
+* that larger CFL numbers can be used for steady-state problems.
+*
+* With periodic_boundaries(), the smoothed residuals of all copies
+* of a periodic control volume are merged after every sweep (see
+* PeriodicBoundaries::merge()), such that the copies obtain the
+* same update and the smoothing acts across the periodic boundaries.
+*********************************************************************/
+class ResidualSmoothing
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  ResidualSmoothing(const DualGrid& dgrid, int n_vars,
+                    double epsilon=0.5, int n_sweeps=2)
+  : dgrid_    { dgrid                        }
+  , n_vars_   { n_vars                       }
+  , epsilon_  { epsilon                      }
+  , n_sweeps_ { n_sweeps                     }
+  , smoothed_ ( dgrid.n_elements(), n_vars, THREAD_POOL )
+  , rhs_      ( dgrid.n_elements(), n_vars, THREAD_POOL )
+  {}
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void epsilon(double e) { epsilon_ = e; }
+  void n_sweeps(int n) { n_sweeps_ = n; }
+
+  void periodic_boundaries(const PeriodicBoundaries& periodic)
+  {
+    ASSERT( n_vars_ == N_FLOW_VARS,
+      "ResidualSmoothing: Periodic boundaries require flow variables.");
+    periodic_ = &periodic;
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  double epsilon() const { return epsilon_; }
+  int n_sweeps() const { return n_sweeps_; }
+
+  /*------------------------------------------------------------------
+  | Smooth the residual R in place
+  ------------------------------------------------------------------*/
+  void apply(DMat& R)
+  {
+    PROFILE_SCOPE( "ResidualSmoothing::apply" );
+
+    ASSERT( R.rows() == dgrid_.n_elements() && R.columns() == n_vars_,
+      "ResidualSmoothing: Invalid size of residual matrix.");
+
+    if ( n_sweeps_ < 1 || epsilon_ <= 0.0 )
+      return;
+
+    const IVec& offsets  = dgrid_.adj_offsets();
+    const IVec& adjacent = dgrid_.adj_elements();
+
+    const int n_elements = dgrid_.n_elements();
+
+    // The unsmoothed residual is the right hand side and the 
+    // initial guess
+    THREAD_POOL.parallel_for_range(0, n_elements, [&](int i0, int i1)
+    {
+      std::copy( R[i0], R[i0] + (i1-i0) * n_vars_, rhs_[i0] );
+    });
+
+    for ( int sweep = 0; sweep < n_sweeps_; ++sweep )
+    {
+      THREAD_POOL.parallel_for_range(0, n_elements, [&](int i0, int i1)
+      {
+        for ( int i = i0; i < i1; ++i )
+        {
+          const int    n_adj = offsets[i+1] - offsets[i];
+          const double diag  = 1.0 / ( 1.0 + epsilon_ * n_adj );
+
+          for ( int k = 0; k < n_vars_; ++k )
+          {
+            double sum = 0.0;
+
+            for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+              sum += R[ adjacent[a] ][k];
+
+            smoothed_[i][k] = ( rhs_[i][k] + epsilon_ * sum ) * diag;
+          }
+        }
+      });
+
+      if ( periodic_ )
+        periodic_->merge( smoothed_ );
+
+      R.swap( smoothed_ );
+    }
+
+  } // apply()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid& dgrid_;
+  int             n_vars_;
+  double          epsilon_;
+  int             n_sweeps_;
+
+  const PeriodicBoundaries* periodic_ { nullptr };
+
+  DMat            smoothed_;
+  DMat            rhs_;
+
+}; // ResidualSmoothing
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,275 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* All available explicit Runge-Kutta schemes
+*********************************************************************/
+enum class RKScheme
+{
+  LSRK4,   // Five-stage, fourth-order scheme in Williamson form
+  SSPRK3,  // Three-stage, third-order strong-stability-preserving
+};
+
+/*********************************************************************
+* This class advances the semi-discrete system
+*
+*   V_i * dU_i/dt + R_i(U) = 0
+*
+* with low-storage explicit Runge-Kutta schemes.
+* Besides the solution U, only a single additional state register
+* is required, regardless of the number of stages. The residual R
+* is stored in a third array of the same size: Residual functions
+* overwrite their output (e.g. EdgeResidual, residual smoothing or
+* the halo exchange of distributed runs), and they read U while
+* writing R. Within a stage, U, the register (dU or U_0) and R(U)
+* are thus alive at the same time. The classical 2N storage would
+* require residual functions, which accumulate into the scaled
+* register. Hence, the storage is 3N and does not grow with the
+* number of stages:
+*
+* LSRK4 (Williamson 2N-form, Carpenter & Kennedy 1994):
+* -----------------------------------------------------
+*   dU = a_k * dU - dt / V * R(U)
+*   U  = U + b_k * dU
+*
+* SSPRK3 (Shu-Osher form):
+* ------------------------
+*   U = alpha_k * U_0 + (1 - alpha_k) * ( U - dt / V * R(U) )
+*
+* The scaling of the residual by the dual element volumes is
+* fused with the stage update into a single parallel pass over the
+* solution arrays. The time step is either global or local to 
+* every dual element (see LocalTimeStep.h).
+*
+* The residual norm is left to the caller. Steady-state drivers with
+* a second-order reconstruction must pass it to
+* Reconstruction::monitor_residual() once per step, in order to
+* freeze the limiters after Reconstruction::freeze_after().
+*********************************************************************/
+class RungeKutta
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  RungeKutta(RKScheme scheme, int n_elements, int n_vars)
+  : scheme_     { scheme                }
+  , n_elements_ { n_elements            }
+  , n_vars_     { n_vars                }
+  , register_   ( n_elements, n_vars, THREAD_POOL )
+  , residual_   ( n_elements, n_vars, THREAD_POOL )
+  {
+    init_coefficients();
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  RKScheme scheme() const { return scheme_; }
+  int n_stages() const { return static_cast<int>(a_.size()); }
+
+  DMat& residual() { return residual_; }
+  const DMat& residual() const { return residual_; }
+
+  /*------------------------------------------------------------------
+  | Advance the solution U by one global time step dt.
+  | The residual function must have the signature
+  |   void(const DMat& U, DMat& R)
+  ------------------------------------------------------------------*/
+  template <typename ResidualFunc>
+  void step(DMat& U, const DVec& volumes, double dt,
+            ResidualFunc&& residual_func)
+  {
+    advance( U, volumes, &dt, 0, residual_func );
+  }
+
+  /*------------------------------------------------------------------
+  | Advance every element of the solution U by its own local 
+  | (pseudo) time step dt[i]
+  ------------------------------------------------------------------*/
+  template <typename ResidualFunc>
+  void step(DMat& U, const DVec& volumes, const DVec& dt,
+            ResidualFunc&& residual_func)
+  {
+    ASSERT( static_cast<int>(dt.size()) == n_elements_,
+      "RungeKutta: Invalid size of local time step vector.");
+
+    advance( U, volumes, dt.data(), 1, residual_func );
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Perform all stages of a single step. The time step of element i
+  | is located at dt[i*dt_inc].
+  ------------------------------------------------------------------*/
+  template <typename ResidualFunc>
+  void advance(DMat& U, const DVec& volumes, 
+               const double* dt, int dt_inc,
+               ResidualFunc&& residual_func)
+  {
+    PROFILE_SCOPE( "RungeKutta::step" );
+
+    ASSERT( U.rows() == n_elements_ && U.columns() == n_vars_,
+      "RungeKutta: Invalid size of solution matrix.");
+    ASSERT( static_cast<int>(volumes.size()) == n_elements_,
+      "RungeKutta: Invalid size of volume vector.");
+
+    for ( int k = 0; k < n_stages(); ++k )
+    {
+      residual_func( U, residual_ );
+
+      if ( scheme_ == RKScheme::SSPRK3 )
+        ssp_stage_update( k, U, volumes, dt, dt_inc );
+      else
+        williamson_stage_update( k, U, volumes, dt, dt_inc );
+    }
+
+  } // advance()
+
+  /*------------------------------------------------------------------
+  | Set up the scheme coefficients
+  ------------------------------------------------------------------*/
+  void init_coefficients()
+  {
+    if ( scheme_ == RKScheme::LSRK4 )
+    {
+      a_ = {  0.0,
+             -567301805773.0  / 1357537059087.0,
+             -2404267990393.0 / 2016746695238.0,
+             -3550918686646.0 / 2091501179385.0,
+             -1275806237668.0 / 842570457699.0   };
+
+      b_ = {  1432997174477.0 / 9575080441755.0,
+              5161836677717.0 / 13612068292357.0,
+              1720146321549.0 / 2090206949498.0,
+              3134564353537.0 / 4481467310338.0,
+              2277821191437.0 / 14882151754819.0 };
+    }
+    else
+    {
+      // Here a_ holds the Shu-Osher weights alpha_k
+      a_ = { 0.0, 0.75, 1.0 / 3.0 };
+      b_ = { 1.0, 0.25, 2.0 / 3.0 };
+    }
+
+  } // init_coefficients()
+
+  /*------------------------------------------------------------------
+  | Stage update in Williamson's 2N-storage form
+  ------------------------------------------------------------------*/
+  void williamson_stage_update(int k, DMat& U, const DVec& volumes,
+                               const double* dt, int dt_inc)
+  {
+    PROFILE_SCOPE( "RungeKutta::update" );
+
+    const double a = a_[k];
+    const double b = b_[k];
+
+    double*       u  = U[0];
+    double*       du = register_[0];
+    const double* r  = residual_[0];
+
+    THREAD_POOL.parallel_for_range(0, n_elements_, [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        const double dt_vol = dt[i*dt_inc] / volumes[i];
+        const int    offset = i * n_vars_;
+
+        for ( int v = offset; v < offset + n_vars_; ++v )
+        {
+          du[v] = a * du[v] - dt_vol * r[v];
+          u[v] += b * du[v];
+        }
+      }
+    });
+
+  } // williamson_stage_update()
+
+  /*------------------------------------------------------------------
+  | Stage update in Shu-Osher form.
+  | The initial solution is stored within the first stage.
+  ------------------------------------------------------------------*/
+  void ssp_stage_update(int k, DMat& U, const DVec& volumes,
+                        const double* dt, int dt_inc)
+  {
+    PROFILE_SCOPE( "RungeKutta::update" );
+
+    const double alpha = a_[k];
+    const double beta  = b_[k];
+
+    double*       u  = U[0];
+    double*       u0 = register_[0];
+    const double* r  = residual_[0];
+
+    if ( k == 0 )
+    {
+      THREAD_POOL.parallel_for_range(0, n_elements_, [&](int i0, int i1)
+      {
+        for ( int i = i0; i < i1; ++i )
+        {
+          const double dt_vol = dt[i*dt_inc] / volumes[i];
+          const int    offset = i * n_vars_;
+
+          for ( int v = offset; v < offset + n_vars_; ++v )
+          {
+            u0[v] = u[v];
+            u[v] -= dt_vol * r[v];
+          }
+        }
+      });
+      return;
+    }
+
+    THREAD_POOL.parallel_for_range(0, n_elements_, [&](int i0, int i1)
+    {
+      for ( int i = i0; i < i1; ++i )
+      {
+        const double dt_vol = dt[i*dt_inc] / volumes[i];
+        const int    offset = i * n_vars_;
+
+        for ( int v = offset; v < offset + n_vars_; ++v )
+          u[v] = alpha * u0[v] + beta * ( u[v] - dt_vol * r[v] );
+      }
+    });
+
+  } // ssp_stage_update()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  RKScheme scheme_;
+  int      n_elements_;
+  int      n_vars_;
+
+  DVec     a_ {};
+  DVec     b_ {};
+
+  DMat     register_;
+  DMat     residual_;
+
+}; // RungeKutta
+
+} // namespace Solver
+} // namespace IncomFlow
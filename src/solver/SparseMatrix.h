@@ -0,0 +1,186 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "Log.h"
+#include "Helpers.h"
+
+#include "definitions.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class represents a sparse block matrix in compressed sparse
+* row format, whose sparsity pattern follows the adjacency of a
+* median dual grid. Every row of blocks belongs to a dual element
+* and stores its diagonal block first, followed by the blocks of
+* all adjacent elements:
+*
+*   row i: [ (i,i), (i,adj_0), (i,adj_1), ... ]
+*
+* Each block is a dense (block_size x block_size) matrix, which is
+* stored in row-major order.
+*********************************************************************/
+class SparseMatrix
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  SparseMatrix(const DualGrid& dgrid, int block_size=1)
+  : n_rows_     { dgrid.n_elements() }
+  , block_size_ { block_size         }
+  {
+    const IVec& adj_offsets  = dgrid.adj_offsets();
+    const IVec& adj_elements = dgrid.adj_elements();
+
+    offsets_.resize( n_rows_ + 1 );
+    columns_.resize( adj_offsets[n_rows_] + n_rows_ );
+
+    for ( int i = 0; i < n_rows_; ++i )
+    {
+      offsets_[i] = adj_offsets[i] + i;
+
+      int pos = offsets_[i];
+      columns_[pos++] = i;
+
+      for ( int a = adj_offsets[i]; a < adj_offsets[i+1]; ++a )
+        columns_[pos++] = adj_elements[a];
+    }
+
+    offsets_[n_rows_] = static_cast<int>( columns_.size() );
+
+    values_.assign( columns_.size() * block_size_ * block_size_, 0.0 );
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_rows() const { return n_rows_; }
+  int block_size() const { return block_size_; }
+  int n_nonzero_blocks() const { return offsets_[n_rows_]; }
+
+  const IVec& offsets() const { return offsets_; }
+  const IVec& columns() const { return columns_; }
+
+  DVec& values() { return values_; }
+  const DVec& values() const { return values_; }
+
+  /*------------------------------------------------------------------
+  | Access to the block at position pos of the column array
+  ------------------------------------------------------------------*/
+  double* block(int pos)
+  { return values_.data() + pos * block_size_ * block_size_; }
+
+  const double* block(int pos) const
+  { return values_.data() + pos * block_size_ * block_size_; }
+
+  /*------------------------------------------------------------------
+  | Access to the diagonal block of row i
+  ------------------------------------------------------------------*/
+  double* diagonal(int i) { return block( offsets_[i] ); }
+  const double* diagonal(int i) const { return block( offsets_[i] ); }
+
+  /*------------------------------------------------------------------
+  | Return the position of block (i,j) in the column array or -1,
+  | if it is not part of the sparsity pattern
+  ------------------------------------------------------------------*/
+  int find(int i, int j) const
+  {
+    for ( int pos = offsets_[i]; pos < offsets_[i+1]; ++pos )
+      if ( columns_[pos] == j )
+        return pos;
+
+    return -1;
+  }
+
+  /*------------------------------------------------------------------
+  | Set all entries to zero, where the rows are distributed onto 
+  | the threads of the global thread pool
+  ------------------------------------------------------------------*/
+  void set_zero()
+  {
+    const int bs2 = block_size_ * block_size_;
+
+    THREAD_POOL.parallel_for_range(0, n_rows_, [&](int i0, int i1)
+    {
+      std::fill( values_.data() + offsets_[i0] * bs2,
+                 values_.data() + offsets_[i1] * bs2, 0.0 );
+    });
+  }
+
+  /*------------------------------------------------------------------
+  | Sparse matrix-vector product y = A * x, where the rows are
+  | distributed onto the threads of the global thread pool
+  ------------------------------------------------------------------*/
+  void multiply(const DVec& x, DVec& y) const
+  {
+    ASSERT( static_cast<int>(x.size()) == n_rows_ * block_size_,
+      "SparseMatrix: Invalid size of input vector.");
+    ASSERT( static_cast<int>(y.size()) == n_rows_ * block_size_,
+      "SparseMatrix: Invalid size of output vector.");
+
+    if ( block_size_ == 1 )
+    {
+      THREAD_POOL.parallel_for(0, n_rows_, [&](int i)
+      {
+        double sum = 0.0;
+
+        for ( int pos = offsets_[i]; pos < offsets_[i+1]; ++pos )
+          sum += values_[pos] * x[ columns_[pos] ];
+
+        y[i] = sum;
+      });
+      return;
+    }
+
+    const int bs = block_size_;
+
+    THREAD_POOL.parallel_for(0, n_rows_, [&](int i)
+    {
+      double* yi = &y[i*bs];
+
+      for ( int r = 0; r < bs; ++r )
+        yi[r] = 0.0;
+
+      for ( int pos = offsets_[i]; pos < offsets_[i+1]; ++pos )
+      {
+        const double* a  = block( pos );
+        const double* xj = &x[ columns_[pos] * bs ];
+
+        for ( int r = 0; r < bs; ++r )
+          for ( int c = 0; c < bs; ++c )
+            yi[r] += a[r*bs+c] * xj[c];
+      }
+    });
+
+  } // multiply()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int  n_rows_;
+  int  block_size_;
+
+  IVec offsets_;
+  IVec columns_;
+  DVec values_;
+
+}; // SparseMatrix
+
+} // namespace Solver
+} // namespace IncomFlow
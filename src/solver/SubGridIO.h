@@ -0,0 +1,460 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "MathUtility.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "PrimaryGrid.h"
+#include "DomainDecomposition.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* Binary sub-grid files
+* ---------------------
+* A partitioned grid is stored as one file per rank, such that every
+* rank of a distributed run only reads its own sub-grid instead of
+* the complete grid (see the partition_grid tool).
+*
+* All entries are stored in native byte order, integers as int32
+* and coordinates as float64:
+*
+*   Header:   magic "IFSUBGRD", byte order tag, version,
+*             rank, n_parts, n_global_vertices, n_owned,
+*             n_vertices, n_tris, n_quads, n_intr_edges,
+*             n_bdry_edges, n_neighbors
+*   Grid:     vertex_coords, tris, quads, tri_neighbors,
+*             quad_neighbors, intr_edges, intr_edge_neighbors,
+*             bdry_edges, bdry_edge_neighbors, bdry_edge_markers
+*   Halo:     local_to_global, neighbor_ranks,
+*             for every neighbor: n_send, send_elements,
+*                                 n_recv, recv_elements
+*
+* The boundary edges include the GHOST_MARKER edges at the rim of
+* the ghost layer.
+*********************************************************************/
+constexpr char         SUBGRID_FILE_MAGIC[8]  { 'I','F','S','U','B','G','R','D' };
+constexpr std::int32_t SUBGRID_FILE_BYTE_TAG  { 0x01020304 };
+constexpr std::int32_t SUBGRID_FILE_VERSION   { 1 };
+
+static_assert( sizeof(int) == sizeof(std::int32_t),
+  "Sub-grid files require 32-bit integers." );
+
+/*********************************************************************
+* Path of the sub-grid file of a rank, e.g. "grid_3.sgrid"
+*********************************************************************/
+inline std::string subgrid_file_path(const std::string& prefix, int rank)
+{
+  return prefix + "_" + std::to_string( rank ) + ".sgrid";
+}
+
+/*********************************************************************
+* This class is used to write sub-grids to binary files
+*********************************************************************/
+class SubGridWriter
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  SubGridWriter() {}
+
+  /*------------------------------------------------------------------
+  | Write the sub-grids of all ranks of a decomposition to the files
+  | <prefix>_<rank>.sgrid
+  ------------------------------------------------------------------*/
+  bool write(const DomainDecomposition& decomp, const std::string& prefix)
+  {
+    const int n_global_vertices = static_cast<int>( decomp.parts().size() );
+
+    for ( int rank = 0; rank < decomp.n_parts(); ++rank )
+    {
+      const SubGrid sub = decomp.subgrid( rank );
+
+      if ( !write( sub, decomp.n_parts(), n_global_vertices,
+                   subgrid_file_path( prefix, rank ) ) )
+        return false;
+    }
+
+    return true;
+
+  } // SubGridWriter::write()
+
+  /*------------------------------------------------------------------
+  | Write a single sub-grid to a file
+  ------------------------------------------------------------------*/
+  bool write(const SubGrid& sub, int n_parts, int n_global_vertices,
+             const std::string& file_path)
+  {
+    std::ofstream file ( file_path, std::ios::binary | std::ios::trunc );
+
+    if ( file.fail() )
+    {
+      LOG(ERROR) << "Failed to open sub-grid file:\n"
+                    "  \"" << file_path << "\"";
+      return false;
+    }
+
+    const PrimaryGrid& grid = sub.primary_grid();
+
+    file.write( SUBGRID_FILE_MAGIC, sizeof(SUBGRID_FILE_MAGIC) );
+
+    write_int( file, SUBGRID_FILE_BYTE_TAG );
+    write_int( file, SUBGRID_FILE_VERSION );
+    write_int( file, sub.rank() );
+    write_int( file, n_parts );
+    write_int( file, n_global_vertices );
+    write_int( file, sub.n_owned() );
+    write_int( file, grid.n_vertices() );
+    write_int( file, grid.n_tris() );
+    write_int( file, grid.n_quads() );
+    write_int( file, grid.n_intr_edges() );
+    write_int( file, grid.n_bdry_edges() );
+    write_int( file, sub.n_neighbors() );
+
+    write_array( file, grid.vertex_coords() );
+    write_array( file, grid.tris() );
+    write_array( file, grid.quads() );
+    write_array( file, grid.tri_neighbors() );
+    write_array( file, grid.quad_neighbors() );
+    write_array( file, grid.intr_edges() );
+    write_array( file, grid.intr_edge_neighbors() );
+    write_array( file, grid.bdry_edges() );
+    write_array( file, grid.bdry_edge_neighbors() );
+    write_array( file, grid.bdry_edge_markers() );
+
+    write_array( file, sub.local_to_global() );
+    write_array( file, sub.neighbor_ranks() );
+
+    for ( int k = 0; k < sub.n_neighbors(); ++k )
+    {
+      write_int( file, sub.send_elements()[k].size() );
+      write_array( file, sub.send_elements()[k] );
+      write_int( file, sub.recv_elements()[k].size() );
+      write_array( file, sub.recv_elements()[k] );
+    }
+
+    if ( file.fail() )
+    {
+      LOG(ERROR) << "Failed to write sub-grid file:\n"
+                    "  \"" << file_path << "\"";
+      return false;
+    }
+
+    return true;
+
+  } // SubGridWriter::write()
+
+private:
+  /*------------------------------------------------------------------
+  | Write helpers
+  ------------------------------------------------------------------*/
+  void write_int(std::ofstream& file, std::int32_t value)
+  {
+    file.write( reinterpret_cast<const char*>( &value ), sizeof(value) );
+  }
+
+  void write_array(std::ofstream& file, const IVec& v)
+  {
+    file.write( reinterpret_cast<const char*>( v.data() ),
+                v.size() * sizeof(int) );
+  }
+
+  template <typename T, typename A>
+  void write_array(std::ofstream& file, const Matrix<T,A>& m)
+  {
+    if ( m.rows() > 0 )
+      file.write( reinterpret_cast<const char*>( m[0] ),
+                  static_cast<std::size_t>( m.rows() ) * m.columns()
+                  * sizeof(T) );
+  }
+
+}; // SubGridWriter
+
+/*********************************************************************
+* This class is used to read sub-grids from binary files. The header
+* counts are validated against each other and against the file size
+* before any memory is allocated, and every block is checked for
+* read errors and out-of-range indices.
+*********************************************************************/
+class SubGridReader
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  SubGridReader() {}
+
+  /*------------------------------------------------------------------
+  | Getters for the attributes of the last file, that was read
+  ------------------------------------------------------------------*/
+  int n_parts() const { return n_parts_; }
+  int n_global_vertices() const { return n_global_vertices_; }
+
+  /*------------------------------------------------------------------
+  | Load the sub-grid of a rank from the file <prefix>_<rank>.sgrid.
+  | The file must belong to a partition into n_parts sub-grids.
+  ------------------------------------------------------------------*/
+  SubGrid read(const std::string& prefix, int rank, int n_parts)
+  {
+    const std::string file_path = subgrid_file_path( prefix, rank );
+
+    SubGrid sub = read( file_path );
+
+    if ( sub.rank() != rank || n_parts_ != n_parts )
+    {
+      LOG(ERROR) << "Sub-grid file \"" << file_path << "\" belongs to "
+                    "rank " << sub.rank() << " of " << n_parts_
+                 << " instead of rank " << rank << " of " << n_parts;
+      TERMINATE();
+    }
+
+    return sub;
+
+  } // SubGridReader::read()
+
+  /*------------------------------------------------------------------
+  | Load a sub-grid from a file
+  ------------------------------------------------------------------*/
+  SubGrid read(const std::string& file_path)
+  {
+    std::ifstream file ( file_path, std::ios::binary );
+
+    if ( file.fail() )
+    {
+      LOG(ERROR) << "Failed to open sub-grid file:\n"
+                    "  \"" << file_path << "\"";
+      TERMINATE();
+    }
+
+    char magic[sizeof(SUBGRID_FILE_MAGIC)];
+    file.read( magic, sizeof(magic) );
+
+    const bool valid_magic
+      = !file.fail()
+      && std::memcmp( magic, SUBGRID_FILE_MAGIC, sizeof(magic) ) == 0;
+
+    if ( !valid_magic
+        || read_int( file ) != SUBGRID_FILE_BYTE_TAG
+        || read_int( file ) != SUBGRID_FILE_VERSION )
+    {
+      LOG(ERROR) << "Invalid sub-grid file format:\n"
+                    "  \"" << file_path << "\"";
+      TERMINATE();
+    }
+
+    const int rank         = read_int( file );
+    n_parts_               = read_int( file );
+    n_global_vertices_     = read_int( file );
+    const int n_owned      = read_int( file );
+    const int n_vertices   = read_int( file );
+    const int n_tris       = read_int( file );
+    const int n_quads      = read_int( file );
+    const int n_intr_edges = read_int( file );
+    const int n_bdry_edges = read_int( file );
+    const int n_neighbors  = read_int( file );
+
+    // The counts must be consistent and the fixed size blocks must
+    // fit into the remaining file, before any memory is allocated
+    const bool valid_header
+      =  !file.fail()
+      && n_parts_ > 0 && rank >= 0 && rank < n_parts_
+      && n_owned >= 0 && n_owned <= n_vertices
+      && n_vertices <= n_global_vertices_
+      && n_tris >= 0 && n_quads >= 0
+      && n_intr_edges >= 0 && n_bdry_edges >= 0
+      && n_neighbors >= 0 && n_neighbors < n_parts_
+      && block_bytes( n_vertices, n_tris, n_quads, n_intr_edges,
+                      n_bdry_edges, n_neighbors ) <= remaining_bytes( file );
+
+    if ( !valid_header )
+    {
+      LOG(ERROR) << "Invalid sub-grid file header:\n"
+                    "  \"" << file_path << "\"";
+      TERMINATE();
+    }
+
+    PrimaryGrid grid { n_vertices, n_tris, n_quads,
+                       n_intr_edges, n_bdry_edges };
+
+    read_array( file, grid.vertex_coords() );
+    read_array( file, grid.tris() );
+    read_array( file, grid.quads() );
+    read_array( file, grid.tri_neighbors() );
+    read_array( file, grid.quad_neighbors() );
+    read_array( file, grid.intr_edges() );
+    read_array( file, grid.intr_edge_neighbors() );
+    read_array( file, grid.bdry_edges() );
+    read_array( file, grid.bdry_edge_neighbors() );
+    read_array( file, grid.bdry_edge_markers() );
+
+    check_block( file, file_path, "grid",
+         in_range( grid.tris(), 0, n_vertices )
+      && in_range( grid.quads(), 0, n_vertices )
+      && in_range( grid.intr_edges(), 0, n_vertices )
+      && in_range( grid.bdry_edges(), 0, n_vertices ) );
+
+    IVec local_to_global ( n_vertices );
+    IVec neighbor_ranks  ( n_neighbors );
+
+    read_array( file, local_to_global );
+    read_array( file, neighbor_ranks );
+
+    check_block( file, file_path, "halo",
+         in_range( local_to_global, 0, n_global_vertices_ )
+      && in_range( neighbor_ranks, 0, n_parts_ ) );
+
+    std::vector<IVec> send_elements ( n_neighbors );
+    std::vector<IVec> recv_elements ( n_neighbors );
+
+    for ( int k = 0; k < n_neighbors; ++k )
+    {
+      read_elements( file, file_path, n_vertices, send_elements[k] );
+      read_elements( file, file_path, n_vertices, recv_elements[k] );
+    }
+
+    return SubGrid { std::move(grid), rank, n_owned,
+                     std::move(local_to_global), std::move(neighbor_ranks),
+                     std::move(send_elements), std::move(recv_elements) };
+
+  } // SubGridReader::read()
+
+private:
+  /*------------------------------------------------------------------
+  | Read helpers
+  ------------------------------------------------------------------*/
+  std::int32_t read_int(std::ifstream& file)
+  {
+    std::int32_t value = -1;
+    file.read( reinterpret_cast<char*>( &value ), sizeof(value) );
+    return value;
+  }
+
+  void read_array(std::ifstream& file, IVec& v)
+  {
+    file.read( reinterpret_cast<char*>( v.data() ),
+               v.size() * sizeof(int) );
+  }
+
+  template <typename T, typename A>
+  void read_array(std::ifstream& file, Matrix<T,A>& m)
+  {
+    if ( m.rows() > 0 )
+      file.read( reinterpret_cast<char*>( m[0] ),
+                 static_cast<std::size_t>( m.rows() ) * m.columns()
+                 * sizeof(T) );
+  }
+
+  /*------------------------------------------------------------------
+  | Read the size and the local element indices of a halo list
+  ------------------------------------------------------------------*/
+  void read_elements(std::ifstream& file, const std::string& file_path,
+                     int n_vertices, IVec& elements)
+  {
+    const int n = read_int( file );
+
+    check_block( file, file_path, "halo list",
+      n >= 0 && n <= n_vertices
+      && static_cast<std::int64_t>( n ) * INT_BYTES
+         <= remaining_bytes( file ) );
+
+    elements.resize( n );
+    read_array( file, elements );
+
+    check_block( file, file_path, "halo list",
+                 in_range( elements, 0, n_vertices ) );
+  }
+
+  /*------------------------------------------------------------------
+  | Terminate, if a block could not be read or is invalid
+  ------------------------------------------------------------------*/
+  static void check_block(const std::ifstream& file,
+                          const std::string& file_path,
+                          const char* block, bool valid)
+  {
+    if ( file.fail() || !valid )
+    {
+      LOG(ERROR) << "Failed to read " << block << " of sub-grid file:\n"
+                    "  \"" << file_path << "\"";
+      TERMINATE();
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Validation helpers
+  ------------------------------------------------------------------*/
+  static constexpr std::int64_t INT_BYTES    = sizeof(std::int32_t);
+  static constexpr std::int64_t DOUBLE_BYTES = sizeof(double);
+
+  static std::int64_t remaining_bytes(std::ifstream& file)
+  {
+    const std::streampos pos = file.tellg();
+    file.seekg( 0, std::ios::end );
+    const std::streampos end = file.tellg();
+    file.seekg( pos );
+
+    return static_cast<std::int64_t>( end - pos );
+  }
+
+  // Bytes of the grid, local_to_global, neighbor_ranks and the
+  // sizes of the halo lists
+  static std::int64_t block_bytes(std::int64_t n_vertices,
+                                  std::int64_t n_tris,
+                                  std::int64_t n_quads,
+                                  std::int64_t n_intr_edges,
+                                  std::int64_t n_bdry_edges,
+                                  std::int64_t n_neighbors)
+  {
+    const std::int64_t n_ints = 6 * n_tris + 8 * n_quads
+                              + 4 * n_intr_edges + 4 * n_bdry_edges
+                              + n_vertices + 3 * n_neighbors;
+
+    return 2 * n_vertices * DOUBLE_BYTES + n_ints * INT_BYTES;
+  }
+
+  static bool in_range(const IVec& v, int lo, int hi)
+  {
+    return std::all_of( v.begin(), v.end(),
+      [lo,hi](int i) { return i >= lo && i < hi; });
+  }
+
+  static bool in_range(const IMat& m, int lo, int hi)
+  {
+    for ( int i = 0; i < m.rows(); ++i )
+      for ( int j = 0; j < m.columns(); ++j )
+        if ( m[i][j] < lo || m[i][j] >= hi )
+          return false;
+
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int n_parts_           { 0 };
+  int n_global_vertices_ { 0 };
+
+}; // SubGridReader
+
+} // namespace Solver
+} // namespace IncomFlow
@@ -0,0 +1,375 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <array>
+
+#include "Log.h"
+#include "Helpers.h"
+#include "Timer.h"
+#include "Vec2.h"
+#include "Geometry.h"
+#include "QuadTree.h"
+#include "MathUtility.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "DualGrid.h"
+
+namespace IncomFlow {
+namespace Solver {
+
+using namespace CppUtils;
+
+/*********************************************************************
+* This class computes the distance of all dual elements to the
+* closest primary edge of all WALL boundaries.
+*
+* The wall edges are sorted into a QuadTree by their midpoints.
+* The tree is then flattened into an array of nodes, which store the
+* tight bounding box of all edges below them, and an array of the
+* edges in leaf order. Every query descends the nodes depth-first,
+* visiting the closest boxes first, and skips all boxes that are
+* farther away than the closest edge found so far. Hence, the result
+* is exact and a query costs about O(log M) for M wall edges, instead
+* of O(M) for a brute force search.
+*
+* The nodes are only read after the setup, such that the dual
+* elements are processed in parallel. Consecutive elements start
+* with the distance bound of their predecessor, which prunes most
+* of the tree right away on spatially ordered grids.
+*********************************************************************/
+class WallDistance
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  WallDistance(const DualGrid& dgrid, size_t qtree_items=16)
+  : dgrid_ { dgrid }
+  {
+    Timer timer {};
+    timer.count();
+
+    std::vector<WallEdge> edges = collect_edges();
+    build_tree( edges, qtree_items );
+
+    timer.count();
+    build_time_ = timer.delta(0);
+
+    if ( segments_.empty() )
+      LOG(WARNING) << "WallDistance: No wall boundaries defined.";
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_wall_edges() const { return static_cast<int>( segments_.size() ); }
+  double build_time() const { return build_time_; }
+  double query_time() const { return query_time_; }
+  const DVec& distances() const { return distances_; }
+
+  /*------------------------------------------------------------------
+  | Compute the wall distances of all dual elements
+  ------------------------------------------------------------------*/
+  const DVec& compute()
+  {
+    PROFILE_SCOPE( "WallDistance::compute" );
+
+    Timer timer {};
+    timer.count();
+
+    const DMat& xy = dgrid_.coords();
+
+    distances_.resize( dgrid_.n_elements() );
+
+    // Consecutive elements are mostly close to each other, hence
+    // the distance of the previous element bounds the search
+    THREAD_POOL.parallel_for_range(0, dgrid_.n_elements(),
+    [&](int i0, int i1)
+    {
+      Vec2d  q    { xy[i0][0], xy[i0][1] };
+      double d_q  = distance( q );
+
+      distances_[i0] = d_q;
+
+      for ( int i = i0 + 1; i < i1; ++i )
+      {
+        const Vec2d p { xy[i][0], xy[i][1] };
+
+        d_q = distance( p, d_q + ( p - q ).length() );
+        q   = p;
+
+        distances_[i] = d_q;
+      }
+    });
+
+    timer.count();
+    query_time_ = timer.delta(0);
+
+    LOG(INFO) << "WallDistance: " << dgrid_.n_elements()
+              << " elements, " << segments_.size() << " wall edges, build "
+              << build_time_ << "s, query " << query_time_ << "s";
+
+    return distances_;
+
+  } // compute()
+
+  /*------------------------------------------------------------------
+  | Distance of an arbitrary point to the walls, optionally with a
+  | known upper bound of the distance
+  ------------------------------------------------------------------*/
+  double distance(const Vec2d& p,
+                  double upper_bound=std::numeric_limits<double>::max()) const
+  {
+    if ( nodes_.empty() )
+      return std::numeric_limits<double>::max();
+
+    // Widened, such that round-off does not prune the closest edge
+    const double bound = ( 1.0 + 1.0E-10 ) * upper_bound + INCOMFLOW_SMALL;
+
+    double dist_sqr = ( bound < 1.0E+150 )
+                    ? bound * bound : std::numeric_limits<double>::max();
+
+    closest_edge( 0, p, dist_sqr );
+
+    return std::sqrt( dist_sqr );
+
+  } // distance()
+
+private:
+  /*------------------------------------------------------------------
+  | A wall edge, which is located by its midpoint
+  ------------------------------------------------------------------*/
+  struct WallEdge
+  {
+    Vec2d v;
+    Vec2d w;
+    Vec2d mid;
+
+    const Vec2d& xy() const { return mid; }
+  };
+
+  using Tree = QuadTree<WallEdge,double>;
+
+  /*------------------------------------------------------------------
+  | Flattened quad with the bounding box of its edges. The children
+  | of inner nodes or the edges of leaf nodes are stored in the
+  | range [begin,end) of children_ or segments_.
+  ------------------------------------------------------------------*/
+  struct Node
+  {
+    double lo_x {  std::numeric_limits<double>::max() };
+    double lo_y {  std::numeric_limits<double>::max() };
+    double hi_x { -std::numeric_limits<double>::max() };
+    double hi_y { -std::numeric_limits<double>::max() };
+    int    begin { 0 };
+    int    end   { 0 };
+    bool   leaf  { true };
+
+    void extend(const Vec2d& p)
+    {
+      lo_x = MIN( lo_x, p.x );
+      lo_y = MIN( lo_y, p.y );
+      hi_x = MAX( hi_x, p.x );
+      hi_y = MAX( hi_y, p.y );
+    }
+
+    double dist_sqr(const Vec2d& p) const
+    {
+      const double dx = MAX( 0.0, MAX( lo_x - p.x, p.x - hi_x ) );
+      const double dy = MAX( 0.0, MAX( lo_y - p.y, p.y - hi_y ) );
+      return dx*dx + dy*dy;
+    }
+  };
+
+  /*------------------------------------------------------------------
+  | Collect the primary edges of all wall boundaries
+  ------------------------------------------------------------------*/
+  std::vector<WallEdge> collect_edges() const
+  {
+    const DMat& xy = dgrid_.coords();
+
+    std::vector<WallEdge> edges {};
+
+    for ( const auto& bdry : dgrid_.boundaries() )
+    {
+      if ( bdry.type() != BdryType::WALL )
+        continue;
+
+      const IMat& prim_edges = bdry.prim_edges();
+
+      for ( int e = 0; e < bdry.n_prim_edges(); ++e )
+      {
+        const int i0 = prim_edges[e][0];
+        const int i1 = prim_edges[e][1];
+
+        const Vec2d v { xy[i0][0], xy[i0][1] };
+        const Vec2d w { xy[i1][0], xy[i1][1] };
+
+        edges.push_back( { v, w, 0.5 * ( v + w ) } );
+      }
+    }
+
+    return edges;
+
+  } // collect_edges()
+
+  /*------------------------------------------------------------------
+  | Sort the wall edges into a quad tree and flatten it
+  ------------------------------------------------------------------*/
+  void build_tree(std::vector<WallEdge>& edges, size_t qtree_items)
+  {
+    if ( edges.empty() )
+      return;
+
+    Vec2d lowleft = edges[0].mid;
+    Vec2d upright = edges[0].mid;
+
+    for ( const auto& edge : edges )
+    {
+      lowleft.x = MIN( lowleft.x, edge.mid.x );
+      lowleft.y = MIN( lowleft.y, edge.mid.y );
+      upright.x = MAX( upright.x, edge.mid.x );
+      upright.y = MAX( upright.y, edge.mid.y );
+    }
+
+    const double scale = 1.01 * MAX( upright.x - lowleft.x,
+                                     upright.y - lowleft.y )
+                       + INCOMFLOW_SMALL;
+
+    Tree qtree { scale, qtree_items, 25, 0.5 * ( lowleft + upright ) };
+
+    for ( auto& edge : edges )
+      if ( !qtree.add( &edge ) )
+      {
+        LOG(ERROR) << "WallDistance: Failed to insert wall edge at ("
+                   << edge.mid.x << ", " << edge.mid.y << ").";
+        TERMINATE();
+      }
+
+    flatten( qtree );
+
+  } // build_tree()
+
+  /*------------------------------------------------------------------
+  | Copy the non-empty quads below quad into the node array and
+  | return the index of its node
+  ------------------------------------------------------------------*/
+  int flatten(const Tree& quad)
+  {
+    const int id = static_cast<int>( nodes_.size() );
+    nodes_.push_back( {} );
+
+    Node node {};
+
+    if ( !quad.split() )
+    {
+      node.begin = static_cast<int>( segments_.size() );
+
+      for ( const WallEdge* edge : quad.items() )
+      {
+        segments_.push_back( { edge->v, edge->w } );
+        node.extend( edge->v );
+        node.extend( edge->w );
+      }
+
+      node.end = static_cast<int>( segments_.size() );
+    }
+    else
+    {
+      IVec kids {};
+
+      for ( const Tree* child : quad.children() )
+        if ( child->size() > 0 )
+          kids.push_back( flatten( *child ) );
+
+      ASSERT( kids.size() <= 4,
+        "WallDistance: Quadtree node with more than four children." );
+
+      node.begin = static_cast<int>( children_.size() );
+
+      for ( int kid : kids )
+      {
+        children_.push_back( kid );
+        node.extend( { nodes_[kid].lo_x, nodes_[kid].lo_y } );
+        node.extend( { nodes_[kid].hi_x, nodes_[kid].hi_y } );
+      }
+
+      node.end  = static_cast<int>( children_.size() );
+      node.leaf = false;
+    }
+
+    nodes_[id] = node;
+
+    return id;
+
+  } // flatten()
+
+  /*------------------------------------------------------------------
+  | Branch-and-bound search for the closest wall edge below a node
+  ------------------------------------------------------------------*/
+  void closest_edge(int id, const Vec2d& p, double& dist_sqr) const
+  {
+    const Node& node = nodes_[id];
+
+    if ( node.leaf )
+    {
+      for ( int e = node.begin; e < node.end; ++e )
+        dist_sqr = MIN( dist_sqr, vertex_edge_dist_sqr(
+          p, segments_[e].first, segments_[e].second ) );
+      return;
+    }
+
+    // Visit the children in the order of their distance, where
+    // inner nodes of the quadtree have at most four children.
+    // They are sorted by insertion, which keeps all accesses
+    // within the fixed bound of the array.
+    std::array<std::pair<double,int>,4> kids {};
+    const int n_kids = MIN( node.end - node.begin, 4 );
+
+    for ( int c = 0; c < n_kids; ++c )
+    {
+      const int    kid = children_[ node.begin + c ];
+      const double d2  = nodes_[kid].dist_sqr( p );
+
+      int pos = c;
+
+      for ( ; pos > 0 && kids[pos-1].first > d2; --pos )
+        kids[pos] = kids[pos-1];
+
+      kids[pos] = { d2, kid };
+    }
+
+    for ( int c = 0; c < n_kids && kids[c].first < dist_sqr; ++c )
+      closest_edge( kids[c].second, p, dist_sqr );
+
+  } // closest_edge()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  const DualGrid&        dgrid_;
+
+  std::vector<Node>      nodes_;
+  IVec                   children_;
+  std::vector<std::pair<Vec2d,Vec2d>> segments_;
+
+  DVec                   distances_;
+  double                 build_time_ { 0.0 };
+  double                 query_time_ { 0.0 };
+
+}; // WallDistance
+
+} // namespace Solver
+} // namespace IncomFlow
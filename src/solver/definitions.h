@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "Matrix.h"
+#include "ThreadPool.h"
 
 namespace IncomFlow {
 namespace Solver {
@@ -23,8 +24,8 @@ using namespace CppUtils;
 using DVec = std::vector<double>;
 using IVec = std::vector<int>;
 
-using DMat = Matrix<double>;
-using IMat = Matrix<int>;
+using DMat = Matrix<double, DefaultInitAllocator<double>>;
+using IMat = Matrix<int, DefaultInitAllocator<int>>;
 
 
 /*********************************************************************
@@ -32,6 +33,16 @@ using IMat = Matrix<int>;
 *********************************************************************/
 constexpr size_t N_MAX_VARS { 100 }; 
 
+/*********************************************************************
+* Flow variables of the artificial compressibility formulation,
+* stored column-wise in the solution matrices
+*********************************************************************/
+constexpr int N_FLOW_VARS { 3 };
+
+constexpr int IP { 0 }; // Pressure
+constexpr int IU { 1 }; // Velocity x-component
+constexpr int IV { 2 }; // Velocity y-component
+
 /*********************************************************************
 * All available boundary types
 *********************************************************************/
@@ -13,7 +13,10 @@
 #include <limits.h>
 #include <cstdlib>
 
+#include "Log.h"
 #include "Helpers.h"
+#include "ParaReader.h"
+#include "ThreadPool.h"
 
 namespace IncomFlow {
 namespace Solver {
@@ -33,29 +36,28 @@ public:
   /*------------------------------------------------------------------
   | Setters 
   ------------------------------------------------------------------*/
-  inline void dummy(double s)  
-  { dummy_ = s; }
+  inline void viscosity(double s)  
+  { viscosity_ = s; }
+
+  inline void art_compressibility(double s)  
+  { art_compressibility_ = s; }
 
   /*------------------------------------------------------------------
   | Getters 
   ------------------------------------------------------------------*/
-  inline double dummy() const 
-  { return dummy_; }
+  inline double viscosity() const 
+  { return viscosity_; }
 
-  inline double dummy_fixed() const 
-  { return dummy_fixed_; }
+  inline double art_compressibility() const 
+  { return art_compressibility_; }
 
 
 private:
   /*------------------------------------------------------------------
   | Adjustable attributes 
   ------------------------------------------------------------------*/
-  double dummy_  = 0.0;
-
-  /*------------------------------------------------------------------
-  | Fixed attributes 
-  ------------------------------------------------------------------*/
-  int dummy_fixed_ = 0.0;
+  double viscosity_           = 1.0E-3;
+  double art_compressibility_ = 1.0;
 
 }; // SolverConstants
 
@@ -77,5 +79,44 @@ inline void TERMINATE()
   std::exit(EXIT_FAILURE);
 }
 
+/*********************************************************************
+* Set up the global thread pool from a parameter file, which may 
+* contain the following entries:
+*
+*   Number of threads:    4     # 0 -> all available cores
+*   Pin threads:          1     # Bind worker threads to cores
+*   Parallel grain size:  1024  # Minimum number of loop indices
+*                               # per parallel task
+*********************************************************************/
+inline void init_thread_pool(const std::string& file_path)
+{
+  ParaBlock reader { file_path };
+
+  reader.new_scalar_parameter<int>("n_threads",   "Number of threads:");
+  reader.new_scalar_parameter<int>("pin_threads", "Pin threads:");
+  reader.new_scalar_parameter<int>("grain_size",  "Parallel grain size:");
+
+  if ( reader.query<int>("pin_threads") )
+    THREAD_POOL.pin_threads( reader.get_value<int>("pin_threads") > 0 );
+
+  if ( reader.query<int>("grain_size") )
+    THREAD_POOL.grain_size( reader.get_value<int>("grain_size") );
+
+  if ( reader.query<int>("n_threads") )
+  {
+    int n_threads = reader.get_value<int>("n_threads");
+
+    if ( n_threads < 1 )
+      n_threads = static_cast<int>( std::thread::hardware_concurrency() );
+
+    THREAD_POOL.n_threads( n_threads );
+  }
+
+  LOG(INFO) << "Thread pool: " << THREAD_POOL.n_threads() << " threads"
+            << ( THREAD_POOL.pin_threads() ? " (pinned)" : "" )
+            << ", grain size " << THREAD_POOL.grain_size();
+
+} // init_thread_pool()
+
 } // namespace Solver
 } // namespace IncomFlow 
@@ -48,6 +48,111 @@ int run_tests(const std::string& test_case)
     LOG(INFO) << "  Running tests for \"DualGrid\" class...";
     run_tests_DualGrid();
   }
+  else if ( !test_case.compare("RungeKutta") )
+  {
+    LOG(INFO) << "  Running tests for \"RungeKutta\" class...";
+    run_tests_RungeKutta();
+  }
+  else if ( !test_case.compare("FractionalStep") )
+  {
+    LOG(INFO) << "  Running tests for \"FractionalStep\" class...";
+    run_tests_FractionalStep();
+  }
+  else if ( !test_case.compare("DualTimeStepping") )
+  {
+    LOG(INFO) << "  Running tests for \"DualTimeStepping\" class...";
+    run_tests_DualTimeStepping();
+  }
+  else if ( !test_case.compare("NewtonKrylov") )
+  {
+    LOG(INFO) << "  Running tests for \"NewtonKrylov\" class...";
+    run_tests_NewtonKrylov();
+  }
+  else if ( !test_case.compare("ThreadPool") )
+  {
+    LOG(INFO) << "  Running tests for \"ThreadPool\" class...";
+    run_tests_ThreadPool();
+  }
+  else if ( !test_case.compare("GraphPartitioner") )
+  {
+    LOG(INFO) << "  Running tests for \"GraphPartitioner\" class...";
+    run_tests_GraphPartitioner();
+  }
+  else if ( !test_case.compare("DomainDecomposition") )
+  {
+    LOG(INFO) << "  Running tests for \"DomainDecomposition\" class...";
+    run_tests_DomainDecomposition();
+  }
+  else if ( !test_case.compare("EdgeColoring") )
+  {
+    LOG(INFO) << "  Running tests for \"EdgeColoring\" class...";
+    run_tests_EdgeColoring();
+  }
+  else if ( !test_case.compare("Reconstruction") )
+  {
+    LOG(INFO) << "  Running tests for \"Reconstruction\" class...";
+    run_tests_Reconstruction();
+  }
+  else if ( !test_case.compare("BoundaryConditions") )
+  {
+    LOG(INFO) << "  Running tests for \"BoundaryConditions\" class...";
+    run_tests_BoundaryConditions();
+  }
+  else if ( !test_case.compare("PeriodicBoundaries") )
+  {
+    LOG(INFO) << "  Running tests for \"PeriodicBoundaries\" class...";
+    run_tests_PeriodicBoundaries();
+  }
+  else if ( !test_case.compare("WallDistance") )
+  {
+    LOG(INFO) << "  Running tests for \"WallDistance\" class...";
+    run_tests_WallDistance();
+  }
+  else if ( !test_case.compare("PoolContainer") )
+  {
+    LOG(INFO) << "  Running tests for \"PoolContainer\" class...";
+    run_tests_PoolContainer();
+  }
+  else if ( !test_case.compare("LinearQuadTree") )
+  {
+    LOG(INFO) << "  Running tests for \"LinearQuadTree\" class...";
+    run_tests_LinearQuadTree();
+  }
+  else if ( !test_case.compare("PointLocator") )
+  {
+    LOG(INFO) << "  Running tests for \"PointLocator\" class...";
+    run_tests_PointLocator();
+  }
+  else if ( !test_case.compare("ConcurrentQuadTree") )
+  {
+    LOG(INFO) << "  Running tests for \"ConcurrentQuadTree\" class...";
+    run_tests_ConcurrentQuadTree();
+  }
+  else if ( !test_case.compare("Geometry") )
+  {
+    LOG(INFO) << "  Running tests for \"Geometry\" class...";
+    run_tests_Geometry();
+  }
+  else if ( !test_case.compare("GridValidator") )
+  {
+    LOG(INFO) << "  Running tests for \"GridValidator\" class...";
+    run_tests_GridValidator();
+  }
+  else if ( !test_case.compare("Log") )
+  {
+    LOG(INFO) << "  Running tests for \"Log\" class...";
+    run_tests_Log();
+  }
+  else if ( !test_case.compare("Profiler") )
+  {
+    LOG(INFO) << "  Running tests for \"Profiler\" class...";
+    run_tests_Profiler();
+  }
+  else if ( !test_case.compare("Performance") )
+  {
+    LOG(INFO) << "  Running tests for \"Performance\" class...";
+    run_tests_Performance();
+  }
   else
   {
     LOG(INFO) << "";
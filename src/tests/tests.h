@@ -20,3 +20,24 @@ int run_tests(const std::string& library);
 *********************************************************************/
 void run_tests_PrimaryGrid();
 void run_tests_DualGrid();
+void run_tests_RungeKutta();
+void run_tests_FractionalStep();
+void run_tests_DualTimeStepping();
+void run_tests_NewtonKrylov();
+void run_tests_ThreadPool();
+void run_tests_GraphPartitioner();
+void run_tests_DomainDecomposition();
+void run_tests_EdgeColoring();
+void run_tests_Reconstruction();
+void run_tests_BoundaryConditions();
+void run_tests_PeriodicBoundaries();
+void run_tests_WallDistance();
+void run_tests_PoolContainer();
+void run_tests_LinearQuadTree();
+void run_tests_PointLocator();
+void run_tests_ConcurrentQuadTree();
+void run_tests_Geometry();
+void run_tests_GridValidator();
+void run_tests_Log();
+void run_tests_Profiler();
+void run_tests_Performance();
@@ -0,0 +1,329 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "BoundaryConditions.h"
+#include "EdgeResidual.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace BoundaryConditionsTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void boundary_states()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: boundary_states() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::SYMMETRY );
+  bdry_def.add_marker( 2, BdryType::OUTLET   );
+  bdry_def.add_marker( 3, BdryType::WALL     );
+  bdry_def.add_marker( 4, BdryType::INLET    );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 20, 16 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + x * y;
+    U[i][IU] = 0.5 + y;
+    U[i][IV] = 0.2 - x;
+  }
+
+  BoundaryConditions bc { dgrid };
+  bc.values( 2, { 0.3, 0.0, 0.0 } );
+  bc.values( 3, { 0.0, 0.4, 0.3 } );
+  bc.values( 4, { 0.0, 1.5, 0.1 } );
+
+  CHECK( bc.values( 4 ).u == 1.5 );
+  CHECK( bc.values( 1 ).u == 0.0 );
+
+  bc.apply( U );
+
+  const double beta2 = CONSTANTS.art_compressibility();
+
+  for ( const auto& bdry : dgrid.boundaries() )
+  {
+    const BoundaryData& data = bdry.bdry_data();
+
+    for ( int e = 0; e < bdry.n_dual_elements(); ++e )
+    {
+      const int    i  = bdry.dual_elements()[e];
+      const double nx = -bdry.dual_normals()[e][0];
+      const double ny = -bdry.dual_normals()[e][1];
+
+      const double ub[N_FLOW_VARS] = { data.var(IP)[e],
+                                       data.var(IU)[e],
+                                       data.var(IV)[e] };
+
+      // Fluxes are the physical fluxes of the boundary states,
+      // walls add the viscous shear flux
+      double f[N_FLOW_VARS];
+      physical_flux( ub, nx, ny, beta2, f );
+
+      if ( bdry.type() == BdryType::WALL )
+      {
+        const double kv = wall_viscous_coefficient(
+          nx, ny, dgrid.volumes()[i], CONSTANTS.viscosity() );
+
+        f[IU] -= kv * ( ub[IU] - U[i][IU] );
+        f[IV] -= kv * ( ub[IV] - U[i][IV] );
+      }
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        CHECK( std::fabs( data.mflux(k)[e] - f[k] ) < 1.0E-14 );
+
+      switch ( bdry.type() )
+      {
+        case BdryType::INLET:
+          CHECK( ub[IP] == U[i][IP] );
+          CHECK( ub[IU] == 1.5 && ub[IV] == 0.1 );
+          break;
+
+        case BdryType::OUTLET:
+          CHECK( ub[IP] == 0.3 );
+          CHECK( ub[IU] == U[i][IU] && ub[IV] == U[i][IV] );
+          break;
+
+        case BdryType::WALL:
+        {
+          // Only the tangential wall velocity is imposed
+          const double len = std::sqrt( nx*nx + ny*ny );
+          const double ex  = nx / len;
+          const double ey  = ny / len;
+
+          CHECK( ub[IP] == U[i][IP] );
+          CHECK( std::fabs( ub[IU] * ex + ub[IV] * ey ) < 1.0E-14 );
+          CHECK( std::fabs( ub[IV] * ex - ub[IU] * ey
+                          - ( 0.3 * ex - 0.4 * ey ) ) < 1.0E-14 );
+          CHECK( std::fabs( data.mflux(IP)[e] ) < 1.0E-14 );
+          break;
+        }
+
+        default:
+        {
+          // No mass flux through symmetry planes
+          CHECK( ub[IP] == U[i][IP] );
+          CHECK( std::fabs( ub[IU] * nx + ub[IV] * ny ) < 1.0E-14 );
+          CHECK( std::fabs( data.mflux(IP)[e] ) < 1.0E-14 );
+        }
+      }
+    }
+  }
+
+  // Timings of all present boundary types
+  for ( BdryType type : { BdryType::INLET, BdryType::OUTLET,
+                          BdryType::WALL, BdryType::SYMMETRY } )
+    CHECK( bc.type_time( type ) > 0.0 );
+
+  CHECK( bc.type_time( BdryType::PERIODIC ) == 0.0 );
+
+  bc.reset_timings();
+  CHECK( bc.type_time( BdryType::INLET ) == 0.0 );
+
+} // boundary_states()
+
+/*********************************************************************
+*
+*********************************************************************/
+void free_stream()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: free_stream() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::SYMMETRY );
+  bdry_def.add_marker( 2, BdryType::OUTLET   );
+  bdry_def.add_marker( 3, BdryType::SYMMETRY );
+  bdry_def.add_marker( 4, BdryType::INLET    );
+
+  for ( int mixed = 0; mixed < 2; ++mixed )
+  {
+    PrimaryGrid primgrid = ( mixed )
+      ? GridGenerator::unstructured( 24, 18 )
+      : GridGenerator::structured( 24, 18 );
+
+    DualGrid dgrid { primgrid, bdry_def };
+
+    const int n_elements = dgrid.n_elements();
+
+    DMat U ( n_elements, N_FLOW_VARS );
+
+    for ( int i = 0; i < n_elements; ++i )
+    {
+      U[i][IP] = 0.5;
+      U[i][IU] = 1.0;
+      U[i][IV] = 0.0;
+    }
+
+    BoundaryConditions bc { dgrid };
+    bc.values( 2, { 0.5, 0.0, 0.0 } );
+    bc.values( 4, { 0.0, 1.0, 0.0 } );
+
+    // Boundary conditions, which match a uniform flow, preserve it
+    EdgeResidual residual { dgrid };
+    residual.boundary_conditions( bc );
+
+    DMat R ( n_elements, N_FLOW_VARS );
+    residual.compute( U, R );
+
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        CHECK( std::fabs( R[i][k] ) < 1.0E-12 );
+
+    // A different outlet pressure drives the flow
+    bc.values( 2, { 0.0, 0.0, 0.0 } );
+    residual.compute( U, R );
+
+    double r_norm = 0.0;
+    for ( int i = 0; i < n_elements; ++i )
+      r_norm += std::fabs( R[i][IU] );
+
+    CHECK( r_norm > 1.0E-3 );
+  }
+
+} // free_stream()
+
+/*********************************************************************
+*
+*********************************************************************/
+void moving_wall()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: moving_wall() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 20, 16 );
+
+  // Residual of the upper boundary 3 with the given type and values
+  auto compute_residual = [&](BdryType type, const BdryValues& val)
+  {
+    BoundaryDef bdry_def {};
+    bdry_def.add_marker( 1, BdryType::WALL );
+    bdry_def.add_marker( 2, BdryType::WALL );
+    bdry_def.add_marker( 3, type           );
+    bdry_def.add_marker( 4, BdryType::WALL );
+
+    DualGrid dgrid { primgrid, bdry_def };
+
+    DMat U ( dgrid.n_elements(), N_FLOW_VARS );
+
+    for ( int i = 0; i < dgrid.n_elements(); ++i )
+    {
+      U[i][IP] = 1.0;
+      U[i][IU] = 0.2 * dgrid.coords()[i][1];
+      U[i][IV] = 0.0;
+    }
+
+    BoundaryConditions bc { dgrid };
+    bc.values( 3, val );
+
+    EdgeResidual residual { dgrid };
+    residual.boundary_conditions( bc );
+
+    DMat R ( dgrid.n_elements(), N_FLOW_VARS );
+    residual.compute( U, R );
+
+    return R;
+  };
+
+  const DMat R_moving = compute_residual( BdryType::WALL,
+                                          { 0.0, 0.4, 0.0 } );
+  const DMat R_still  = compute_residual( BdryType::WALL, {} );
+  const DMat R_slip   = compute_residual( BdryType::SYMMETRY, {} );
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::WALL );
+  bdry_def.add_marker( 2, BdryType::WALL );
+  bdry_def.add_marker( 3, BdryType::WALL );
+  bdry_def.add_marker( 4, BdryType::WALL );
+
+  DualGrid dgrid { primgrid, bdry_def };
+
+  int n_wall = 0;
+
+  for ( const auto& bdry : dgrid.boundaries() )
+  {
+    if ( bdry.marker() != 3 )
+      continue;
+
+    for ( int i : bdry.dual_elements() )
+    {
+      ++n_wall;
+
+      // The moving wall drags the fluid along, while the still
+      // wall slows it down compared to a slip wall
+      CHECK( R_moving[i][IU] < R_still[i][IU] );
+      CHECK( R_still[i][IU] > R_slip[i][IU] );
+
+      // No mass flux in any case
+      CHECK( EQ( R_moving[i][IP], R_still[i][IP] ) );
+      CHECK( EQ( R_still[i][IP], R_slip[i][IP] ) );
+    }
+  }
+
+  CHECK( n_wall > 0 );
+
+} // moving_wall()
+
+} // namespace BoundaryConditionsTests
+
+
+/*********************************************************************
+* Run tests for: BoundaryConditions.h
+*********************************************************************/
+void run_tests_BoundaryConditions()
+{
+  // Set logging output file
+  std::string log_file_path
+  { BoundaryConditionsTests::BASE_DIR + "/aux/test_logs/tests_BoundaryConditions.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  BoundaryConditionsTests::boundary_states();
+  BoundaryConditionsTests::free_stream();
+  BoundaryConditionsTests::moving_wall();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_BoundaryConditions()
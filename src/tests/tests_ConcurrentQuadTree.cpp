@@ -0,0 +1,289 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "ConcurrentQuadTree.h"
+
+namespace ConcurrentQuadTreeTests
+{
+using namespace CppUtils;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Test item
+*********************************************************************/
+struct Point
+{
+  Point(double x, double y, int id) : xy_ { x, y }, id_ { id } {}
+
+  const Vec2d& xy() const { return xy_; }
+  int id() const { return id_; }
+
+  Vec2d xy_;
+  int   id_;
+};
+
+/*********************************************************************
+* Random points in [0,1]^2
+*********************************************************************/
+std::vector<Point> random_points(int n, unsigned seed)
+{
+  std::mt19937 gen { seed };
+  std::uniform_real_distribution<double> coord { 0.0, 1.0 };
+
+  std::vector<Point> points {};
+
+  for ( int i = 0; i < n; ++i )
+    points.emplace_back( coord( gen ), coord( gen ), i );
+
+  return points;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void publish()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: publish() ==========";
+  LOG(INFO) << "";
+
+  std::vector<Point> points = random_points( 2000, 3 );
+
+  ConcurrentQuadTree<Point,double> qtree { 16 };
+
+  CHECK( qtree.size() == 0 );
+  CHECK( qtree.version() == 0 );
+
+  for ( auto& p : points )
+    CHECK( qtree.add( &p ) );
+
+  // Items are neither added twice nor visible before publishing
+  CHECK( !qtree.add( &points[0] ) );
+  CHECK( qtree.n_pending() == points.size() );
+  CHECK( qtree.size() == 0 );
+
+  auto old = qtree.snapshot();
+
+  CHECK( qtree.publish() == 1 );
+  CHECK( qtree.publish() == 1 );
+  CHECK( qtree.size() == points.size() );
+  CHECK( qtree.n_pending() == 0 );
+
+  // Held snapshots are not affected by publishing
+  CHECK( old->size() == 0 );
+
+  // Remove every third item
+  for ( size_t i = 0; i < points.size(); i += 3 )
+    CHECK( qtree.remove( &points[i] ) );
+
+  CHECK( !qtree.remove( &points[0] ) );
+
+  auto before = qtree.snapshot();
+  qtree.publish();
+  auto after = qtree.snapshot();
+
+  CHECK( before->size() == points.size() );
+  CHECK( after->size() == points.size() - ( points.size() + 2 ) / 3 );
+
+  // Queries agree with brute force
+  const Vec2d lowleft { 0.2, 0.3 };
+  const Vec2d upright { 0.6, 0.5 };
+
+  size_t n_brute = 0;
+  for ( size_t i = 0; i < points.size(); ++i )
+    n_brute += ( i % 3 != 0 ) && in_on_rect( points[i].xy(), lowleft, upright );
+
+  size_t n_found = 0;
+  qtree.get_items( lowleft, upright, [&](Point* p)
+  {
+    ++n_found;
+    CHECK( p->id() % 3 != 0 );
+  });
+
+  CHECK( n_found == n_brute );
+
+  size_t n_circle = 0;
+  for ( size_t i = 0; i < points.size(); ++i )
+    n_circle += ( i % 3 != 0 )
+      && ( points[i].xy() - lowleft ).length_squared() < 0.01;
+
+  CHECK( qtree.get_items( lowleft, 0.1, [](Point*) {} ) == n_circle );
+
+} // publish()
+
+/*********************************************************************
+*
+*********************************************************************/
+void concurrent_queries()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: concurrent_queries() ==========";
+  LOG(INFO) << "";
+
+  const int batch     = 500;
+  const int n_batches = 40;
+
+  std::vector<Point> points = random_points( batch * n_batches, 5 );
+
+  ConcurrentQuadTree<Point,double> qtree { 32 };
+
+  std::atomic<bool> done      { false };
+  std::atomic<int>  n_errors  { 0 };
+  std::atomic<int>  n_queries { 0 };
+
+  // Readers query the whole domain and a random window. Every
+  // snapshot contains complete batches of items.
+  auto reader = [&](unsigned seed)
+  {
+    std::mt19937 gen { seed };
+    std::uniform_real_distribution<double> coord { 0.0, 0.8 };
+
+    while ( !done.load() )
+    {
+      auto snapshot = qtree.snapshot();
+      const size_t n = snapshot->size();
+
+      if ( n % batch != 0 )
+        ++n_errors;
+
+      int max_id = -1;
+      const size_t n_all = snapshot->get_items( {0.0,0.0}, {1.0,1.0},
+        [&](Point* p) { max_id = std::max( max_id, p->id() ); });
+
+      if ( n_all != n || max_id != static_cast<int>( n ) - 1 )
+        ++n_errors;
+
+      const Vec2d lowleft { coord( gen ), coord( gen ) };
+      const Vec2d upright = lowleft + 0.2;
+
+      size_t n_brute = 0;
+      for ( size_t i = 0; i < n; ++i )
+        n_brute += in_on_rect( points[i].xy(), lowleft, upright );
+
+      if ( snapshot->get_items( lowleft, upright, [](Point*) {} )
+           != n_brute )
+        ++n_errors;
+
+      ++n_queries;
+    }
+  };
+
+  std::vector<std::thread> readers {};
+
+  for ( unsigned t = 0; t < 3; ++t )
+    readers.emplace_back( reader, t + 1 );
+
+  for ( int b = 0; b < n_batches; ++b )
+  {
+    for ( int i = b * batch; i < (b+1) * batch; ++i )
+      qtree.add( &points[i] );
+
+    qtree.publish();
+    std::this_thread::yield();
+  }
+
+  // Wait for some queries of the final snapshot
+  const int n_before = n_queries.load();
+  while ( n_queries.load() < n_before + 10 )
+    std::this_thread::yield();
+
+  done = true;
+
+  for ( auto& t : readers )
+    t.join();
+
+  CHECK( n_errors.load() == 0 );
+  CHECK( n_queries.load() > 0 );
+  CHECK( qtree.size() == points.size() );
+  CHECK( qtree.version() == n_batches );
+
+} // concurrent_queries()
+
+/*********************************************************************
+*
+*********************************************************************/
+void synchronize()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: synchronize() ==========";
+  LOG(INFO) << "";
+
+  std::vector<Point> points = random_points( 100, 7 );
+
+  ConcurrentQuadTree<Point,double> qtree {};
+
+  for ( auto& p : points )
+    qtree.add( &p );
+
+  qtree.publish();
+
+  // A reader holds the snapshot with all items for a while
+  std::atomic<bool> holding  { false };
+  std::atomic<bool> released { false };
+
+  std::thread reader { [&]()
+  {
+    auto snapshot = qtree.snapshot();
+    holding = true;
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+    released = true;
+  }};
+
+  while ( !holding.load() )
+    std::this_thread::yield();
+
+  qtree.remove( &points[0] );
+  qtree.synchronize();
+
+  // The old snapshot has been released by the reader
+  CHECK( released.load() );
+  CHECK( qtree.size() == points.size() - 1 );
+
+  reader.join();
+
+} // synchronize()
+
+} // namespace ConcurrentQuadTreeTests
+
+
+/*********************************************************************
+* Run tests for: ConcurrentQuadTree.h
+*********************************************************************/
+void run_tests_ConcurrentQuadTree()
+{
+  // Set logging output file
+  std::string log_file_path
+  { ConcurrentQuadTreeTests::BASE_DIR + "/aux/test_logs/tests_ConcurrentQuadTree.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  ConcurrentQuadTreeTests::publish();
+  ConcurrentQuadTreeTests::concurrent_queries();
+  ConcurrentQuadTreeTests::synchronize();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_ConcurrentQuadTree()
@@ -0,0 +1,493 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "Communicator.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "GraphPartitioner.h"
+#include "DomainDecomposition.h"
+#include "SubGridIO.h"
+#include "HaloExchange.h"
+#include "EdgeResidual.h"
+#include "RungeKutta.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace DomainDecompositionTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+constexpr int N_RANKS { 4 };
+
+/*********************************************************************
+* Boundary definition of the generated grids
+*********************************************************************/
+BoundaryDef boundary_definition()
+{
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  return bdry_def;
+}
+
+/*********************************************************************
+* Smooth initial solution
+*********************************************************************/
+void init_solution(double x, double y, double* u)
+{
+  u[IP] = 1.0 + 0.1 * x * y;
+  u[IU] = 1.0 + 0.2 * y * (1.0 - y);
+  u[IV] = 0.1 * x * (1.0 - x);
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void subgrids()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: subgrids() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 24, 20 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  GraphPartitioner partitioner { dgrid };
+  const IVec& parts = partitioner.partition( N_RANKS );
+
+  DomainDecomposition decomp { primgrid, parts, N_RANKS };
+
+  std::vector<SubGrid> subgrids;
+  for ( int rank = 0; rank < N_RANKS; ++rank )
+    subgrids.push_back( decomp.subgrid( rank ) );
+
+  int n_owned = 0;
+  int n_bdry_elements[5] = { 0 };
+
+  for ( const SubGrid& sub : subgrids )
+  {
+    n_owned += sub.n_owned();
+
+    CHECK( sub.n_ghosts() > 0 );
+    CHECK( sub.n_neighbors() > 0 );
+
+    DualGrid local { sub.primary_grid(), bdry_def };
+
+    // The dual elements of all owned vertices are complete
+    for ( int i = 0; i < sub.n_owned(); ++i )
+    {
+      const int g = sub.local_to_global()[i];
+
+      CHECK( parts[g] == sub.rank() );
+      CHECK( EQ( local.volumes()[i], dgrid.volumes()[g] ) );
+    }
+
+    // The boundaries are set up locally
+    CHECK( local.boundaries().size() == 4 );
+
+    for ( const auto& bdry : local.boundaries() )
+      for ( int i : bdry.dual_elements() )
+        if ( i < sub.n_owned() )
+          ++n_bdry_elements[ bdry.marker() ];
+  }
+
+  CHECK( n_owned == dgrid.n_elements() );
+
+  for ( const auto& bdry : dgrid.boundaries() )
+    CHECK( n_bdry_elements[ bdry.marker() ] == bdry.n_dual_elements() );
+
+  // Send lists match the receive lists of the neighbors
+  for ( const SubGrid& p : subgrids )
+    for ( int k = 0; k < p.n_neighbors(); ++k )
+    {
+      const SubGrid& q = subgrids[ p.neighbor_ranks()[k] ];
+
+      int l = 0;
+      while ( l < q.n_neighbors() && q.neighbor_ranks()[l] != p.rank() )
+        ++l;
+
+      CHECK( l < q.n_neighbors() );
+
+      const IVec& send = p.send_elements()[k];
+      const IVec& recv = q.recv_elements()[l];
+
+      CHECK( send.size() == recv.size() );
+
+      for ( std::size_t i = 0; i < send.size(); ++i )
+      {
+        CHECK( send[i] < p.n_owned() );
+        CHECK( recv[i] >= q.n_owned() );
+        CHECK( p.local_to_global()[send[i]]
+            == q.local_to_global()[recv[i]] );
+      }
+    }
+
+} // subgrids()
+
+/*********************************************************************
+*
+*********************************************************************/
+void subgrid_files()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: subgrid_files() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 24, 20 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  GraphPartitioner partitioner { dgrid };
+  const IVec& parts = partitioner.partition( N_RANKS );
+
+  DomainDecomposition decomp { primgrid, parts, N_RANKS };
+
+  const std::string prefix {
+    ( std::filesystem::temp_directory_path() / "incomflow_subgrid" ).string() };
+
+  SubGridWriter writer {};
+  CHECK( writer.write( decomp, prefix ) );
+
+  auto equal = [](const auto& a, const auto& b)
+  {
+    if ( a.rows() != b.rows() || a.columns() != b.columns() )
+      return false;
+
+    for ( int i = 0; i < a.rows(); ++i )
+      for ( int j = 0; j < a.columns(); ++j )
+        if ( a[i][j] != b[i][j] )
+          return false;
+
+    return true;
+  };
+
+  for ( int rank = 0; rank < N_RANKS; ++rank )
+  {
+    const SubGrid ref = decomp.subgrid( rank );
+
+    SubGridReader reader {};
+    const SubGrid sub = reader.read( prefix, rank, N_RANKS );
+
+    std::remove( subgrid_file_path( prefix, rank ).c_str() );
+
+    CHECK( reader.n_parts() == N_RANKS );
+    CHECK( reader.n_global_vertices() == primgrid.n_vertices() );
+
+    CHECK( sub.rank() == rank );
+    CHECK( sub.n_owned() == ref.n_owned() );
+    CHECK( sub.n_ghosts() == ref.n_ghosts() );
+    CHECK( sub.local_to_global() == ref.local_to_global() );
+    CHECK( sub.neighbor_ranks() == ref.neighbor_ranks() );
+    CHECK( sub.send_elements() == ref.send_elements() );
+    CHECK( sub.recv_elements() == ref.recv_elements() );
+
+    const PrimaryGrid& a = sub.primary_grid();
+    const PrimaryGrid& b = ref.primary_grid();
+
+    CHECK( equal( a.vertex_coords(), b.vertex_coords() ) );
+    CHECK( equal( a.tris(), b.tris() ) );
+    CHECK( equal( a.quads(), b.quads() ) );
+    CHECK( equal( a.tri_neighbors(), b.tri_neighbors() ) );
+    CHECK( equal( a.quad_neighbors(), b.quad_neighbors() ) );
+    CHECK( equal( a.intr_edges(), b.intr_edges() ) );
+    CHECK( equal( a.intr_edge_neighbors(), b.intr_edge_neighbors() ) );
+    CHECK( equal( a.bdry_edges(), b.bdry_edges() ) );
+    CHECK( a.bdry_edge_neighbors() == b.bdry_edge_neighbors() );
+    CHECK( a.bdry_edge_markers() == b.bdry_edge_markers() );
+
+    // The loaded sub-grid yields the same local dual grid
+    DualGrid local { a, bdry_def };
+
+    for ( int i = 0; i < sub.n_owned(); ++i )
+      CHECK( EQ( local.volumes()[i],
+                 dgrid.volumes()[ sub.local_to_global()[i] ] ) );
+  }
+
+} // subgrid_files()
+
+/*********************************************************************
+*
+*********************************************************************/
+void distributed_residual()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: distributed_residual() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 30, 26 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  GraphPartitioner partitioner { dgrid };
+  const IVec& parts = partitioner.partition( N_RANKS );
+
+  DomainDecomposition decomp { primgrid, parts, N_RANKS };
+
+  // -----------------------------------------------------------------
+  // Serial reference
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+    init_solution( dgrid.coords()[i][0], dgrid.coords()[i][1], U[i] );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  EdgeResidual residual { dgrid };
+  residual.compute( U, R );
+
+  double res_norm = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      res_norm += R[i][k] * R[i][k];
+  res_norm = std::sqrt( res_norm );
+
+  const int    n_steps = 5;
+  const double dt      = 1.0E-3;
+
+  DMat U_steps { U };
+  RungeKutta rk { RKScheme::LSRK4, n_elements, N_FLOW_VARS };
+
+  for ( int n = 0; n < n_steps; ++n )
+    rk.step( U_steps, dgrid.volumes(), dt,
+             [&](const DMat& u, DMat& r) { residual.compute( u, r ); } );
+
+  // -----------------------------------------------------------------
+  // Distributed run on local processes
+  const bool success = run_local_ranks( N_RANKS, [&](Communicator& comm)
+  {
+    SubGrid  sub = decomp.subgrid( comm.rank() );
+    DualGrid local { sub.primary_grid(), bdry_def };
+
+    HaloExchange halo { sub, local, comm };
+    EdgeResidual local_residual { local };
+
+    const int   n_local = local.n_elements();
+    const IVec& l2g     = sub.local_to_global();
+
+    // Ghost rows are only known after the exchange
+    DMat U_local ( n_local, N_FLOW_VARS );
+
+    for ( int i = 0; i < n_local; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        U_local[i][k] = ( i < sub.n_owned() ) ? U[ l2g[i] ][k] : 1.0E+10;
+
+    DMat R_local ( n_local, N_FLOW_VARS );
+    local_residual.compute( U_local, R_local, halo );
+
+    const double local_norm = halo.norm( R_local );
+
+    // Assemble the global residual on every rank
+    DVec R_global ( n_elements * N_FLOW_VARS, 0.0 );
+
+    for ( int i = 0; i < sub.n_owned(); ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        R_global[ l2g[i]*N_FLOW_VARS + k ] = R_local[i][k];
+
+    comm.all_reduce_sum( R_global.data(), n_elements * N_FLOW_VARS );
+
+    // Explicit time steps with repeated halo exchanges
+    RungeKutta local_rk { RKScheme::LSRK4, n_local, N_FLOW_VARS };
+
+    for ( int n = 0; n < n_steps; ++n )
+      local_rk.step( U_local, local.volumes(), dt,
+        [&](DMat& u, DMat& r) { local_residual.compute( u, r, halo ); } );
+
+    DVec U_global ( n_elements * N_FLOW_VARS, 0.0 );
+
+    for ( int i = 0; i < sub.n_owned(); ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        U_global[ l2g[i]*N_FLOW_VARS + k ] = U_local[i][k];
+
+    comm.all_reduce_sum( U_global.data(), n_elements * N_FLOW_VARS );
+
+    comm.barrier();
+
+    // Rank 0 is the calling process of the test suite
+    if ( comm.rank() != 0 )
+      return;
+
+    CHECK( comm.size() == N_RANKS );
+    CHECK( std::fabs( local_norm - res_norm ) < 1.0E-12 * res_norm );
+
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+      {
+        CHECK( EQ( R_global[i*N_FLOW_VARS+k], R[i][k] ) );
+        CHECK( EQ( U_global[i*N_FLOW_VARS+k], U_steps[i][k] ) );
+      }
+  });
+
+  CHECK( success );
+
+} // distributed_residual()
+
+/*********************************************************************
+*
+*********************************************************************/
+void shared_memory_communicator()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: shared_memory_communicator() ==========";
+  LOG(INFO) << "";
+
+  // Messages exceed the channel capacity and are sent in chunks
+  const int n_ranks  = 3;
+  const int count    = 1000;
+  const int capacity = 64;
+
+  const bool success = run_local_ranks( n_ranks, [&](Communicator& comm)
+  {
+    const int rank = comm.rank();
+    const int next = ( rank + 1 ) % n_ranks;
+    const int prev = ( rank + n_ranks - 1 ) % n_ranks;
+
+    DVec send_a ( count ), send_b ( count );
+    DVec recv_a ( count ), recv_b ( count );
+
+    for ( int i = 0; i < count; ++i )
+    {
+      send_a[i] = rank * count + i;
+      send_b[i] = -send_a[i];
+    }
+
+    // Two messages per pair are matched in posting order
+    comm.isend( next, send_a.data(), count );
+    comm.isend( next, send_b.data(), count );
+    comm.irecv( prev, recv_a.data(), count );
+    comm.irecv( prev, recv_b.data(), count );
+    comm.wait_all();
+
+    bool valid = true;
+    for ( int i = 0; i < count; ++i )
+      valid &= ( recv_a[i] == prev * count + i )
+            && ( recv_b[i] == -( prev * count + i ) );
+
+    const double n_valid = comm.all_reduce_sum( valid ? 1.0 : 0.0 );
+    const double max_rank = comm.all_reduce_max( rank );
+
+    if ( rank == 0 )
+    {
+      CHECK( n_valid == n_ranks );
+      CHECK( max_rank == n_ranks - 1 );
+    }
+
+  }, capacity );
+
+  CHECK( success );
+
+  // Messages, which fit into a slot, are transferred when they are
+  // posted: The receiver finds the data before calling wait_all()
+  const bool eager = run_local_ranks( 2, [&](Communicator& comm)
+  {
+    double buffer[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+    if ( comm.rank() == 0 )
+    {
+      const double message[4] = { 1.0, 2.0, 3.0, 4.0 };
+      comm.isend( 1, message, 4 );
+      comm.barrier();
+      comm.wait_all();
+    }
+    else
+    {
+      comm.barrier();
+      comm.irecv( 0, buffer, 4 );
+    }
+
+    const bool posted = ( comm.rank() == 0 )
+                     || ( buffer[0] == 1.0 && buffer[3] == 4.0 );
+
+    comm.wait_all();
+
+    const double n_posted = comm.all_reduce_sum( posted ? 1.0 : 0.0 );
+
+    if ( comm.rank() == 0 )
+      CHECK( n_posted == 2.0 );
+
+  }, capacity );
+
+  CHECK( eager );
+
+  // An exception of rank 0 kills and reaps the ranks, which wait
+  // in the barrier
+  bool thrown = false;
+
+  try
+  {
+    run_local_ranks( n_ranks, [&](Communicator& comm)
+    {
+      if ( comm.rank() == 0 )
+        throw std::runtime_error( "rank 0 failed" );
+
+      comm.barrier();
+    });
+  }
+  catch ( const std::runtime_error& )
+  {
+    thrown = true;
+  }
+
+  CHECK( thrown );
+  CHECK( waitpid( -1, nullptr, WNOHANG ) == -1 );
+
+} // shared_memory_communicator()
+
+} // namespace DomainDecompositionTests
+
+
+/*********************************************************************
+* Run tests for: DomainDecomposition.h
+*********************************************************************/
+void run_tests_DomainDecomposition()
+{
+  // Set logging output file
+  std::string log_file_path
+  { DomainDecompositionTests::BASE_DIR + "/aux/test_logs/tests_DomainDecomposition.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  DomainDecompositionTests::subgrids();
+  DomainDecompositionTests::subgrid_files();
+  DomainDecompositionTests::shared_memory_communicator();
+  DomainDecompositionTests::distributed_residual();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_DomainDecomposition()
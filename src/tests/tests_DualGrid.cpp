@@ -14,6 +14,7 @@
 #include "tests.h"
 
 #include "Testing.h"
+#include "MathUtility.h"
 
 #include "PrimaryGrid.h"
 #include "PrimaryGridReader.h"
@@ -188,6 +189,126 @@ void boundaries()
 
 } // boundaries()
 
+/*********************************************************************
+*
+*********************************************************************/
+void metrics()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: metrics() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path 
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  // -----------------------------------------------------------------
+  // The dual elements must cover the unit square
+  double total_volume = 0.0;
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+  {
+    CHECK( dualgrid.volumes()[i] > 0.0 );
+    total_volume += dualgrid.volumes()[i];
+  }
+
+  CHECK( EQ(total_volume, 1.0) );
+
+  // Corner and interior dual elements of the uniform quad region
+  CHECK( EQ(dualgrid.volumes()[0], 0.015625) );
+  CHECK( EQ(dualgrid.volumes()[1], 0.03125) );
+
+  CHECK( EQ(dualgrid.coords()[5][0], 1.0) );
+  CHECK( EQ(dualgrid.coords()[5][1], 0.25) );
+
+  // -----------------------------------------------------------------
+  // Face normals point from the first to the second neighbor
+  for ( int i_face = 0; i_face < dualgrid.n_intr_faces(); ++i_face )
+  {
+    const int i = dualgrid.face_neighbors()[i_face][0];
+    const int j = dualgrid.face_neighbors()[i_face][1];
+
+    const double dx = dualgrid.coords()[j][0] - dualgrid.coords()[i][0];
+    const double dy = dualgrid.coords()[j][1] - dualgrid.coords()[i][1];
+
+    CHECK( dualgrid.face_normals()[i_face][0] * dx 
+         + dualgrid.face_normals()[i_face][1] * dy > 0.0 );
+  }
+
+  // Face 0 connects vertex 17 and vertex 2 
+  CHECK( dualgrid.face_neighbors()[0][0] == 17 );
+  CHECK( dualgrid.face_neighbors()[0][1] == 2 );
+  CHECK( EQ(dualgrid.face_normals()[0][0], 0.0) );
+  CHECK( EQ(dualgrid.face_normals()[0][1], -0.25) );
+
+  // -----------------------------------------------------------------
+  // All dual elements must be closed
+  DMat normal_sum ( dualgrid.n_elements(), 2 );
+
+  for ( int i_face = 0; i_face < dualgrid.n_intr_faces(); ++i_face )
+  {
+    const int i = dualgrid.face_neighbors()[i_face][0];
+    const int j = dualgrid.face_neighbors()[i_face][1];
+
+    for ( int k = 0; k < 2; ++k )
+    {
+      normal_sum[i][k] += dualgrid.face_normals()[i_face][k];
+      normal_sum[j][k] -= dualgrid.face_normals()[i_face][k];
+    }
+  }
+
+  for ( const auto& bdry : dualgrid.boundaries() )
+    for ( int i = 0; i < bdry.n_dual_elements(); ++i )
+      for ( int k = 0; k < 2; ++k )
+        normal_sum[bdry.dual_elements()[i]][k] 
+          -= bdry.dual_normals()[i][k];
+
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+  {
+    CHECK( EQ0(normal_sum[i][0]) );
+    CHECK( EQ0(normal_sum[i][1]) );
+  }
+
+  // -----------------------------------------------------------------
+  // Element adjacency 
+  const IVec& offsets  = dualgrid.adj_offsets();
+  const IVec& adjacent = dualgrid.adj_elements();
+  const IVec& faces    = dualgrid.adj_faces();
+
+  CHECK( static_cast<int>( offsets.size() ) == dualgrid.n_elements() + 1 );
+  CHECK( offsets.back() == 2 * dualgrid.n_intr_faces() );
+
+  // Corner element 0 is adjacent to elements 1 and 15
+  CHECK( offsets[1] - offsets[0] == 2 );
+
+  // Interior element 19 is adjacent to 3, 18, 20, 17, 21 and 23
+  CHECK( offsets[20] - offsets[19] == 6 );
+
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+    for ( int a = offsets[i]; a < offsets[i+1]; ++a )
+    {
+      const int f = faces[a];
+      const int j = adjacent[a];
+
+      CHECK( ( dualgrid.face_neighbors()[f][0] == i &&
+               dualgrid.face_neighbors()[f][1] == j ) ||
+             ( dualgrid.face_neighbors()[f][0] == j &&
+               dualgrid.face_neighbors()[f][1] == i ) );
+    }
+
+} // metrics()
+
 } // namespace DualGridTests
 
 
@@ -203,6 +324,7 @@ void run_tests_DualGrid()
   CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
 
   DualGridTests::boundaries();
+  DualGridTests::metrics();
 
   // Reset logging ostream
   CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
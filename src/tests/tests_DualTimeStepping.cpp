@@ -0,0 +1,446 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeResidual.h"
+#include "BoundaryConditions.h"
+#include "FluxJacobian.h"
+#include "DualTimeStepping.h"
+
+#include "definitions.h"
+
+namespace DualTimeSteppingTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Initialize a perturbed flow field
+*********************************************************************/
+void init_solution(const DualGrid& dualgrid, DMat& U)
+{
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+  {
+    const double x = dualgrid.coords()[i][0];
+    const double y = dualgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = 0.1 * x;
+  }
+
+} // init_solution()
+
+/*********************************************************************
+* Integrate the perturbed flow field up to t_end with n_steps.
+* For stretch != 1, the step sizes alternate between dt_a and
+* dt_b = stretch * dt_a with the mean step size t_end / n_steps.
+*********************************************************************/
+DMat integrate(const DualGrid& dualgrid, double t_end, int n_steps,
+               bool reuse, int& n_builds, int& n_inner,
+               double stretch=1.0)
+{
+  DMat U ( dualgrid.n_elements(), N_FLOW_VARS );
+  init_solution( dualgrid, U );
+
+  DualTimeStepping solver { dualgrid };
+  solver.inner_tolerance( 1.0E-10 );
+  solver.max_inner_iter( 200 );
+  solver.reuse_jacobian( reuse );
+
+  const double dt   = t_end / static_cast<double>( n_steps );
+  const double dt_a = 2.0 * dt / ( 1.0 + stretch );
+  const double dt_b = stretch * dt_a;
+
+  for ( int n = 0; n < n_steps; ++n )
+    solver.step( U, ( n % 2 == 0 ) ? dt_a : dt_b );
+
+  n_builds = solver.n_jacobian_builds();
+  n_inner  = solver.n_inner_iterations();
+
+  LOG(INFO) << "dt = " << dt << ": " << n_builds << " rebuilds, "
+            << n_inner << " inner iterations, ratio " 
+            << solver.rebuild_ratio();
+
+  return U;
+
+} // integrate()
+
+/*********************************************************************
+* Maximum difference of two solutions
+*********************************************************************/
+double max_difference(const DMat& A, const DMat& B)
+{
+  double diff = 0.0;
+
+  for ( int i = 0; i < A.rows(); ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      diff = MAX( diff, std::fabs( A[i][k] - B[i][k] ) );
+
+  return diff;
+
+} // max_difference()
+
+/*********************************************************************
+*
+*********************************************************************/
+void flux_jacobian()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: flux_jacobian() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  const int n_elements = dualgrid.n_elements();
+
+  EdgeResidual residual { dualgrid };
+  FluxJacobian jacobian { dualgrid };
+
+  // For a uniform state, the frozen dissipation coefficient 
+  // yields the exact Jacobian of the residual
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    U[i][IP] = 1.0;
+    U[i][IU] = 0.8;
+    U[i][IV] = 0.3;
+  }
+
+  SparseMatrix J { dualgrid, N_FLOW_VARS };
+  jacobian.assemble( U, J );
+
+  DVec dU ( n_elements * N_FLOW_VARS );
+  DVec JdU ( n_elements * N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements * N_FLOW_VARS; ++i )
+    dU[i] = std::sin( 1.0 + 0.7 * i );
+
+  J.multiply( dU, JdU );
+
+  const double eps = 1.0E-7;
+
+  DMat U_eps = U;
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      U_eps[i][k] += eps * dU[i*N_FLOW_VARS+k];
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  DMat R_eps ( n_elements, N_FLOW_VARS );
+
+  residual.compute( U, R );
+  residual.compute( U_eps, R_eps );
+
+  double max_error = 0.0;
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      const double fd = ( R_eps[i][k] - R[i][k] ) / eps;
+      max_error = MAX( max_error, 
+                       std::fabs( fd - JdU[i*N_FLOW_VARS+k] ) );
+    }
+
+  LOG(INFO) << "Max. error of Jacobian-vector product: " << max_error;
+
+  CHECK( max_error < 1.0E-6 );
+
+} // flux_jacobian()
+
+/*********************************************************************
+*
+*********************************************************************/
+void temporal_order()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: temporal_order() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  int n_builds = 0;
+  int n_inner  = 0;
+
+  const double t_end = 0.1;
+
+  DMat U_1 = integrate( dualgrid, t_end, 10, true, n_builds, n_inner );
+  DMat U_2 = integrate( dualgrid, t_end, 20, true, n_builds, n_inner );
+  DMat U_4 = integrate( dualgrid, t_end, 40, true, n_builds, n_inner );
+
+  const double e_coarse = max_difference( U_1, U_2 );
+  const double e_fine   = max_difference( U_2, U_4 );
+  const double order    = std::log2( e_coarse / e_fine );
+
+  LOG(INFO) << "BDF2 convergence order: " << order;
+
+  CHECK( order > 1.8 && order < 2.3 );
+
+} // temporal_order()
+
+/*********************************************************************
+*
+*********************************************************************/
+void variable_time_step()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: variable_time_step() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  int n_builds = 0;
+  int n_inner  = 0;
+
+  const double t_end   = 0.1;
+  const double stretch = 2.0;
+
+  // Step sizes alternate with the ratios 2 and 1/2
+  DMat U_1 = integrate( dualgrid, t_end, 10, true,
+                        n_builds, n_inner, stretch );
+  DMat U_2 = integrate( dualgrid, t_end, 20, true,
+                        n_builds, n_inner, stretch );
+  DMat U_4 = integrate( dualgrid, t_end, 40, true,
+                        n_builds, n_inner, stretch );
+
+  const double e_coarse = max_difference( U_1, U_2 );
+  const double e_fine   = max_difference( U_2, U_4 );
+  const double order    = std::log2( e_coarse / e_fine );
+
+  LOG(INFO) << "Variable step BDF2 convergence order: " << order;
+
+  CHECK( order > 1.8 && order < 2.3 );
+
+  // A changing step size forces a rebuild of the system matrix 
+  // in every physical step
+  CHECK( n_builds >= 40 );
+
+} // variable_time_step()
+
+/*********************************************************************
+*
+*********************************************************************/
+void jacobian_reuse()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: jacobian_reuse() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  int n_builds_reuse = 0;
+  int n_inner_reuse  = 0;
+  int n_builds_full  = 0;
+  int n_inner_full   = 0;
+
+  DMat U_reuse = integrate( dualgrid, 0.1, 20, true, 
+                            n_builds_reuse, n_inner_reuse );
+  DMat U_full  = integrate( dualgrid, 0.1, 20, false, 
+                            n_builds_full, n_inner_full );
+
+  // Both variants converge to the same solution
+  CHECK( max_difference( U_reuse, U_full ) < 1.0E-6 );
+
+  // Rebuilding in every inner iteration
+  CHECK( n_builds_full == n_inner_full );
+
+  // The frozen Jacobian is reused across physical steps
+  CHECK( n_builds_reuse < 20 );
+  CHECK( n_builds_reuse < n_builds_full );
+
+} // jacobian_reuse()
+
+/*********************************************************************
+*
+*********************************************************************/
+void second_order_residual()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: second_order_residual() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  const int n_elements = dualgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+  init_solution( dualgrid, U );
+
+  const DMat U_0 = U;
+
+  BoundaryConditions bc { dualgrid };
+  bc.values( 1, { 0.0, 1.0, 0.0 } );
+
+  DualTimeStepping solver { dualgrid };
+  solver.inner_tolerance( 1.0E-10 );
+  solver.max_inner_iter( 200 );
+  solver.residual().second_order( true );
+  solver.residual().boundary_conditions( bc );
+
+  CHECK( solver.residual().second_order() );
+  CHECK( solver.residual().boundary_conditions() == &bc );
+
+  const double dt = 0.01;
+  solver.step( U, dt );
+
+  // The step solves the implicit Euler equations of the 
+  // second-order residual with boundary conditions
+  EdgeResidual residual { dualgrid };
+  residual.second_order( true );
+  residual.boundary_conditions( bc );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+
+  residual.compute( U_0, R );
+  double norm_0 = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      norm_0 += R[i][k] * R[i][k];
+
+  residual.compute( U, R );
+  double norm = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double v_dt = dualgrid.volumes()[i] / dt;
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      const double r = R[i][k] + v_dt * ( U[i][k] - U_0[i][k] );
+      norm += r * r;
+    }
+  }
+
+  LOG(INFO) << "Inner iterations:       " << solver.n_inner_iterations();
+  LOG(INFO) << "Residual reduction:     " 
+            << std::sqrt( norm / norm_0 );
+
+  CHECK( std::sqrt( norm ) < 1.0E-8 * std::sqrt( norm_0 ) );
+
+  // The solution differs from the first-order residual
+  DMat U_1 = U_0;
+  DualTimeStepping solver_1 { dualgrid };
+  solver_1.inner_tolerance( 1.0E-10 );
+  solver_1.max_inner_iter( 200 );
+  solver_1.residual().boundary_conditions( bc );
+  solver_1.step( U_1, dt );
+
+  CHECK( max_difference( U, U_1 ) > 1.0E-6 );
+
+} // second_order_residual()
+
+} // namespace DualTimeSteppingTests
+
+
+/*********************************************************************
+* Run tests for: DualTimeStepping.h
+*********************************************************************/
+void run_tests_DualTimeStepping()
+{
+  // Set logging output file
+  std::string log_file_path
+  { DualTimeSteppingTests::BASE_DIR + "/aux/test_logs/tests_DualTimeStepping.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  DualTimeSteppingTests::flux_jacobian();
+  DualTimeSteppingTests::temporal_order();
+  DualTimeSteppingTests::variable_time_step();
+  DualTimeSteppingTests::jacobian_reuse();
+  DualTimeSteppingTests::second_order_residual();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_DualTimeStepping()
@@ -0,0 +1,278 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeColoring.h"
+#include "EdgeTiling.h"
+#include "EdgeResidual.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace EdgeColoringTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Boundary definition of the generated grids
+*********************************************************************/
+BoundaryDef boundary_definition()
+{
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  return bdry_def;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void coloring()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: coloring() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  for ( int mixed = 0; mixed < 2; ++mixed )
+  {
+    PrimaryGrid primgrid = ( mixed )
+      ? GridGenerator::unstructured( 40, 32 )
+      : GridGenerator::structured( 40, 32 );
+
+    DualGrid dgrid { primgrid, bdry_def };
+
+    EdgeColoring coloring { dgrid };
+
+    const int   n_faces = dgrid.n_intr_faces();
+    const IMat& nbrs    = dgrid.face_neighbors();
+
+    CHECK( coloring.n_edges() == n_faces );
+    CHECK( coloring.color_offsets().back() == n_faces );
+
+    // The edge order is a permutation grouped by colors
+    IVec visited ( n_faces, 0 );
+
+    for ( int c = 0; c < coloring.n_colors(); ++c )
+    {
+      IVec used ( dgrid.n_elements(), 0 );
+
+      for ( int p = coloring.color_offsets()[c];
+            p < coloring.color_offsets()[c+1]; ++p )
+      {
+        const int e = coloring.edge_order()[p];
+
+        CHECK( coloring.colors()[e] == c );
+        CHECK( ++visited[e] == 1 );
+
+        // No two edges of a color share an element
+        CHECK( ++used[ nbrs[e][0] ] == 1 );
+        CHECK( ++used[ nbrs[e][1] ] == 1 );
+      }
+    }
+
+    // Greedy bound plus two balancing colors
+    int max_degree = 0;
+    for ( int i = 0; i < dgrid.n_elements(); ++i )
+      max_degree = MAX( max_degree, dgrid.adj_offsets()[i+1]
+                                  - dgrid.adj_offsets()[i] );
+
+    CHECK( coloring.n_colors() >= max_degree );
+    CHECK( coloring.n_colors() <= 2 * max_degree + 1 );
+    CHECK( coloring.imbalance() < 1.15 );
+  }
+
+} // coloring()
+
+/*********************************************************************
+*
+*********************************************************************/
+void tiling()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: tiling() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 60, 50 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int tile_size = 500;
+
+  EdgeTiling tiling { dgrid, tile_size };
+
+  const int   n_tiles = tiling.n_tiles();
+  const IVec& tiles   = tiling.element_tiles();
+  const IMat& nbrs    = dgrid.face_neighbors();
+
+  CHECK( n_tiles == ( dgrid.n_elements() + tile_size - 1 ) / tile_size );
+  CHECK( tiling.max_tile_elements() <= 1.1 * tile_size + 1 );
+
+  // Every element is listed in its own tile
+  CHECK( tiling.element_offsets().back() == dgrid.n_elements() );
+
+  for ( int t = 0; t < n_tiles; ++t )
+    for ( int p = tiling.element_offsets()[t];
+          p < tiling.element_offsets()[t+1]; ++p )
+      CHECK( tiles[ tiling.elements()[p] ] == t );
+
+  // Inner faces are listed once, cut faces in both tiles
+  IVec count ( dgrid.n_intr_faces(), 0 );
+  int  n_cut = 0;
+
+  for ( int t = 0; t < n_tiles; ++t )
+  {
+    for ( int p = tiling.face_offsets()[t]; p < tiling.inner_end()[t]; ++p )
+    {
+      const int f = tiling.faces()[p];
+      CHECK( tiles[ nbrs[f][0] ] == t && tiles[ nbrs[f][1] ] == t );
+      ++count[f];
+    }
+
+    for ( int p = tiling.inner_end()[t]; p < tiling.face_offsets()[t+1]; ++p )
+    {
+      const int f = tiling.faces()[p];
+      CHECK( ( tiles[ nbrs[f][0] ] == t ) != ( tiles[ nbrs[f][1] ] == t ) );
+      ++count[f];
+      ++n_cut;
+    }
+  }
+
+  for ( int f = 0; f < dgrid.n_intr_faces(); ++f )
+  {
+    const bool cut = ( tiles[ nbrs[f][0] ] != tiles[ nbrs[f][1] ] );
+    CHECK( count[f] == ( cut ? 2 : 1 ) );
+  }
+
+  CHECK( n_cut == 2 * tiling.n_cut_faces() );
+
+  // Compact tiles have few cut faces
+  CHECK( tiling.n_cut_faces() < 0.2 * dgrid.n_intr_faces() );
+
+} // tiling()
+
+/*********************************************************************
+*
+*********************************************************************/
+void accumulation_modes()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: accumulation_modes() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 30, 26 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = 0.1 * x * (1.0 - x);
+  }
+
+  DMat R_ref ( n_elements, N_FLOW_VARS );
+  EdgeResidual residual { dgrid };
+  residual.compute( U, R_ref );
+
+  CHECK( residual.accumulation() == FluxAccumulation::FACE_GATHER );
+
+  const FluxAccumulation modes[] = { FluxAccumulation::EDGE_COLORING,
+                                     FluxAccumulation::OWNER_COMPUTES,
+                                     FluxAccumulation::TILED };
+
+  residual.tile_size( 100 );
+  CHECK( residual.tile_size() == 100 );
+
+  // Serial and parallel runs with tiny chunks
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 1 );
+
+    for ( FluxAccumulation mode : modes )
+    {
+      residual.accumulation( mode );
+      CHECK( residual.accumulation() == mode );
+
+      DMat R ( n_elements, N_FLOW_VARS );
+
+      // Repeated evaluations must not accumulate old values
+      for ( int n = 0; n < 2; ++n )
+      {
+        residual.compute( U, R );
+
+        for ( int i = 0; i < n_elements; ++i )
+          for ( int k = 0; k < N_FLOW_VARS; ++k )
+            CHECK( std::fabs( R[i][k] - R_ref[i][k] ) < 1.0E-12 );
+      }
+    }
+  }
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+} // accumulation_modes()
+
+} // namespace EdgeColoringTests
+
+
+/*********************************************************************
+* Run tests for: EdgeColoring.h
+*********************************************************************/
+void run_tests_EdgeColoring()
+{
+  // Set logging output file
+  std::string log_file_path
+  { EdgeColoringTests::BASE_DIR + "/aux/test_logs/tests_EdgeColoring.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  EdgeColoringTests::coloring();
+  EdgeColoringTests::tiling();
+  EdgeColoringTests::accumulation_modes();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_EdgeColoring()
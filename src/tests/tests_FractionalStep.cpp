@@ -0,0 +1,322 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "BoundaryConditions.h"
+#include "FractionalStep.h"
+
+#include "definitions.h"
+
+namespace FractionalStepTests 
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void poisson_matrix()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: poisson_matrix() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  std::string grid_file_path 
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  FractionalStep solver { dualgrid };
+
+  const SparseMatrix& A = solver.poisson_matrix();
+
+  CHECK( A.n_rows() == dualgrid.n_elements() );
+  CHECK( A.n_nonzero_blocks() 
+      == dualgrid.n_elements() + 2 * dualgrid.n_intr_faces() );
+
+  // The matrix must be symmetric with a positive diagonal
+  for ( int i = 0; i < A.n_rows(); ++i )
+  {
+    CHECK( A.diagonal(i)[0] > 0.0 );
+
+    for ( int pos = A.offsets()[i]; pos < A.offsets()[i+1]; ++pos )
+    {
+      const int j = A.columns()[pos];
+      CHECK( EQ( *A.block(pos), *A.block( A.find(j,i) ) ) );
+    }
+  }
+
+  // Outlet elements (4...8) have a prescribed pressure
+  for ( int i = 4; i <= 8; ++i )
+  {
+    CHECK( EQ( A.diagonal(i)[0], 1.0 ) );
+    for ( int pos = A.offsets()[i]+1; pos < A.offsets()[i+1]; ++pos )
+      CHECK( EQ0( *A.block(pos) ) );
+  }
+
+  // Rows of the remaining interior elements sum up to zero
+  double row_sum = 0.0;
+  for ( int pos = A.offsets()[23]; pos < A.offsets()[24]; ++pos )
+    row_sum += *A.block(pos);
+
+  CHECK( EQ0( row_sum ) );
+
+} // poisson_matrix()
+
+/*********************************************************************
+*
+*********************************************************************/
+void projection()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: projection() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  std::string grid_file_path 
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  BoundaryConditions bc { dualgrid };
+  bc.values( 4, { 0.0, 1.0, 0.0 } );
+
+  FractionalStep solver { dualgrid };
+  solver.boundary_conditions( bc );
+  solver.poisson_solver().tolerance( 1.0E-10 );
+
+  const int n_elements = dualgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  const DVec poisson_values = solver.poisson_matrix().values();
+
+  const double dt = 1.0E-2;
+
+  DVec div_star ( n_elements );
+  DVec div_new  ( n_elements );
+
+  for ( int n = 0; n < 20; ++n )
+  {
+    solver.step( U, dt );
+
+    solver.divergence( solver.velocity_star(), div_star );
+    solver.divergence( U, div_new, IU );
+
+    CHECK( solver.poisson_solver().residual_norm() < 1.0E-10 );
+  }
+
+  // The projection reduces the divergence of the intermediate 
+  // velocity field in the interior of the domain, whereas the 
+  // velocity is prescribed at the boundaries
+  std::vector<bool> is_bdry ( n_elements, false );
+  for ( const auto& bdry : dualgrid.boundaries() )
+    for ( int i : bdry.dual_elements() )
+      is_bdry[i] = true;
+
+  double norm_star = 0.0;
+  double norm_new  = 0.0;
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    if ( is_bdry[i] )
+      continue;
+
+    norm_star += div_star[i] * div_star[i];
+    norm_new  += div_new[i] * div_new[i];
+  }
+
+  LOG(INFO) << "Divergence of u*:     " << std::sqrt(norm_star);
+  LOG(INFO) << "Divergence of u^n+1:  " << std::sqrt(norm_new);
+  LOG(INFO) << "Poisson iterations:   " 
+            << solver.poisson_solver().iterations();
+  LOG(INFO) << "Predictor time:       " << solver.predictor_time();
+  LOG(INFO) << "Pressure time:        " << solver.pressure_time();
+  LOG(INFO) << "Correction time:      " << solver.correction_time();
+
+  CHECK( norm_new < norm_star );
+  CHECK( solver.n_steps() == 20 );
+
+  // The flow enters at the inlet and the solution stays bounded
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    CHECK( std::isfinite( U[i][IP] ) );
+    CHECK( std::fabs( U[i][IU] ) < 5.0 );
+    CHECK( std::fabs( U[i][IV] ) < 5.0 );
+  }
+
+  CHECK( U[23][IU] > 0.0 );
+
+  // The Poisson matrix is not reassembled during the time steps
+  const DVec& values = solver.poisson_matrix().values();
+  bool unchanged = ( values.size() == poisson_values.size() );
+
+  for ( size_t k = 0; unchanged && k < values.size(); ++k )
+    unchanged = ( values[k] == poisson_values[k] );
+
+  CHECK( unchanged );
+
+} // projection()
+
+/*********************************************************************
+*
+*********************************************************************/
+void boundary_values()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: boundary_values() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  std::string grid_file_path 
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  // Inlet with an inclined velocity and a moving wall, whose
+  // velocity has a normal component
+  const BdryValues inlet { 0.0, 0.5, 0.1 };
+  const BdryValues wall  { 0.0, 2.0, 1.0 };
+
+  BoundaryConditions bc { dualgrid };
+  bc.values( 4, inlet );
+  bc.values( 1, wall );
+
+  FractionalStep solver { dualgrid };
+  solver.boundary_conditions( bc );
+
+  const int n_elements = dualgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+  solver.step( U, 1.0E-2 );
+
+  // Corner elements belong to two boundaries and are skipped
+  IVec n_bdries ( n_elements, 0 );
+  for ( const auto& bdry : dualgrid.boundaries() )
+    for ( int i : bdry.dual_elements() )
+      ++n_bdries[i];
+
+  int n_inlet = 0;
+  int n_wall  = 0;
+
+  for ( const auto& bdry : dualgrid.boundaries() )
+  {
+    const IVec& elements = bdry.dual_elements();
+    const DMat& normals  = bdry.dual_normals();
+
+    for ( int k = 0; k < bdry.n_dual_elements(); ++k )
+    {
+      const int i = elements[k];
+
+      if ( n_bdries[i] > 1 )
+        continue;
+
+      if ( bdry.marker() == 4 )
+      {
+        CHECK( EQ( U[i][IU], inlet.u ) );
+        CHECK( EQ( U[i][IV], inlet.v ) );
+        ++n_inlet;
+      }
+      else if ( bdry.marker() == 1 )
+      {
+        const double nx  = normals[k][0];
+        const double ny  = normals[k][1];
+        const double len = std::sqrt( nx*nx + ny*ny );
+        const double un  = ( wall.u * nx + wall.v * ny ) / len;
+
+        // Only the tangential wall velocity is imposed
+        CHECK( std::fabs( U[i][IU] * nx + U[i][IV] * ny ) < 1.0E-12 );
+        CHECK( EQ( U[i][IU], wall.u - un * nx / len ) );
+        CHECK( EQ( U[i][IV], wall.v - un * ny / len ) );
+        ++n_wall;
+      }
+      else if ( bdry.marker() == 3 )
+      {
+        // Walls without values are at rest
+        CHECK( EQ0( U[i][IU] ) );
+        CHECK( EQ0( U[i][IV] ) );
+      }
+    }
+  }
+
+  CHECK( n_inlet > 0 );
+  CHECK( n_wall > 0 );
+
+} // boundary_values()
+
+} // namespace FractionalStepTests
+
+
+/*********************************************************************
+* Run tests for: FractionalStep.h
+*********************************************************************/
+void run_tests_FractionalStep()
+{
+  // Set logging output file
+  std::string log_file_path 
+  { FractionalStepTests::BASE_DIR + "/aux/test_logs/tests_FractionalStep.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  FractionalStepTests::poisson_matrix();
+  FractionalStepTests::projection();
+  FractionalStepTests::boundary_values();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_FractionalStep()
@@ -0,0 +1,290 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <memory>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "Log.h"
+#include "Geometry.h"
+
+namespace GeometryTests
+{
+using namespace CppUtils;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Exact reference orientation of integer coordinates below 2^53
+*********************************************************************/
+int orient_reference(long long px, long long py,
+                     long long qx, long long qy,
+                     long long rx, long long ry)
+{
+  const __int128 det = (__int128)( px - rx ) * ( qy - ry )
+                     - (__int128)( py - ry ) * ( qx - rx );
+
+  return ( det > 0 ) - ( det < 0 );
+}
+
+/*********************************************************************
+* Points on a fine grid around the line (12,12)-(24,24), whose
+* orientation is misclassified by the floating-point determinant.
+* The coordinates are 0.5 + i * 2^-53, which are exact integers
+* after scaling with 2^53.
+*********************************************************************/
+struct NearDegenerate
+{
+  std::vector<double>    x, y;
+  std::vector<long long> ix, iy;
+};
+
+NearDegenerate near_degenerate_points(int n)
+{
+  NearDegenerate pts {};
+
+  const double    ulp  = std::ldexp( 1.0, -53 );
+  const long long half = 1LL << 52;
+
+  for ( int i = 0; i < n; ++i )
+    for ( int j = 0; j < n; ++j )
+    {
+      pts.x.push_back( 0.5 + i * ulp );
+      pts.y.push_back( 0.5 + j * ulp );
+      pts.ix.push_back( half + i );
+      pts.iy.push_back( half + j );
+    }
+
+  return pts;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void robust_orientation()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: robust_orientation() ==========";
+  LOG(INFO) << "";
+
+  // Near-degenerate points, (12,12) and (24,24) scaled by 2^53
+  const NearDegenerate pts = near_degenerate_points( 64 );
+
+  const long long s = 1LL << 53;
+  const Vec2d q { 12.0, 12.0 };
+  const Vec2d r { 24.0, 24.0 };
+
+  int n_naive_wrong = 0;
+  int n_collinear   = 0;
+
+  for ( size_t i = 0; i < pts.x.size(); ++i )
+  {
+    const int ref = orient_reference( pts.ix[i], pts.iy[i],
+                                      12*s, 12*s, 24*s, 24*s );
+
+    const Vec2d p { pts.x[i], pts.y[i] };
+
+    CHECK( orient2d( p.x, p.y, q.x, q.y, r.x, r.y ) == ref );
+
+    const Orientation o = CppUtils::robust_orientation( p, q, r );
+    CHECK( o == ( ref > 0 ? Orientation::CCW
+                : ref < 0 ? Orientation::CW : Orientation::CL ) );
+
+    const double naive = ( p.x - r.x ) * ( q.y - r.y )
+                       - ( p.y - r.y ) * ( q.x - r.x );
+
+    n_naive_wrong += ( ( naive > 0.0 ) - ( naive < 0.0 ) != ref );
+    n_collinear   += ( ref == 0 );
+  }
+
+  // The test set is hard for the plain determinant
+  CHECK( n_naive_wrong > 100 );
+  CHECK( n_collinear == 64 );
+
+  // Random large integer coordinates
+  std::mt19937_64 gen { 3 };
+  std::uniform_int_distribution<long long> coord { -(1LL << 52), 1LL << 52 };
+
+  for ( int n = 0; n < 20000; ++n )
+  {
+    long long c[6];
+    for ( auto& v : c )
+      v = coord( gen );
+
+    // Every second case is collinear up to a small offset
+    if ( n % 2 == 0 )
+    {
+      c[4] = c[0] + ( c[2] - c[0] ) / 4;
+      c[5] = c[1] + ( c[3] - c[1] ) / 4 + ( n % 3 ) - 1;
+    }
+
+    const int ref = orient_reference( c[0], c[1], c[2], c[3], c[4], c[5] );
+
+    CHECK( orient2d( (double)c[0], (double)c[1], (double)c[2],
+                     (double)c[3], (double)c[4], (double)c[5] ) == ref );
+  }
+
+} // robust_orientation()
+
+/*********************************************************************
+*
+*********************************************************************/
+void batched_predicates()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: batched_predicates() ==========";
+  LOG(INFO) << "";
+
+  const NearDegenerate pts = near_degenerate_points( 40 );
+  const size_t n = pts.x.size();
+
+  // Orientation of all points with respect to (12,12)-(24,24)
+  std::vector<Orientation> o ( n );
+  orientation_batch( Vec2Array { pts.x.data(), pts.y.data() },
+                     Vec2d { 12.0, 12.0 }, Vec2d { 24.0, 24.0 },
+                     n, o.data() );
+
+  for ( size_t i = 0; i < n; ++i )
+    CHECK( o[i] == CppUtils::robust_orientation(
+      Vec2d { pts.x[i], pts.y[i] }, Vec2d { 12.0, 12.0 },
+      Vec2d { 24.0, 24.0 } ) );
+
+  // Random triangles and points on a coarse lattice, such that
+  // many points are located on triangle edges
+  std::mt19937 gen { 5 };
+  std::uniform_int_distribution<int> lattice { -8, 8 };
+
+  const size_t n_tris = 5000;
+
+  std::vector<double> px(n_tris), py(n_tris), qx(n_tris), qy(n_tris),
+                      rx(n_tris), ry(n_tris), sx(n_tris), sy(n_tris),
+                      vx(n_tris), vy(n_tris);
+
+  for ( size_t i = 0; i < n_tris; ++i )
+  {
+    px[i] = lattice( gen ); py[i] = lattice( gen );
+    qx[i] = lattice( gen ); qy[i] = lattice( gen );
+    rx[i] = lattice( gen ); ry[i] = lattice( gen );
+    sx[i] = lattice( gen ); sy[i] = lattice( gen );
+    vx[i] = 0.5 * lattice( gen ); vy[i] = 0.5 * lattice( gen );
+
+    // Counter-clockwise triangles
+    if ( orient2d( px[i], py[i], qx[i], qy[i], rx[i], ry[i] ) < 0 )
+    {
+      std::swap( qx[i], rx[i] );
+      std::swap( qy[i], ry[i] );
+    }
+  }
+
+  const Vec2Array p { px.data(), py.data() };
+  const Vec2Array q { qx.data(), qy.data() };
+  const Vec2Array r { rx.data(), ry.data() };
+  const Vec2Array s { sx.data(), sy.data() };
+  const Vec2Array v { vx.data(), vy.data() };
+
+  std::unique_ptr<bool[]> result { new bool[n_tris] };
+  bool* res = result.get();
+
+  // Many points in many triangles, the scalar predicates agree for
+  // integer coordinates
+  in_on_triangle_batch( v, p, q, r, n_tris, res );
+
+  int n_inside = 0;
+
+  for ( size_t i = 0; i < n_tris; ++i )
+  {
+    const bool ref = in_on_triangle( Vec2d { vx[i], vy[i] },
+      Vec2d { px[i], py[i] }, Vec2d { qx[i], qy[i] },
+      Vec2d { rx[i], ry[i] } );
+
+    CHECK( res[i] == ref );
+    n_inside += ref;
+  }
+
+  CHECK( n_inside > 0 );
+
+  // One point in many triangles
+  const Vec2d center { 0.0, 0.0 };
+  in_on_triangle_batch( center, p, q, r, n_tris, res );
+
+  for ( size_t i = 0; i < n_tris; ++i )
+    CHECK( res[i] == in_on_triangle( center,
+      Vec2d { px[i], py[i] }, Vec2d { qx[i], qy[i] },
+      Vec2d { rx[i], ry[i] } ) );
+
+  // Quads (p,q,r,s), which are not necessarily convex
+  in_on_quad_batch( v, p, q, r, s, n_tris, res );
+
+  for ( size_t i = 0; i < n_tris; ++i )
+    CHECK( res[i] == in_on_quad( Vec2d { vx[i], vy[i] },
+      Vec2d { px[i], py[i] }, Vec2d { qx[i], qy[i] },
+      Vec2d { rx[i], ry[i] }, Vec2d { sx[i], sy[i] } ) );
+
+  // Segments (p,q) and (r,s), including collinear overlaps
+  line_line_intersection_batch( p, q, r, s, n_tris, res );
+
+  int n_intersect = 0;
+
+  for ( size_t i = 0; i < n_tris; ++i )
+  {
+    const bool ref = line_line_intersection(
+      Vec2d { px[i], py[i] }, Vec2d { qx[i], qy[i] },
+      Vec2d { rx[i], ry[i] }, Vec2d { sx[i], sy[i] } );
+
+    CHECK( res[i] == ref );
+    n_intersect += ref;
+  }
+
+  CHECK( n_intersect > 0 );
+
+  // Identical and overlapping collinear segments
+  const Vec2d a { 0.0, 0.0 };
+  const Vec2d b { 2.0, 0.0 };
+
+  line_line_intersection_batch( a, b, a, b, 1, res );
+  CHECK( !res[0] );
+
+  line_line_intersection_batch( a, b, Vec2d { 1.0, 0.0 },
+                                Vec2d { 3.0, 0.0 }, 1, res );
+  CHECK( res[0] );
+
+  line_line_intersection_batch( a, b, b, Vec2d { 3.0, 0.0 }, 1, res );
+  CHECK( !res[0] );
+
+} // batched_predicates()
+
+} // namespace GeometryTests
+
+
+/*********************************************************************
+* Run tests for: Geometry.h
+*********************************************************************/
+void run_tests_Geometry()
+{
+  // Set logging output file
+  std::string log_file_path
+  { GeometryTests::BASE_DIR + "/aux/test_logs/tests_Geometry.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  GeometryTests::robust_orientation();
+  GeometryTests::batched_predicates();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_Geometry()
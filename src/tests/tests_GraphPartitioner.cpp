@@ -0,0 +1,298 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "GraphPartitioner.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace GraphPartitionerTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void grid_generator()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: grid_generator() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL );
+  bdry_def.add_marker( 2, BdryType::WALL );
+  bdry_def.add_marker( 3, BdryType::WALL );
+  bdry_def.add_marker( 4, BdryType::WALL );
+
+  // -----------------------------------------------------------------
+  // Structured quad grid
+  PrimaryGrid quads = GridGenerator::structured( 8, 5, 2.0, 1.0 );
+
+  CHECK( quads.vertex_coords().rows() == 54 );
+  CHECK( quads.quads().rows() == 40 );
+  CHECK( quads.tris().rows() == 0 );
+  CHECK( quads.intr_edges().rows() == 7*5 + 8*4 );
+  CHECK( quads.bdry_edges().rows() == 26 );
+
+  // Neighbor k lies across the edge (k+1, k+2) of the first quad
+  CHECK( quads.quad_neighbors()[0][0] == 1 );
+  CHECK( quads.quad_neighbors()[0][1] == 8 );
+  CHECK( quads.quad_neighbors()[0][2] == -1 );
+  CHECK( quads.quad_neighbors()[0][3] == -1 );
+
+  // Boundary edges have the domain on their left
+  for ( int i = 0; i < quads.bdry_edges().rows(); ++i )
+  {
+    const int v0 = quads.bdry_edges()[i][0];
+    const int v1 = quads.bdry_edges()[i][1];
+    const double x = 0.5 * ( quads.vertex_coords()[v0][0]
+                           + quads.vertex_coords()[v1][0] );
+    const double y = 0.5 * ( quads.vertex_coords()[v0][1]
+                           + quads.vertex_coords()[v1][1] );
+    const double dx = quads.vertex_coords()[v1][0]
+                    - quads.vertex_coords()[v0][0];
+    const double dy = quads.vertex_coords()[v1][1]
+                    - quads.vertex_coords()[v0][1];
+
+    switch ( quads.bdry_edge_markers()[i] )
+    {
+      case 1: CHECK( EQ(y, 0.0) && dx > 0.0 ); break;
+      case 2: CHECK( EQ(x, 2.0) && dy > 0.0 ); break;
+      case 3: CHECK( EQ(y, 1.0) && dx < 0.0 ); break;
+      case 4: CHECK( EQ(x, 0.0) && dy < 0.0 ); break;
+      default: CHECK( false );
+    }
+  }
+
+  DualGrid quad_dgrid { quads, bdry_def };
+
+  double area = 0.0;
+  for ( double v : quad_dgrid.volumes() )
+    area += v;
+
+  CHECK( EQ( area, 2.0 ) );
+  CHECK( quad_dgrid.boundaries().size() == 4 );
+
+  // -----------------------------------------------------------------
+  // Jittered triangle grid
+  PrimaryGrid tris = GridGenerator::unstructured( 10, 10 );
+
+  CHECK( tris.tris().rows() == 200 );
+  CHECK( tris.quads().rows() == 0 );
+  CHECK( tris.bdry_edges().rows() == 40 );
+
+  DualGrid tri_dgrid { tris, bdry_def };
+
+  area = 0.0;
+  for ( double v : tri_dgrid.volumes() )
+  {
+    CHECK( v > 0.0 );
+    area += v;
+  }
+
+  CHECK( EQ( area, 1.0 ) );
+
+} // grid_generator()
+
+/*********************************************************************
+*
+*********************************************************************/
+void partition_quality()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: partition_quality() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL );
+  bdry_def.add_marker( 2, BdryType::WALL );
+  bdry_def.add_marker( 3, BdryType::WALL );
+  bdry_def.add_marker( 4, BdryType::WALL );
+
+  PrimaryGrid structured   = GridGenerator::structured( 80, 80 );
+  PrimaryGrid unstructured = GridGenerator::unstructured( 70, 90 );
+
+  for ( const PrimaryGrid* primgrid : { &structured, &unstructured } )
+  {
+    DualGrid dgrid { *primgrid, bdry_def };
+    const int n = dgrid.n_elements();
+
+    GraphPartitioner partitioner { dgrid };
+
+    for ( int n_parts : { 2, 4, 7, 16 } )
+    {
+      const IVec& parts = partitioner.partition( n_parts );
+
+      CHECK( static_cast<int>( parts.size() ) == n );
+
+      // All parts are used and balanced
+      for ( int w : partitioner.part_weights() )
+        CHECK( w > 0 );
+
+      CHECK( partitioner.imbalance() < 1.05 );
+      CHECK( partitioner.edge_cut() == partitioner.edge_cut( parts ) );
+      CHECK( partitioner.partition_time() >= 0.0 );
+
+      // Contiguous index ranges correspond to straight strips of the
+      // grid, which are close to optimal for few parts. For many
+      // parts, the edge cut must be clearly smaller.
+      IVec strips ( n );
+      for ( int i = 0; i < n; ++i )
+        strips[i] = static_cast<int>( static_cast<long long>(i)
+                                    * n_parts / n );
+
+      const int strip_cut = partitioner.edge_cut( strips );
+
+      if ( n_parts < 7 )
+        CHECK( partitioner.edge_cut() < 1.25 * strip_cut );
+      else
+        CHECK( partitioner.edge_cut() < 0.7 * strip_cut );
+    }
+
+    // The partition is reproducible
+    IVec parts_a = partitioner.partition( 7 );
+    IVec parts_b = partitioner.partition( 7 );
+
+    CHECK( parts_a == parts_b );
+  }
+
+} // partition_quality()
+
+/*********************************************************************
+*
+*********************************************************************/
+void weighted_graph()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: weighted_graph() ==========";
+  LOG(INFO) << "";
+
+  // Ring of n vertices, where the first half is three times
+  // heavier than the second half
+  const int n = 1000;
+
+  IVec offsets ( n+1 );
+  IVec adjacency ( 2*n );
+  IVec weights ( n );
+
+  for ( int i = 0; i < n; ++i )
+  {
+    offsets[i]        = 2 * i;
+    adjacency[2*i]    = ( i + n - 1 ) % n;
+    adjacency[2*i+1]  = ( i + 1 ) % n;
+    weights[i]        = ( i < n/2 ) ? 3 : 1;
+  }
+  offsets[n] = 2 * n;
+
+  GraphPartitioner partitioner { offsets, adjacency, weights };
+  partitioner.partition( 4 );
+
+  // Four arcs of a ring cut four edges
+  CHECK( partitioner.edge_cut() >= 4 );
+  CHECK( partitioner.edge_cut() <= 6 );
+  CHECK( partitioner.imbalance() < 1.05 );
+
+  // Single part
+  partitioner.partition( 1 );
+
+  CHECK( partitioner.edge_cut() == 0 );
+  CHECK( EQ( partitioner.imbalance(), 1.0 ) );
+
+} // weighted_graph()
+
+/*********************************************************************
+*
+*********************************************************************/
+void many_parts()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: many_parts() ==========";
+  LOG(INFO) << "";
+
+  // Ring of n vertices, which is split into up to n parts
+  const int n = 24;
+
+  IVec offsets ( n+1 );
+  IVec adjacency ( 2*n );
+
+  for ( int i = 0; i < n; ++i )
+  {
+    offsets[i]        = 2 * i;
+    adjacency[2*i]    = ( i + n - 1 ) % n;
+    adjacency[2*i+1]  = ( i + 1 ) % n;
+  }
+  offsets[n] = 2 * n;
+
+  GraphPartitioner partitioner { offsets, adjacency };
+
+  for ( int k : { n-7, n-1, n } )
+  {
+    partitioner.partition( k );
+
+    // No part is empty
+    const IVec& pw = partitioner.part_weights();
+
+    CHECK( static_cast<int>( pw.size() ) == k );
+    CHECK( std::all_of( pw.begin(), pw.end(),
+      [](int w) { return w > 0; }) );
+  }
+
+  // Every vertex is a part of its own
+  CHECK( partitioner.edge_cut() == n );
+  CHECK( EQ( partitioner.imbalance(), 1.0 ) );
+
+} // many_parts()
+
+} // namespace GraphPartitionerTests
+
+
+/*********************************************************************
+* Run tests for: GraphPartitioner.h
+*********************************************************************/
+void run_tests_GraphPartitioner()
+{
+  // Set logging output file
+  std::string log_file_path
+  { GraphPartitionerTests::BASE_DIR + "/aux/test_logs/tests_GraphPartitioner.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  GraphPartitionerTests::grid_generator();
+  GraphPartitionerTests::partition_quality();
+  GraphPartitionerTests::weighted_graph();
+  GraphPartitionerTests::many_parts();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_GraphPartitioner()
@@ -0,0 +1,317 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "GridValidator.h"
+
+#include "definitions.h"
+
+namespace GridValidatorTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Check if an offender of the given defect refers to entity a
+*********************************************************************/
+bool reported(const GridValidator& validator, GridDefect defect, int a)
+{
+  const auto& offenders = validator.offenders();
+
+  return std::any_of( offenders.begin(), offenders.end(),
+    [&](const GridOffender& o) { return o.defect == defect && o.a == a; });
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void valid_grids()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: valid_grids() ==========";
+  LOG(INFO) << "";
+
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 64 );
+
+    PrimaryGrid quads = GridGenerator::structured( 40, 30, 2.0, 1.0 );
+    PrimaryGrid tris  = GridGenerator::unstructured( 40, 30, 1.0, 3.0 );
+
+    GridValidator quad_validator { quads };
+    GridValidator tri_validator { tris };
+
+    CHECK( quad_validator.validate() );
+    CHECK( tri_validator.validate() );
+
+    CHECK( quad_validator.n_elements() == 40 * 30 );
+    CHECK( tri_validator.n_elements() == 2 * 40 * 30 );
+  }
+
+} // valid_grids()
+
+/*********************************************************************
+*
+*********************************************************************/
+void inverted_elements()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: inverted_elements() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid grid = GridGenerator::unstructured( 20, 20 );
+
+  // Reverse the orientation of a triangle
+  std::swap( grid.tris()[17][0], grid.tris()[17][1] );
+
+  GridValidator validator { grid };
+
+  CHECK( validator.check_orientation() == 1 );
+  CHECK( reported( validator, GridDefect::INVERTED_ELEMENT, 17 ) );
+
+  // Its neighbors do not match anymore
+  CHECK( validator.check_neighbors() > 0 );
+  CHECK( !validator.validate() );
+
+  // A non-convex quad
+  PrimaryGrid quads = GridGenerator::structured( 10, 10 );
+  const int v = quads.quads()[55][2];
+  quads.vertex_coords()[v][0] -= 0.09;
+  quads.vertex_coords()[v][1] -= 0.09;
+
+  GridValidator quad_validator { quads };
+  CHECK( quad_validator.check_orientation() == 1 );
+  CHECK( reported( quad_validator, GridDefect::INVERTED_ELEMENT, 55 ) );
+
+} // inverted_elements()
+
+/*********************************************************************
+*
+*********************************************************************/
+void neighbor_mismatches()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: neighbor_mismatches() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid grid = GridGenerator::structured( 12, 12 );
+
+  // Wrong neighbor of an interior quad
+  const int k = ( grid.quad_neighbors()[50][0] >= 0 ) ? 0 : 1;
+  grid.quad_neighbors()[50][k] = 100;
+
+  // Swapped elements of an interior edge
+  std::swap( grid.intr_edge_neighbors()[3][0],
+             grid.intr_edge_neighbors()[3][1] );
+
+  GridValidator validator { grid };
+
+  // Both quad 50 and its former neighbor are reported
+  CHECK( validator.check_neighbors() == 2 );
+  CHECK( reported( validator, GridDefect::NEIGHBOR_MISMATCH, 50 ) );
+
+  CHECK( validator.check_edges() > 0 );
+  CHECK( reported( validator, GridDefect::EDGE_MISMATCH, 3 ) );
+
+  CHECK( validator.check_orientation() == 0 );
+  CHECK( validator.check_overlaps() == 0 );
+
+} // neighbor_mismatches()
+
+/*********************************************************************
+*
+*********************************************************************/
+void duplicate_vertices()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: duplicate_vertices() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid grid = GridGenerator::unstructured( 16, 16 );
+
+  // Vertices of a structured grid share coordinates with their
+  // column neighbors, which are no duplicates
+  PrimaryGrid quads = GridGenerator::structured( 16, 16 );
+  GridValidator quad_validator { quads };
+  CHECK( quad_validator.check_duplicate_vertices() == 0 );
+
+  // Vertex 40 almost coincides with vertex 120
+  grid.vertex_coords()[40][0] = grid.vertex_coords()[120][0] + 1.0E-15;
+  grid.vertex_coords()[40][1] = grid.vertex_coords()[120][1];
+
+  GridValidator validator { grid };
+
+  CHECK( validator.check_duplicate_vertices() == 1 );
+  CHECK( validator.offenders()[0].a == 40 );
+  CHECK( validator.offenders()[0].b == 120 );
+
+} // duplicate_vertices()
+
+/*********************************************************************
+*
+*********************************************************************/
+void open_boundaries()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: open_boundaries() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid grid = GridGenerator::structured( 8, 8 );
+
+  GridValidator validator { grid };
+  CHECK( validator.check_boundary() == 0 );
+
+  // Reconnect a boundary edge to an interior vertex
+  const int v0 = grid.bdry_edges()[5][0];
+  const int v1 = grid.bdry_edges()[5][1];
+  grid.bdry_edges()[5][1] = 40;
+
+  CHECK( validator.check_boundary() > 0 );
+  CHECK( reported( validator, GridDefect::OPEN_BOUNDARY, v1 ) );
+  CHECK( reported( validator, GridDefect::OPEN_BOUNDARY, 40 ) );
+
+  // Vertex offenders have no second entity
+  const auto& offenders = validator.offenders();
+  CHECK( std::none_of( offenders.begin(), offenders.end(),
+    [v0](const GridOffender& o) { return o.a == v0 && o.b == -1; }) );
+
+  CHECK( validator.check_edges() == 1 );
+  CHECK( reported( validator, GridDefect::EDGE_MISMATCH,
+                   grid.n_intr_edges() + 5 ) );
+
+} // open_boundaries()
+
+/*********************************************************************
+*
+*********************************************************************/
+void overlapping_elements()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: overlapping_elements() ==========";
+  LOG(INFO) << "";
+
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 16 );
+
+    // Vertex, which is moved across several elements
+    PrimaryGrid grid = GridGenerator::unstructured( 20, 20 );
+    grid.vertex_coords()[110][0] += 0.12;
+
+    GridValidator validator { grid };
+    CHECK( validator.check_overlaps() > 0 );
+
+    // Corner quad, which is shrunk into the interior of quad 44,
+    // such that no edges cross
+    PrimaryGrid quads = GridGenerator::structured( 10, 10 );
+
+    const int* q = quads.quads()[44];
+    double cx = 0.0, cy = 0.0;
+
+    for ( int k = 0; k < 4; ++k )
+    {
+      cx += 0.25 * quads.vertex_coords()[ q[k] ][0];
+      cy += 0.25 * quads.vertex_coords()[ q[k] ][1];
+    }
+
+    const int*   c = quads.quads()[0];
+    const double dx[4] = { -0.01, 0.01, 0.01, -0.01 };
+    const double dy[4] = { -0.01, -0.01, 0.01, 0.01 };
+
+    for ( int k = 0; k < 4; ++k )
+    {
+      quads.vertex_coords()[ c[k] ][0] = cx + dx[k];
+      quads.vertex_coords()[ c[k] ][1] = cy + dy[k];
+    }
+
+    GridValidator quad_validator { quads };
+    CHECK( quad_validator.check_overlaps() > 0 );
+
+    const auto& offenders = quad_validator.offenders();
+    CHECK( std::any_of( offenders.begin(), offenders.end(),
+      [](const GridOffender& o) { return o.a == 0 && o.b == 44; }) );
+
+    // Fan of three counter-clockwise triangles around the boundary
+    // vertex 0, whose angles of 150 degrees sum up to 450 degrees,
+    // such that the first and the last triangle overlap, although
+    // they only share vertex 0 and no element is inverted
+    PrimaryGrid fan { 5, 3, 0, 0, 0 };
+
+    for ( int k = 1; k < 5; ++k )
+    {
+      const double phi = ( k - 1 ) * 150.0 * M_PI / 180.0;
+      fan.vertex_coords()[k][0] = std::cos( phi );
+      fan.vertex_coords()[k][1] = std::sin( phi );
+    }
+
+    const int fan_tris[3][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 4 } };
+    const int fan_nbrs[3][3] = { { -1, 1, -1 }, { -1, 2, 0 }, { -1, -1, 1 } };
+
+    for ( int i = 0; i < 3; ++i )
+      for ( int k = 0; k < 3; ++k )
+      {
+        fan.tris()[i][k]          = fan_tris[i][k];
+        fan.tri_neighbors()[i][k] = fan_nbrs[i][k];
+      }
+
+    GridValidator fan_validator { fan };
+    CHECK( fan_validator.check_orientation() == 0 );
+    CHECK( fan_validator.check_overlaps() == 1 );
+    CHECK( reported( fan_validator, GridDefect::OVERLAPPING, 0 ) );
+  }
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+} // overlapping_elements()
+
+} // namespace GridValidatorTests
+
+
+/*********************************************************************
+* Run tests for: GridValidator.h
+*********************************************************************/
+void run_tests_GridValidator()
+{
+  // Set logging output file
+  std::string log_file_path
+  { GridValidatorTests::BASE_DIR + "/aux/test_logs/tests_GridValidator.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  GridValidatorTests::valid_grids();
+  GridValidatorTests::inverted_elements();
+  GridValidatorTests::neighbor_mismatches();
+  GridValidatorTests::duplicate_vertices();
+  GridValidatorTests::open_boundaries();
+  GridValidatorTests::overlapping_elements();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_GridValidator()
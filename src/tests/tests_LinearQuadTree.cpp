@@ -0,0 +1,247 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "QuadTree.h"
+#include "LinearQuadTree.h"
+
+namespace LinearQuadTreeTests
+{
+using namespace CppUtils;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Test item
+*********************************************************************/
+struct Point
+{
+  Point(double x, double y, int id) : xy_ { x, y }, id_ { id } {}
+
+  const Vec2d& xy() const { return xy_; }
+  int id() const { return id_; }
+
+  Vec2d xy_;
+  int   id_;
+};
+
+/*********************************************************************
+* Sorted ids of the given items
+*********************************************************************/
+std::vector<int> ids(const std::vector<Point*>& items)
+{
+  std::vector<int> result {};
+
+  for ( const Point* p : items )
+    result.push_back( p->id() );
+
+  std::sort( result.begin(), result.end() );
+
+  return result;
+}
+
+/*********************************************************************
+* Random points, where every tenth point is located on a coarse
+* lattice, such that points on query borders and duplicates occur
+*********************************************************************/
+std::vector<Point> random_points(int n)
+{
+  std::mt19937 gen { 7 };
+  std::uniform_real_distribution<double> coord { -10.0, 10.0 };
+  std::uniform_int_distribution<int>     lattice { -10, 10 };
+
+  std::vector<Point> points {};
+
+  for ( int i = 0; i < n; ++i )
+  {
+    if ( i % 10 == 0 )
+      points.emplace_back( 0.5 * lattice( gen ), 0.5 * lattice( gen ), i );
+    else
+      points.emplace_back( coord( gen ), coord( gen ), i );
+  }
+
+  return points;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void build()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: build() ==========";
+  LOG(INFO) << "";
+
+  std::vector<Point>  points = random_points( 5000 );
+  std::vector<Point*> ptrs {};
+
+  for ( auto& p : points )
+    ptrs.push_back( &p );
+
+  LinearQuadTree<Point,double> qtree { 20, 25 };
+
+  // Empty trees have no nodes and find nothing
+  CHECK( qtree.size() == 0 );
+  CHECK( qtree.n_nodes() == 0 );
+  CHECK( qtree.get_items( {-100.0,-100.0}, {100.0,100.0},
+                          [](Point*) {} ) == 0 );
+
+  qtree.build( ptrs );
+
+  CHECK( qtree.size() == points.size() );
+  CHECK( qtree.n_leafs() > 5000 / 20 );
+  CHECK( qtree.depth() > 0 );
+
+  // The sorted items are a permutation of the input
+  CHECK( ids( qtree.items() ) == ids( ptrs ) );
+
+  // The whole domain is reported without any item tests
+  CHECK( qtree.get_items( {-10.0,-10.0}, {10.0,10.0},
+                          [](Point*) {} ) == points.size() );
+
+  // Rebuilds replace the previous items
+  ptrs.resize( 100 );
+  qtree.build( ptrs );
+
+  CHECK( qtree.size() == 100 );
+  CHECK( ids( qtree.items() ) == ids( ptrs ) );
+
+  // Identical locations are stopped by the maximum depth
+  std::vector<Point>  same {};
+  std::vector<Point*> same_ptrs {};
+
+  for ( int i = 0; i < 200; ++i )
+    same.emplace_back( 1.0, 2.0, i );
+
+  for ( auto& p : same )
+    same_ptrs.push_back( &p );
+
+  LinearQuadTree<Point,double> same_tree { 4, 10 };
+  same_tree.build( same_ptrs );
+
+  CHECK( same_tree.size() == 200 );
+  CHECK( same_tree.n_leafs() == 1 );
+  CHECK( same_tree.get_items( {1.0,2.0}, 1.0E-6,
+                              [](Point*) {} ) == 200 );
+  CHECK( same_tree.get_items( {1.0,2.1}, 0.05,
+                              [](Point*) {} ) == 0 );
+
+} // build()
+
+/*********************************************************************
+*
+*********************************************************************/
+void queries()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: queries() ==========";
+  LOG(INFO) << "";
+
+  std::vector<Point>  points = random_points( 5000 );
+  std::vector<Point*> ptrs {};
+
+  QuadTree<Point,double> ref_tree { 40.0, 20, 25 };
+
+  for ( auto& p : points )
+  {
+    ptrs.push_back( &p );
+    ref_tree.add( &p );
+  }
+
+  LinearQuadTree<Point,double> qtree { 20, 25 };
+  qtree.build( ptrs );
+
+  std::mt19937 gen { 11 };
+  std::uniform_real_distribution<double> coord { -12.0, 12.0 };
+  std::uniform_real_distribution<double> size  { 0.0, 4.0 };
+
+  for ( int q = 0; q < 200; ++q )
+  {
+    // Every fourth query is aligned with the lattice points
+    Vec2d lowleft { coord( gen ), coord( gen ) };
+    Vec2d upright = lowleft + Vec2d { size( gen ), size( gen ) };
+
+    if ( q % 4 == 0 )
+    {
+      lowleft = { 0.5 * std::round( 2.0 * lowleft.x ),
+                  0.5 * std::round( 2.0 * lowleft.y ) };
+      upright = { 0.5 * std::round( 2.0 * upright.x ),
+                  0.5 * std::round( 2.0 * upright.y ) };
+    }
+
+    std::vector<Point*> brute {};
+
+    for ( auto& p : points )
+      if ( in_on_rect( p.xy(), lowleft, upright ) )
+        brute.push_back( &p );
+
+    std::vector<Point*> found {};
+    const size_t n = qtree.get_items( lowleft, upright,
+                                      [&](Point* p) { found.push_back( p ); } );
+
+    CHECK( n == brute.size() );
+    CHECK( ids( found ) == ids( brute ) );
+
+    std::vector<Point*> ref_found {};
+    ref_tree.get_items( lowleft, upright, ref_found );
+    CHECK( ids( ref_found ) == ids( found ) );
+
+    // Circles
+    const Vec2d  center = lowleft;
+    const double radius = size( gen );
+
+    brute.clear();
+
+    for ( auto& p : points )
+      if ( ( p.xy() - center ).length_squared() < radius * radius )
+        brute.push_back( &p );
+
+    found.clear();
+    CHECK( qtree.get_items( center, radius, found ) == brute.size() );
+    CHECK( ids( found ) == ids( brute ) );
+
+    ref_found.clear();
+    ref_tree.get_items( center, radius, ref_found );
+    CHECK( ids( ref_found ) == ids( found ) );
+  }
+
+} // queries()
+
+} // namespace LinearQuadTreeTests
+
+
+/*********************************************************************
+* Run tests for: LinearQuadTree.h
+*********************************************************************/
+void run_tests_LinearQuadTree()
+{
+  // Set logging output file
+  std::string log_file_path
+  { LinearQuadTreeTests::BASE_DIR + "/aux/test_logs/tests_LinearQuadTree.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  LinearQuadTreeTests::build();
+  LinearQuadTreeTests::queries();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_LinearQuadTree()
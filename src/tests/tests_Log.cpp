@@ -0,0 +1,221 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "Log.h"
+
+namespace LogTests
+{
+using namespace CppUtils;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+std::string LOG_FILE { BASE_DIR + "/aux/test_logs/tests_Log.output.log" };
+std::string TEST_LOG { BASE_DIR + "/aux/test_logs/tests_Log.log" };
+
+/*********************************************************************
+* Redirect all levels to the output file / back to the test log
+*********************************************************************/
+void log_to(const std::string& path)
+{
+  LOG_PROPERTIES.set_info_ostream( TO_FILE, path );
+  LOG_PROPERTIES.set_debug_ostream( TO_FILE, path );
+  LOG_PROPERTIES.set_warn_ostream( TO_FILE,
+    path.substr( 0, path.rfind( ".log" ) ) + ".warn.log" );
+}
+
+std::vector<std::string> read_lines(const std::string& path)
+{
+  std::ifstream file { path };
+  std::vector<std::string> lines {};
+  std::string line;
+
+  while ( std::getline( file, line ) )
+    lines.push_back( line );
+
+  return lines;
+}
+
+int n_calls = 0;
+
+int counted() { return ++n_calls; }
+
+/*********************************************************************
+*
+*********************************************************************/
+void synchronous_output()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: synchronous_output() ==========";
+  LOG(INFO) << "";
+
+  LOG_PROPERTIES.set_level( INFO );
+  log_to( LOG_FILE );
+
+  n_calls = 0;
+
+  LOG(INFO) << "value " << 3 << " " << 0.5;
+  LOG(DEBUG) << "skipped " << counted();
+  LOG(INFO, GREEN) << "colored";
+
+  // Arguments of nested messages are formatted separately
+  LOG(INFO) << "outer " << [] { LOG(INFO) << "inner"; return 1; }();
+
+  log_to( TEST_LOG );
+
+  // Disabled levels do not evaluate their arguments
+  CHECK( n_calls == 0 );
+
+  const auto lines = read_lines( LOG_FILE );
+
+  CHECK( lines.size() == 4 );
+  CHECK( lines[0] == "  value 3 0.5" );
+  CHECK( lines[1] == "  colored" );
+  CHECK( lines[2] == "  inner" );
+  CHECK( lines[3] == "  outer 1" );
+
+  LOG_PROPERTIES.set_level( DEBUG );
+
+} // synchronous_output()
+
+/*********************************************************************
+*
+*********************************************************************/
+void message_headers()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: message_headers() ==========";
+  LOG(INFO) << "";
+
+  log_to( LOG_FILE );
+
+  LOG_PROPERTIES.show_timestamp( true );
+  LOG_PROPERTIES.show_thread_id( true );
+
+  LOG(INFO) << "main";
+  std::thread { [] { LOG(INFO) << "worker"; } }.join();
+
+  LOG_PROPERTIES.show_timestamp( false );
+  LOG_PROPERTIES.show_thread_id( false );
+
+  log_to( TEST_LOG );
+
+  const auto lines = read_lines( LOG_FILE );
+
+  CHECK( lines.size() == 2 );
+
+  // "[    0.123456] [T00]   main"
+  double time = -1.0;
+  char   id[8];
+
+  CHECK( std::sscanf( lines[0].c_str(), "[%lf] [T%2s]", &time, id ) == 2 );
+  CHECK( time >= 0.0 );
+  CHECK( lines[0].substr( lines[0].size() - 6 ) == "  main" );
+  CHECK( lines[0].substr( 15, 5 ) != lines[1].substr( 15, 5 ) );
+
+} // message_headers()
+
+/*********************************************************************
+*
+*********************************************************************/
+void asynchronous_output()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: asynchronous_output() ==========";
+  LOG(INFO) << "";
+
+  constexpr int n_threads  = 4;
+  constexpr int n_messages = 20000;
+
+  log_to( LOG_FILE );
+
+  const size_t n_written = ASYNC_LOGGER.n_written();
+
+  LOG_PROPERTIES.use_async( true );
+  CHECK( ASYNC_LOGGER.running() );
+
+  std::vector<std::thread> threads {};
+
+  for ( int t = 0; t < n_threads; ++t )
+    threads.emplace_back( [t]
+    {
+      for ( int i = 0; i < n_messages; ++i )
+        LOG(INFO) << t << " " << i;
+    });
+
+  for ( auto& thread : threads )
+    thread.join();
+
+  // Streams are only replaced after all pending messages are written
+  log_to( TEST_LOG );
+
+  LOG_PROPERTIES.use_async( false );
+  CHECK( !ASYNC_LOGGER.running() );
+
+  CHECK( ASYNC_LOGGER.n_written() - n_written == n_threads * n_messages );
+
+  // Every message is written once and in order of its thread
+  const auto lines = read_lines( LOG_FILE );
+  CHECK( lines.size() == n_threads * n_messages );
+
+  std::vector<int> next ( n_threads, 0 );
+  bool ordered = true;
+
+  for ( const auto& line : lines )
+  {
+    int t = -1, i = -1;
+    std::istringstream { line } >> t >> i;
+
+    ordered &= ( t >= 0 && t < n_threads && next[t] == i );
+
+    if ( t >= 0 && t < n_threads )
+      ++next[t];
+  }
+
+  CHECK( ordered );
+
+  for ( int t = 0; t < n_threads; ++t )
+    CHECK( next[t] == n_messages );
+
+  LOG(INFO) << "Producer waits for full rings: " << ASYNC_LOGGER.n_waits();
+
+} // asynchronous_output()
+
+} // namespace LogTests
+
+
+/*********************************************************************
+* Run tests for: Log.h
+*********************************************************************/
+void run_tests_Log()
+{
+  // Set logging output file
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, LogTests::TEST_LOG );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, LogTests::TEST_LOG );
+
+  LogTests::synchronous_output();
+  LogTests::message_headers();
+  LogTests::asynchronous_output();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_warn_ostream( CppUtils::TO_COUT );
+
+} // run_tests_Log()
@@ -0,0 +1,301 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeResidual.h"
+#include "BoundaryConditions.h"
+#include "FluxJacobian.h"
+#include "LinearSolver.h"
+#include "NewtonKrylov.h"
+
+#include "definitions.h"
+
+namespace NewtonKrylovTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void gmres()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: gmres() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  const int n_elements = dualgrid.n_elements();
+  const int n          = n_elements * N_FLOW_VARS;
+
+  // A non-symmetric block system
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    U[i][IP] = 1.0;
+    U[i][IU] = 1.0 + 0.2 * dualgrid.coords()[i][1];
+    U[i][IV] = 0.1 * dualgrid.coords()[i][0];
+  }
+
+  DVec diag ( n_elements );
+  for ( int i = 0; i < n_elements; ++i )
+    diag[i] = 10.0 * dualgrid.volumes()[i];
+
+  FluxJacobian jacobian { dualgrid };
+  SparseMatrix A { dualgrid, N_FLOW_VARS };
+
+  jacobian.assemble( U, diag, A );
+
+  DVec b ( n );
+  for ( int i = 0; i < n; ++i )
+    b[i] = std::cos( 0.3 * i );
+
+  auto matvec = [&](const DVec& v, DVec& Av) { A.multiply( v, Av ); };
+
+  auto identity = [](const DVec& v, DVec& Mv) { Mv = v; };
+
+  BlockGaussSeidel gauss_seidel { 1 };
+  gauss_seidel.setup( A );
+
+  auto precond = [&](const DVec& v, DVec& Mv)
+  { gauss_seidel.solve( A, v, Mv ); };
+
+  // -----------------------------------------------------------------
+  // Both variants converge to the solution of the system
+  GMRES solver { n, 20, 1.0E-10, 500 };
+
+  DVec x_plain ( n, 0.0 );
+  DVec x_prec  ( n, 0.0 );
+
+  CHECK( solver.solve( matvec, identity, b, x_plain ) );
+  const int iter_plain = solver.iterations();
+
+  CHECK( solver.solve( matvec, precond, b, x_prec ) );
+  const int iter_prec = solver.iterations();
+
+  LOG(INFO) << "GMRES iterations (no preconditioner): " << iter_plain;
+  LOG(INFO) << "GMRES iterations (block SGS):         " << iter_prec;
+
+  DVec Ax ( n );
+  A.multiply( x_prec, Ax );
+
+  for ( int i = 0; i < n; ++i )
+  {
+    CHECK( std::fabs( Ax[i] - b[i] ) < 1.0E-8 );
+    CHECK( std::fabs( x_plain[i] - x_prec[i] ) < 1.0E-8 );
+  }
+
+  // -----------------------------------------------------------------
+  // The first-order preconditioner reduces the number of iterations
+  CHECK( iter_prec < iter_plain );
+
+} // gmres()
+
+/*********************************************************************
+*
+*********************************************************************/
+void steady_convergence()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: steady_convergence() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  const int n_elements = dualgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dualgrid.coords()[i][0];
+    const double y = dualgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = 0.1 * x;
+  }
+
+  NewtonKrylov solver { dualgrid, 10.0 };
+  solver.linear_tolerance( 1.0E-3 );
+
+  const bool converged = solver.solve( U, 1.0E-10, 50 );
+
+  const DVec& history = solver.residual_history();
+
+  LOG(INFO) << "Newton iterations:    " << solver.n_newton_iterations();
+  LOG(INFO) << "GMRES iterations:     " << solver.n_linear_iterations();
+  LOG(INFO) << "Residual evaluations: " 
+            << solver.n_residual_evaluations();
+
+  for ( size_t k = 0; k < history.size(); ++k )
+    LOG(INFO) << "  Residual " << k << ": " << history[k];
+
+  CHECK( converged );
+  CHECK( solver.n_newton_iterations() < 30 );
+  CHECK( history.back() <= 1.0E-10 * history.front() );
+
+  // The residual of the converged solution vanishes
+  EdgeResidual residual { dualgrid };
+  DMat R ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R );
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      CHECK( std::fabs( R[i][k] ) < 1.0E-8 );
+
+} // steady_convergence()
+
+/*********************************************************************
+*
+*********************************************************************/
+void second_order_convergence()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: second_order_convergence() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  const int n_elements = dualgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double y = dualgrid.coords()[i][1];
+
+    U[i][IP] = 0.0;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = 0.0;
+  }
+
+  BoundaryConditions bc { dualgrid };
+  bc.values( 1, { 0.0, 1.0, 0.0 } );
+
+  NewtonKrylov solver { dualgrid, 10.0 };
+  solver.linear_tolerance( 1.0E-3 );
+  solver.residual().second_order( true );
+  solver.residual().boundary_conditions( bc );
+  solver.residual().reconstruction().freeze_after( 4.0 );
+
+  const bool converged = solver.solve( U, 1.0E-8, 50 );
+
+  const DVec& history = solver.residual_history();
+
+  LOG(INFO) << "Newton iterations:    " << solver.n_newton_iterations();
+  LOG(INFO) << "GMRES iterations:     " << solver.n_linear_iterations();
+
+  for ( size_t k = 0; k < history.size(); ++k )
+    LOG(INFO) << "  Residual " << k << ": " << history[k];
+
+  CHECK( converged );
+
+  // The solver passes its residual norms to the reconstruction
+  CHECK( solver.residual().reconstruction().frozen() );
+
+  // The second-order residual of the converged solution vanishes
+  EdgeResidual residual { dualgrid };
+  residual.second_order( true );
+  residual.boundary_conditions( bc );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R );
+
+  double norm = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      norm += R[i][k] * R[i][k];
+
+  CHECK( std::sqrt( norm ) <= 1.0E-8 * history.front() );
+
+} // second_order_convergence()
+
+} // namespace NewtonKrylovTests
+
+
+/*********************************************************************
+* Run tests for: NewtonKrylov.h
+*********************************************************************/
+void run_tests_NewtonKrylov()
+{
+  // Set logging output file
+  std::string log_file_path
+  { NewtonKrylovTests::BASE_DIR + "/aux/test_logs/tests_NewtonKrylov.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  NewtonKrylovTests::gmres();
+  NewtonKrylovTests::steady_convergence();
+  NewtonKrylovTests::second_order_convergence();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_NewtonKrylov()
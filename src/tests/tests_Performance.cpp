@@ -0,0 +1,261 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeResidual.h"
+#include "SparseMatrix.h"
+#include "FluxJacobian.h"
+
+namespace PerformanceTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Baseline of the normalized throughputs, which is rewritten with
+* the measured throughputs for INCOMFLOW_UPDATE_BASELINE=1
+* (see the update_perf_baseline target)
+*********************************************************************/
+PerfBaseline& baseline()
+{
+  static PerfBaseline BASELINE = []()
+  {
+    PerfBaseline b { BASE_DIR + "/aux/test_data/PerformanceBaseline.dat" };
+
+    const char* update = std::getenv( "INCOMFLOW_UPDATE_BASELINE" );
+    b.update( update != nullptr && std::string( update ) == "1" );
+
+    return b;
+  }();
+
+  return BASELINE;
+}
+
+/*********************************************************************
+* Measure the normalized throughput of func() in processed vertices
+* and compare it against the baseline
+*********************************************************************/
+constexpr int N_REPEATS  = 21;
+constexpr int N_ATTEMPTS = 3;
+
+template <typename Func>
+void check_throughput(const std::string& name, int n_vertices, Func&& func)
+{
+  const PerfResult result = baseline().check( name, [&]()
+  {
+    return measure_normalized_throughput( n_vertices, N_REPEATS, func );
+  }, N_ATTEMPTS );
+
+  LOG(INFO) << "  " << result;
+
+  if ( !result.passed && result.baseline <= 0.0 )
+    LOG(WARNING) << "Missing baseline of " << name << " in "
+                 << baseline().file_path();
+  else if ( !result.passed )
+    LOG(WARNING) << "Performance regression of " << result;
+
+  CHECK( result.passed );
+
+} // check_throughput()
+
+/*********************************************************************
+* Measure the calibration kernel before the tests
+*********************************************************************/
+void calibration()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "  Calibration throughput: "
+            << calibration_throughput() << " elements/s";
+
+} // calibration()
+
+/*********************************************************************
+* Tests fail without a baseline, unless the baseline is updated
+*********************************************************************/
+void missing_baseline()
+{
+  PerfBaseline missing { BASE_DIR + "/aux/test_data/NoBaseline.dat" };
+
+  CHECK( !missing.loaded() );
+  CHECK( !missing.check( "Missing::test", 1.0 ).passed );
+
+  missing.update( true );
+  CHECK( missing.check( "Missing::test", 1.0 ).passed );
+
+} // missing_baseline()
+
+/*********************************************************************
+* Write the measured throughputs in update mode
+*********************************************************************/
+void update_baseline()
+{
+  if ( !baseline().update() )
+    return;
+
+  CHECK( baseline().save() );
+
+  LOG(INFO) << "";
+  LOG(INFO) << "  Baseline written to " << baseline().file_path();
+
+} // update_baseline()
+
+/*********************************************************************
+* Grid and solution of the performance tests
+*********************************************************************/
+BoundaryDef boundary_definition()
+{
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  return bdry_def;
+}
+
+DMat initial_solution(const DualGrid& dgrid)
+{
+  DMat U ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL );
+
+  for ( int i = 0; i < dgrid.n_elements(); ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * std::sin( 3.0 * y );
+    U[i][IV] = 0.1 * std::cos( 2.0 * x );
+  }
+
+  return U;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void dual_grid()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: dual_grid() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 160, 80, 2.0, 1.0 );
+  const BoundaryDef bdry_def = boundary_definition();
+
+  check_throughput( "DualGrid::build", primgrid.n_vertices(), [&]()
+  {
+    DualGrid dgrid { primgrid, bdry_def };
+  });
+
+} // dual_grid()
+
+/*********************************************************************
+*
+*********************************************************************/
+void residual()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: residual() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 160, 80, 2.0, 1.0 );
+  DualGrid    dgrid { primgrid, boundary_definition() };
+
+  const DMat U = initial_solution( dgrid );
+  DMat       R ( dgrid.n_elements(), N_FLOW_VARS, THREAD_POOL );
+
+  EdgeResidual residual { dgrid };
+
+  check_throughput( "EdgeResidual::compute", dgrid.n_elements(),
+    [&]() { residual.compute( U, R ); } );
+
+  residual.second_order( true );
+
+  check_throughput( "EdgeResidual::compute_second_order",
+    dgrid.n_elements(), [&]() { residual.compute( U, R ); } );
+
+} // residual()
+
+/*********************************************************************
+*
+*********************************************************************/
+void spmv()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: spmv() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 160, 80, 2.0, 1.0 );
+  DualGrid    dgrid { primgrid, boundary_definition() };
+
+  const DMat U = initial_solution( dgrid );
+
+  SparseMatrix jacobian { dgrid, N_FLOW_VARS };
+  FluxJacobian { dgrid }.assemble( U, jacobian );
+
+  DVec x ( dgrid.n_elements() * N_FLOW_VARS, 1.0 );
+  DVec y ( dgrid.n_elements() * N_FLOW_VARS, 0.0 );
+
+  check_throughput( "SparseMatrix::multiply", dgrid.n_elements(),
+    [&]() { jacobian.multiply( x, y ); } );
+
+} // spmv()
+
+} // namespace PerformanceTests
+
+
+/*********************************************************************
+* Run performance regression tests
+*********************************************************************/
+void run_tests_Performance()
+{
+  // Set logging output file
+  std::string log_file_path
+  { PerformanceTests::BASE_DIR + "/aux/test_logs/tests_Performance.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  // Single-threaded, such that the throughputs do not depend on the
+  // number of cores of the host
+  const int n_threads = CppUtils::THREAD_POOL.n_threads();
+  CppUtils::THREAD_POOL.n_threads( 1 );
+
+  PerformanceTests::missing_baseline();
+  PerformanceTests::calibration();
+  PerformanceTests::dual_grid();
+  PerformanceTests::residual();
+  PerformanceTests::spmv();
+  PerformanceTests::update_baseline();
+
+  CppUtils::THREAD_POOL.n_threads( n_threads );
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_Performance()
@@ -0,0 +1,430 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "PeriodicBoundaries.h"
+#include "EdgeResidual.h"
+#include "LocalTimeStep.h"
+#include "ResidualSmoothing.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace PeriodicBoundariesTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+constexpr double PI = 3.14159265358979323846;
+
+/*********************************************************************
+* Find the dual element at the given location
+*********************************************************************/
+int find_element(const DualGrid& dgrid, double x, double y)
+{
+  for ( int i = 0; i < dgrid.n_elements(); ++i )
+    if ( std::fabs( dgrid.coords()[i][0] - x ) < 1.0E-10
+      && std::fabs( dgrid.coords()[i][1] - y ) < 1.0E-10 )
+      return i;
+
+  return -1;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void pairing()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: pairing() ==========";
+  LOG(INFO) << "";
+
+  const int    nx = 16;
+  const int    ny = 10;
+  const double lx = 2.0;
+  const double ly = 1.0;
+
+  // Channel with periodic inlet and outlet
+  BoundaryDef channel_def {};
+  channel_def.add_marker( 1, BdryType::WALL     );
+  channel_def.add_marker( 2, BdryType::PERIODIC );
+  channel_def.add_marker( 3, BdryType::WALL     );
+  channel_def.add_marker( 4, BdryType::PERIODIC );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( nx, ny, lx, ly );
+  DualGrid    channel { primgrid, channel_def };
+
+  PeriodicBoundaries periodic { channel };
+  periodic.add_pair( 4, 2, { { lx, 0.0 } } );
+
+  CHECK( periodic.n_pairs() == ny + 1 );
+  CHECK( periodic.n_groups() == ny + 1 );
+
+  for ( int g = 0; g < periodic.n_groups(); ++g )
+  {
+    const int p0 = periodic.group_offsets()[g];
+    CHECK( periodic.group_offsets()[g+1] - p0 == 2 );
+
+    const int a = periodic.group_elements()[p0];
+    const int b = periodic.group_elements()[p0+1];
+
+    CHECK( std::fabs( std::fabs( channel.coords()[a][0]
+                               - channel.coords()[b][0] ) - lx ) < 1.0E-12 );
+    CHECK( channel.coords()[a][1] == channel.coords()[b][1] );
+  }
+
+  // Doubly periodic grid: the four corners form a single group
+  BoundaryDef torus_def {};
+  for ( int marker = 1; marker <= 4; ++marker )
+    torus_def.add_marker( marker, BdryType::PERIODIC );
+
+  DualGrid torus { primgrid, torus_def };
+
+  PeriodicBoundaries torus_periodic { torus };
+  torus_periodic.add_pair( 4, 2, { { lx, 0.0 } } );
+  torus_periodic.add_pair( 1, 3, { { 0.0, ly } } );
+
+  CHECK( torus_periodic.n_pairs() == nx + ny + 2 );
+  CHECK( torus_periodic.n_groups() == nx + ny - 1 );
+
+  int n_corner_groups = 0;
+
+  for ( int g = 0; g < torus_periodic.n_groups(); ++g )
+  {
+    const int size = torus_periodic.group_offsets()[g+1]
+                   - torus_periodic.group_offsets()[g];
+    CHECK( size == 2 || size == 4 );
+    n_corner_groups += ( size == 4 );
+  }
+
+  CHECK( n_corner_groups == 1 );
+
+} // pairing()
+
+/*********************************************************************
+* On a structured periodic channel, shifting the solution by one
+* cell shifts the residual per volume by one cell, also across the
+* periodic boundaries
+*********************************************************************/
+void merged_residual()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: merged_residual() ==========";
+  LOG(INFO) << "";
+
+  const int    nx = 12;
+  const int    ny = 8;
+  const double lx = 2.0;
+  const double ly = 1.0;
+  const double hx = lx / nx;
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::WALL     );
+  bdry_def.add_marker( 2, BdryType::PERIODIC );
+  bdry_def.add_marker( 3, BdryType::WALL     );
+  bdry_def.add_marker( 4, BdryType::PERIODIC );
+
+  PrimaryGrid primgrid = GridGenerator::structured( nx, ny, lx, ly );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  PeriodicBoundaries periodic { dgrid };
+  periodic.add_pair( 4, 2, { { lx, 0.0 } } );
+
+  EdgeResidual residual { dgrid };
+  residual.periodic_boundaries( periodic );
+
+  const int n_elements = dgrid.n_elements();
+
+  auto init = [&](DMat& U, double shift)
+  {
+    for ( int i = 0; i < n_elements; ++i )
+    {
+      const double x = dgrid.coords()[i][0] - shift;
+      const double y = dgrid.coords()[i][1];
+      const double s = std::sin( 2.0 * PI * x / lx );
+      const double c = std::cos( 2.0 * PI * x / lx );
+
+      U[i][IP] = 0.1 * s;
+      U[i][IU] = 1.0 + 0.2 * c * y * ( ly - y );
+      U[i][IV] = 0.1 * s * y * ( ly - y );
+    }
+  };
+
+  DMat U ( n_elements, N_FLOW_VARS );
+  DMat U_shift ( n_elements, N_FLOW_VARS );
+  init( U, 0.0 );
+  init( U_shift, hx );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  DMat R_shift ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R );
+  residual.compute( U_shift, R_shift );
+
+  const DVec& volumes = dgrid.volumes();
+
+  double r_max = 0.0;
+
+  for ( int ix = 0; ix <= nx; ++ix )
+    for ( int iy = 0; iy <= ny; ++iy )
+    {
+      const int i_src = ( ix == 0 ) ? nx - 1 : ix - 1;
+
+      const int i = find_element( dgrid, ix * hx, iy * ly / ny );
+      const int j = find_element( dgrid, i_src * hx, iy * ly / ny );
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+      {
+        CHECK( std::fabs( R_shift[i][k] / volumes[i]
+                        - R[j][k] / volumes[j] ) < 1.0E-10 );
+        r_max = MAX( r_max, std::fabs( R[j][k] ) );
+      }
+    }
+
+  CHECK( r_max > 1.0E-4 );
+
+} // merged_residual()
+
+/*********************************************************************
+*
+*********************************************************************/
+void rotated_pairing()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: rotated_pairing() ==========";
+  LOG(INFO) << "";
+
+  const int n = 10;
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::PERIODIC );
+  bdry_def.add_marker( 2, BdryType::WALL     );
+  bdry_def.add_marker( 3, BdryType::WALL     );
+  bdry_def.add_marker( 4, BdryType::PERIODIC );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( n, n );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  // A quarter turn around the center maps the left boundary onto
+  // the bottom boundary: (0,y) -> (1-y,0)
+  PeriodicTransform transform {};
+  transform.angle  = 0.5 * PI;
+  transform.center = { 0.5, 0.5 };
+
+  PeriodicBoundaries periodic { dgrid };
+  periodic.add_pair( 4, 1, transform );
+
+  // The corner (0,0) is linked to (1,0) and (0,1)
+  CHECK( periodic.n_groups() == n );
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = x + 2.0 * y;
+    U[i][IU] = 1.0 - x * y;
+    U[i][IV] = 0.5 * x;
+  }
+
+  periodic.synchronize( U );
+
+  // Partner velocities are rotated by a quarter turn
+  for ( int iy = 0; iy <= n; ++iy )
+  {
+    const double y = iy / static_cast<double>( n );
+
+    const int a = find_element( dgrid, 0.0, y );
+    const int b = find_element( dgrid, 1.0 - y, 0.0 );
+
+    CHECK( a >= 0 && b >= 0 );
+
+    CHECK( std::fabs( U[b][IP] - U[a][IP] ) < 1.0E-12 );
+    CHECK( std::fabs( U[b][IU] + U[a][IV] ) < 1.0E-12 );
+    CHECK( std::fabs( U[b][IV] - U[a][IU] ) < 1.0E-12 );
+  }
+
+  // Merged residuals per volume transform accordingly
+  EdgeResidual residual { dgrid };
+  residual.periodic_boundaries( periodic );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R );
+
+  const DVec& volumes = dgrid.volumes();
+
+  for ( int iy = 0; iy <= n; ++iy )
+  {
+    const double y = iy / static_cast<double>( n );
+
+    const int a = find_element( dgrid, 0.0, y );
+    const int b = find_element( dgrid, 1.0 - y, 0.0 );
+
+    const double* ra = R[a];
+    const double* rb = R[b];
+    const double  va = volumes[a];
+    const double  vb = volumes[b];
+
+    CHECK( std::fabs( rb[IP] / vb - ra[IP] / va ) < 1.0E-10 );
+    CHECK( std::fabs( rb[IU] / vb + ra[IV] / va ) < 1.0E-10 );
+    CHECK( std::fabs( rb[IV] / vb - ra[IU] / va ) < 1.0E-10 );
+  }
+
+} // rotated_pairing()
+
+/*********************************************************************
+* Local time steps and residual smoothing keep the periodic copies
+* identical during explicit pseudo time steps
+*********************************************************************/
+void local_time_stepping()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: local_time_stepping() ==========";
+  LOG(INFO) << "";
+
+  const int    nx = 12;
+  const int    ny = 8;
+  const double lx = 2.0;
+  const double ly = 1.0;
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::WALL     );
+  bdry_def.add_marker( 2, BdryType::PERIODIC );
+  bdry_def.add_marker( 3, BdryType::WALL     );
+  bdry_def.add_marker( 4, BdryType::PERIODIC );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( nx, ny, lx, ly );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  PeriodicBoundaries periodic { dgrid };
+  periodic.add_pair( 4, 2, { { lx, 0.0 } } );
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 0.1 * std::sin( 2.0 * PI * x / lx );
+    U[i][IU] = 1.0 + 0.2 * x * y * ( ly - y );
+    U[i][IV] = 0.1 * x * y * ( ly - y );
+  }
+
+  periodic.synchronize( U );
+
+  // Without merging, the copies obtain different time steps
+  LocalTimeStep unmerged { dgrid, 0.5 };
+  unmerged.compute( U );
+
+  double dt_diff = 0.0;
+
+  for ( int g = 0; g < periodic.n_groups(); ++g )
+  {
+    const int p0 = periodic.group_offsets()[g];
+    const int a  = periodic.group_elements()[p0];
+    const int b  = periodic.group_elements()[p0+1];
+
+    dt_diff = MAX( dt_diff, std::fabs( unmerged.time_steps()[a]
+                                     - unmerged.time_steps()[b] ) );
+  }
+
+  CHECK( dt_diff > 1.0E-6 );
+
+  EdgeResidual residual { dgrid };
+  residual.periodic_boundaries( periodic );
+
+  LocalTimeStep time_step { dgrid, 0.5 };
+  time_step.periodic_boundaries( periodic );
+
+  ResidualSmoothing smoothing { dgrid, N_FLOW_VARS };
+  smoothing.periodic_boundaries( periodic );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+
+  const DVec& volumes = dgrid.volumes();
+
+  for ( int step = 0; step < 10; ++step )
+  {
+    residual.compute( U, R );
+    smoothing.apply( R );
+
+    const DVec& dt = time_step.compute( U );
+
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        U[i][k] -= dt[i] / volumes[i] * R[i][k];
+  }
+
+  double u_diff = 0.0;
+
+  for ( int g = 0; g < periodic.n_groups(); ++g )
+  {
+    const int p0 = periodic.group_offsets()[g];
+    const int a  = periodic.group_elements()[p0];
+    const int b  = periodic.group_elements()[p0+1];
+
+    CHECK( time_step.time_steps()[a] == time_step.time_steps()[b] );
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      u_diff = MAX( u_diff, std::fabs( U[a][k] - U[b][k] ) );
+  }
+
+  LOG(INFO) << "Maximum time step difference (unmerged): " << dt_diff;
+  LOG(INFO) << "Maximum state difference of copies:      " << u_diff;
+
+  CHECK( u_diff < 1.0E-12 );
+
+} // local_time_stepping()
+
+} // namespace PeriodicBoundariesTests
+
+
+/*********************************************************************
+* Run tests for: PeriodicBoundaries.h
+*********************************************************************/
+void run_tests_PeriodicBoundaries()
+{
+  // Set logging output file
+  std::string log_file_path
+  { PeriodicBoundariesTests::BASE_DIR + "/aux/test_logs/tests_PeriodicBoundaries.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  PeriodicBoundariesTests::pairing();
+  PeriodicBoundariesTests::merged_residual();
+  PeriodicBoundariesTests::rotated_pairing();
+  PeriodicBoundariesTests::local_time_stepping();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_PeriodicBoundaries()
@@ -0,0 +1,258 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <random>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "PointLocator.h"
+
+#include "definitions.h"
+
+namespace PointLocatorTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Linear field, which is interpolated exactly by both element types
+*********************************************************************/
+double linear(const Vec2d& p) { return 1.0 + 2.0 * p.x - 3.0 * p.y; }
+
+/*********************************************************************
+* Check if element e contains p with a relative tolerance
+*********************************************************************/
+bool contains(const PrimaryGrid& grid, int e, const Vec2d& p)
+{
+  const int  n_quads = grid.n_quads();
+  const int  n       = ( e < n_quads ) ? 4 : 3;
+  const int* v       = ( e < n_quads ) ? grid.quads()[e]
+                                       : grid.tris()[e-n_quads];
+
+  for ( int k = 0; k < n; ++k )
+  {
+    const double* a = grid.vertex_coords()[ v[k] ];
+    const double* b = grid.vertex_coords()[ v[(k+1)%n] ];
+
+    const double cross = (b[0]-a[0]) * (p.y-a[1]) - (b[1]-a[1]) * (p.x-a[0]);
+
+    if ( cross < -1.0E-10 )
+      return false;
+  }
+
+  return true;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void single_queries()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: single_queries() ==========";
+  LOG(INFO) << "";
+
+  std::mt19937 gen { 5 };
+  std::uniform_real_distribution<double> coord { 0.0, 1.0 };
+
+  for ( int mixed = 0; mixed < 2; ++mixed )
+  {
+    PrimaryGrid grid = ( mixed )
+      ? GridGenerator::unstructured( 40, 32 )
+      : GridGenerator::structured( 40, 32 );
+
+    PointLocator locator { grid };
+
+    CHECK( locator.n_elements() == grid.n_tris() + grid.n_quads() );
+
+    DMat U ( grid.n_vertices(), 1 );
+
+    for ( int i = 0; i < grid.n_vertices(); ++i )
+      U[i][0] = linear( { grid.vertex_coords()[i][0],
+                          grid.vertex_coords()[i][1] } );
+
+    int prev = -1;
+
+    for ( int q = 0; q < 2000; ++q )
+    {
+      const Vec2d p { coord( gen ), coord( gen ) };
+
+      const PointLocation loc = locator.locate( p );
+
+      CHECK( loc.found() );
+      CHECK( contains( grid, loc.element, p ) );
+
+      double sum = 0.0;
+      for ( int j = 0; j < loc.n_vertices; ++j )
+      {
+        CHECK( loc.weights[j] > -1.0E-10 );
+        sum += loc.weights[j];
+      }
+      CHECK( std::fabs( sum - 1.0 ) < 1.0E-12 );
+
+      double value;
+      PointLocator::interpolate( U, loc, &value );
+      CHECK( std::fabs( value - linear( p ) ) < 1.0E-10 );
+
+      // Walks from arbitrary hints find the same element
+      if ( prev >= 0 )
+      {
+        const int e = locator.locate_element( p, prev );
+        CHECK( contains( grid, e, p ) );
+      }
+
+      prev = loc.element;
+    }
+
+    // Grid vertices are found in one of their elements
+    for ( int i = 0; i < grid.n_vertices(); i += 7 )
+    {
+      const Vec2d p { grid.vertex_coords()[i][0],
+                      grid.vertex_coords()[i][1] };
+
+      const PointLocation loc = locator.locate( p );
+      CHECK( loc.found() );
+
+      double value;
+      PointLocator::interpolate( U, loc, &value );
+      CHECK( std::fabs( value - linear( p ) ) < 1.0E-10 );
+    }
+
+    // Points outside of the grid
+    CHECK( !locator.locate( { -0.1, 0.5 } ).found() );
+    CHECK( !locator.locate( { 0.5, 1.01 } ).found() );
+    CHECK( !locator.locate( { 3.0, 3.0 } ).found() );
+    CHECK( locator.locate_element( { 1.2, 0.5 }, 0 ) < 0 );
+  }
+
+} // single_queries()
+
+/*********************************************************************
+*
+*********************************************************************/
+void batched_queries()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: batched_queries() ==========";
+  LOG(INFO) << "";
+
+  PrimaryGrid  grid = GridGenerator::unstructured( 50, 40, 2.0, 1.0 );
+  PointLocator locator { grid };
+
+  std::mt19937 gen { 9 };
+  std::uniform_real_distribution<double> x_coord { -0.1, 2.1 };
+  std::uniform_real_distribution<double> y_coord { -0.1, 1.1 };
+
+  std::vector<Vec2d> points ( 5000 );
+
+  for ( auto& p : points )
+    p = { x_coord( gen ), y_coord( gen ) };
+
+  DMat U ( grid.n_vertices(), 2 );
+
+  for ( int i = 0; i < grid.n_vertices(); ++i )
+  {
+    const Vec2d p { grid.vertex_coords()[i][0],
+                    grid.vertex_coords()[i][1] };
+    U[i][0] = linear( p );
+    U[i][1] = p.x;
+  }
+
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 64 );
+
+    const std::vector<PointLocation> locs = locator.locate( points );
+
+    CHECK( locs.size() == points.size() );
+
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+      const Vec2d& p = points[i];
+      const bool inside = ( p.x >= 0.0 && p.x <= 2.0
+                         && p.y >= 0.0 && p.y <= 1.0 );
+
+      CHECK( locs[i].found() == inside );
+
+      if ( inside )
+        CHECK( contains( grid, locs[i].element, p ) );
+    }
+
+    // Probes with cached weights
+    ProbeSet probes { locator, points };
+
+    CHECK( probes.size() == static_cast<int>( points.size() ) );
+
+    DMat values;
+    probes.interpolate( U, values );
+
+    CHECK( values.rows() == probes.size() );
+    CHECK( values.columns() == 2 );
+
+    int n_outside = 0;
+
+    for ( int i = 0; i < probes.size(); ++i )
+    {
+      if ( !probes.locations()[i].found() )
+      {
+        ++n_outside;
+        CHECK( values[i][0] == 0.0 && values[i][1] == 0.0 );
+        continue;
+      }
+
+      CHECK( std::fabs( values[i][0] - linear( points[i] ) ) < 1.0E-10 );
+      CHECK( std::fabs( values[i][1] - points[i].x ) < 1.0E-10 );
+    }
+
+    CHECK( n_outside == probes.n_outside() );
+    CHECK( n_outside > 0 );
+  }
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+} // batched_queries()
+
+} // namespace PointLocatorTests
+
+
+/*********************************************************************
+* Run tests for: PointLocator.h
+*********************************************************************/
+void run_tests_PointLocator()
+{
+  // Set logging output file
+  std::string log_file_path
+  { PointLocatorTests::BASE_DIR + "/aux/test_logs/tests_PointLocator.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  PointLocatorTests::single_queries();
+  PointLocatorTests::batched_queries();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_PointLocator()
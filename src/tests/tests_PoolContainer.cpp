@@ -0,0 +1,163 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "PoolContainer.h"
+
+namespace PoolContainerTests
+{
+using namespace CppUtils;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Test item, which counts its live instances
+*********************************************************************/
+struct Point
+{
+  static int n_alive;
+
+  Point(double x, double y, int id) : xy_ { x, y }, id_ { id }
+  { ++n_alive; }
+
+  ~Point() { --n_alive; }
+
+  const Vec2d& xy() const { return xy_; }
+  int id() const { return id_; }
+
+  Vec2d xy_;
+  int   id_;
+};
+
+int Point::n_alive = 0;
+
+/*********************************************************************
+*
+*********************************************************************/
+void insert_remove()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: insert_remove() ==========";
+  LOG(INFO) << "";
+
+  {
+    // Small slabs, such that several slabs are used
+    PoolContainer<Point,16> points { 100.0, 4, 10 };
+
+    std::vector<PoolHandle> handles;
+
+    for ( int i = 0; i < 100; ++i )
+    {
+      Point& p = points.push_back( 0.1 * i, 0.05 * i, i );
+      handles.push_back( points.handle( p ) );
+    }
+
+    CHECK( points.size() == 100 );
+    CHECK( points.capacity() == 112 );
+    CHECK( points.quad_tree().size() == 100 );
+    CHECK( Point::n_alive == 100 );
+
+    for ( int i = 0; i < 100; ++i )
+    {
+      CHECK( points[i].id() == i );
+      CHECK( points.get( handles[i] )->id() == i );
+    }
+
+    // Items keep their addresses
+    const Point* p50 = points.get( handles[50] );
+
+    // Remove all even items
+    for ( int i = 0; i < 100; i += 2 )
+      CHECK( points.remove( handles[i] ) );
+
+    CHECK( !points.remove( handles[0] ) );
+    CHECK( points.size() == 50 );
+    CHECK( points.quad_tree().size() == 50 );
+    CHECK( Point::n_alive == 50 );
+
+    for ( int i = 0; i < 100; ++i )
+      CHECK( points.valid( handles[i] ) == ( i % 2 == 1 ) );
+
+    // Dense iteration visits every live item once
+    std::vector<int> visited ( 100, 0 );
+
+    for ( const Point* p : points )
+      ++visited[ p->id() ];
+
+    for ( int i = 0; i < 100; ++i )
+      CHECK( visited[i] == i % 2 );
+
+    // Free slots are reused, old handles stay invalid
+    for ( int i = 0; i < 50; ++i )
+      points.push_back( 0.1 * i, 0.2, 100 + i );
+
+    CHECK( points.size() == 100 );
+    CHECK( points.capacity() == 112 );
+    CHECK( !points.valid( handles[50] ) );
+    CHECK( points.get( handles[51] )->id() == 51 );
+    CHECK( p50 != points.get( handles[51] ) );
+
+    // Quad tree queries
+    auto found = points.get_items( Vec2d { -0.01, 0.19 },
+                                   Vec2d { 10.0, 0.21 } );
+    CHECK( found.size() == 50 );
+
+    // Sorting by id
+    points.sort( [](const Point* a, const Point* b)
+                 { return a->id() < b->id(); } );
+
+    for ( size_t i = 1; i < points.size(); ++i )
+      CHECK( points[i-1].id() < points[i].id() );
+
+    CHECK( points.get( handles[51] )->id() == 51 );
+    CHECK( points.front().id() == 1 );
+    CHECK( points.back().id() == 149 );
+
+    points.clear();
+    CHECK( points.size() == 0 );
+    CHECK( points.quad_tree().size() == 0 );
+    CHECK( Point::n_alive == 0 );
+
+    points.push_back( 1.0, 1.0, 0 );
+  }
+
+  // The destructor releases all remaining items
+  CHECK( Point::n_alive == 0 );
+
+} // insert_remove()
+
+} // namespace PoolContainerTests
+
+
+/*********************************************************************
+* Run tests for: PoolContainer.h
+*********************************************************************/
+void run_tests_PoolContainer()
+{
+  // Set logging output file
+  std::string log_file_path
+  { PoolContainerTests::BASE_DIR + "/aux/test_logs/tests_PoolContainer.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  PoolContainerTests::insert_remove();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_PoolContainer()
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdio>
+#include <filesystem>
 
 #include <IncomFlowConfig.h>
 
@@ -17,6 +19,8 @@
 
 #include "PrimaryGrid.h"
 #include "PrimaryGridReader.h"
+#include "PrimaryGridWriter.h"
+#include "GridGenerator.h"
 
 namespace PrimaryGridTests 
 {
@@ -98,6 +102,71 @@ void read_grid()
 
 } // read_grid()
 
+/*********************************************************************
+* Write a generated grid and read it again
+*********************************************************************/
+void write_grid()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: write_grid() ==========";
+  LOG(INFO) << "";
+
+  const std::string grid_file_path {
+    ( std::filesystem::temp_directory_path() / "incomflow_grid.dat" ).string() };
+
+  for ( int quads = 0; quads < 2; ++quads )
+  {
+    PrimaryGrid grid = quads
+      ? GridGenerator::structured( 7, 5, 2.0, 1.0 )
+      : GridGenerator::unstructured( 7, 5, 2.0, 1.0 );
+
+    PrimaryGridWriter writer {};
+    CHECK( writer.write( grid, grid_file_path ) );
+
+    PrimaryGridReader reader {};
+    PrimaryGrid copy = reader.read( grid_file_path );
+
+    std::remove( grid_file_path.c_str() );
+
+    CHECK( copy.n_vertices() == grid.n_vertices() );
+    CHECK( copy.n_tris() == grid.n_tris() );
+    CHECK( copy.n_quads() == grid.n_quads() );
+    CHECK( copy.n_intr_edges() == grid.n_intr_edges() );
+    CHECK( copy.n_bdry_edges() == grid.n_bdry_edges() );
+
+    bool equal = true;
+
+    for ( int i = 0; i < grid.n_vertices(); ++i )
+      for ( int k = 0; k < 2; ++k )
+        equal &= ( copy.vertex_coords()[i][k] == grid.vertex_coords()[i][k] );
+
+    for ( int i = 0; i < grid.n_tris(); ++i )
+      for ( int k = 0; k < 3; ++k )
+        equal &= ( copy.tris()[i][k] == grid.tris()[i][k]
+                && copy.tri_neighbors()[i][k] == grid.tri_neighbors()[i][k] );
+
+    for ( int i = 0; i < grid.n_quads(); ++i )
+      for ( int k = 0; k < 4; ++k )
+        equal &= ( copy.quads()[i][k] == grid.quads()[i][k]
+                && copy.quad_neighbors()[i][k] == grid.quad_neighbors()[i][k] );
+
+    for ( int i = 0; i < grid.n_intr_edges(); ++i )
+      for ( int k = 0; k < 2; ++k )
+        equal &= ( copy.intr_edges()[i][k] == grid.intr_edges()[i][k]
+                && copy.intr_edge_neighbors()[i][k]
+                   == grid.intr_edge_neighbors()[i][k] );
+
+    for ( int i = 0; i < grid.n_bdry_edges(); ++i )
+      equal &= ( copy.bdry_edges()[i][0] == grid.bdry_edges()[i][0]
+              && copy.bdry_edges()[i][1] == grid.bdry_edges()[i][1]
+              && copy.bdry_edge_neighbors()[i] == grid.bdry_edge_neighbors()[i]
+              && copy.bdry_edge_markers()[i] == grid.bdry_edge_markers()[i] );
+
+    CHECK( equal );
+  }
+
+} // write_grid()
+
 } // namespace PrimaryGridTests
 
 
@@ -113,6 +182,7 @@ void run_tests_PrimaryGrid()
   CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
 
   PrimaryGridTests::read_grid();
+  PrimaryGridTests::write_grid();
 
   // Reset logging ostream
   CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
@@ -0,0 +1,256 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "Profiler.h"
+
+#include "definitions.h"
+#include "RungeKutta.h"
+
+namespace ProfilerTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Child node of a merged region
+*********************************************************************/
+const Profiler::Node* child(const Profiler::Node& node,
+                            const std::string& name)
+{
+  for ( const auto& c : node.children )
+    if ( c.name == name )
+      return &c;
+
+  return nullptr;
+}
+
+double work(int n)
+{
+  double sum = 0.0;
+  for ( int i = 0; i < n; ++i )
+    sum += std::sqrt( static_cast<double>( i ) );
+  return sum;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void nested_regions()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: nested_regions() ==========";
+  LOG(INFO) << "";
+
+  PROFILER.reset();
+  PROFILER.enable( true );
+
+  double sum = 0.0;
+
+  for ( int i = 0; i < 10; ++i )
+  {
+    PROFILE_SCOPE( "outer" );
+
+    {
+      PROFILE_SCOPE( "inner" );
+      sum += work( 1000 );
+    }
+
+    for ( int j = 0; j < 3; ++j )
+    {
+      PROFILE_SCOPE( "loop" );
+      sum += work( 100 );
+    }
+  }
+
+  // Regions are not recorded, while the profiler is disabled
+  PROFILER.enable( false );
+  {
+    PROFILE_SCOPE( "disabled" );
+    sum += work( 10 );
+  }
+
+  CHECK( sum > 0.0 );
+
+  const Profiler::Node root = PROFILER.tree();
+
+  CHECK( root.children.size() == 1 );
+
+  const Profiler::Node* outer = child( root, "outer" );
+  CHECK( outer != nullptr );
+  CHECK( outer->calls == 10 );
+  CHECK( outer->n_threads == 1 );
+  CHECK( outer->children.size() == 2 );
+
+  const Profiler::Node* inner = child( *outer, "inner" );
+  const Profiler::Node* loop  = child( *outer, "loop" );
+
+  CHECK( inner != nullptr && inner->calls == 10 );
+  CHECK( loop != nullptr && loop->calls == 30 );
+
+  CHECK( outer->min <= outer->mean() && outer->mean() <= outer->max );
+  CHECK( inner->total + loop->total <= outer->total );
+  CHECK( std::fabs( root.total - outer->total ) < 1.0E-12 );
+
+  PROFILER.summary();
+
+} // nested_regions()
+
+/*********************************************************************
+*
+*********************************************************************/
+void threaded_regions()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: threaded_regions() ==========";
+  LOG(INFO) << "";
+
+  PROFILER.reset();
+  PROFILER.enable( true );
+  PROFILER.hardware_counters( true );
+
+  constexpr int n_threads = 4;
+  std::vector<std::thread> threads {};
+  std::vector<double>      sums ( n_threads, 0.0 );
+
+  for ( int t = 0; t < n_threads; ++t )
+    threads.emplace_back( [t, &sums]
+    {
+      for ( int i = 0; i <= t; ++i )
+      {
+        PROFILE_SCOPE( "kernel" );
+        PROFILE_SCOPE( "work" );
+        sums[t] += work( 10000 );
+      }
+    });
+
+  for ( auto& thread : threads )
+    thread.join();
+
+  PROFILER.enable( false );
+  PROFILER.hardware_counters( false );
+
+  // The regions of all threads are merged
+  const Profiler::Node  root   = PROFILER.tree();
+  const Profiler::Node* kernel = child( root, "kernel" );
+
+  CHECK( kernel != nullptr );
+  CHECK( kernel->calls == 1 + 2 + 3 + 4 );
+  CHECK( kernel->n_threads == n_threads );
+  CHECK( child( *kernel, "work" ) != nullptr );
+  CHECK( child( *kernel, "work" )->calls == kernel->calls );
+
+  PROFILER.summary();
+
+} // threaded_regions()
+
+/*********************************************************************
+*
+*********************************************************************/
+void chrome_trace()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: chrome_trace() ==========";
+  LOG(INFO) << "";
+
+  const std::string path { BASE_DIR + "/aux/test_logs/tests_Profiler.trace.json" };
+
+  PROFILER.reset();
+  PROFILER.enable( true );
+  PROFILER.tracing( true );
+  PROFILER.max_events( 5 );
+
+  // Instrumented solver stages
+  constexpr int n_elements = 4;
+
+  DMat U ( n_elements, 1 );
+  DVec volumes ( n_elements, 1.0 );
+
+  auto residual = [&](const DMat& Uk, DMat& R)
+  {
+    PROFILE_SCOPE( "residual \"decay\"" );
+
+    for ( int i = 0; i < n_elements; ++i )
+      R[i][0] = Uk[i][0];
+  };
+
+  RungeKutta rk { RKScheme::SSPRK3, n_elements, 1 };
+  rk.step( U, volumes, 0.1, residual );
+
+  PROFILER.enable( false );
+  PROFILER.tracing( false );
+
+  const Profiler::Node  root = PROFILER.tree();
+  const Profiler::Node* step = child( root, "RungeKutta::step" );
+
+  CHECK( step != nullptr && step->calls == 1 );
+  CHECK( child( *step, "RungeKutta::update" )->calls == 3 );
+  CHECK( child( *step, "residual \"decay\"" )->calls == 3 );
+
+  CHECK( PROFILER.write_chrome_trace( path ) );
+  PROFILER.max_events( 1000000 );
+
+  std::ifstream file { path };
+  std::stringstream content {};
+  content << file.rdbuf();
+  const std::string json = content.str();
+
+  // Only the first five events are recorded
+  size_t n_events = 0;
+  for ( size_t pos = json.find( "\"ph\":\"X\"" ); pos != std::string::npos;
+        pos = json.find( "\"ph\":\"X\"", pos+1 ) )
+    ++n_events;
+
+  CHECK( n_events == 5 );
+  CHECK( json.find( "{\"displayTimeUnit\"" ) == 0 );
+  CHECK( json.find( "residual \\\"decay\\\"" ) != std::string::npos );
+  CHECK( json.find( "\n]}\n" ) != std::string::npos );
+
+  PROFILER.reset();
+
+} // chrome_trace()
+
+} // namespace ProfilerTests
+
+
+/*********************************************************************
+* Run tests for: Profiler.h
+*********************************************************************/
+void run_tests_Profiler()
+{
+  // Set logging output file
+  std::string log_file_path
+  { ProfilerTests::BASE_DIR + "/aux/test_logs/tests_Profiler.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  CppUtils::PROFILER.summary_at_exit( false );
+
+  ProfilerTests::nested_regions();
+  ProfilerTests::threaded_regions();
+  ProfilerTests::chrome_trace();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_Profiler()
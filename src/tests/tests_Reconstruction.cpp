@@ -0,0 +1,414 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "Reconstruction.h"
+#include "EdgeResidual.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace ReconstructionTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Boundary definition of the generated grids
+*********************************************************************/
+BoundaryDef boundary_definition()
+{
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  return bdry_def;
+}
+
+/*********************************************************************
+* Flags of the elements, which are adjacent to a boundary
+*********************************************************************/
+IVec boundary_elements(const DualGrid& dgrid)
+{
+  IVec flags ( dgrid.n_elements(), 0 );
+
+  for ( const auto& bdry : dgrid.boundaries() )
+    for ( int i : bdry.dual_elements() )
+      flags[i] = 1;
+
+  return flags;
+}
+
+/*********************************************************************
+*
+*********************************************************************/
+void linear_field()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: linear_field() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  for ( int mixed = 0; mixed < 2; ++mixed )
+  {
+    PrimaryGrid primgrid = ( mixed )
+      ? GridGenerator::unstructured( 20, 16 )
+      : GridGenerator::structured( 20, 16 );
+
+    DualGrid dgrid { primgrid, bdry_def };
+
+    const int  n_elements = dgrid.n_elements();
+    const IVec on_bdry    = boundary_elements( dgrid );
+
+    DMat U ( n_elements, N_FLOW_VARS );
+
+    for ( int i = 0; i < n_elements; ++i )
+    {
+      const double x = dgrid.coords()[i][0];
+      const double y = dgrid.coords()[i][1];
+
+      U[i][IP] = 1.0 + 2.0 * x - 3.0 * y;
+      U[i][IU] = 0.5 * x;
+      U[i][IV] = -4.0 * y;
+    }
+
+    const double grad[N_FLOW_VARS][2] = { {  2.0, -3.0 },
+                                          {  0.5,  0.0 },
+                                          {  0.0, -4.0 } };
+
+    Reconstruction recon { dgrid };
+    recon.limiter( LimiterType::BARTH_JESPERSEN );
+    recon.compute( U );
+
+    // Green-Gauss gradients of linear fields are exact and
+    // linear fields are never limited in the interior
+    for ( int i = 0; i < n_elements; ++i )
+    {
+      if ( on_bdry[i] )
+        continue;
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+      {
+        CHECK( std::fabs( recon.gradients_x()[k][i] - grad[k][0] ) < 1.0E-10 );
+        CHECK( std::fabs( recon.gradients_y()[k][i] - grad[k][1] ) < 1.0E-10 );
+        CHECK( std::fabs( recon.limiters()[k][i] - 1.0 ) < 1.0E-12 );
+        CHECK( std::fabs( recon.slopes()[i][2*k] - grad[k][0] ) < 1.0E-10 );
+      }
+    }
+  }
+
+} // linear_field()
+
+/*********************************************************************
+*
+*********************************************************************/
+void bounded_states()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: bounded_states() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 30, 24 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int   n_elements = dgrid.n_elements();
+  const IMat& nbrs       = dgrid.face_neighbors();
+  const IVec& offsets    = dgrid.adj_offsets();
+  const IVec& adj        = dgrid.adj_elements();
+
+  // Discontinuities in all variables
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = ( x < 0.5 ) ? 1.0 : 0.0;
+    U[i][IU] = ( x + y < 0.8 ) ? 2.0 : -1.0;
+    U[i][IV] = ( ( x - 0.5 ) * ( x - 0.5 ) + ( y - 0.5 ) * ( y - 0.5 )
+                 < 0.1 ) ? 1.0 : 0.0;
+  }
+
+  for ( LimiterType type : { LimiterType::BARTH_JESPERSEN,
+                             LimiterType::VENKATAKRISHNAN } )
+  {
+    Reconstruction recon { dgrid };
+    recon.limiter( type );
+    recon.venkatakrishnan_constant( 0.0 );
+    recon.compute( U );
+
+    int n_limited = 0;
+
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      for ( int i = 0; i < n_elements; ++i )
+      {
+        const double phi = recon.limiters()[k][i];
+        CHECK( phi >= 0.0 && phi <= 1.0 );
+        n_limited += ( phi < 1.0 );
+      }
+
+    CHECK( n_limited > 0 );
+
+    // Barth-Jespersen states lie within the neighbor extrema
+    if ( type != LimiterType::BARTH_JESPERSEN )
+      continue;
+
+    for ( int f = 0; f < dgrid.n_intr_faces(); ++f )
+    {
+      const int i = nbrs[f][0];
+      const int j = nbrs[f][1];
+
+      double ul[N_FLOW_VARS];
+      double ur[N_FLOW_VARS];
+      recon.face_states( U, i, j, ul, ur );
+
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+      {
+        for ( int e : { i, j } )
+        {
+          double lo = U[e][k];
+          double hi = U[e][k];
+
+          for ( int a = offsets[e]; a < offsets[e+1]; ++a )
+          {
+            lo = MIN( lo, U[ adj[a] ][k] );
+            hi = MAX( hi, U[ adj[a] ][k] );
+          }
+
+          const double u_face = ( e == i ) ? ul[k] : ur[k];
+
+          CHECK( u_face >= lo - 1.0E-12 );
+          CHECK( u_face <= hi + 1.0E-12 );
+        }
+      }
+    }
+  }
+
+} // bounded_states()
+
+/*********************************************************************
+*
+*********************************************************************/
+void freezing()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: freezing() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 20, 16 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    U[i][IP] = ( x < 0.5 ) ? 1.0 : 0.0;
+    U[i][IU] = x * x;
+    U[i][IV] = 0.0;
+  }
+
+  Reconstruction recon { dgrid };
+  recon.limiter( LimiterType::BARTH_JESPERSEN );
+  recon.freeze_after( 2.0 );
+
+  // Residual drops by less than two orders
+  recon.monitor_residual( 1.0 );
+  recon.monitor_residual( 0.05 );
+  CHECK( !recon.frozen() );
+
+  recon.compute( U );
+  const DMat phi = recon.limiters();
+
+  recon.monitor_residual( 0.009 );
+  CHECK( recon.frozen() );
+
+  // Frozen limiters are kept, while the gradients are updated
+  for ( int i = 0; i < n_elements; ++i )
+    U[i][IP] = ( dgrid.coords()[i][1] < 0.5 ) ? 1.0 : 0.0;
+
+  recon.compute( U );
+
+  double dgrad = 0.0;
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+    {
+      const double p = recon.limiters()[k][i];
+      CHECK( p == phi[k][i] );
+      CHECK( recon.slopes()[i][2*k+1] == p * recon.gradients_y()[k][i] );
+    }
+
+    dgrad += std::fabs( recon.gradients_y()[IP][i] );
+  }
+
+  CHECK( dgrad > 0.0 );
+
+  // Manual unfreezing updates the limiters again
+  recon.freeze( false );
+  recon.compute( U );
+
+  bool changed = false;
+  for ( int i = 0; i < n_elements; ++i )
+    changed |= ( recon.limiters()[IP][i] != phi[IP][i] );
+
+  CHECK( changed );
+
+  // Timings of all variables and evaluations
+  CHECK( recon.n_evaluations() == 3 );
+
+  for ( double t : recon.variable_times() )
+    CHECK( t > 0.0 );
+
+  recon.reset_timings();
+  CHECK( recon.n_evaluations() == 0 );
+
+} // freezing()
+
+/*********************************************************************
+*
+*********************************************************************/
+void second_order_residual()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: second_order_residual() ==========";
+  LOG(INFO) << "";
+
+  const BoundaryDef bdry_def = boundary_definition();
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 30, 26 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  const int n_elements = dgrid.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dgrid.coords()[i][0];
+    const double y = dgrid.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = ( x < 0.4 ) ? 0.1 : 0.0;
+  }
+
+  EdgeResidual residual { dgrid };
+
+  DMat R_first ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R_first );
+
+  residual.second_order( true );
+  CHECK( residual.second_order() );
+
+  DMat R_ref ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R_ref );
+
+  double diff = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      diff += std::fabs( R_ref[i][k] - R_first[i][k] );
+
+  CHECK( diff > 1.0E-6 );
+
+  // All accumulation strategies agree
+  const FluxAccumulation modes[] = { FluxAccumulation::EDGE_COLORING,
+                                     FluxAccumulation::OWNER_COMPUTES,
+                                     FluxAccumulation::TILED };
+
+  residual.tile_size( 100 );
+
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 1 );
+
+    for ( FluxAccumulation mode : modes )
+    {
+      residual.accumulation( mode );
+
+      DMat R ( n_elements, N_FLOW_VARS );
+      residual.compute( U, R );
+
+      for ( int i = 0; i < n_elements; ++i )
+        for ( int k = 0; k < N_FLOW_VARS; ++k )
+          CHECK( std::fabs( R[i][k] - R_ref[i][k] ) < 1.0E-12 );
+    }
+  }
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+  // First order again
+  residual.second_order( false );
+  residual.accumulation( FluxAccumulation::FACE_GATHER );
+
+  DMat R ( n_elements, N_FLOW_VARS );
+  residual.compute( U, R );
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      CHECK( R[i][k] == R_first[i][k] );
+
+} // second_order_residual()
+
+} // namespace ReconstructionTests
+
+
+/*********************************************************************
+* Run tests for: Reconstruction.h
+*********************************************************************/
+void run_tests_Reconstruction()
+{
+  // Set logging output file
+  std::string log_file_path
+  { ReconstructionTests::BASE_DIR + "/aux/test_logs/tests_Reconstruction.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  ReconstructionTests::linear_field();
+  ReconstructionTests::bounded_states();
+  ReconstructionTests::freezing();
+  ReconstructionTests::second_order_residual();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_Reconstruction()
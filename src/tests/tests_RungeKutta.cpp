@@ -0,0 +1,338 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeResidual.h"
+#include "RungeKutta.h"
+#include "LocalTimeStep.h"
+#include "ResidualSmoothing.h"
+
+#include "definitions.h"
+
+namespace RungeKuttaTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+* Integrate dU/dt = -U up to t=1 and return the maximum error
+*********************************************************************/
+double decay_error(RKScheme scheme, int n_steps)
+{
+  const int n_elements = 4;
+
+  DMat U ( n_elements, 2 );
+  DVec volumes ( n_elements, 0.5 );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    U[i][0] = 1.0;
+    U[i][1] = 2.0;
+  }
+
+  // R = V * U  ->  dU/dt = -U
+  auto residual = [&](const DMat& Uk, DMat& R)
+  {
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < 2; ++k )
+        R[i][k] = volumes[i] * Uk[i][k];
+  };
+
+  RungeKutta rk { scheme, n_elements, 2 };
+
+  const double dt = 1.0 / static_cast<double>( n_steps );
+
+  for ( int n = 0; n < n_steps; ++n )
+    rk.step( U, volumes, dt, residual );
+
+  double error = 0.0;
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    error = MAX( error, std::fabs( U[i][0] - std::exp(-1.0) ) );
+    error = MAX( error, std::fabs( U[i][1] - 2.0 * std::exp(-1.0) ) );
+  }
+
+  return error;
+
+} // decay_error()
+
+/*********************************************************************
+*
+*********************************************************************/
+void order_of_accuracy()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: order_of_accuracy() ==========";
+  LOG(INFO) << "";
+
+  // -----------------------------------------------------------------
+  // LSRK4 must converge with fourth order
+  const double e4_coarse = decay_error( RKScheme::LSRK4, 10 );
+  const double e4_fine   = decay_error( RKScheme::LSRK4, 20 );
+  const double order_4   = std::log2( e4_coarse / e4_fine );
+
+  LOG(INFO) << "LSRK4 convergence order: " << order_4;
+
+  CHECK( e4_fine < 1.0E-6 );
+  CHECK( order_4 > 3.8 && order_4 < 4.3 );
+
+  // -----------------------------------------------------------------
+  // SSPRK3 must converge with third order
+  const double e3_coarse = decay_error( RKScheme::SSPRK3, 10 );
+  const double e3_fine   = decay_error( RKScheme::SSPRK3, 20 );
+  const double order_3   = std::log2( e3_coarse / e3_fine );
+
+  LOG(INFO) << "SSPRK3 convergence order: " << order_3;
+
+  CHECK( e3_fine < 1.0E-4 );
+  CHECK( order_3 > 2.8 && order_3 < 3.3 );
+
+  RungeKutta rk4 { RKScheme::LSRK4, 1, 1 };
+  RungeKutta rk3 { RKScheme::SSPRK3, 1, 1 };
+
+  CHECK( rk4.n_stages() == 5 );
+  CHECK( rk3.n_stages() == 3 );
+
+} // order_of_accuracy()
+
+/*********************************************************************
+*
+*********************************************************************/
+void free_stream()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: free_stream() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  EdgeResidual residual { dualgrid };
+
+  // A uniform flow field must be preserved exactly
+  DMat U ( dualgrid.n_elements(), N_FLOW_VARS );
+
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+  {
+    U[i][IP] = 1.0;
+    U[i][IU] = 1.0;
+    U[i][IV] = 0.5;
+  }
+
+  DMat R ( dualgrid.n_elements(), N_FLOW_VARS );
+  residual.compute( U, R );
+
+  for ( int i = 0; i < dualgrid.n_elements(); ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      CHECK( EQ0( R[i][k] ) );
+
+  for ( auto scheme : { RKScheme::LSRK4, RKScheme::SSPRK3 } )
+  {
+    RungeKutta rk { scheme, dualgrid.n_elements(), N_FLOW_VARS };
+
+    for ( int n = 0; n < 10; ++n )
+      rk.step( U, dualgrid.volumes(), 1.0E-2, residual );
+
+    for ( int i = 0; i < dualgrid.n_elements(); ++i )
+    {
+      CHECK( EQ( U[i][IP], 1.0 ) );
+      CHECK( EQ( U[i][IU], 1.0 ) );
+      CHECK( EQ( U[i][IV], 0.5 ) );
+    }
+  }
+
+} // free_stream()
+
+/*********************************************************************
+*
+*********************************************************************/
+void local_time_stepping()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: local_time_stepping() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  DualGrid dualgrid { primgrid, bdry_def };
+
+  EdgeResidual residual { dualgrid };
+
+  const int n_elements = dualgrid.n_elements();
+
+  // A perturbed flow field 
+  DMat U_init ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = dualgrid.coords()[i][0];
+    const double y = dualgrid.coords()[i][1];
+
+    U_init[i][IP] = 1.0 + 0.1 * x * y;
+    U_init[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U_init[i][IV] = 0.1 * x;
+  }
+
+  // -----------------------------------------------------------------
+  // Local time steps correspond to the local CFL number
+  LocalTimeStep time_step { dualgrid, 0.8 };
+  const DVec& dt = time_step.compute( U_init );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    CHECK( dt[i] > 0.0 );
+    CHECK( dt[i] >= time_step.min_time_step() );
+  }
+
+  // The smallest elements are located at the domain corners
+  CHECK( EQ( time_step.min_time_step(), dt[0] ) 
+      || EQ( time_step.min_time_step(), dt[4] ) 
+      || EQ( time_step.min_time_step(), dt[8] ) 
+      || EQ( time_step.min_time_step(), dt[12] ) );
+
+  // -----------------------------------------------------------------
+  // Residual smoothing preserves constant residuals
+  ResidualSmoothing smoothing { dualgrid, N_FLOW_VARS, 0.5, 2 };
+
+  DMat R ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      R[i][k] = 2.0;
+
+  smoothing.apply( R );
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      CHECK( EQ( R[i][k], 2.0 ) );
+
+  // -----------------------------------------------------------------
+  // Local time stepping converges faster towards the steady state
+  auto residual_norm = [&](const DMat& U)
+  {
+    DMat Rn ( n_elements, N_FLOW_VARS );
+    residual.compute( U, Rn );
+
+    double norm = 0.0;
+    for ( int i = 0; i < n_elements; ++i )
+      for ( int k = 0; k < N_FLOW_VARS; ++k )
+        norm += Rn[i][k] * Rn[i][k] / dualgrid.volumes()[i];
+
+    return std::sqrt( norm );
+  };
+
+  const int n_iter = 50;
+
+  DMat U_global = U_init;
+  DMat U_local  = U_init;
+  DMat U_smooth = U_init;
+
+  RungeKutta rk { RKScheme::LSRK4, n_elements, N_FLOW_VARS };
+
+  for ( int n = 0; n < n_iter; ++n )
+  {
+    time_step.cfl( 0.8 );
+    time_step.compute( U_global );
+    rk.step( U_global, dualgrid.volumes(), 
+             time_step.min_time_step(), residual );
+
+    time_step.compute( U_local );
+    rk.step( U_local, dualgrid.volumes(), 
+             time_step.time_steps(), residual );
+
+    // Smoothing allows for larger CFL numbers
+    time_step.cfl( 1.6 );
+    time_step.compute( U_smooth );
+    rk.step( U_smooth, dualgrid.volumes(), time_step.time_steps(), 
+      [&](const DMat& Uk, DMat& Rk)
+      {
+        residual.compute( Uk, Rk );
+        smoothing.apply( Rk );
+      });
+  }
+
+  const double res_init   = residual_norm( U_init );
+  const double res_global = residual_norm( U_global );
+  const double res_local  = residual_norm( U_local );
+  const double res_smooth = residual_norm( U_smooth );
+
+  LOG(INFO) << "Initial residual:          " << res_init;
+  LOG(INFO) << "Residual (global dt):      " << res_global;
+  LOG(INFO) << "Residual (local dt):       " << res_local;
+  LOG(INFO) << "Residual (local dt + IRS): " << res_smooth;
+
+  CHECK( res_global < res_init );
+  CHECK( res_local < res_global );
+  CHECK( res_smooth < res_global );
+
+} // local_time_stepping()
+
+} // namespace RungeKuttaTests
+
+
+/*********************************************************************
+* Run tests for: RungeKutta.h
+*********************************************************************/
+void run_tests_RungeKutta()
+{
+  // Set logging output file
+  std::string log_file_path
+  { RungeKuttaTests::BASE_DIR + "/aux/test_logs/tests_RungeKutta.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  RungeKuttaTests::order_of_accuracy();
+  RungeKuttaTests::free_stream();
+  RungeKuttaTests::local_time_stepping();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_RungeKutta()
@@ -0,0 +1,329 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "EdgeResidual.h"
+#include "SparseMatrix.h"
+#include "LinearSolver.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace ThreadPoolTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void parallel_loops()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: parallel_loops() ==========";
+  LOG(INFO) << "";
+
+  ThreadPool pool { 4 };
+  pool.grain_size( 10 );
+
+  CHECK( pool.n_threads() == 4 );
+  CHECK( pool.n_chunks( 5, 10 ) == 1 );
+  CHECK( pool.n_chunks( 35, 10 ) == 4 );
+  CHECK( pool.n_chunks( 100000, 10 ) == 16 );
+
+  // -----------------------------------------------------------------
+  // Every index is visited exactly once
+  const int n = 10007;
+
+  std::vector<std::atomic<int>> visits ( n );
+  for ( auto& v : visits )
+    v = 0;
+
+  pool.parallel_for(0, n, [&](int i) { ++visits[i]; });
+
+  bool all_once = true;
+  for ( auto& v : visits )
+    all_once &= ( v == 1 );
+
+  CHECK( all_once );
+
+  // -----------------------------------------------------------------
+  // Chunks are contiguous and cover the whole range
+  std::atomic<int>  n_indices    { 0 };
+  std::atomic<bool> valid_chunks { true };
+
+  pool.parallel_for_range(3, n, [&](int i0, int i1)
+  {
+    if ( i0 < 3 || i1 > n || i0 >= i1 )
+      valid_chunks = false;
+    n_indices += i1 - i0;
+  });
+
+  CHECK( valid_chunks );
+  CHECK( n_indices == n - 3 );
+
+  // -----------------------------------------------------------------
+  // Reductions are exact for integers and reproducible for doubles
+  const long long sum = pool.parallel_reduce(0, n, 0LL,
+    [](int i0, int i1)
+    {
+      long long s = 0;
+      for ( int i = i0; i < i1; ++i )
+        s += i;
+      return s;
+    },
+    [](long long a, long long b) { return a + b; });
+
+  CHECK( sum == static_cast<long long>(n) * (n-1) / 2 );
+
+  auto harmonic = [&]()
+  {
+    return pool.parallel_reduce(0, n, 0.0,
+      [](int i0, int i1)
+      {
+        double s = 0.0;
+        for ( int i = i0; i < i1; ++i )
+          s += 1.0 / ( 1.0 + i );
+        return s;
+      },
+      [](double a, double b) { return a + b; });
+  };
+
+  const double h0 = harmonic();
+  for ( int k = 0; k < 10; ++k )
+    CHECK( harmonic() == h0 );
+
+  // -----------------------------------------------------------------
+  // Nested loops do not dead-lock
+  std::atomic<int> n_inner { 0 };
+
+  pool.parallel_for(0, 64, 1, [&](int)
+  {
+    pool.parallel_for(0, 100, 1, [&](int) { ++n_inner; });
+  });
+
+  CHECK( n_inner == 6400 );
+
+  // -----------------------------------------------------------------
+  // Resizing and pinning restart the workers
+  pool.n_threads( 2 );
+  pool.pin_threads( true );
+
+  std::atomic<int> n_visits { 0 };
+  pool.parallel_for(0, 1000, [&](int) { ++n_visits; });
+
+  CHECK( pool.n_threads() == 2 );
+  CHECK( n_visits == 1000 );
+
+  // -----------------------------------------------------------------
+  // First-touch initialized matrices are zero
+  DMat M ( 1000, 3, pool );
+
+  bool all_zero = true;
+  for ( int i = 0; i < M.rows(); ++i )
+    for ( int k = 0; k < M.columns(); ++k )
+      all_zero &= ( M[i][k] == 0.0 );
+
+  CHECK( all_zero );
+
+  // -----------------------------------------------------------------
+  // Exceptions are rethrown after all chunks have finished
+  std::atomic<int> n_finished { 0 };
+  bool             thrown     = false;
+
+  try
+  {
+    pool.parallel_for_range(0, 1000, 10, [&](int i0, int)
+    {
+      if ( i0 == 0 )
+        throw std::runtime_error( "chunk failed" );
+
+      std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+      ++n_finished;
+    });
+  }
+  catch ( const std::runtime_error& )
+  {
+    thrown = true;
+  }
+
+  CHECK( thrown );
+  CHECK( n_finished == pool.n_chunks( 1000, 10 ) - 1 );
+
+} // parallel_loops()
+
+/*********************************************************************
+*
+*********************************************************************/
+void parallel_solver_kernels()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: parallel_solver_kernels() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+
+  bdry_def.add_marker( 1, BdryType::INLET  );
+  bdry_def.add_marker( 2, BdryType::WALL   );
+  bdry_def.add_marker( 3, BdryType::OUTLET );
+  bdry_def.add_marker( 4, BdryType::WALL   );
+
+  std::string grid_file_path
+  { BASE_DIR + "/aux/test_data/TestGrid.dat" };
+
+  PrimaryGridReader grid_reader {};
+
+  PrimaryGrid primgrid = grid_reader.read( grid_file_path );
+
+  // -----------------------------------------------------------------
+  // Serial reference
+  THREAD_POOL.n_threads( 1 );
+
+  DualGrid grid_serial { primgrid, bdry_def };
+
+  const int n_elements = grid_serial.n_elements();
+
+  DMat U ( n_elements, N_FLOW_VARS );
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const double x = grid_serial.coords()[i][0];
+    const double y = grid_serial.coords()[i][1];
+
+    U[i][IP] = 1.0 + 0.1 * x * y;
+    U[i][IU] = 1.0 + 0.2 * y * (1.0 - y);
+    U[i][IV] = 0.1 * x;
+  }
+
+  DMat R_serial ( n_elements, N_FLOW_VARS );
+  EdgeResidual residual_serial { grid_serial };
+  residual_serial.compute( U, R_serial );
+
+  // -----------------------------------------------------------------
+  // Parallel run, where the thread count is read from the 
+  // parameter file and the grain size forces tiny chunks
+  init_thread_pool( BASE_DIR + "/aux/test_data/TestParameters.dat" );
+
+  CHECK( THREAD_POOL.n_threads() == 4 );
+  CHECK( THREAD_POOL.grain_size() == 8 );
+
+  THREAD_POOL.grain_size( 1 );
+
+  DualGrid grid_parallel { primgrid, bdry_def };
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    CHECK( grid_parallel.volumes()[i] == grid_serial.volumes()[i] );
+    CHECK( grid_parallel.coords()[i][0] == grid_serial.coords()[i][0] );
+    CHECK( grid_parallel.coords()[i][1] == grid_serial.coords()[i][1] );
+  }
+
+  for ( int i = 0; i < grid_serial.n_intr_faces(); ++i )
+  {
+    CHECK( grid_parallel.face_normals()[i][0] 
+        == grid_serial.face_normals()[i][0] );
+    CHECK( grid_parallel.face_normals()[i][1] 
+        == grid_serial.face_normals()[i][1] );
+  }
+
+  CHECK( grid_parallel.boundaries().size() == 4 );
+
+  auto bdry_serial = grid_serial.boundaries().begin();
+
+  for ( const auto& bdry : grid_parallel.boundaries() )
+  {
+    CHECK( bdry.marker() == bdry_serial->marker() );
+    CHECK( bdry.dual_elements() == bdry_serial->dual_elements() );
+    ++bdry_serial;
+  }
+
+  DMat R_parallel ( n_elements, N_FLOW_VARS );
+  EdgeResidual residual_parallel { grid_parallel };
+  residual_parallel.compute( U, R_parallel );
+
+  for ( int i = 0; i < n_elements; ++i )
+    for ( int k = 0; k < N_FLOW_VARS; ++k )
+      CHECK( EQ( R_parallel[i][k], R_serial[i][k] ) );
+
+  // -----------------------------------------------------------------
+  // Linear algebra
+  SparseMatrix A { grid_parallel };
+
+  for ( int i = 0; i < n_elements; ++i )
+  {
+    const int n_adj = A.offsets()[i+1] - A.offsets()[i] - 1;
+    A.diagonal(i)[0] = n_adj + 1.0;
+
+    for ( int pos = A.offsets()[i]+1; pos < A.offsets()[i+1]; ++pos )
+      *A.block(pos) = -1.0;
+  }
+
+  DVec b ( n_elements, 1.0 );
+  DVec x ( n_elements, 0.0 );
+
+  ConjugateGradient cg { n_elements, 1.0E-12 };
+  CHECK( cg.solve( A, b, x ) );
+
+  DVec Ax ( n_elements );
+  A.multiply( x, Ax );
+
+  for ( int i = 0; i < n_elements; ++i )
+    CHECK( std::fabs( Ax[i] - 1.0 ) < 1.0E-10 );
+
+  CHECK( EQ( dot_product( b, b ), static_cast<double>(n_elements) ) );
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+} // parallel_solver_kernels()
+
+} // namespace ThreadPoolTests
+
+
+/*********************************************************************
+* Run tests for: ThreadPool.h
+*********************************************************************/
+void run_tests_ThreadPool()
+{
+  // Set logging output file
+  std::string log_file_path
+  { ThreadPoolTests::BASE_DIR + "/aux/test_logs/tests_ThreadPool.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  ThreadPoolTests::parallel_loops();
+  ThreadPoolTests::parallel_solver_kernels();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_ThreadPool()
@@ -0,0 +1,180 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <IncomFlowConfig.h>
+
+#include "tests.h"
+
+#include "Testing.h"
+#include "MathUtility.h"
+#include "Geometry.h"
+#include "ThreadPool.h"
+
+#include "PrimaryGrid.h"
+#include "GridGenerator.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "WallDistance.h"
+
+#include "definitions.h"
+#include "solver_utils.h"
+
+namespace WallDistanceTests
+{
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+std::string BASE_DIR { INCOMFLOW_SOURCE_DIR };
+
+/*********************************************************************
+*
+*********************************************************************/
+void channel()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: channel() ==========";
+  LOG(INFO) << "";
+
+  const double lx = 3.0;
+  const double ly = 1.0;
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::WALL   );
+  bdry_def.add_marker( 2, BdryType::OUTLET );
+  bdry_def.add_marker( 3, BdryType::WALL   );
+  bdry_def.add_marker( 4, BdryType::INLET  );
+
+  for ( int mixed = 0; mixed < 2; ++mixed )
+  {
+    PrimaryGrid primgrid = ( mixed )
+      ? GridGenerator::unstructured( 60, 20, lx, ly )
+      : GridGenerator::structured( 60, 20, lx, ly );
+
+    DualGrid dgrid { primgrid, bdry_def };
+
+    WallDistance wall_dist { dgrid };
+    CHECK( wall_dist.n_wall_edges() == 120 );
+
+    const DVec& dist = wall_dist.compute();
+
+    // Distance to the lower or upper wall
+    for ( int i = 0; i < dgrid.n_elements(); ++i )
+    {
+      const double y = dgrid.coords()[i][1];
+      CHECK( std::fabs( dist[i] - MIN( y, ly - y ) ) < 1.0E-12 );
+    }
+
+    // Arbitrary points
+    CHECK( std::fabs( wall_dist.distance( { 1.0, 0.3 } ) - 0.3 ) < 1.0E-12 );
+    CHECK( std::fabs( wall_dist.distance( { 5.0, 2.0 } )
+                    - std::sqrt( 4.0 + 1.0 ) ) < 1.0E-12 );
+  }
+
+} // channel()
+
+/*********************************************************************
+*
+*********************************************************************/
+void brute_force()
+{
+  LOG(INFO) << "";
+  LOG(INFO) << "========== Test: brute_force() ==========";
+  LOG(INFO) << "";
+
+  BoundaryDef bdry_def {};
+  bdry_def.add_marker( 1, BdryType::WALL     );
+  bdry_def.add_marker( 2, BdryType::WALL     );
+  bdry_def.add_marker( 3, BdryType::OUTLET   );
+  bdry_def.add_marker( 4, BdryType::SYMMETRY );
+
+  PrimaryGrid primgrid = GridGenerator::unstructured( 50, 40, 1.0, 1.0,
+                                                       0.3, 7 );
+  DualGrid    dgrid { primgrid, bdry_def };
+
+  // Reference distances
+  const DMat& xy = dgrid.coords();
+  DVec reference ( dgrid.n_elements(), 1.0E+10 );
+
+  for ( const auto& bdry : dgrid.boundaries() )
+  {
+    if ( bdry.type() != BdryType::WALL )
+      continue;
+
+    for ( int e = 0; e < bdry.n_prim_edges(); ++e )
+    {
+      const int v = bdry.prim_edges()[e][0];
+      const int w = bdry.prim_edges()[e][1];
+
+      for ( int i = 0; i < dgrid.n_elements(); ++i )
+      {
+        const double d2 = vertex_edge_dist_sqr(
+          Vec2d { xy[i][0], xy[i][1] },
+          Vec2d { xy[v][0], xy[v][1] },
+          Vec2d { xy[w][0], xy[w][1] } );
+
+        reference[i] = MIN( reference[i], std::sqrt( d2 ) );
+      }
+    }
+  }
+
+  // Serial and parallel queries with small quads
+  for ( int n_threads : { 1, 4 } )
+  {
+    THREAD_POOL.n_threads( n_threads );
+    THREAD_POOL.grain_size( 64 );
+
+    WallDistance wall_dist { dgrid, 2 };
+    const DVec& dist = wall_dist.compute();
+
+    for ( int i = 0; i < dgrid.n_elements(); ++i )
+      CHECK( std::fabs( dist[i] - reference[i] ) < 1.0E-14 );
+  }
+
+  // Restore the serial default
+  THREAD_POOL.n_threads( 1 );
+  THREAD_POOL.grain_size( 1024 );
+
+  // Grids without walls
+  BoundaryDef open_def {};
+  open_def.add_marker( 1, BdryType::INLET );
+
+  DualGrid open_grid { primgrid, open_def };
+
+  WallDistance open_dist { open_grid };
+  CHECK( open_dist.n_wall_edges() == 0 );
+  CHECK( open_dist.compute()[0] > 1.0E+100 );
+
+} // brute_force()
+
+} // namespace WallDistanceTests
+
+
+/*********************************************************************
+* Run tests for: WallDistance.h
+*********************************************************************/
+void run_tests_WallDistance()
+{
+  // Set logging output file
+  std::string log_file_path
+  { WallDistanceTests::BASE_DIR + "/aux/test_logs/tests_WallDistance.log" };
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_FILE, log_file_path );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_FILE, log_file_path );
+
+  WallDistanceTests::channel();
+  WallDistanceTests::brute_force();
+
+  // Reset logging ostream
+  CppUtils::LOG_PROPERTIES.set_info_ostream( CppUtils::TO_COUT );
+  CppUtils::LOG_PROPERTIES.set_debug_ostream( CppUtils::TO_COUT );
+
+} // run_tests_WallDistance()
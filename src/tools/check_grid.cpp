@@ -0,0 +1,83 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "Log.h"
+#include "Timer.h"
+#include "ThreadPool.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "GridValidator.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Validation of a primary grid before a run
+*
+* Usage: check_grid <grid file> [n_threads] [max_reported]
+*
+* All checks of the GridValidator are applied to the grid and the
+* first offenders of every defect are logged. The exit status is
+* non-zero, if the grid is invalid, such that job scripts can abort
+* before the solver starts.
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  if ( argc < 2 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " <grid file> [n_threads] [max_reported]";
+    return EXIT_FAILURE;
+  }
+
+  const std::string grid_file { argv[1] };
+
+  if ( argc > 2 && std::atoi( argv[2] ) > 0 )
+    THREAD_POOL.n_threads( std::atoi( argv[2] ) );
+
+  Timer timer {};
+  timer.count();
+
+  PrimaryGridReader reader {};
+  PrimaryGrid primgrid = reader.read( grid_file );
+
+  timer.count();
+
+  GridValidator validator { primgrid };
+
+  if ( argc > 3 )
+    validator.max_reported( std::atoi( argv[3] ) );
+
+  const bool valid = validator.validate();
+
+  timer.count();
+
+  LOG(INFO) << "Reading:    " << timer.delta(0) << "s";
+  LOG(INFO) << "Validation: " << timer.delta(1) << "s";
+
+  if ( !valid )
+  {
+    LOG(ERROR) << "Invalid grid: " << grid_file << " ("
+               << validator.offenders().size() << " offenders)";
+    return EXIT_FAILURE;
+  }
+
+  LOG(INFO) << "Valid grid: " << grid_file;
+
+  return EXIT_SUCCESS;
+
+} // main()
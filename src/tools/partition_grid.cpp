@@ -0,0 +1,105 @@
+/*
+* This file is part of the IncomFlow library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "Log.h"
+#include "Timer.h"
+
+#include "definitions.h"
+#include "PrimaryGrid.h"
+#include "PrimaryGridReader.h"
+#include "DualGrid.h"
+#include "BoundaryDef.h"
+#include "GraphPartitioner.h"
+#include "DomainDecomposition.h"
+#include "SubGridIO.h"
+
+using namespace CppUtils;
+using namespace IncomFlow::Solver;
+
+/*********************************************************************
+* Pre-partitioning of a primary grid for distributed runs
+*
+* Usage: partition_grid <grid file> <n_parts> [output prefix]
+*
+* The grid is partitioned with the GraphPartitioner and the sub-grid
+* of every rank is written to the binary file
+*
+*   <output prefix>_<rank>.sgrid
+*
+* The prefix defaults to the grid file path without its extension.
+* At startup, every rank then only loads its own sub-grid with the
+* SubGridReader (see SubGridIO.h).
+*********************************************************************/
+int main(int argc, char* argv[])
+{
+  LOG_PROPERTIES.set_level( INFO );
+  LOG_PROPERTIES.show_header( true );
+  LOG_PROPERTIES.set_info_header( "  " );
+
+  if ( argc < 3 || std::atoi( argv[2] ) < 1 )
+  {
+    LOG(ERROR) << "Usage: " << argv[0]
+      << " <grid file> <n_parts> [output prefix]";
+    return EXIT_FAILURE;
+  }
+
+  const std::string grid_file { argv[1] };
+  const int n_parts = std::atoi( argv[2] );
+
+  std::string prefix = ( argc > 3 ) ? std::string { argv[3] } : grid_file;
+
+  if ( argc <= 3 )
+  {
+    const std::size_t dot = prefix.find_last_of( '.' );
+    const std::size_t sep = prefix.find_last_of( '/' );
+
+    if ( dot != std::string::npos
+        && ( sep == std::string::npos || dot > sep ) )
+      prefix.erase( dot );
+  }
+
+  Timer timer {};
+  timer.count();
+
+  PrimaryGridReader reader {};
+  PrimaryGrid primgrid = reader.read( grid_file );
+
+  timer.count();
+
+  // Only the vertex adjacency is required for the partitioning,
+  // hence no boundary definition is needed
+  IVec parts;
+  {
+    DualGrid dgrid { primgrid, BoundaryDef {} };
+    GraphPartitioner partitioner { dgrid };
+    parts = partitioner.partition( n_parts );
+  }
+
+  timer.count();
+
+  DomainDecomposition decomp { primgrid, parts, n_parts };
+  SubGridWriter writer {};
+
+  if ( !writer.write( decomp, prefix ) )
+    return EXIT_FAILURE;
+
+  timer.count();
+
+  LOG(INFO) << "Wrote " << n_parts << " sub-grid files: "
+            << subgrid_file_path( prefix, 0 ) << " ... "
+            << subgrid_file_path( prefix, n_parts-1 );
+  LOG(INFO) << "Reading:      " << timer.delta(0) << "s";
+  LOG(INFO) << "Partitioning: " << timer.delta(1) << "s";
+  LOG(INFO) << "Writing:      " << timer.delta(2) << "s";
+
+  return EXIT_SUCCESS;
+
+} // main()
@@ -0,0 +1,637 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+
+#ifdef CPPUTILS_USE_MPI
+// Only the C interface of MPI is used
+#define OMPI_SKIP_MPICXX 1
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+#endif
+
+#include "ThreadPool.h"
+
+namespace CppUtils {
+
+/*********************************************************************
+* Interface for the message passing between the ranks of a
+* distributed-memory run. Messages consist of doubles.
+*
+* Point-to-point messages are non-blocking: isend() and irecv()
+* only post a message, which is completed by wait_all(). The
+* buffers must stay valid until then. Messages between two ranks
+* are matched in the order in which they were posted.
+*
+* Collective operations must be called by all ranks in the
+* same order.
+*********************************************************************/
+class Communicator
+{
+public:
+  virtual ~Communicator() = default;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  virtual int rank() const = 0;
+  virtual int size() const = 0;
+
+  /*------------------------------------------------------------------
+  | Point-to-point messages
+  ------------------------------------------------------------------*/
+  virtual void isend(int dest, const double* data, int count) = 0;
+  virtual void irecv(int source, double* data, int count) = 0;
+  virtual void wait_all() = 0;
+
+  /*------------------------------------------------------------------
+  | Collectives: Element-wise sum / maximum over all ranks
+  ------------------------------------------------------------------*/
+  virtual void all_reduce_sum(double* data, int count) = 0;
+  virtual void all_reduce_max(double* data, int count) = 0;
+  virtual void barrier() = 0;
+
+  double all_reduce_sum(double value)
+  { all_reduce_sum( &value, 1 ); return value; }
+
+  double all_reduce_max(double value)
+  { all_reduce_max( &value, 1 ); return value; }
+
+}; // Communicator
+
+/*********************************************************************
+* Communicator for ranks, which are processes on the same machine
+* that share an anonymous memory region (see run_local_ranks()).
+*
+* Every ordered pair of ranks owns a single-slot channel in the
+* shared region. A message larger than the slot capacity is
+* transferred in several chunks. Posting a message already
+* progresses all pending messages once: isend() copies its data
+* into a free slot and irecv() takes data, which is already in the
+* slot. Thus, messages that fit into a slot are transferred while
+* the ranks compute between posting and wait_all(). wait_all()
+* progresses the remaining messages without blocking on a single
+* one, hence symmetric exchange patterns can not dead-lock.
+* Collectives are reduced and broadcast via rank 0.
+*********************************************************************/
+class SharedMemoryCommunicator : public Communicator
+{
+public:
+  using Counter = std::atomic<std::uint64_t>;
+
+  static_assert( Counter::is_always_lock_free,
+    "SharedMemoryCommunicator requires lock-free atomics." );
+
+  /*------------------------------------------------------------------
+  | Layout of the shared memory region
+  ------------------------------------------------------------------*/
+  struct Header
+  {
+    int     n_ranks;
+    int     capacity;
+    Counter barrier_count;
+    Counter barrier_generation;
+  };
+
+  struct Channel
+  {
+    Counter sent;
+    Counter received;
+    int     count;
+  };
+
+  /*------------------------------------------------------------------
+  | Size of the shared region for n_ranks ranks and channels of
+  | the given capacity (number of doubles)
+  ------------------------------------------------------------------*/
+  static std::size_t region_size(int n_ranks, int capacity)
+  {
+    return header_size()
+         + static_cast<std::size_t>( n_ranks ) * n_ranks
+         * channel_size( capacity );
+  }
+
+  /*------------------------------------------------------------------
+  | Initialize a zeroed shared region
+  ------------------------------------------------------------------*/
+  static void init_region(void* region, int n_ranks, int capacity)
+  {
+    Header* header = new( region ) Header {};
+    header->n_ranks  = n_ranks;
+    header->capacity = capacity;
+
+    char* channels = static_cast<char*>( region ) + header_size();
+
+    for ( int i = 0; i < n_ranks * n_ranks; ++i )
+      new( channels + i * channel_size( capacity ) ) Channel {};
+  }
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  SharedMemoryCommunicator(void* region, int rank)
+  : region_   { static_cast<char*>( region )           }
+  , header_   { static_cast<Header*>( region )         }
+  , rank_     { rank                                   }
+  , size_     { header_->n_ranks                       }
+  , capacity_ { header_->capacity                      }
+  , send_busy_( size_, 0 )
+  , recv_busy_( size_, 0 )
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int rank() const override { return rank_; }
+  int size() const override { return size_; }
+
+  /*------------------------------------------------------------------
+  | Point-to-point messages
+  ------------------------------------------------------------------*/
+  void isend(int dest, const double* data, int count) override
+  {
+    requests_.push_back( { dest, const_cast<double*>( data ),
+                           count, 0, true } );
+    progress();
+  }
+
+  void irecv(int source, double* data, int count) override
+  {
+    requests_.push_back( { source, data, count, 0, false } );
+    progress();
+  }
+
+  void wait_all() override
+  {
+    while ( n_pending_ > 0 )
+      if ( !progress() )
+        std::this_thread::yield();
+
+    requests_.clear();
+  }
+
+  /*------------------------------------------------------------------
+  | Collectives
+  ------------------------------------------------------------------*/
+  void all_reduce_sum(double* data, int count) override
+  {
+    all_reduce( data, count, [](double a, double b) { return a + b; } );
+  }
+
+  void all_reduce_max(double* data, int count) override
+  {
+    all_reduce( data, count,
+                [](double a, double b) { return ( a > b ) ? a : b; } );
+  }
+
+  void barrier() override
+  {
+    const auto generation
+      = header_->barrier_generation.load( std::memory_order_acquire );
+
+    if ( header_->barrier_count.fetch_add( 1 ) + 1
+         == static_cast<std::uint64_t>( size_ ) )
+    {
+      header_->barrier_count.store( 0 );
+      header_->barrier_generation.fetch_add( 1, std::memory_order_release );
+      return;
+    }
+
+    while ( header_->barrier_generation.load( std::memory_order_acquire )
+            == generation )
+      std::this_thread::yield();
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | A posted message
+  ------------------------------------------------------------------*/
+  struct Request
+  {
+    int     peer;
+    double* data;
+    int     count;
+    int     done;
+    bool    is_send;
+  };
+
+  static std::size_t header_size()
+  { return align( sizeof(Header) ); }
+
+  /*------------------------------------------------------------------
+  | Try to transfer the next chunk of every pending message once.
+  | Messages between two ranks are processed in posting order.
+  | Returns true, if any chunk was transferred.
+  ------------------------------------------------------------------*/
+  bool progress()
+  {
+    std::fill( send_busy_.begin(), send_busy_.end(), 0 );
+    std::fill( recv_busy_.begin(), recv_busy_.end(), 0 );
+
+    bool transferred = false;
+    n_pending_       = 0;
+
+    for ( auto& req : requests_ )
+    {
+      if ( req.done == req.count )
+        continue;
+
+      char& busy = req.is_send ? send_busy_[req.peer]
+                               : recv_busy_[req.peer];
+
+      if ( !busy && ( req.is_send ? try_send( req ) : try_recv( req ) ) )
+      {
+        transferred = true;
+        if ( req.done == req.count )
+          continue;
+      }
+
+      busy = 1;
+      ++n_pending_;
+    }
+
+    return transferred;
+  }
+
+  static std::size_t channel_size(int capacity)
+  { return align( sizeof(Channel) )
+         + align( sizeof(double) * static_cast<std::size_t>( capacity ) ); }
+
+  static std::size_t align(std::size_t n)
+  { return ( n + 63 ) / 64 * 64; }
+
+  /*------------------------------------------------------------------
+  | Channel from rank src to rank dst and its data slot
+  ------------------------------------------------------------------*/
+  Channel& channel(int src, int dst)
+  {
+    return *reinterpret_cast<Channel*>( region_ + header_size()
+      + static_cast<std::size_t>( src * size_ + dst )
+      * channel_size( capacity_ ) );
+  }
+
+  double* slot(Channel& c)
+  {
+    return reinterpret_cast<double*>(
+      reinterpret_cast<char*>( &c ) + align( sizeof(Channel) ) );
+  }
+
+  /*------------------------------------------------------------------
+  | Write the next chunk of a message, if the channel is empty
+  ------------------------------------------------------------------*/
+  bool try_send(Request& req)
+  {
+    Channel& c = channel( rank_, req.peer );
+
+    if ( c.sent.load( std::memory_order_acquire )
+      != c.received.load( std::memory_order_acquire ) )
+      return false;
+
+    const int n = std::min( capacity_, req.count - req.done );
+
+    std::memcpy( slot(c), req.data + req.done, n * sizeof(double) );
+    c.count = n;
+    c.sent.fetch_add( 1, std::memory_order_release );
+
+    req.done += n;
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Read the next chunk of a message, if the channel is filled
+  ------------------------------------------------------------------*/
+  bool try_recv(Request& req)
+  {
+    Channel& c = channel( req.peer, rank_ );
+
+    if ( c.sent.load( std::memory_order_acquire )
+      == c.received.load( std::memory_order_acquire ) )
+      return false;
+
+    const int n = c.count;
+
+    if ( req.done + n > req.count )
+      throw std::runtime_error(
+        "SharedMemoryCommunicator: Received message is too long." );
+
+    std::memcpy( req.data + req.done, slot(c), n * sizeof(double) );
+    c.received.fetch_add( 1, std::memory_order_release );
+
+    req.done += n;
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Reduce on rank 0 and broadcast the result
+  ------------------------------------------------------------------*/
+  template <typename Op>
+  void all_reduce(double* data, int count, Op op)
+  {
+    if ( size_ == 1 )
+      return;
+
+    if ( rank_ == 0 )
+    {
+      std::vector<double> buffer ( static_cast<std::size_t>( count )
+                                   * ( size_ - 1 ) );
+
+      for ( int r = 1; r < size_; ++r )
+        irecv( r, &buffer[ static_cast<std::size_t>( r-1 ) * count ], count );
+      wait_all();
+
+      for ( int r = 1; r < size_; ++r )
+        for ( int i = 0; i < count; ++i )
+          data[i] = op( data[i],
+                        buffer[ static_cast<std::size_t>( r-1 ) * count + i ] );
+
+      for ( int r = 1; r < size_; ++r )
+        isend( r, data, count );
+      wait_all();
+    }
+    else
+    {
+      isend( 0, data, count );
+      wait_all();
+      irecv( 0, data, count );
+      wait_all();
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  char*                region_;
+  Header*              header_;
+  int                  rank_;
+  int                  size_;
+  int                  capacity_;
+
+  std::vector<Request> requests_;
+  std::vector<char>    send_busy_;
+  std::vector<char>    recv_busy_;
+  std::size_t          n_pending_ { 0 };
+
+}; // SharedMemoryCommunicator
+
+/*********************************************************************
+* This class owns the shared memory region and the forked processes
+* of run_local_ranks(). The destructor kills and reaps all children,
+* which have not been joined, and unmaps the region, such that an
+* exception of rank 0 leaves neither orphans nor zombies behind.
+*********************************************************************/
+class LocalRanks
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor, which maps the shared memory region
+  ------------------------------------------------------------------*/
+  explicit LocalRanks(std::size_t bytes)
+  : bytes_ { bytes }
+  {
+    region_ = mmap( nullptr, bytes_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+
+    if ( region_ == MAP_FAILED )
+      throw std::runtime_error( "run_local_ranks: mmap() failed." );
+  }
+
+  LocalRanks(const LocalRanks&) = delete;
+  LocalRanks& operator=(const LocalRanks&) = delete;
+
+  /*------------------------------------------------------------------
+  | Destructor
+  ------------------------------------------------------------------*/
+  ~LocalRanks()
+  {
+    for ( pid_t pid : children_ )
+    {
+      kill( pid, SIGKILL );
+
+      int status = 0;
+      waitpid( pid, &status, 0 );
+    }
+
+    munmap( region_, bytes_ );
+  }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  void* region() const { return region_; }
+
+  /*------------------------------------------------------------------
+  | Register a forked child process
+  ------------------------------------------------------------------*/
+  void add(pid_t pid) { children_.push_back( pid ); }
+
+  /*------------------------------------------------------------------
+  | Wait for all children and return true, if all of them finished
+  | successfully
+  ------------------------------------------------------------------*/
+  bool join()
+  {
+    bool success = true;
+
+    while ( !children_.empty() )
+    {
+      int status = 0;
+      waitpid( children_.back(), &status, 0 );
+      children_.pop_back();
+
+      success &= ( WIFEXITED(status) && WEXITSTATUS(status) == 0 );
+    }
+
+    return success;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  void*              region_ { nullptr };
+  std::size_t        bytes_  { 0 };
+  std::vector<pid_t> children_ {};
+
+}; // LocalRanks
+
+/*********************************************************************
+* Run func(comm) on n_ranks processes of the local machine, which
+* communicate via a SharedMemoryCommunicator. The calling process
+* becomes rank 0 and forks the ranks 1 ... n_ranks-1, which exit
+* once func returned.
+* The channel capacity is given as number of doubles.
+*
+* Worker threads do not survive fork(), hence the global thread
+* pool must be serial when the ranks are started. Each rank may
+* resize it afterwards.
+*
+* Returns true, if all forked ranks finished successfully.
+*********************************************************************/
+template <typename Func>
+bool run_local_ranks(int n_ranks, Func&& func, int capacity=1<<14)
+{
+  if ( n_ranks < 1 || capacity < 1 )
+    throw std::runtime_error( "run_local_ranks: Invalid arguments." );
+
+  if ( THREAD_POOL.n_threads() != 1 )
+    throw std::runtime_error(
+      "run_local_ranks: The global thread pool must be serial." );
+
+  const std::size_t bytes
+    = SharedMemoryCommunicator::region_size( n_ranks, capacity );
+
+  LocalRanks  ranks { bytes };
+  void* const region = ranks.region();
+
+  SharedMemoryCommunicator::init_region( region, n_ranks, capacity );
+
+  for ( int rank = 1; rank < n_ranks; ++rank )
+  {
+    const pid_t pid = fork();
+
+    if ( pid < 0 )
+      throw std::runtime_error( "run_local_ranks: fork() failed." );
+
+    if ( pid == 0 )
+    {
+      int status = 0;
+
+      try
+      {
+        SharedMemoryCommunicator comm { region, rank };
+        func( comm );
+      }
+      catch ( ... )
+      {
+        status = 1;
+      }
+
+      // Skip the destructors of objects inherited from the parent
+      _exit( status );
+    }
+
+    ranks.add( pid );
+  }
+
+  {
+    SharedMemoryCommunicator comm { region, 0 };
+    func( comm );
+  }
+
+  return ranks.join();
+
+} // run_local_ranks()
+
+#ifdef CPPUTILS_USE_MPI
+/*********************************************************************
+* Communicator based on MPI_COMM_WORLD. MPI is initialized by the
+* first communicator and finalized by the one that initialized it.
+*********************************************************************/
+class MPICommunicator : public Communicator
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  MPICommunicator(int* argc=nullptr, char*** argv=nullptr)
+  {
+    int initialized = 0;
+    MPI_Initialized( &initialized );
+
+    if ( !initialized )
+    {
+      MPI_Init( argc, argv );
+      owns_mpi_ = true;
+    }
+
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank_ );
+    MPI_Comm_size( MPI_COMM_WORLD, &size_ );
+  }
+
+  ~MPICommunicator()
+  {
+    if ( owns_mpi_ )
+      MPI_Finalize();
+  }
+
+  MPICommunicator(const MPICommunicator&) = delete;
+  MPICommunicator& operator=(const MPICommunicator&) = delete;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int rank() const override { return rank_; }
+  int size() const override { return size_; }
+
+  /*------------------------------------------------------------------
+  | Point-to-point messages
+  ------------------------------------------------------------------*/
+  void isend(int dest, const double* data, int count) override
+  {
+    requests_.emplace_back();
+    MPI_Isend( data, count, MPI_DOUBLE, dest, 0, MPI_COMM_WORLD,
+               &requests_.back() );
+  }
+
+  void irecv(int source, double* data, int count) override
+  {
+    requests_.emplace_back();
+    MPI_Irecv( data, count, MPI_DOUBLE, source, 0, MPI_COMM_WORLD,
+               &requests_.back() );
+  }
+
+  void wait_all() override
+  {
+    MPI_Waitall( static_cast<int>( requests_.size() ), requests_.data(),
+                 MPI_STATUSES_IGNORE );
+    requests_.clear();
+  }
+
+  /*------------------------------------------------------------------
+  | Collectives
+  ------------------------------------------------------------------*/
+  void all_reduce_sum(double* data, int count) override
+  {
+    MPI_Allreduce( MPI_IN_PLACE, data, count, MPI_DOUBLE, MPI_SUM,
+                   MPI_COMM_WORLD );
+  }
+
+  void all_reduce_max(double* data, int count) override
+  {
+    MPI_Allreduce( MPI_IN_PLACE, data, count, MPI_DOUBLE, MPI_MAX,
+                   MPI_COMM_WORLD );
+  }
+
+  void barrier() override { MPI_Barrier( MPI_COMM_WORLD ); }
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int                      rank_     { 0 };
+  int                      size_     { 1 };
+  bool                     owns_mpi_ { false };
+  std::vector<MPI_Request> requests_;
+
+}; // MPICommunicator
+#endif
+
+} // namespace CppUtils
@@ -0,0 +1,219 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>        // std::vector
+#include <memory>        // std::shared_ptr, std::atomic_load
+#include <mutex>         // std::mutex
+#include <thread>        // std::this_thread::yield
+#include <unordered_map> // std::unordered_map
+#include <algorithm>     // std::remove_if
+
+#include "LinearQuadTree.h"
+#include "Vec2.h"
+
+namespace CppUtils {
+
+/*********************************************************************
+* A quad tree of 2D items, which is queried by many threads while
+* other threads add or remove items (read-copy-update).
+*
+* The pointer-based QuadTree can not be queried during insertions,
+* since add() and remove() restructure the tree and update the item
+* counters of all parents. This class separates both sides:
+*
+* - Writers add and remove items to a set, which is protected by a
+*   mutex. publish() builds a new LinearQuadTree from the current
+*   set and replaces the current snapshot atomically.
+* - Readers obtain the current snapshot, which is immutable and is
+*   kept alive by a shared pointer, as long as it is queried. Queries
+*   never wait for writers and never see partial updates.
+* - Old snapshots are released by their last reader. synchronize()
+*   publishes the current set and waits until no reader holds an
+*   older snapshot. Afterwards, removed items may be deleted.
+*
+* Publishing rebuilds the tree in O(n log n), hence the structure
+* suits many queries with infrequent batches of changes.
+*
+* Usage:
+* ------
+*   ConcurrentQuadTree<Vertex,double> qtree {};
+*
+*   // Writer thread
+*   qtree.add( v );
+*   qtree.publish();
+*
+*   // Reader threads
+*   auto snapshot = qtree.snapshot();
+*   snapshot->get_items( center, radius, [&](Vertex* v) { ... } );
+*
+*   // Deletion of removed items
+*   qtree.remove( v );
+*   qtree.synchronize();
+*   delete v;
+*********************************************************************/
+template <typename T, typename V>
+class ConcurrentQuadTree
+{
+public:
+  using Vector   = std::vector<T*>;
+  using Tree     = LinearQuadTree<T,V>;
+  using Snapshot = std::shared_ptr<const Tree>;
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  ConcurrentQuadTree(size_t max_items=100, size_t max_depth=25)
+  : max_item_  { max_items }
+  , max_depth_ { max_depth }
+  , current_   { std::make_shared<const Tree>( max_items, max_depth ) }
+  {}
+
+  ConcurrentQuadTree(const ConcurrentQuadTree&) = delete;
+  ConcurrentQuadTree& operator=(const ConcurrentQuadTree&) = delete;
+
+  /*------------------------------------------------------------------
+  | The current snapshot, which remains valid as long as it is held
+  ------------------------------------------------------------------*/
+  Snapshot snapshot() const { return std::atomic_load( &current_ ); }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  size_t size() const { return snapshot()->size(); }
+
+  size_t n_pending() const
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+    return n_pending_;
+  }
+
+  size_t version() const
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+    return version_;
+  }
+
+  /*------------------------------------------------------------------
+  | Query the current snapshot, see LinearQuadTree::get_items()
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  size_t get_items(const Vec2<V>& lowleft, const Vec2<V>& upright,
+                   Function&& f) const
+  { return snapshot()->get_items( lowleft, upright, f ); }
+
+  template <typename Function>
+  size_t get_items(const Vec2<V>& center, const double radius,
+                   Function&& f) const
+  { return snapshot()->get_items( center, radius, f ); }
+
+  /*------------------------------------------------------------------
+  | Add an item, which becomes visible with the next publish()
+  ------------------------------------------------------------------*/
+  bool add(T* item)
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if ( !positions_.emplace( item, items_.size() ).second )
+      return false;
+
+    items_.push_back( item );
+    ++n_pending_;
+
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Remove an item, which is visible until the next publish()
+  ------------------------------------------------------------------*/
+  bool remove(T* item)
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    auto it = positions_.find( item );
+
+    if ( it == positions_.end() )
+      return false;
+
+    T* last = items_.back();
+    items_[it->second] = last;
+    positions_[last]   = it->second;
+
+    items_.pop_back();
+    positions_.erase( item );
+    ++n_pending_;
+
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Build a new snapshot of the current items and replace the
+  | current snapshot. Returns the new version.
+  ------------------------------------------------------------------*/
+  size_t publish()
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if ( n_pending_ == 0 )
+      return version_;
+
+    auto tree = std::make_shared<Tree>( max_item_, max_depth_ );
+    tree->build( items_ );
+
+    Snapshot old = std::atomic_exchange( &current_, Snapshot { tree } );
+
+    // Keep track of old snapshots, which are still queried
+    retired_.erase( std::remove_if( retired_.begin(), retired_.end(),
+      [](const std::weak_ptr<const Tree>& r) { return r.expired(); }),
+      retired_.end() );
+
+    retired_.push_back( old );
+
+    n_pending_ = 0;
+
+    return ++version_;
+  }
+
+  /*------------------------------------------------------------------
+  | Publish the current items and wait until all readers have
+  | released older snapshots
+  ------------------------------------------------------------------*/
+  void synchronize()
+  {
+    publish();
+
+    std::vector<std::weak_ptr<const Tree>> retired;
+    {
+      std::lock_guard<std::mutex> lock { mutex_ };
+      retired.swap( retired_ );
+    }
+
+    for ( const auto& old : retired )
+      while ( !old.expired() )
+        std::this_thread::yield();
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  size_t                                 max_item_;
+  size_t                                 max_depth_;
+
+  mutable std::mutex                     mutex_;
+  Vector                                 items_;
+  std::unordered_map<const T*, size_t>   positions_;
+  size_t                                 n_pending_ { 0 };
+  size_t                                 version_   { 0 };
+
+  Snapshot                               current_;
+  std::vector<std::weak_ptr<const Tree>> retired_;
+
+}; // ConcurrentQuadTree
+
+} // namespace CppUtils
@@ -130,8 +130,8 @@ public:
   | Insert any simplex through constructor before 
   | a specified position
   ------------------------------------------------------------------*/
-  template <typename... Args>
-  T& insert( auto pos, Args&&... args )
+  template <typename Iterator, typename... Args>
+  T& insert( Iterator pos, Args&&... args )
   {
     std::unique_ptr<T> u_ptr = std::make_unique<T>(args...);
     T* ptr = u_ptr.get();
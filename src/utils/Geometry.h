@@ -7,6 +7,9 @@
 */
 #pragma once
 
+#include <cmath>   // std::fma, std::fabs
+#include <cstddef> // std::size_t
+
 #include "MathUtility.h"
 #include "Vec2.h"
 
@@ -458,4 +461,406 @@ inline bool segment_overlap(const Vec2<T>& v1, const Vec2<T> w1,
   return false;
 }
 
+/*********************************************************************
+* Robust predicates
+* -----------------
+* The predicates above classify nearly collinear points with an
+* absolute tolerance. The following predicates are exact instead,
+* following Shewchuk's adaptive-precision arithmetic: the orientation
+* determinant is evaluated in floating point, together with an error
+* bound. Only if the determinant is within this bound, it is
+* evaluated exactly as a sum of products, which are represented as
+* non-overlapping expansions.
+*
+* Reference:
+* J.R. Shewchuk, "Adaptive Precision Floating-Point Arithmetic and
+* Fast Robust Geometric Predicates", Discrete & Computational
+* Geometry 18, 1997
+*********************************************************************/
+
+/*--------------------------------------------------------------------
+| Relative error bound of the floating-point orientation determinant
+--------------------------------------------------------------------*/
+constexpr double ORIENT2D_EPSILON  = 1.1102230246251565E-16; // 2^-53
+constexpr double ORIENT2D_ERRBOUND
+  = ( 3.0 + 16.0 * ORIENT2D_EPSILON ) * ORIENT2D_EPSILON;
+
+/*--------------------------------------------------------------------
+| Exact sum (x + y = a + b) and product (x + y = a * b)
+--------------------------------------------------------------------*/
+static inline void two_sum(double a, double b, double& x, double& y)
+{
+  x = a + b;
+  const double b_virt = x - a;
+  const double a_virt = x - b_virt;
+  y = ( a - a_virt ) + ( b - b_virt );
+}
+
+static inline void two_product(double a, double b, double& x, double& y)
+{
+  x = a * b;
+  y = std::fma( a, b, -x );
+}
+
+/*--------------------------------------------------------------------
+| Add b to the expansion e of length n, store the result in h and
+| return its length. Zero components are eliminated.
+--------------------------------------------------------------------*/
+static inline int grow_expansion(int n, const double* e, double b,
+                                 double* h)
+{
+  double q = b;
+  int    m = 0;
+
+  for ( int i = 0; i < n; ++i )
+  {
+    double sum, err;
+    two_sum( q, e[i], sum, err );
+    q = sum;
+
+    if ( err != 0.0 )
+      h[m++] = err;
+  }
+
+  if ( q != 0.0 || m == 0 )
+    h[m++] = q;
+
+  return m;
+}
+
+/*--------------------------------------------------------------------
+| Exact sign of the orientation determinant of (p,q,r):
+| +1 for counter-clockwise, -1 for clockwise, 0 for collinear
+--------------------------------------------------------------------*/
+static inline int orient2d_exact(double px, double py,
+                                 double qx, double qy,
+                                 double rx, double ry)
+{
+  // Exact coordinate differences, e.g. of nearby points, reduce the
+  // determinant to two exact products
+  double acx, acy, bcx, bcy, t_acx, t_acy, t_bcx, t_bcy;
+  two_sum( px, -rx, acx, t_acx );
+  two_sum( py, -ry, acy, t_acy );
+  two_sum( qx, -rx, bcx, t_bcx );
+  two_sum( qy, -ry, bcy, t_bcy );
+
+  if ( t_acx == 0.0 && t_acy == 0.0 && t_bcx == 0.0 && t_bcy == 0.0 )
+  {
+    double l_hi, l_lo, r_hi, r_lo;
+    two_product( acx, bcy, l_hi, l_lo );
+    two_product( acy, bcx, r_hi, r_lo );
+
+    double e[4], h[4];
+    int n = grow_expansion( 0, e, l_lo, h );
+    n = grow_expansion( n, h, l_hi, e );
+    n = grow_expansion( n, e, -r_lo, h );
+    n = grow_expansion( n, h, -r_hi, e );
+
+    return ( e[n-1] > 0.0 ) - ( e[n-1] < 0.0 );
+  }
+
+  // Otherwise, the determinant expands into six products
+  const double terms[6][2] = { {  px, qy }, { -py, qx },
+                               {  qx, ry }, { -qy, rx },
+                               {  rx, py }, { -ry, px } };
+
+  double buffer[2][12];
+  int    n   = 0;
+  int    cur = 0;
+
+  for ( const auto& t : terms )
+  {
+    double hi, lo;
+    two_product( t[0], t[1], hi, lo );
+
+    n = grow_expansion( n, buffer[cur], lo, buffer[1-cur] );
+    cur = 1 - cur;
+    n = grow_expansion( n, buffer[cur], hi, buffer[1-cur] );
+    cur = 1 - cur;
+  }
+
+  // The largest component determines the sign
+  const double det = buffer[cur][n-1];
+
+  return ( det > 0.0 ) - ( det < 0.0 );
+}
+
+/*--------------------------------------------------------------------
+| Sign of the orientation determinant of (p,q,r), which is exact
+| for all inputs
+--------------------------------------------------------------------*/
+static inline int orient2d(double px, double py,
+                           double qx, double qy,
+                           double rx, double ry)
+{
+  const double left  = ( px - rx ) * ( qy - ry );
+  const double right = ( py - ry ) * ( qx - rx );
+  const double det   = left - right;
+  const double bound = ORIENT2D_ERRBOUND
+                     * ( std::fabs( left ) + std::fabs( right ) );
+
+  if ( det > bound || -det > bound || bound == 0.0 )
+    return ( det > 0.0 ) - ( det < 0.0 );
+
+  return orient2d_exact( px, py, qx, qy, rx, ry );
+}
+
+/*--------------------------------------------------------------------
+| Exact orientation of three points (p, q, r). In contrast to
+| orientation(), only exactly collinear points are classified CL.
+--------------------------------------------------------------------*/
+static inline Orientation robust_orientation(const Vec2d& p,
+                                             const Vec2d& q,
+                                             const Vec2d& r)
+{
+  const int sign = orient2d( p.x, p.y, q.x, q.y, r.x, r.y );
+
+  if ( sign > 0 )
+    return Orientation::CCW;
+
+  if ( sign < 0 )
+    return Orientation::CW;
+
+  return Orientation::CL;
+}
+
+/*********************************************************************
+* Batched predicates
+* ------------------
+* The following predicates are evaluated for n lanes at once. The
+* coordinates of every argument are given either as structure of
+* arrays (Vec2Array), or as single point (Vec2d), which is used for
+* all lanes, e.g. to test one point against many triangles.
+*
+* The lanes are processed in blocks: the floating-point
+* determinants and their error bounds are evaluated by branch-free
+* loops, which are vectorized by the compiler (2, 4 or 8 lanes per
+* instruction for SSE2, AVX2 or AVX-512). Only the lanes, whose
+* determinants are within the error bound, are evaluated exactly
+* afterwards. Hence, all batched predicates are exact.
+*
+* Usage:
+* ------
+*   Vec2Array tri_p { px.data(), py.data() };
+*   ...
+*   in_on_triangle_batch( point, tri_p, tri_q, tri_r, n, inside );
+*********************************************************************/
+struct Vec2Array
+{
+  const double* x;
+  const double* y;
+};
+
+static inline double lane_x(const Vec2Array& a, std::size_t i)
+{ return a.x[i]; }
+static inline double lane_y(const Vec2Array& a, std::size_t i)
+{ return a.y[i]; }
+
+static inline double lane_x(const Vec2d& a, std::size_t)
+{ return a.x; }
+static inline double lane_y(const Vec2d& a, std::size_t)
+{ return a.y; }
+
+constexpr std::size_t GEOMETRY_BATCH_BLOCK = 256;
+
+/*--------------------------------------------------------------------
+| Orientation signs of the lanes [i0, i0+m) with m <= block size
+--------------------------------------------------------------------*/
+template <typename P, typename Q, typename R>
+static inline void orient2d_block(const P& p, const Q& q, const R& r,
+                                  std::size_t i0, std::size_t m,
+                                  signed char* sign)
+{
+  double det[GEOMETRY_BATCH_BLOCK];
+  double bound[GEOMETRY_BATCH_BLOCK];
+
+  // Floating-point filter
+  for ( std::size_t j = 0; j < m; ++j )
+  {
+    const std::size_t i = i0 + j;
+
+    const double rx = lane_x( r, i );
+    const double ry = lane_y( r, i );
+
+    const double left  = ( lane_x( p, i ) - rx ) * ( lane_y( q, i ) - ry );
+    const double right = ( lane_y( p, i ) - ry ) * ( lane_x( q, i ) - rx );
+
+    det[j]   = left - right;
+    bound[j] = ORIENT2D_ERRBOUND * ( std::fabs( left ) + std::fabs( right ) );
+  }
+
+  int n_uncertain = 0;
+
+  for ( std::size_t j = 0; j < m; ++j )
+  {
+    const int pos = ( det[j] >  bound[j] );
+    const int neg = ( det[j] < -bound[j] );
+
+    sign[j]      = static_cast<signed char>( pos - neg );
+    n_uncertain += ( pos | neg | ( bound[j] == 0.0 ) ) ^ 1;
+  }
+
+  if ( n_uncertain == 0 )
+    return;
+
+  // Exact evaluation of uncertain lanes
+  for ( std::size_t j = 0; j < m; ++j )
+  {
+    if ( sign[j] != 0 || bound[j] == 0.0 )
+      continue;
+
+    const std::size_t i = i0 + j;
+
+    sign[j] = static_cast<signed char>( orient2d_exact(
+      lane_x( p, i ), lane_y( p, i ),
+      lane_x( q, i ), lane_y( q, i ),
+      lane_x( r, i ), lane_y( r, i ) ) );
+  }
+}
+
+/*--------------------------------------------------------------------
+| Exact orientations of n triples (p, q, r)
+--------------------------------------------------------------------*/
+template <typename P, typename Q, typename R>
+static inline void orientation_batch(const P& p, const Q& q, const R& r,
+                                     std::size_t n, Orientation* result)
+{
+  signed char sign[GEOMETRY_BATCH_BLOCK];
+
+  for ( std::size_t i0 = 0; i0 < n; i0 += GEOMETRY_BATCH_BLOCK )
+  {
+    const std::size_t m = MIN( GEOMETRY_BATCH_BLOCK, n - i0 );
+
+    orient2d_block( p, q, r, i0, m, sign );
+
+    for ( std::size_t j = 0; j < m; ++j )
+      result[i0+j] = ( sign[j] > 0 ) ? Orientation::CCW
+                   : ( sign[j] < 0 ) ? Orientation::CW
+                                     : Orientation::CL;
+  }
+}
+
+/*--------------------------------------------------------------------
+| Check if n vertices v are inside or on n counter-clockwise
+| triangles (p,q,r)
+--------------------------------------------------------------------*/
+template <typename Vtx, typename P, typename Q, typename R>
+static inline void in_on_triangle_batch(const Vtx& v,
+                                        const P& p, const Q& q,
+                                        const R& r,
+                                        std::size_t n, bool* result)
+{
+  signed char s1[GEOMETRY_BATCH_BLOCK];
+  signed char s2[GEOMETRY_BATCH_BLOCK];
+  signed char s3[GEOMETRY_BATCH_BLOCK];
+
+  for ( std::size_t i0 = 0; i0 < n; i0 += GEOMETRY_BATCH_BLOCK )
+  {
+    const std::size_t m = MIN( GEOMETRY_BATCH_BLOCK, n - i0 );
+
+    orient2d_block( p, q, v, i0, m, s1 );
+    orient2d_block( q, r, v, i0, m, s2 );
+    orient2d_block( r, p, v, i0, m, s3 );
+
+    for ( std::size_t j = 0; j < m; ++j )
+      result[i0+j] = ( s1[j] >= 0 ) & ( s2[j] >= 0 ) & ( s3[j] >= 0 );
+  }
+}
+
+/*--------------------------------------------------------------------
+| Check if n vertices v are inside or on n counter-clockwise
+| quads (p,q,r,s)
+--------------------------------------------------------------------*/
+template <typename Vtx, typename P, typename Q, typename R, typename S>
+static inline void in_on_quad_batch(const Vtx& v,
+                                    const P& p, const Q& q,
+                                    const R& r, const S& s,
+                                    std::size_t n, bool* result)
+{
+  signed char s1[GEOMETRY_BATCH_BLOCK];
+  signed char s2[GEOMETRY_BATCH_BLOCK];
+  signed char s3[GEOMETRY_BATCH_BLOCK];
+  signed char s4[GEOMETRY_BATCH_BLOCK];
+
+  for ( std::size_t i0 = 0; i0 < n; i0 += GEOMETRY_BATCH_BLOCK )
+  {
+    const std::size_t m = MIN( GEOMETRY_BATCH_BLOCK, n - i0 );
+
+    orient2d_block( p, q, v, i0, m, s1 );
+    orient2d_block( q, r, v, i0, m, s2 );
+    orient2d_block( r, s, v, i0, m, s3 );
+    orient2d_block( s, p, v, i0, m, s4 );
+
+    for ( std::size_t j = 0; j < m; ++j )
+      result[i0+j] = ( s1[j] >= 0 ) & ( s2[j] >= 0 )
+                   & ( s3[j] >= 0 ) & ( s4[j] >= 0 );
+  }
+}
+
+/*--------------------------------------------------------------------
+| Check if the collinear point r lies strictly within the segment
+| (p,q), which is exact for collinear points
+--------------------------------------------------------------------*/
+static inline bool collinear_in_segment(double px, double py,
+                                        double qx, double qy,
+                                        double rx, double ry)
+{
+  if ( px != qx )
+    return ( MIN(px,qx) < rx ) && ( rx < MAX(px,qx) );
+
+  return ( MIN(py,qy) < ry ) && ( ry < MAX(py,qy) );
+}
+
+/*--------------------------------------------------------------------
+| Check if n pairs of lines (p1,q1) and (p2,q2) intersect, see
+| line_line_intersection() for the treatment of special cases
+--------------------------------------------------------------------*/
+template <typename P1, typename Q1, typename P2, typename Q2>
+static inline void line_line_intersection_batch(const P1& p1,
+                                                const Q1& q1,
+                                                const P2& p2,
+                                                const Q2& q2,
+                                                std::size_t n,
+                                                bool* result)
+{
+  signed char o1[GEOMETRY_BATCH_BLOCK];
+  signed char o2[GEOMETRY_BATCH_BLOCK];
+  signed char o3[GEOMETRY_BATCH_BLOCK];
+  signed char o4[GEOMETRY_BATCH_BLOCK];
+
+  for ( std::size_t i0 = 0; i0 < n; i0 += GEOMETRY_BATCH_BLOCK )
+  {
+    const std::size_t m = MIN( GEOMETRY_BATCH_BLOCK, n - i0 );
+
+    orient2d_block( p1, q1, p2, i0, m, o1 );
+    orient2d_block( p1, q1, q2, i0, m, o2 );
+    orient2d_block( p2, q2, p1, i0, m, o3 );
+    orient2d_block( p2, q2, q1, i0, m, o4 );
+
+    // Proper intersections
+    for ( std::size_t j = 0; j < m; ++j )
+      result[i0+j] = ( o1[j] * o2[j] < 0 ) & ( o3[j] * o4[j] < 0 );
+
+    // Collinear end points
+    for ( std::size_t j = 0; j < m; ++j )
+    {
+      if ( o1[j] != 0 && o2[j] != 0 && o3[j] != 0 && o4[j] != 0 )
+        continue;
+
+      const std::size_t i = i0 + j;
+
+      const double p1x = lane_x( p1, i ), p1y = lane_y( p1, i );
+      const double q1x = lane_x( q1, i ), q1y = lane_y( q1, i );
+      const double p2x = lane_x( p2, i ), p2y = lane_y( p2, i );
+      const double q2x = lane_x( q2, i ), q2y = lane_y( q2, i );
+
+      result[i] =
+        ( o1[j] == 0 && collinear_in_segment( p1x,p1y, q1x,q1y, p2x,p2y ) )
+     || ( o2[j] == 0 && collinear_in_segment( p1x,p1y, q1x,q1y, q2x,q2y ) )
+     || ( o3[j] == 0 && collinear_in_segment( p2x,p2y, q2x,q2y, p1x,p1y ) )
+     || ( o4[j] == 0 && collinear_in_segment( p2x,p2y, q2x,q2y, q1x,q1y ) );
+    }
+  }
+}
+
 } // namespace CppUtils
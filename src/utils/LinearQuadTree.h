@@ -0,0 +1,441 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>    // std::vector
+#include <cstdint>   // std::uint64_t
+#include <algorithm> // std::sort
+#include <limits>    // std::numeric_limits
+#include <utility>   // std::pair
+
+#include "Vec2.h"
+#include "Geometry.h"
+#include "MathUtility.h"
+#include "Helpers.h"
+#include "Log.h"
+
+namespace CppUtils {
+
+/*********************************************************************
+* This class refers to a linear quad tree of 2D items, which is
+* built at once from a set of items. It is an array-based
+* alternative to QuadTree for static item sets.
+*
+* Build:
+* ------
+* The items are sorted by the Morton codes of their locations,
+* which are quantized on a 2^32 x 2^32 grid over the bounding square
+* of all items. Thereby, the items of every quad occupy a contiguous
+* range of the sorted item array. The quads are then split top-down,
+* whereby the ranges of the four children are found by binary
+* searches in the sorted codes. The total cost is O(n log n).
+*
+* Storage:
+* --------
+* All nodes are stored in a single array. The non-empty children of
+* a node are stored contiguously and every leaf refers to a range
+* of the item array. The item locations are copied in the same
+* order, such that queries only dereference the items they report.
+* Every node stores the tight bounding box of its items, which are
+* used to prune the queries.
+*
+* Queries:
+* --------
+* Items within rectangles or circles are reported through a
+* callback f(T*), such that no result vector is allocated. Nodes,
+* which are entirely covered by a query, are reported without
+* testing their items.
+*
+* Usage:
+* ------
+*   LinearQuadTree<Vertex,double> qtree { 100 };
+*   qtree.build( vertex_pointers );
+*
+*   qtree.get_items( lowleft, upright, [&](Vertex* v) { ... } );
+*
+* Items must provide their location through xy(). Changes of the
+* item locations require a new build.
+*********************************************************************/
+template <typename T, typename V>
+class LinearQuadTree
+{
+public:
+  using Vector = std::vector<T*>;
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  LinearQuadTree(size_t max_items=100, size_t max_depth=25)
+  : max_item_  { MAX( max_items, size_t(1) ) }
+  , max_depth_ { MIN( max_depth, size_t(MORTON_BITS) ) }
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  size_t size() const { return items_.size(); }
+  size_t max_items() const { return max_item_; }
+  size_t max_depth() const { return max_depth_; }
+  size_t n_nodes() const { return nodes_.size(); }
+  size_t depth() const { return depth_; }
+
+  // Items in the order of their Morton codes
+  const Vector& items() const { return items_; }
+
+  int n_leafs() const
+  {
+    int n = 0;
+    for ( const auto& node : nodes_ )
+      n += ( node.n_children == 0 );
+    return n;
+  }
+
+  /*------------------------------------------------------------------
+  | Build the tree from the given items, replacing the previous ones
+  ------------------------------------------------------------------*/
+  void build(const Vector& items)
+  {
+    nodes_.clear();
+    items_.clear();
+    xy_.clear();
+    depth_ = 0;
+
+    const size_t n = items.size();
+
+    if ( n == 0 )
+      return;
+
+    ASSERT( n < std::numeric_limits<std::uint32_t>::max(),
+      "LinearQuadTree: Too many items.");
+
+    // Bounding square
+    Vec2<V> lowleft = items[0]->xy();
+    Vec2<V> upright = items[0]->xy();
+
+    for ( const T* item : items )
+    {
+      lowleft.x = MIN( lowleft.x, item->xy().x );
+      lowleft.y = MIN( lowleft.y, item->xy().y );
+      upright.x = MAX( upright.x, item->xy().x );
+      upright.y = MAX( upright.y, item->xy().y );
+    }
+
+    const double scale = MAX( upright.x - lowleft.x,
+                              upright.y - lowleft.y );
+    const double to_grid = ( scale > 0.0 )
+                         ? GRID_SIZE / scale : 0.0;
+
+    // Sort items by their Morton codes
+    std::vector<std::pair<std::uint64_t, T*>> sorted ( n );
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      const Vec2<V>& p = items[i]->xy();
+      sorted[i] = { morton_code( quantize( p.x - lowleft.x, to_grid ),
+                                 quantize( p.y - lowleft.y, to_grid ) ),
+                    items[i] };
+    }
+
+    std::sort( sorted.begin(), sorted.end(),
+    [](const std::pair<std::uint64_t, T*>& a,
+       const std::pair<std::uint64_t, T*>& b)
+    { return a.first < b.first; });
+
+    codes_.resize( n );
+    items_.resize( n );
+    xy_.resize( n );
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      codes_[i] = sorted[i].first;
+      items_[i] = sorted[i].second;
+      xy_[i]    = sorted[i].second->xy();
+    }
+
+    nodes_.push_back( {} );
+    build_node( 0, 0, static_cast<std::uint32_t>( n ), 0 );
+
+    // The codes are only needed for the build
+    std::vector<std::uint64_t>().swap( codes_ );
+
+  } // build()
+
+  /*------------------------------------------------------------------
+  | Report all items within the rectangle [lowleft,upright] to f
+  | and return their number
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  size_t get_items(const Vec2<V>& lowleft,
+                   const Vec2<V>& upright,
+                   Function&& f) const
+  {
+    return traverse(
+      [&](const Node& node)
+      {
+        return node.hi_x >= lowleft.x && node.lo_x <= upright.x
+            && node.hi_y >= lowleft.y && node.lo_y <= upright.y;
+      },
+      [&](const Node& node)
+      {
+        return node.lo_x >= lowleft.x && node.hi_x <= upright.x
+            && node.lo_y >= lowleft.y && node.hi_y <= upright.y;
+      },
+      [&](const Vec2<V>& p)
+      { return in_on_rect( p, lowleft, upright ); },
+      f );
+  }
+
+  /*------------------------------------------------------------------
+  | Report all items with a distance less than radius to center
+  | to f and return their number
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  size_t get_items(const Vec2<V>& center,
+                   const double   radius,
+                   Function&&     f) const
+  {
+    const double r2 = radius * radius;
+
+    return traverse(
+      [&](const Node& node)
+      {
+        const double dx = MAX( 0.0, MAX( node.lo_x - center.x,
+                                         center.x - node.hi_x ) );
+        const double dy = MAX( 0.0, MAX( node.lo_y - center.y,
+                                         center.y - node.hi_y ) );
+        return dx*dx + dy*dy < r2;
+      },
+      [&](const Node& node)
+      {
+        const double dx = MAX( center.x - node.lo_x, node.hi_x - center.x );
+        const double dy = MAX( center.y - node.lo_y, node.hi_y - center.y );
+        return dx*dx + dy*dy < r2;
+      },
+      [&](const Vec2<V>& p)
+      { return ( p - center ).length_squared() < r2; },
+      f );
+  }
+
+  /*------------------------------------------------------------------
+  | Collect items within a rectangle or a circle, as QuadTree does
+  ------------------------------------------------------------------*/
+  size_t get_items(const Vec2<V>& lowleft,
+                   const Vec2<V>& upright,
+                   Vector& found) const
+  {
+    return get_items( lowleft, upright,
+                      [&](T* item) { found.push_back( item ); } );
+  }
+
+  size_t get_items(const Vec2<V>& center,
+                   const double   radius,
+                   Vector&        found) const
+  {
+    return get_items( center, radius,
+                      [&](T* item) { found.push_back( item ); } );
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | A quad with the bounding box of its items, its contiguous
+  | children and its range of items
+  ------------------------------------------------------------------*/
+  struct Node
+  {
+    V             lo_x { 0 };
+    V             lo_y { 0 };
+    V             hi_x { 0 };
+    V             hi_y { 0 };
+    std::uint32_t begin      { 0 };
+    std::uint32_t end        { 0 };
+    std::uint32_t first_child { 0 };
+    std::uint32_t n_children  { 0 };
+  };
+
+  static constexpr int    MORTON_BITS = 32;
+  static constexpr double GRID_SIZE   = 4294967296.0; // 2^32
+
+  /*------------------------------------------------------------------
+  | Quantize a coordinate on the Morton grid
+  ------------------------------------------------------------------*/
+  static std::uint32_t quantize(double d, double to_grid)
+  {
+    const double q = d * to_grid;
+    return ( q >= GRID_SIZE - 1.0 )
+      ? std::numeric_limits<std::uint32_t>::max()
+      : static_cast<std::uint32_t>( MAX( 0.0, q ) );
+  }
+
+  /*------------------------------------------------------------------
+  | Interleave the bits of x (even bits) and y (odd bits)
+  ------------------------------------------------------------------*/
+  static std::uint64_t spread_bits(std::uint32_t v)
+  {
+    std::uint64_t x = v;
+    x = ( x | ( x << 16 ) ) & 0x0000FFFF0000FFFFull;
+    x = ( x | ( x <<  8 ) ) & 0x00FF00FF00FF00FFull;
+    x = ( x | ( x <<  4 ) ) & 0x0F0F0F0F0F0F0F0Full;
+    x = ( x | ( x <<  2 ) ) & 0x3333333333333333ull;
+    x = ( x | ( x <<  1 ) ) & 0x5555555555555555ull;
+    return x;
+  }
+
+  static std::uint64_t morton_code(std::uint32_t x, std::uint32_t y)
+  { return spread_bits( x ) | ( spread_bits( y ) << 1 ); }
+
+  /*------------------------------------------------------------------
+  | Set up the node for the items [begin,end) on the given level
+  | and split it recursively
+  ------------------------------------------------------------------*/
+  void build_node(size_t id, std::uint32_t begin, std::uint32_t end,
+                  size_t level)
+  {
+    depth_ = MAX( depth_, level );
+
+    nodes_[id].begin = begin;
+    nodes_[id].end   = end;
+
+    if ( end - begin <= max_item_ || level >= max_depth_ )
+    {
+      Node& node = nodes_[id];
+
+      node.lo_x = node.hi_x = xy_[begin].x;
+      node.lo_y = node.hi_y = xy_[begin].y;
+
+      for ( std::uint32_t i = begin + 1; i < end; ++i )
+      {
+        node.lo_x = MIN( node.lo_x, xy_[i].x );
+        node.lo_y = MIN( node.lo_y, xy_[i].y );
+        node.hi_x = MAX( node.hi_x, xy_[i].x );
+        node.hi_y = MAX( node.hi_y, xy_[i].y );
+      }
+
+      return;
+    }
+
+    // Children are the ranges of the next two code bits
+    const int shift = 2 * ( MORTON_BITS - 1 - static_cast<int>(level) );
+
+    std::uint32_t bounds[5] = { begin, 0, 0, 0, end };
+
+    for ( std::uint64_t c = 1; c < 4; ++c )
+    {
+      bounds[c] = static_cast<std::uint32_t>( std::partition_point(
+        codes_.begin() + bounds[c-1], codes_.begin() + end,
+        [&](std::uint64_t code) { return ( ( code >> shift ) & 3 ) < c; })
+        - codes_.begin() );
+    }
+
+    std::uint32_t n_children = 0;
+    for ( int c = 0; c < 4; ++c )
+      n_children += ( bounds[c+1] > bounds[c] );
+
+    // All items share the same quad on this level
+    if ( n_children == 1 )
+    {
+      build_node( id, begin, end, level + 1 );
+      return;
+    }
+
+    const size_t first = nodes_.size();
+    nodes_.resize( first + n_children );
+
+    nodes_[id].first_child = static_cast<std::uint32_t>( first );
+    nodes_[id].n_children  = n_children;
+
+    size_t child = first;
+
+    for ( int c = 0; c < 4; ++c )
+      if ( bounds[c+1] > bounds[c] )
+        build_node( child++, bounds[c], bounds[c+1], level + 1 );
+
+    Node& node = nodes_[id];
+    node.lo_x = node.hi_x = nodes_[first].lo_x;
+    node.lo_y = node.hi_y = nodes_[first].lo_y;
+
+    for ( size_t k = first; k < first + n_children; ++k )
+    {
+      node.lo_x = MIN( node.lo_x, nodes_[k].lo_x );
+      node.lo_y = MIN( node.lo_y, nodes_[k].lo_y );
+      node.hi_x = MAX( node.hi_x, nodes_[k].hi_x );
+      node.hi_y = MAX( node.hi_y, nodes_[k].hi_y );
+    }
+
+  } // build_node()
+
+  /*------------------------------------------------------------------
+  | Depth-first traversal with an explicit stack. Nodes, which
+  | overlap the query, are descended, covered nodes are reported
+  | entirely and the items of other leafs are tested one by one.
+  ------------------------------------------------------------------*/
+  template <typename Overlap, typename Covered, typename Inside,
+            typename Function>
+  size_t traverse(Overlap&& overlap, Covered&& covered,
+                  Inside&& inside, Function&& f) const
+  {
+    if ( nodes_.empty() )
+      return 0;
+
+    // Every level adds at most three pending siblings
+    std::uint32_t stack[ 3 * ( MORTON_BITS + 1 ) + 1 ];
+    int           top = 0;
+
+    stack[top++] = 0;
+
+    size_t n_found = 0;
+
+    while ( top > 0 )
+    {
+      const Node& node = nodes_[ stack[--top] ];
+
+      if ( !overlap( node ) )
+        continue;
+
+      if ( covered( node ) )
+      {
+        for ( std::uint32_t i = node.begin; i < node.end; ++i )
+          f( items_[i] );
+
+        n_found += node.end - node.begin;
+        continue;
+      }
+
+      if ( node.n_children > 0 )
+      {
+        for ( std::uint32_t c = node.n_children; c > 0; --c )
+          stack[top++] = node.first_child + c - 1;
+        continue;
+      }
+
+      for ( std::uint32_t i = node.begin; i < node.end; ++i )
+        if ( inside( xy_[i] ) )
+        {
+          f( items_[i] );
+          ++n_found;
+        }
+    }
+
+    return n_found;
+
+  } // traverse()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  size_t                     max_item_;
+  size_t                     max_depth_;
+  size_t                     depth_ { 0 };
+
+  std::vector<Node>          nodes_;
+  Vector                     items_;
+  std::vector<Vec2<V>>       xy_;
+  std::vector<std::uint64_t> codes_;
+
+}; // LinearQuadTree
+
+} // namespace CppUtils
@@ -9,8 +9,16 @@
 
 
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
 
 namespace CppUtils {
 
@@ -34,6 +42,17 @@ enum LogColor {
   DEFAULT  = 39,
 };
 
+/*********************************************************************
+* Compile-time minimum log level. Messages of higher levels are
+* removed by the LOG macro, including the evaluation of their
+* arguments, e.g. with -DCPPUTILS_LOG_MIN_LEVEL=INFO
+*********************************************************************/
+#ifndef CPPUTILS_LOG_MIN_LEVEL
+#define CPPUTILS_LOG_MIN_LEVEL DEBUG
+#endif
+
+constexpr LogLevel LOG_MIN_LEVEL { CPPUTILS_LOG_MIN_LEVEL };
+
 
 /*********************************************************************
 * Interface to create ostream unique_ptr, which gets properly 
@@ -70,6 +89,30 @@ static inline OStreamPtr create_stream(OStreamType type, const std::string& path
   return OStreamPtr { &std::cout, ConditionalDeleter {false} };
 }
 
+/*********************************************************************
+* Escape sequence of a color, which is built only once
+*********************************************************************/
+inline const std::string& color_code(LogColor c)
+{
+  static const std::string codes[] = {
+    "\033[30m", "\033[31m", "\033[32m", "\033[33m", "\033[34m",
+    "\033[35m", "\033[36m", "\033[37m", "\033[38m", "\033[39m" };
+
+  const int i = static_cast<int>( c ) - 30;
+  return codes[ ( i >= 0 && i < 10 ) ? i : 9 ];
+}
+
+/*********************************************************************
+* Small index of the calling thread in the order of its first log
+* message, which is shown in the message headers
+*********************************************************************/
+inline int log_thread_id()
+{
+  static std::atomic<int> n_threads { 0 };
+  thread_local const int id = n_threads.fetch_add( 1 );
+  return id;
+}
+
 
 /*********************************************************************
 * The global logging properties
@@ -77,6 +120,8 @@ static inline OStreamPtr create_stream(OStreamType type, const std::string& path
 class LogProperties
 {
 public:
+  using Clock = std::chrono::steady_clock;
+
   /*------------------------------------------------------------------
   | Default constructor
   ------------------------------------------------------------------*/
@@ -93,42 +138,47 @@ public:
   ------------------------------------------------------------------*/
   void set_level(LogLevel level) { level_ = level; }
   void show_header(bool show) { show_header_ = show; }
+  void show_timestamp(bool show) { show_timestamp_ = show; }
+  void show_thread_id(bool show) { show_thread_id_ = show; }
   void use_newline(bool nl) { use_newline_ = nl; }
   void use_color(bool c) { use_color_ = c; }
 
+  // Write messages through the AsyncLogger (defined below)
+  inline void use_async(bool async);
+
   void set_error_header(const std::string& msg) { error_header_ = msg; }
   void set_warn_header(const std::string& msg) { warn_header_ = msg; }
   void set_info_header(const std::string& msg) { info_header_ = msg; }
   void set_debug_header(const std::string& msg) { debug_header_ = msg; }
 
   void set_error_ostream(OStreamType type, const std::string& f="")
-  { 
-    error_os_      = create_stream( type, f ); 
-    error_os_type_ = type;
-  }
+  { set_ostream( error_os_, error_os_type_, type, f ); }
   void set_warn_ostream(OStreamType type, const std::string& f="")
-  { 
-    warn_os_      = create_stream( type, f ); 
-    warn_os_type_ = type;
-  }
+  { set_ostream( warn_os_, warn_os_type_, type, f ); }
   void set_info_ostream(OStreamType type, const std::string& f="")
-  { 
-    info_os_      = create_stream( type, f ); 
-    info_os_type_ = type;
-  }
+  { set_ostream( info_os_, info_os_type_, type, f ); }
   void set_debug_ostream(OStreamType type, const std::string& f="")
-  { 
-    debug_os_      = create_stream( type, f ); 
-    debug_os_type_ = type;
-  }
+  { set_ostream( debug_os_, debug_os_type_, type, f ); }
 
   /*------------------------------------------------------------------
   | Getters
   ------------------------------------------------------------------*/
   const LogLevel& level() const { return level_; }
   bool show_header() const { return show_header_; }
+  bool show_timestamp() const { return show_timestamp_; }
+  bool show_thread_id() const { return show_thread_id_; }
   bool use_newline() const { return use_newline_; }
   bool use_color() const { return use_color_; }
+  bool use_async() const { return use_async_; }
+
+  // Serializes the output to the streams
+  std::mutex& ostream_mutex() { return ostream_mutex_; }
+
+  // Seconds since the start of the program
+  double elapsed() const
+  {
+    return std::chrono::duration<double>( Clock::now() - start_ ).count();
+  }
 
   const std::string& get_header(LogLevel level) const 
   {
@@ -163,36 +213,33 @@ public:
     return info_os_type_;
   }
 
-  std::string get_color(LogLevel level)
+  const std::string& get_color(LogLevel level)
   {
-    std::string base = { "\033[" };
     switch( level ) {
-      case ERROR:   
-        base += std::to_string( error_col_ ); 
-        break;
-      case WARNING: 
-        base += std::to_string( warn_col_ ); 
-        break;
-      case INFO:    
-        base += std::to_string( info_col_ ); 
-        break;
-      case DEBUG:   
-        base += std::to_string( debug_col_ ); 
-        break;
-      default:      
-        base += std::to_string( LogColor::DEFAULT );
+      case ERROR:   return color_code( error_col_ );
+      case WARNING: return color_code( warn_col_ );
+      case INFO:    return color_code( info_col_ );
+      case DEBUG:   return color_code( debug_col_ );
     }
-    base += "m";
-    return base;
+    return color_code( LogColor::DEFAULT );
   }
 
 
 private:
+  /*------------------------------------------------------------------
+  | Replace a stream, after pending asynchronous messages have been
+  | written to the old one
+  ------------------------------------------------------------------*/
+  inline void set_ostream(OStreamPtr& os, OStreamType& os_type,
+                          OStreamType type, const std::string& f);
 
-  LogLevel    level_         = INFO;
-  bool        show_header_   = true;
-  bool        use_newline_   = true;
-  bool        use_color_     = true;
+  LogLevel    level_          = INFO;
+  bool        show_header_    = true;
+  bool        show_timestamp_ = false;
+  bool        show_thread_id_ = false;
+  bool        use_newline_    = true;
+  bool        use_color_      = true;
+  bool        use_async_      = false;
 
   std::string error_header_  = "[ERROR] ";
   std::string warn_header_   = "[WARNING] ";
@@ -214,13 +261,309 @@ private:
   LogColor info_col_   { DEFAULT };
   LogColor debug_col_  { DEFAULT };
 
+  std::mutex        ostream_mutex_;
+  Clock::time_point start_ { Clock::now() };
+
 };
 
 inline LogProperties LOG_PROPERTIES;
 
+
+/*********************************************************************
+* Asynchronous backend for LOG
+*
+* Every logging thread owns a lock-free single-producer ring buffer
+* of preformatted records. A background thread collects the records
+* of all rings, orders them by their timestamps and writes them to
+* the streams of LOG_PROPERTIES. Hence, threads only format their
+* messages and never wait for the streams or for each other.
+*
+* If the ring of a thread is full, the thread waits for the flusher,
+* such that no messages are lost. Error messages are written
+* immediately.
+*
+* Usage:
+* ------
+*   LOG_PROPERTIES.use_async( true );   // Start the flusher thread
+*   ...
+*   ASYNC_LOGGER.flush();               // Write all pending records
+*   LOG_PROPERTIES.use_async( false );  // Write and stop
+*
+* The mode should be changed, while no other threads are logging.
+*********************************************************************/
+class AsyncLogger
+{
+public:
+  /*------------------------------------------------------------------
+  | A preformatted message
+  ------------------------------------------------------------------*/
+  struct Record
+  {
+    std::string text;
+    double      time    { 0.0 };
+    LogLevel    level   { INFO };
+    bool        newline { true };
+  };
+
+  /*------------------------------------------------------------------
+  | Constructor / destructor
+  ------------------------------------------------------------------*/
+  AsyncLogger(size_t ring_size=4096)
+  : ring_size_ { ring_size }
+  {}
+
+  ~AsyncLogger() { stop(); }
+
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  bool running() const { return running_.load(); }
+
+  // Number of messages, for which a producer had to wait
+  size_t n_waits() const { return n_waits_.load(); }
+
+  size_t n_written() const { return n_written_.load(); }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void flush_interval(std::chrono::microseconds dt) { interval_ = dt; }
+
+  /*------------------------------------------------------------------
+  | Start / stop the flusher thread
+  ------------------------------------------------------------------*/
+  void start()
+  {
+    if ( running_.exchange( true ) )
+      return;
+
+    flusher_ = std::thread { [this] { run(); } };
+  }
+
+  void stop()
+  {
+    if ( !running_.exchange( false ) )
+      return;
+
+    flusher_.join();
+    flush();
+  }
+
+  /*------------------------------------------------------------------
+  | Add a message of the calling thread
+  ------------------------------------------------------------------*/
+  void push(LogLevel level, const std::string& text, bool newline)
+  {
+    Ring& ring = local_ring();
+
+    const size_t tail = ring.tail.load( std::memory_order_relaxed );
+
+    if ( tail - ring.head.load( std::memory_order_acquire )
+         >= ring.records.size() )
+    {
+      n_waits_.fetch_add( 1, std::memory_order_relaxed );
+
+      while ( tail - ring.head.load( std::memory_order_acquire )
+              >= ring.records.size() )
+        std::this_thread::yield();
+    }
+
+    Record& record = ring.records[ tail & ring.mask ];
+    record.text.assign( text );
+    record.time    = LOG_PROPERTIES.elapsed();
+    record.level   = level;
+    record.newline = newline;
+
+    ring.tail.store( tail + 1, std::memory_order_release );
+
+    if ( level == ERROR )
+      flush();
+  }
+
+  /*------------------------------------------------------------------
+  | Write all records, which have been pushed so far
+  ------------------------------------------------------------------*/
+  size_t flush()
+  {
+    std::lock_guard<std::mutex> drain_lock { drain_mutex_ };
+
+    std::vector<Ring*> rings {};
+    {
+      std::lock_guard<std::mutex> lock { registry_mutex_ };
+      for ( auto& ring : rings_ )
+        rings.push_back( ring.get() );
+    }
+
+    // Collect the pending records, which remain in their rings
+    // until they have been written
+    batch_.clear();
+    tails_.resize( rings.size() );
+
+    for ( size_t i = 0; i < rings.size(); ++i )
+    {
+      Ring& ring = *rings[i];
+      const size_t head = ring.head.load( std::memory_order_relaxed );
+      tails_[i] = ring.tail.load( std::memory_order_acquire );
+
+      for ( size_t j = head; j < tails_[i]; ++j )
+        batch_.push_back( &ring.records[ j & ring.mask ] );
+    }
+
+    if ( batch_.empty() )
+      return 0;
+
+    std::stable_sort( batch_.begin(), batch_.end(),
+      [](const Record* a, const Record* b) { return a->time < b->time; });
+
+    {
+      std::lock_guard<std::mutex> lock { LOG_PROPERTIES.ostream_mutex() };
+
+      for ( const Record* r : batch_ )
+      {
+        std::ostream& os = LOG_PROPERTIES.get_ostream( r->level );
+        os << r->text;
+        if ( r->newline )
+          os << '\n';
+      }
+
+      for ( LogLevel level : { ERROR, WARNING, INFO, DEBUG } )
+        LOG_PROPERTIES.get_ostream( level ).flush();
+    }
+
+    for ( size_t i = 0; i < rings.size(); ++i )
+      rings[i]->head.store( tails_[i], std::memory_order_release );
+
+    n_written_.fetch_add( batch_.size(), std::memory_order_relaxed );
+
+    return batch_.size();
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Single-producer single-consumer ring buffer, whose indices are
+  | placed on separate cache lines
+  ------------------------------------------------------------------*/
+  struct Ring
+  {
+    Ring(size_t size) : records ( size ), mask { size - 1 } {}
+
+    std::vector<Record>              records;
+    size_t                           mask;
+    std::atomic<bool>                in_use { true };
+
+    alignas(64) std::atomic<size_t>  head   { 0 };
+    alignas(64) std::atomic<size_t>  tail   { 0 };
+  };
+
+  // Releases the ring of a thread, when the thread exits
+  struct RingHandle
+  {
+    Ring* ring { nullptr };
+    ~RingHandle() { if ( ring ) ring->in_use.store( false ); }
+  };
+
+  /*------------------------------------------------------------------
+  | The ring of the calling thread, which is registered once and
+  | reused by later threads after the thread has exited
+  ------------------------------------------------------------------*/
+  Ring& local_ring()
+  {
+    thread_local RingHandle handle {};
+
+    if ( handle.ring )
+      return *handle.ring;
+
+    std::lock_guard<std::mutex> lock { registry_mutex_ };
+
+    for ( auto& ring : rings_ )
+    {
+      bool in_use = false;
+      if ( ring->in_use.compare_exchange_strong( in_use, true ) )
+      {
+        handle.ring = ring.get();
+        return *handle.ring;
+      }
+    }
+
+    size_t size = 1;
+    while ( size < ring_size_ )
+      size *= 2;
+
+    rings_.push_back( std::make_unique<Ring>( size ) );
+    handle.ring = rings_.back().get();
+
+    return *handle.ring;
+  }
+
+  /*------------------------------------------------------------------
+  | Flusher thread
+  ------------------------------------------------------------------*/
+  void run()
+  {
+    while ( running_.load() )
+      if ( flush() == 0 )
+        std::this_thread::sleep_for( interval_ );
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  size_t                              ring_size_;
+  std::chrono::microseconds           interval_ { 1000 };
+
+  std::mutex                          registry_mutex_;
+  std::vector<std::unique_ptr<Ring>>  rings_;
+
+  std::mutex                          drain_mutex_;
+  std::vector<Record*>                batch_;
+  std::vector<size_t>                 tails_;
+
+  std::thread                         flusher_;
+  std::atomic<bool>                   running_   { false };
+  std::atomic<size_t>                 n_waits_   { 0 };
+  std::atomic<size_t>                 n_written_ { 0 };
+
+}; // AsyncLogger
+
+inline AsyncLogger ASYNC_LOGGER;
+
+/*--------------------------------------------------------------------
+| LogProperties functions, which depend on the AsyncLogger
+--------------------------------------------------------------------*/
+inline void LogProperties::use_async(bool async)
+{
+  if ( async )
+    ASYNC_LOGGER.start();
+
+  use_async_ = async;
+
+  if ( !async )
+    ASYNC_LOGGER.stop();
+}
+
+inline void LogProperties::set_ostream(OStreamPtr& os, OStreamType& os_type,
+                                       OStreamType type, const std::string& f)
+{
+  if ( use_async_ )
+    ASYNC_LOGGER.flush();
+
+  std::lock_guard<std::mutex> lock { ostream_mutex_ };
+  os      = create_stream( type, f );
+  os_type = type;
+}
+
+
 /*********************************************************************
 * The interface for the actual SimpleLogger
 *
+* Every message is formatted into a buffer of the calling thread
+* and written at once, either directly or through the AsyncLogger.
+* Nested messages, e.g. in functions called within a message, use
+* separate buffers.
+*
 * Reference:
 * ----------
 * -https://stackoverflow.com/questions/5028302/small-logger-class
@@ -231,84 +574,196 @@ public:
   /*------------------------------------------------------------------
   | Default constructor
   ------------------------------------------------------------------*/
-  LOG() {}
+  LOG() : LOG( DEBUG ) {}
 
   /*------------------------------------------------------------------
   | Constructror with log level specification
   ------------------------------------------------------------------*/
   LOG(LogLevel level)
+  : LOG( level, LOG_PROPERTIES.get_color( level ) )
+  {}
+
+  /*------------------------------------------------------------------
+  | Constructror with log level and color specification
+  ------------------------------------------------------------------*/
+  LOG(LogLevel level, LogColor c)
+  : LOG( level, color_code( c ) )
+  {}
+
+  /*------------------------------------------------------------------
+  | Destructor -> write the message and append new line, if
+  | property is set
+  ------------------------------------------------------------------*/
+  ~LOG() 
   {
-    level_ = level;
+    if ( enabled_ )
+    {
+      // Set default color
+      if ( LOG_PROPERTIES.use_color() &&
+           LOG_PROPERTIES.get_ostream_type(level_) != TO_FILE )
+        operator<< ("\e[0m");
 
-    if ( LOG_PROPERTIES.use_color() && 
-         LOG_PROPERTIES.get_ostream_type(level_) != TO_FILE )
-      operator<<( LOG_PROPERTIES.get_color( level_ ) );
-    
-    if ( LOG_PROPERTIES.show_header() )
-      operator<<( LOG_PROPERTIES.get_header( level_ ) );
+      if ( opened_ )
+        write();
+    }
+
+    --buffers().depth;
   }
 
   /*------------------------------------------------------------------
-  | Constructror with log level and color specification
+  | OStream operator
   ------------------------------------------------------------------*/
-  LOG(LogLevel level, LogColor c)
+  template<class T>
+  LOG& operator<<(const T& msg)
   {
-    level_ = level;
+    if ( enabled_ )
+    {
+      buffer().os << msg;
+      opened_ = true;
+    }
+    return *this;
+  }
 
-    if ( LOG_PROPERTIES.use_color() && 
-         LOG_PROPERTIES.get_ostream_type(level_) != TO_FILE )
+private:
+  /*------------------------------------------------------------------
+  | Thread-local message buffers, which keep their capacity
+  ------------------------------------------------------------------*/
+  struct StringBuf : public std::streambuf
+  {
+    std::string text;
+
+    int_type overflow(int_type c) override
     {
-      std::string color { "\033[" };
-      color += std::to_string( c ); 
-      color += "m";
-      operator<<( color );
+      if ( c != traits_type::eof() )
+        text.push_back( static_cast<char>( c ) );
+      return c;
     }
-    
-    if ( LOG_PROPERTIES.show_header() )
-      operator<<( LOG_PROPERTIES.get_header( level_ ) );
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+      text.append( s, n );
+      return n;
+    }
+  };
+
+  struct Buffer
+  {
+    Buffer() : os { &buf } {}
+
+    StringBuf    buf;
+    std::ostream os;
+  };
+
+  struct Buffers
+  {
+    std::vector<std::unique_ptr<Buffer>> stack;
+    size_t                               depth { 0 };
+  };
+
+  static Buffers& buffers()
+  {
+    thread_local Buffers b {};
+    return b;
   }
 
+  Buffer& buffer() { return *buffers().stack[ index_ ]; }
+
   /*------------------------------------------------------------------
-  | Destructor -> append new line, if property is set
+  | Acquire a buffer and write the headers
   ------------------------------------------------------------------*/
-  ~LOG() 
+  LOG(LogLevel level, const std::string& color)
+  : level_   { level }
+  , enabled_ { level <= LOG_PROPERTIES.level() }
   {
-    // Set default color
+    Buffers& b = buffers();
+    index_ = b.depth++;
+
+    if ( b.stack.size() <= index_ )
+      b.stack.push_back( std::make_unique<Buffer>() );
+
+    buffer().buf.text.clear();
+
+    if ( !enabled_ )
+      return;
+
     if ( LOG_PROPERTIES.use_color() &&
          LOG_PROPERTIES.get_ostream_type(level_) != TO_FILE )
-      operator<< ("\e[0m");
+      operator<<( color );
 
-    // Append newline
-    if ( opened_ && LOG_PROPERTIES.use_newline() )
-      LOG_PROPERTIES.get_ostream( level_ ) << std::endl;
+    if ( LOG_PROPERTIES.show_timestamp() )
+    {
+      char stamp[32];
+      std::snprintf( stamp, sizeof(stamp), "[%12.6f] ",
+                     LOG_PROPERTIES.elapsed() );
+      operator<<( stamp );
+    }
 
-    // Reset 
-    opened_ = false;
+    if ( LOG_PROPERTIES.show_thread_id() )
+    {
+      char id[16];
+      std::snprintf( id, sizeof(id), "[T%02d] ", log_thread_id() );
+      operator<<( id );
+    }
+
+    if ( LOG_PROPERTIES.show_header() )
+      operator<<( LOG_PROPERTIES.get_header( level_ ) );
   }
 
   /*------------------------------------------------------------------
-  | OStream operator
+  | Write the formatted message
   ------------------------------------------------------------------*/
-  template<class T>
-  LOG& operator<<(const T& msg)
+  void write()
   {
-    if ( level_ <= LOG_PROPERTIES.level() )
+    const std::string& text    = buffer().buf.text;
+    const bool         newline = LOG_PROPERTIES.use_newline();
+
+    if ( LOG_PROPERTIES.use_async() )
     {
-      LOG_PROPERTIES.get_ostream( level_ ) << msg;
-      opened_ = true;
+      ASYNC_LOGGER.push( level_, text, newline );
+      return;
     }
-    return *this;
+
+    std::lock_guard<std::mutex> lock { LOG_PROPERTIES.ostream_mutex() };
+
+    std::ostream& os = LOG_PROPERTIES.get_ostream( level_ );
+    os << text;
+
+    if ( newline )
+      os << std::endl;
   }
 
-private:
   /*------------------------------------------------------------------
   | Attributes
   ------------------------------------------------------------------*/
-  bool     opened_ = false;
-  LogLevel level_  = DEBUG;
+  LogLevel level_   = DEBUG;
+  bool     enabled_ = false;
+  bool     opened_  = false;
+  size_t   index_   = 0;
 
 }; // LOG
 
+/*********************************************************************
+* The LOG macro, which skips the message and the evaluation of its
+* arguments for disabled levels. Levels above LOG_MIN_LEVEL are
+* removed at compile time.
+*
+*   LOG(INFO) << "Residual: " << compute_residual();
+*   LOG(INFO, GREEN) << "Converged";
+*********************************************************************/
+struct LogVoidify
+{
+  void operator&(const LOG&) const {}
+};
+
+inline bool log_enabled(LogLevel level, LogColor=DEFAULT)
+{
+  return level <= LOG_MIN_LEVEL && level <= LOG_PROPERTIES.level();
+}
+
+#define LOG(...)                                                     \
+  !CppUtils::log_enabled( __VA_ARGS__ ) ? (void) 0                   \
+  : CppUtils::LogVoidify {} & CppUtils::LOG( __VA_ARGS__ )
+
 /*********************************************************************
 * Additional debug macro
 *********************************************************************/
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 
 namespace CppUtils {
 
@@ -36,6 +37,27 @@ public:
   , data_ (r*c, 0) 
   { }
 
+  /*------------------------------------------------------------------
+  | Constructor with parallel first-touch initialization: 
+  | The rows are set to zero within a parallel loop of the given 
+  | executor (e.g. the ThreadPool). If the allocator does not 
+  | initialize the elements (see DefaultInitAllocator), every memory
+  | page is placed on the NUMA node of the thread that processes 
+  | these rows in later parallel loops.
+  ------------------------------------------------------------------*/
+  template <typename Executor>
+  Matrix(int r, int c, Executor& executor)
+  : rows_ { r }
+  , cols_ { c }
+  , data_ ( r*c )
+  {
+    executor.parallel_for(0, r, [this](int i)
+    {
+      std::fill( data_.data() + i*cols_, 
+                 data_.data() + (i+1)*cols_, T{} );
+    });
+  }
+
   Matrix(T* data, int r, int c)
   : rows_ { r }
   , cols_ { c }
@@ -104,7 +126,7 @@ public:
   { 
     rows_ = r;
     cols_ = c;
-    data_.resize( r * c ); 
+    data_.resize( r * c, T{} ); 
   }
 
   /*------------------------------------------------------------------
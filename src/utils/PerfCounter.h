@@ -0,0 +1,163 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace CppUtils {
+
+/*********************************************************************
+* Hardware events, which are supported by the PerfCounter
+*********************************************************************/
+enum class PerfEvent
+{
+  CYCLES,
+  INSTRUCTIONS,
+  CACHE_REFERENCES,
+  CACHE_MISSES,
+};
+
+/*********************************************************************
+* A hardware performance counter of the calling thread, based on
+* the Linux perf_event_open() interface.
+*
+* Counters are optional: If the event is not supported, e.g. on
+* other platforms, inside of containers or for a restrictive
+* /proc/sys/kernel/perf_event_paranoid, available() returns false
+* and all readings are zero.
+*
+* Usage:
+* ------
+*   PerfCounter misses { PerfEvent::CACHE_MISSES };
+*
+*   misses.start();
+*   ...
+*   misses.stop();
+*
+*   if ( misses.available() )
+*     std::cout << misses.value() * 64 << " bytes from memory";
+*********************************************************************/
+class PerfCounter
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  PerfCounter(PerfEvent event)
+  {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset( &attr, 0, sizeof(attr) );
+
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config( event );
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    fd_ = static_cast<int>(
+      syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 ) );
+#else
+    (void) event;
+#endif
+  }
+
+  ~PerfCounter()
+  {
+#if defined(__linux__)
+    if ( fd_ >= 0 )
+      close( fd_ );
+#endif
+  }
+
+  PerfCounter(const PerfCounter&) = delete;
+  PerfCounter& operator=(const PerfCounter&) = delete;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  bool available() const { return fd_ >= 0; }
+
+  /*------------------------------------------------------------------
+  | Reset and start counting
+  ------------------------------------------------------------------*/
+  void start()
+  {
+#if defined(__linux__)
+    if ( fd_ < 0 )
+      return;
+
+    ioctl( fd_, PERF_EVENT_IOC_RESET, 0 );
+    ioctl( fd_, PERF_EVENT_IOC_ENABLE, 0 );
+#endif
+  }
+
+  /*------------------------------------------------------------------
+  | Stop counting
+  ------------------------------------------------------------------*/
+  void stop()
+  {
+#if defined(__linux__)
+    if ( fd_ >= 0 )
+      ioctl( fd_, PERF_EVENT_IOC_DISABLE, 0 );
+#endif
+  }
+
+  /*------------------------------------------------------------------
+  | Number of events between start() and stop()
+  ------------------------------------------------------------------*/
+  std::uint64_t value() const
+  {
+    std::uint64_t count = 0;
+
+#if defined(__linux__)
+    if ( fd_ >= 0 && read( fd_, &count, sizeof(count) ) != sizeof(count) )
+      count = 0;
+#endif
+
+    return count;
+  }
+
+private:
+#if defined(__linux__)
+  /*------------------------------------------------------------------
+  | Map events to the perf_event configuration
+  ------------------------------------------------------------------*/
+  static std::uint64_t config(PerfEvent event)
+  {
+    switch ( event )
+    {
+      case PerfEvent::CYCLES:
+        return PERF_COUNT_HW_CPU_CYCLES;
+      case PerfEvent::INSTRUCTIONS:
+        return PERF_COUNT_HW_INSTRUCTIONS;
+      case PerfEvent::CACHE_REFERENCES:
+        return PERF_COUNT_HW_CACHE_REFERENCES;
+      default:
+        return PERF_COUNT_HW_CACHE_MISSES;
+    }
+  }
+#endif
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int fd_ { -1 };
+
+}; // PerfCounter
+
+} // namespace CppUtils
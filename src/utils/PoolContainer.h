@@ -0,0 +1,354 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>         // std::vector
+#include <memory>         // std::unique_ptr
+#include <utility>        // std::forward
+#include <algorithm>      // std::sort
+#include <cstdint>        // std::uint32_t
+#include <new>            // placement new
+
+#include "QuadTree.h"
+#include "Container.h"
+#include "Vec2.h"
+#include "Helpers.h"
+#include "Log.h"
+
+namespace CppUtils {
+
+/*********************************************************************
+* Handle of an item in a PoolContainer, which remains valid until
+* the item is removed. Handles of removed items are detected by
+* their generation, even if the slot has been reused.
+*********************************************************************/
+struct PoolHandle
+{
+  std::uint32_t index      { 0 };
+  std::uint32_t generation { 0 };
+};
+
+/*********************************************************************
+* This class is a container for two-dimensional objects that also
+* keeps track of its objects using a quadtree, similar to
+* Container, but with pooled storage:
+*
+* - Items are constructed in place within slabs of SlabSize slots,
+*   such that inserting an item does not allocate memory in most
+*   cases and the addresses of all items remain stable
+* - The slots of removed items are destructed right away and reused
+*   through a free-list
+* - Pointers to all live items are stored densely, which provides
+*   O(1) indexed access and iteration without gaps. Removals move
+*   the last item to the removed position, hence the order of the
+*   items changes on removal.
+*
+* Items are only required to provide their location through xy().
+* Iterating the container yields pointers to the items.
+*********************************************************************/
+template <typename T, std::size_t SlabSize=4096>
+class PoolContainer
+{
+public:
+  using Vector         = std::vector<T*>;
+  using size_type      = typename Vector::size_type;
+  using iterator       = typename Vector::iterator;
+  using const_iterator = typename Vector::const_iterator;
+
+  iterator begin() { return dense_.begin(); }
+  iterator end() { return dense_.end(); }
+
+  const_iterator begin() const { return dense_.begin(); }
+  const_iterator end() const { return dense_.end(); }
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  PoolContainer(double qtree_scale = ContainerQuadTreeScale,
+                size_t qtree_items = ContainerQuadTreeItems,
+                size_t qtree_depth = ContainerQuadTreeDepth)
+  : qtree_ { qtree_scale, qtree_items, qtree_depth }
+  {}
+
+  /*------------------------------------------------------------------
+  | Destructor
+  ------------------------------------------------------------------*/
+  ~PoolContainer()
+  {
+    for ( T* item : dense_ )
+      item->~T();
+  }
+
+  PoolContainer(const PoolContainer&) = delete;
+  PoolContainer& operator=(const PoolContainer&) = delete;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  size_type size() const { return dense_.size(); }
+  size_type capacity() const { return slabs_.size() * SlabSize; }
+  const QuadTree<T,double>& quad_tree() const { return qtree_; }
+
+  /*------------------------------------------------------------------
+  | Get all items in a specified rectangle
+  ------------------------------------------------------------------*/
+  Vector get_items(const Vec2d& lowleft,
+                   const Vec2d& upright) const
+  {
+    Vector found;
+    qtree_.get_items( lowleft, upright, found );
+    return found;
+  }
+
+  /*------------------------------------------------------------------
+  | Get all items in a specified radius
+  ------------------------------------------------------------------*/
+  Vector get_items(const Vec2d& center,
+                   const double radius) const
+  {
+    Vector found;
+    qtree_.get_items( center, radius, found );
+    return found;
+  }
+
+  /*------------------------------------------------------------------
+  | Reserve slots for at least n items
+  ------------------------------------------------------------------*/
+  void reserve(size_type n)
+  {
+    while ( capacity() < n )
+      add_slab();
+
+    dense_.reserve( n );
+  }
+
+  /*------------------------------------------------------------------
+  | Construct a new item at the end of the container
+  ------------------------------------------------------------------*/
+  template <typename... Args>
+  T& push_back( Args&&... args )
+  {
+    if ( free_ == NO_SLOT )
+      add_slab();
+
+    const std::uint32_t index = free_;
+    Slot& slot = slot_at( index );
+
+    T* ptr = new ( slot.storage ) T( std::forward<Args>(args)... );
+
+    free_          = slot.next_free;
+    slot.dense_pos = static_cast<std::int64_t>( dense_.size() );
+
+    dense_.push_back( ptr );
+
+    if ( !qtree_.add( ptr ) )
+    {
+      LOG(ERROR) <<
+        "Failed to add element to the quad tree. "
+        "Maybe the element is outside of the defined domain.";
+    }
+
+    return *ptr;
+  }
+
+  /*------------------------------------------------------------------
+  | Remove an item, whose slot is reused afterwards
+  ------------------------------------------------------------------*/
+  bool remove(T& item)
+  {
+    Slot& slot = slot_of( item );
+
+    if ( slot.dense_pos < 0 || !qtree_.remove( &item ) )
+      return false;
+
+    release( item );
+
+    return true;
+  }
+
+  bool remove(PoolHandle handle)
+  {
+    T* item = get( handle );
+    return item ? remove( *item ) : false;
+  }
+
+  /*------------------------------------------------------------------
+  | Remove all items
+  ------------------------------------------------------------------*/
+  void clear()
+  {
+    while ( !dense_.empty() )
+    {
+      T& item = *dense_.back();
+      qtree_.remove( &item );
+      release( item );
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Handles of items and the access through handles, which yields
+  | a nullptr for removed items
+  ------------------------------------------------------------------*/
+  PoolHandle handle(const T& item) const
+  {
+    const Slot& slot = slot_of( item );
+    return { slot.index, slot.generation };
+  }
+
+  bool valid(PoolHandle handle) const
+  { return get( handle ) != nullptr; }
+
+  T* get(PoolHandle handle) const
+  {
+    if ( handle.index >= capacity() )
+      return nullptr;
+
+    const Slot& slot = slot_at( handle.index );
+
+    if ( slot.dense_pos < 0 || slot.generation != handle.generation )
+      return nullptr;
+
+    return dense_[ slot.dense_pos ];
+  }
+
+  /*------------------------------------------------------------------
+  | Access operator
+  ------------------------------------------------------------------*/
+  const T& operator[](size_t i) const
+  {
+    ASSERT( (i < dense_.size()), "Invalid access to PoolContainer" );
+    return *dense_[i];
+  }
+
+  T& operator[](size_t i)
+  {
+    ASSERT( (i < dense_.size()), "Invalid access to PoolContainer" );
+    return *dense_[i];
+  }
+
+  /*------------------------------------------------------------------
+  | Return a reference to the first / last element in container
+  ------------------------------------------------------------------*/
+  T& front()
+  {
+    ASSERT( (dense_.size() > 0), "Invalid access to container." );
+    return *dense_.front();
+  }
+  const T& front() const
+  {
+    ASSERT( (dense_.size() > 0), "Invalid access to container." );
+    return *dense_.front();
+  }
+
+  T& back()
+  {
+    ASSERT( (dense_.size() > 0), "Invalid access to container." );
+    return *dense_.back();
+  }
+  const T& back() const
+  {
+    ASSERT( (dense_.size() > 0), "Invalid access to container." );
+    return *dense_.back();
+  }
+
+  /*------------------------------------------------------------------
+  | Sort the elements in the container, the comparison is applied
+  | on pointers to the items
+  ------------------------------------------------------------------*/
+  template <class Compare>
+  void sort(Compare comp)
+  {
+    std::sort( dense_.begin(), dense_.end(), comp );
+
+    for ( size_t i = 0; i < dense_.size(); ++i )
+      slot_of( *dense_[i] ).dense_pos = static_cast<std::int64_t>( i );
+  }
+
+private:
+
+  /*------------------------------------------------------------------
+  | Storage of a single item. The item is located at the beginning
+  | of its slot, such that the slot is obtained from the item.
+  ------------------------------------------------------------------*/
+  struct Slot
+  {
+    alignas(T) unsigned char storage[sizeof(T)];
+    std::int64_t  dense_pos  { -1 };
+    std::uint32_t index      { 0 };
+    std::uint32_t generation { 0 };
+    std::uint32_t next_free  { 0 };
+  };
+
+  static constexpr std::uint32_t NO_SLOT = static_cast<std::uint32_t>(-1);
+
+  /*------------------------------------------------------------------
+  | Destruct an item and add its slot to the free-list. The last
+  | item is moved into its position of the dense storage.
+  ------------------------------------------------------------------*/
+  void release(T& item)
+  {
+    Slot& slot = slot_of( item );
+
+    T* last = dense_.back();
+    dense_[ slot.dense_pos ] = last;
+    slot_of( *last ).dense_pos = slot.dense_pos;
+    dense_.pop_back();
+
+    item.~T();
+
+    slot.dense_pos = -1;
+    ++slot.generation;
+    slot.next_free = free_;
+    free_          = slot.index;
+  }
+
+  /*------------------------------------------------------------------
+  | Add a slab, whose slots are prepended to the free-list in
+  | ascending order
+  ------------------------------------------------------------------*/
+  void add_slab()
+  {
+    const std::uint32_t first
+      = static_cast<std::uint32_t>( slabs_.size() * SlabSize );
+
+    slabs_.emplace_back( new Slot[SlabSize] );
+    Slot* slab = slabs_.back().get();
+
+    for ( std::uint32_t s = 0; s < SlabSize; ++s )
+    {
+      slab[s].index     = first + s;
+      slab[s].next_free = ( s + 1 < SlabSize ) ? first + s + 1 : free_;
+    }
+
+    free_ = first;
+  }
+
+  Slot& slot_at(std::uint32_t index)
+  { return slabs_[index / SlabSize][index % SlabSize]; }
+
+  const Slot& slot_at(std::uint32_t index) const
+  { return slabs_[index / SlabSize][index % SlabSize]; }
+
+  static Slot& slot_of(T& item)
+  { return *reinterpret_cast<Slot*>( &item ); }
+
+  static const Slot& slot_of(const T& item)
+  { return *reinterpret_cast<const Slot*>( &item ); }
+
+  /*------------------------------------------------------------------
+  | Container attributes
+  ------------------------------------------------------------------*/
+  std::vector<std::unique_ptr<Slot[]>> slabs_;
+  std::uint32_t                        free_ { NO_SLOT };
+  Vector                               dense_;
+  QuadTree<T,double>                   qtree_;
+
+}; // PoolContainer
+
+
+} // namespace CppUtils
@@ -0,0 +1,559 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include "Log.h"
+#include "PerfCounter.h"
+
+namespace CppUtils {
+
+/*********************************************************************
+* A hierarchical profiler of scoped regions.
+*
+* Regions are opened by a ScopedRegion (see PROFILE_SCOPE) and
+* closed at the end of its scope. Nested regions form a call tree,
+* which is accumulated per thread without synchronization:
+*
+* - Calls, total, minimum and maximum time of every region
+* - Optionally, CPU cycles and instructions of every region from
+*   the hardware counters (PerfCounter, perf_event_open() on Linux)
+* - Optionally, every call as event of a Chrome trace, which can be
+*   inspected with chrome://tracing or https://ui.perfetto.dev
+*
+* summary() merges the trees of all threads by their region names
+* and logs them. Regions, which are opened by the workers of the
+* thread pool, appear at the top level of the tree. The summary is
+* logged and the trace is written at exit, if requested.
+*
+* The profiler is disabled by default, such that regions only cost
+* a single branch. The regions can be removed at compile time with
+* CPPUTILS_NO_PROFILING. summary(), write_chrome_trace() and reset()
+* must be called, while no other threads are within regions.
+*
+* Usage:
+* ------
+*   PROFILER.enable( true );
+*   PROFILER.trace_file( "trace.json" );
+*
+*   void iteration()
+*   {
+*     PROFILE_SCOPE( "iteration" );
+*     ...
+*   }
+*********************************************************************/
+class Profiler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /*------------------------------------------------------------------
+  | A region in the call tree of a thread
+  ------------------------------------------------------------------*/
+  struct Region
+  {
+    const char*      name         { "" };
+    int              parent       { -1 };
+    std::vector<int> children     {};
+
+    size_t           calls        { 0 };
+    double           total        { 0.0 };
+    double           min          { std::numeric_limits<double>::max() };
+    double           max          { 0.0 };
+    std::uint64_t    cycles       { 0 };
+    std::uint64_t    instructions { 0 };
+  };
+
+  /*------------------------------------------------------------------
+  | A single call of a region, times in seconds since the start
+  ------------------------------------------------------------------*/
+  struct TraceEvent
+  {
+    const char* name;
+    double      start;
+    double      duration;
+  };
+
+  /*------------------------------------------------------------------
+  | The profile of a single thread
+  ------------------------------------------------------------------*/
+  struct ThreadData
+  {
+    ThreadData(int thread_id) : id { thread_id }, regions ( 1 ) {}
+
+    int                          id;
+    std::vector<Region>          regions;
+    int                          current  { 0 };
+    std::vector<TraceEvent>      events   {};
+    size_t                       n_dropped { 0 };
+
+    std::unique_ptr<PerfCounter> cycles       {};
+    std::unique_ptr<PerfCounter> instructions {};
+  };
+
+  /*------------------------------------------------------------------
+  | Regions of all threads, which are merged by their names
+  ------------------------------------------------------------------*/
+  struct Node
+  {
+    std::string       name         {};
+    size_t            calls        { 0 };
+    double            total        { 0.0 };
+    double            min          { std::numeric_limits<double>::max() };
+    double            max          { 0.0 };
+    std::uint64_t     cycles       { 0 };
+    std::uint64_t     instructions { 0 };
+    int               n_threads    { 0 };
+    std::vector<Node> children     {};
+
+    double mean() const { return calls > 0 ? total / calls : 0.0; }
+  };
+
+  /*------------------------------------------------------------------
+  | Constructor / destructor
+  ------------------------------------------------------------------*/
+  Profiler() = default;
+
+  ~Profiler()
+  {
+    if ( summary_at_exit_ && !threads_.empty() )
+      summary();
+
+    if ( !trace_file_.empty() )
+      write_chrome_trace( trace_file_ );
+  }
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  bool enabled() const
+  { return enabled_.load( std::memory_order_relaxed ); }
+  bool tracing() const
+  { return tracing_.load( std::memory_order_relaxed ); }
+  bool hardware_counters() const { return counters_; }
+  size_t max_events() const { return max_events_; }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void enable(bool e) { enabled_.store( e, std::memory_order_relaxed ); }
+  void tracing(bool t) { tracing_.store( t, std::memory_order_relaxed ); }
+  void hardware_counters(bool c) { counters_ = c; }
+  void summary_at_exit(bool s) { summary_at_exit_ = s; }
+
+  // Events per thread, which are recorded for the trace
+  void max_events(size_t n) { max_events_ = n; }
+
+  // Record a trace, which is written at exit
+  void trace_file(const std::string& path)
+  {
+    trace_file_ = path;
+    tracing( !path.empty() );
+  }
+
+  /*------------------------------------------------------------------
+  | The profile of the calling thread, which is registered at its
+  | first region
+  ------------------------------------------------------------------*/
+  ThreadData& thread_data()
+  {
+    thread_local ThreadData* data = nullptr;
+
+    if ( data )
+      return *data;
+
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    const int id = static_cast<int>( threads_.size() );
+    threads_.push_back( std::make_unique<ThreadData>( id ) );
+    data = threads_.back().get();
+
+    return *data;
+  }
+
+  /*------------------------------------------------------------------
+  | Open the child region of the current region with the given name
+  ------------------------------------------------------------------*/
+  int enter(ThreadData& data, const char* name)
+  {
+    const int parent = data.current;
+
+    for ( int child : data.regions[parent].children )
+    {
+      const char* child_name = data.regions[child].name;
+
+      if ( child_name == name || std::strcmp( child_name, name ) == 0 )
+        return data.current = child;
+    }
+
+    const int child = static_cast<int>( data.regions.size() );
+
+    data.regions.emplace_back();
+    data.regions[child].name   = name;
+    data.regions[child].parent = parent;
+    data.regions[parent].children.push_back( child );
+
+    return data.current = child;
+  }
+
+  /*------------------------------------------------------------------
+  | Close a region, which has been opened at time start
+  ------------------------------------------------------------------*/
+  void leave(ThreadData& data, int region, Clock::time_point start,
+             std::uint64_t cycles=0, std::uint64_t instructions=0)
+  {
+    const Clock::time_point end = Clock::now();
+    const double dt = std::chrono::duration<double>( end - start ).count();
+
+    Region& r = data.regions[region];
+
+    ++r.calls;
+    r.total        += dt;
+    r.min           = std::min( r.min, dt );
+    r.max           = std::max( r.max, dt );
+    r.cycles       += cycles;
+    r.instructions += instructions;
+
+    data.current = r.parent;
+
+    if ( tracing() )
+    {
+      if ( data.events.size() < max_events_ )
+        data.events.push_back( { r.name, seconds( start ), dt } );
+      else
+        ++data.n_dropped;
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Start the hardware counters of a thread, if requested
+  ------------------------------------------------------------------*/
+  bool start_counters(ThreadData& data)
+  {
+    if ( !counters_ )
+      return false;
+
+    if ( !data.cycles )
+    {
+      data.cycles = std::make_unique<PerfCounter>( PerfEvent::CYCLES );
+      data.instructions
+        = std::make_unique<PerfCounter>( PerfEvent::INSTRUCTIONS );
+
+      data.cycles->start();
+      data.instructions->start();
+    }
+
+    return data.cycles->available();
+  }
+
+  /*------------------------------------------------------------------
+  | Merge the call trees of all threads
+  ------------------------------------------------------------------*/
+  Node tree() const
+  {
+    Node root { "Total" };
+
+    for ( const auto& data : threads_ )
+    {
+      merge( *data, 0, root );
+
+      for ( int child : data->regions[0].children )
+        root.total += data->regions[child].total;
+    }
+
+    return root;
+  }
+
+  /*------------------------------------------------------------------
+  | Log the merged call tree, where the children of every region
+  | are sorted by their total time
+  ------------------------------------------------------------------*/
+  void summary() const
+  {
+    Node root = tree();
+
+    bool with_counters = false;
+    int  n_threads     = 0;
+
+    for ( const auto& data : threads_ )
+    {
+      with_counters |= ( data->cycles && data->cycles->available() );
+      n_threads     += ( data->regions.size() > 1 );
+    }
+
+    LOG(INFO) << "";
+    LOG(INFO) << "Profile of " << n_threads << " thread(s)";
+    LOG(INFO) << "Region                                 Calls   "
+                 "Total [s]   Mean [ms]    Min [ms]    Max [ms]  "
+                 "Parent  Thr." << ( with_counters ? "    IPC" : "" );
+    LOG(INFO) << std::string( with_counters ? 122 : 115, '-' );
+
+    for ( auto& child : root.children )
+      log_node( child, root.total, 0, with_counters );
+
+    LOG(INFO) << "";
+  }
+
+  /*------------------------------------------------------------------
+  | Write all recorded events in the Chrome trace event format
+  ------------------------------------------------------------------*/
+  bool write_chrome_trace(const std::string& path) const
+  {
+    std::ofstream file { path };
+
+    if ( !file )
+    {
+      LOG(WARNING) << "Profiler: Can not write trace file " << path;
+      return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool   first     = true;
+    size_t n_dropped = 0;
+    char   line[64];
+
+    for ( const auto& data : threads_ )
+    {
+      if ( data->events.empty() && data->n_dropped == 0 )
+        continue;
+
+      file << ( first ? "\n" : ",\n" )
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+           << data->id << ",\"args\":{\"name\":\"Thread " << data->id
+           << "\"}}";
+      first = false;
+
+      for ( const auto& e : data->events )
+      {
+        std::snprintf( line, sizeof(line), "\"ts\":%.3f,\"dur\":%.3f",
+                       1.0E6 * e.start, 1.0E6 * e.duration );
+
+        file << ",\n{\"name\":\"" << escaped( e.name )
+             << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << data->id
+             << "," << line << "}";
+      }
+
+      n_dropped += data->n_dropped;
+    }
+
+    file << "\n]}\n";
+
+    if ( n_dropped > 0 )
+      LOG(WARNING) << "Profiler: " << n_dropped << " events exceeded "
+                   << "the maximum number of events per thread";
+
+    return true;
+  }
+
+  /*------------------------------------------------------------------
+  | Remove all recorded regions and events
+  ------------------------------------------------------------------*/
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    for ( auto& data : threads_ )
+    {
+      data->regions.assign( 1, Region {} );
+      data->current   = 0;
+      data->n_dropped = 0;
+      data->events.clear();
+    }
+
+    start_ = Clock::now();
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | Seconds since the start of the profiler
+  ------------------------------------------------------------------*/
+  double seconds(Clock::time_point t) const
+  { return std::chrono::duration<double>( t - start_ ).count(); }
+
+  /*------------------------------------------------------------------
+  | Merge the children of a region of a thread into a node
+  ------------------------------------------------------------------*/
+  static void merge(const ThreadData& data, int region, Node& node)
+  {
+    for ( int child : data.regions[region].children )
+    {
+      const Region& r = data.regions[child];
+
+      auto it = std::find_if( node.children.begin(), node.children.end(),
+        [&r](const Node& n) { return n.name == r.name; });
+
+      if ( it == node.children.end() )
+      {
+        node.children.push_back( Node { r.name } );
+        it = node.children.end() - 1;
+      }
+
+      it->calls        += r.calls;
+      it->total        += r.total;
+      it->min           = std::min( it->min, r.min );
+      it->max           = std::max( it->max, r.max );
+      it->cycles       += r.cycles;
+      it->instructions += r.instructions;
+      it->n_threads    += 1;
+
+      merge( data, child, *it );
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Log a node and its children
+  ------------------------------------------------------------------*/
+  static void log_node(Node& node, double parent_total, int depth,
+                       bool with_counters)
+  {
+    std::sort( node.children.begin(), node.children.end(),
+      [](const Node& a, const Node& b) { return a.total > b.total; });
+
+    const std::string name = std::string( 2 * depth, ' ' ) + node.name;
+    const double share = ( parent_total > 0.0 )
+                       ? 100.0 * node.total / parent_total : 0.0;
+
+    char line[160];
+    std::snprintf( line, sizeof(line),
+      "%-34.34s %10zu %11.4f %11.4f %11.4f %11.4f %6.1f%% %5d",
+      name.c_str(), node.calls, node.total, 1.0E3 * node.mean(),
+      ( node.calls > 0 ) ? 1.0E3 * node.min : 0.0, 1.0E3 * node.max,
+      share, node.n_threads );
+
+    if ( with_counters )
+    {
+      char ipc[16];
+      std::snprintf( ipc, sizeof(ipc), " %6.2f", ( node.cycles > 0 )
+        ? static_cast<double>( node.instructions ) / node.cycles : 0.0 );
+      LOG(INFO) << line << ipc;
+    }
+    else
+      LOG(INFO) << line;
+
+    for ( auto& child : node.children )
+      log_node( child, node.total, depth+1, with_counters );
+  }
+
+  /*------------------------------------------------------------------
+  | Escape quotes and backslashes of region names for JSON
+  ------------------------------------------------------------------*/
+  static std::string escaped(const char* name)
+  {
+    std::string s {};
+
+    for ( const char* c = name; *c; ++c )
+    {
+      if ( *c == '"' || *c == '\\' )
+        s.push_back( '\\' );
+      s.push_back( *c );
+    }
+
+    return s;
+  }
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  std::atomic<bool>                        enabled_         { false };
+  std::atomic<bool>                        tracing_         { false };
+  bool                                     counters_        { false };
+  bool                                     summary_at_exit_ { true };
+  size_t                                   max_events_      { 1000000 };
+  std::string                              trace_file_      {};
+
+  Clock::time_point                        start_ { Clock::now() };
+
+  mutable std::mutex                       mutex_;
+  std::vector<std::unique_ptr<ThreadData>> threads_;
+
+}; // Profiler
+
+inline Profiler PROFILER;
+
+/*********************************************************************
+* A region, which is profiled until the end of its scope
+*********************************************************************/
+class ScopedRegion
+{
+public:
+  ScopedRegion(const char* name)
+  {
+    if ( !PROFILER.enabled() )
+      return;
+
+    data_   = &PROFILER.thread_data();
+    region_ = PROFILER.enter( *data_, name );
+
+    if ( PROFILER.start_counters( *data_ ) )
+    {
+      cycles_       = data_->cycles->value();
+      instructions_ = data_->instructions->value();
+      counting_     = true;
+    }
+
+    start_ = Profiler::Clock::now();
+  }
+
+  ~ScopedRegion()
+  {
+    if ( !data_ )
+      return;
+
+    if ( counting_ )
+      PROFILER.leave( *data_, region_, start_,
+                      data_->cycles->value() - cycles_,
+                      data_->instructions->value() - instructions_ );
+    else
+      PROFILER.leave( *data_, region_, start_ );
+  }
+
+  ScopedRegion(const ScopedRegion&) = delete;
+  ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+private:
+  Profiler::ThreadData*       data_         { nullptr };
+  int                         region_       { 0 };
+  Profiler::Clock::time_point start_        {};
+  std::uint64_t               cycles_       { 0 };
+  std::uint64_t               instructions_ { 0 };
+  bool                        counting_     { false };
+
+}; // ScopedRegion
+
+/*********************************************************************
+* Profile the enclosing scope as region with the given name, which
+* must be a string literal
+*********************************************************************/
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef CPPUTILS_NO_PROFILING
+#define PROFILE_SCOPE(name) \
+  CppUtils::ScopedRegion PROFILE_CONCAT(profile_region_, __LINE__) { name }
+#else
+#define PROFILE_SCOPE(name) \
+  do { } while (false)
+#endif
+
+} // namespace CppUtils
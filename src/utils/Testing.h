@@ -9,6 +9,14 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
 namespace CppUtils {
 
@@ -105,4 +113,361 @@ static inline bool eval_test(bool cond,
   } while(false)
 
 
+/*********************************************************************
+* Performance tests
+* -----------------
+* Performance tests compare a measured throughput against a stored
+* baseline. In order to compare the results of different build
+* hosts, every throughput is normalized by the throughput of a short
+* calibration kernel. A test fails if its normalized throughput is
+* more than the tolerance below the baseline, e.g. 15% slower for a
+* tolerance of 0.15.
+*
+* Baseline files contain one test per line:
+*
+*   # Name                    Throughput        Tolerance
+*   DualGrid::build           1.234567e-01      0.15
+*
+* The tolerance is optional and defaults to the tolerance of the
+* PerfBaseline. Outside of update mode, tests fail if the baseline
+* file can not be read or does not contain them. In update mode,
+* all tests pass and save() writes the measured throughputs to the
+* baseline file.
+*
+* The speed of a shared build host drifts over time, therefore the
+* calibration kernel runs directly before every measurement and
+* the median of the normalized throughputs is used. Failed tests
+* are measured again before they are reported.
+*********************************************************************/
+
+/*********************************************************************
+* The calibration kernel mixes a streaming triad on arrays beyond
+* the size of typical L2 caches with a dependent floating-point
+* chain, similar to the memory and compute mix of the solver kernels
+*********************************************************************/
+class CalibrationKernel
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  CalibrationKernel(int n=1<<18)
+  : a_ ( n, 0.0 )
+  , b_ ( n, 1.0 )
+  , c_ ( n, 2.0 )
+  {}
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int size() const { return static_cast<int>( a_.size() ); }
+  double sink() const { return sink_; }
+
+  /*------------------------------------------------------------------
+  | Run the kernel once
+  ------------------------------------------------------------------*/
+  void run()
+  {
+    const int n = size();
+
+    for ( int i = 0; i < n; ++i )
+      a_[i] = b_[i] + 0.5 * c_[i];
+
+    double x = 1.0;
+    for ( int i = 0; i < n; ++i )
+      x = std::sqrt( x * a_[i] + 1.0 ) * 0.5;
+
+    sink_ += x;
+  }
+
+private:
+  std::vector<double> a_;
+  std::vector<double> b_;
+  std::vector<double> c_;
+  double              sink_ { 0.0 };
+
+}; // CalibrationKernel
+
+/*********************************************************************
+* Wall time of a single call of func() in seconds
+*********************************************************************/
+template <typename Func>
+double measure_time(Func&& func)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const auto t0 = Clock::now();
+  func();
+  const auto t1 = Clock::now();
+
+  return std::max( std::chrono::duration<double>( t1 - t0 ).count(),
+                   1.0E-12 );
+}
+
+/*********************************************************************
+* Median of n_repeats measurements of the throughput n_items / t of
+* func(), which is called once before the measurements
+*********************************************************************/
+template <typename Func>
+double measure_throughput(double n_items, int n_repeats, Func&& func)
+{
+  func();
+
+  std::vector<double> samples ( n_repeats, 0.0 );
+
+  for ( int n = 0; n < n_repeats; ++n )
+    samples[n] = n_items / measure_time( func );
+
+  std::sort( samples.begin(), samples.end() );
+
+  return samples[n_repeats / 2];
+
+} // measure_throughput()
+
+/*********************************************************************
+* Throughput of the calibration kernel in elements per second
+*********************************************************************/
+inline double calibration_throughput(int n_repeats=10)
+{
+  CalibrationKernel kernel {};
+
+  const double throughput = measure_throughput( kernel.size(), n_repeats,
+                                               [&]() { kernel.run(); } );
+
+  return ( kernel.sink() < 0.0 ) ? 0.0 : throughput;
+
+} // calibration_throughput()
+
+/*********************************************************************
+* Number of calls of func(), which take at least min_time seconds
+*********************************************************************/
+template <typename Func>
+int calls_per_sample(double min_time, Func&& func)
+{
+  const double t = measure_time( func );
+
+  return std::max( 1, static_cast<int>( std::ceil( min_time / t ) ) );
+}
+
+/*********************************************************************
+* Median of n_repeats measurements of the throughput n_items / t of
+* func(), each normalized by the throughput of the calibration
+* kernel, which is measured directly before. Short kernels are
+* called repeatedly, such that every sample takes at least
+* min_time seconds.
+*********************************************************************/
+template <typename Func>
+double measure_normalized_throughput(double n_items, int n_repeats,
+                                     Func&& func, double min_time=0.02)
+{
+  CalibrationKernel kernel {};
+
+  auto calibration = [&]() { kernel.run(); };
+
+  const int n_cal  = calls_per_sample( min_time, calibration );
+  const int n_func = calls_per_sample( min_time, func );
+
+  std::vector<double> samples ( n_repeats, 0.0 );
+
+  for ( int n = 0; n < n_repeats; ++n )
+  {
+    const double t_cal = measure_time( [&]()
+    { for ( int i = 0; i < n_cal; ++i ) calibration(); } ) / n_cal;
+
+    const double t_func = measure_time( [&]()
+    { for ( int i = 0; i < n_func; ++i ) func(); } ) / n_func;
+
+    samples[n] = ( n_items / t_func ) / ( kernel.size() / t_cal );
+  }
+
+  std::sort( samples.begin(), samples.end() );
+
+  return ( kernel.sink() < 0.0 ) ? 0.0 : samples[n_repeats / 2];
+
+} // measure_normalized_throughput()
+
+/*********************************************************************
+* Result of a single performance test
+*********************************************************************/
+struct PerfResult
+{
+  std::string name;
+  double      measured  { 0.0 };
+  double      baseline  { 0.0 };
+  double      tolerance { 0.0 };
+  bool        passed    { true };
+
+  // Ratio of the measured to the baseline throughput
+  double ratio() const
+  { return ( baseline > 0.0 ) ? measured / baseline : 0.0; }
+
+}; // PerfResult
+
+/*********************************************************************
+* PerfResult ostream overload
+*********************************************************************/
+inline std::ostream& operator<<(std::ostream& os,
+                                const PerfResult& r)
+{
+  os << r.name << ": " << r.measured;
+
+  if ( r.baseline <= 0.0 )
+    return os << " (no baseline) "
+              << ( r.passed ? "passed" : "FAILED" );
+
+  return os << " / baseline " << r.baseline
+            << " = " << 100.0 * r.ratio() << "% (tolerance "
+            << 100.0 * r.tolerance << "%) "
+            << ( r.passed ? "passed" : "FAILED" );
+}
+
+/*********************************************************************
+* This class stores the baseline throughputs of the performance
+* tests and compares measured throughputs against them
+*********************************************************************/
+class PerfBaseline
+{
+public:
+  /*------------------------------------------------------------------
+  | Constructor, which reads the baseline file if it exists
+  ------------------------------------------------------------------*/
+  PerfBaseline(const std::string& file_path, double tolerance=0.15)
+  : file_path_ { file_path }
+  , tolerance_ { tolerance }
+  {
+    std::ifstream file ( file_path_ );
+    std::string   line;
+
+    loaded_ = file.is_open();
+
+    while ( std::getline( file, line ) )
+    {
+      std::stringstream ss { line.substr( 0, line.find('#') ) };
+
+      std::string name;
+      double      value;
+
+      if ( !(ss >> name >> value) )
+        continue;
+
+      double tol;
+      entries_[name] = { value, (ss >> tol) ? tol : tolerance_ };
+    }
+  }
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void update(bool u) { update_ = u; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  bool update() const { return update_; }
+  bool loaded() const { return loaded_; }
+  bool contains(const std::string& name) const
+  { return entries_.count( name ) > 0; }
+  const std::string& file_path() const { return file_path_; }
+
+  /*------------------------------------------------------------------
+  | Compare a normalized throughput against the baseline. Tests
+  | without a baseline fail outside of update mode, such that a
+  | missing or incomplete baseline file is not silently accepted.
+  ------------------------------------------------------------------*/
+  PerfResult check(const std::string& name, double measured)
+  {
+    PerfResult result { name, measured, 0.0, tolerance_, update_ };
+
+    auto entry = entries_.find( name );
+
+    if ( entry != entries_.end() )
+    {
+      result.baseline  = entry->second.first;
+      result.tolerance = entry->second.second;
+      result.passed    = update_ || measured >=
+        ( 1.0 - result.tolerance ) * result.baseline;
+    }
+
+    measured_[name] = { measured,
+      ( entry != entries_.end() ) ? entry->second.second : tolerance_ };
+
+    return result;
+
+  } // PerfBaseline::check()
+
+  /*------------------------------------------------------------------
+  | Compare the normalized throughput of measure() against the
+  | baseline, where failed tests are measured up to n_attempts
+  | times in total. In update mode, the median of n_attempts
+  | measurements is stored.
+  ------------------------------------------------------------------*/
+  template <typename Measure>
+  PerfResult check(const std::string& name, Measure&& measure,
+                   int n_attempts)
+  {
+    if ( update_ )
+    {
+      std::vector<double> samples ( n_attempts, 0.0 );
+
+      for ( double& sample : samples )
+        sample = measure();
+
+      std::sort( samples.begin(), samples.end() );
+
+      return check( name, samples[n_attempts / 2] );
+    }
+
+    PerfResult result = check( name, measure() );
+
+    for ( int n = 1; n < n_attempts && !result.passed; ++n )
+      result = check( name, measure() );
+
+    return result;
+
+  } // PerfBaseline::check()
+
+  /*------------------------------------------------------------------
+  | Write the measured throughputs to the baseline file, while
+  | the tolerances of existing tests are kept
+  ------------------------------------------------------------------*/
+  bool save() const
+  {
+    std::map<std::string, std::pair<double,double>> entries { entries_ };
+
+    for ( const auto& m : measured_ )
+      entries[m.first] = m.second;
+
+    std::ofstream file ( file_path_, std::ios::trunc );
+
+    file << "# Normalized throughputs of the performance tests\n"
+         << "# Name                              Throughput        Tolerance\n";
+
+    for ( const auto& e : entries )
+    {
+      char line[160];
+      std::snprintf( line, sizeof(line), "%-35s %-17.6e %.2f\n",
+                     e.first.c_str(), e.second.first, e.second.second );
+      file << line;
+    }
+
+    return !file.fail();
+
+  } // PerfBaseline::save()
+
+private:
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  std::string file_path_;
+  double      tolerance_ { 0.15 };
+  bool        update_    { false };
+  bool        loaded_    { false };
+
+  // Throughput and tolerance of every test
+  std::map<std::string, std::pair<double,double>> entries_  {};
+  std::map<std::string, std::pair<double,double>> measured_ {};
+
+}; // PerfBaseline
+
+
 } // namespace CppUtils
@@ -0,0 +1,476 @@
+/*
+* This file is part of the CppUtils library.  
+* This code was written by Florian Setzwein in 2022, 
+* and is covered under the MIT License
+* Refer to the accompanying documentation for details
+* on usage and license.
+*/
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace CppUtils {
+
+/*********************************************************************
+* An allocator, which default-initializes its elements instead of
+* value-initializing them. For trivial types such as double, the
+* memory stays untouched after the allocation, such that the
+* operating system places every page on the NUMA node of the
+* thread that writes to it first ("first-touch").
+*********************************************************************/
+template <typename T>
+class DefaultInitAllocator : public std::allocator<T>
+{
+public:
+  template <typename U>
+  struct rebind { using other = DefaultInitAllocator<U>; };
+
+  DefaultInitAllocator() = default;
+
+  template <typename U>
+  DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+
+  template <typename U>
+  void construct(U* ptr)
+  noexcept( std::is_nothrow_default_constructible<U>::value )
+  { ::new( static_cast<void*>(ptr) ) U; }
+
+  template <typename U, typename... Args>
+  void construct(U* ptr, Args&&... args)
+  { ::new( static_cast<void*>(ptr) ) U( std::forward<Args>(args)... ); }
+
+}; // DefaultInitAllocator
+
+/*********************************************************************
+* A persistent work-stealing thread pool
+*
+* The index range of a parallel loop is split into contiguous
+* chunks, which are distributed round-robin onto the task queues
+* of all threads. Every thread processes its own queue first and
+* steals chunks from the other queues once it runs out of work.
+* The calling thread takes part in the computation and uses the
+* queue with index 0, thus a pool of n threads spawns n-1 workers.
+*
+* Since chunk c is always placed in the queue c % n_threads, loops
+* over the same index range are processed mostly by the same
+* threads. Together with pinned workers and first-touch
+* initialization (see Matrix.h), the data of a thread stays on its
+* NUMA node.
+*
+* Results of parallel_reduce() are combined in the order of the
+* chunks, such that they are reproducible for a fixed number of
+* threads and grain size.
+*
+* Usage:
+* ------
+*   ThreadPool pool { 4 };
+*
+*   pool.parallel_for(0, n, [&](int i) { y[i] = a * x[i]; });
+*
+*   double sum = pool.parallel_reduce(0, n, 0.0,
+*     [&](int i0, int i1) { double s = 0.0;
+*                           for (int i = i0; i < i1; ++i) s += x[i];
+*                           return s; },
+*     [](double a, double b) { return a + b; });
+*********************************************************************/
+class ThreadPool
+{
+public:
+  using Task = std::function<void()>;
+
+  /*------------------------------------------------------------------
+  | Constructor
+  ------------------------------------------------------------------*/
+  ThreadPool(int n_threads=1, bool pin_threads=false)
+  { start( n_threads, pin_threads ); }
+
+  ~ThreadPool() { stop(); }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /*------------------------------------------------------------------
+  | Setters
+  ------------------------------------------------------------------*/
+  void n_threads(int n)
+  {
+    if ( n == n_threads_ )
+      return;
+
+    stop();
+    start( n, pin_threads_ );
+  }
+
+  void pin_threads(bool p)
+  {
+    if ( p == pin_threads_ )
+      return;
+
+    stop();
+    start( n_threads_, p );
+  }
+
+  void grain_size(int g) { grain_size_ = ( g < 1 ) ? 1 : g; }
+  void chunks_per_thread(int c) { chunks_per_thread_ = ( c < 1 ) ? 1 : c; }
+
+  /*------------------------------------------------------------------
+  | Getters
+  ------------------------------------------------------------------*/
+  int n_threads() const { return n_threads_; }
+  bool pin_threads() const { return pin_threads_; }
+  int grain_size() const { return grain_size_; }
+  int chunks_per_thread() const { return chunks_per_thread_; }
+
+  /*------------------------------------------------------------------
+  | Index of the calling thread within the pool.
+  | External threads have the index 0.
+  ------------------------------------------------------------------*/
+  static int thread_index() { return thread_index_ref(); }
+
+  /*------------------------------------------------------------------
+  | Number of chunks, into which a range of n indices is split
+  ------------------------------------------------------------------*/
+  int n_chunks(int n, int grain) const
+  {
+    if ( n <= 0 )
+      return 0;
+
+    if ( n_threads_ < 2 || n <= grain )
+      return 1;
+
+    const int max_chunks = n_threads_ * chunks_per_thread_;
+    const int n_grains   = ( n + grain - 1 ) / grain;
+
+    return ( n_grains < max_chunks ) ? n_grains : max_chunks;
+  }
+
+  /*------------------------------------------------------------------
+  | Call f(i) for all indices i in [begin, end)
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  void parallel_for(int begin, int end, Function&& f)
+  { parallel_for( begin, end, grain_size_, std::forward<Function>(f) ); }
+
+  template <typename Function>
+  void parallel_for(int begin, int end, int grain, Function&& f)
+  {
+    for_each_chunk( begin, end, grain,
+      [&f](int i0, int i1, int)
+      {
+        for ( int i = i0; i < i1; ++i )
+          f( i );
+      });
+  }
+
+  /*------------------------------------------------------------------
+  | Call f(i0, i1) for contiguous sub-ranges [i0, i1) of
+  | [begin, end)
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  void parallel_for_range(int begin, int end, Function&& f)
+  {
+    parallel_for_range( begin, end, grain_size_,
+                        std::forward<Function>(f) );
+  }
+
+  template <typename Function>
+  void parallel_for_range(int begin, int end, int grain, Function&& f)
+  {
+    for_each_chunk( begin, end, grain,
+      [&f](int i0, int i1, int) { f( i0, i1 ); } );
+  }
+
+  /*------------------------------------------------------------------
+  | Reduce the range [begin, end): map(i0, i1) computes the partial
+  | result of a sub-range, which are combined with reduce(a, b)
+  ------------------------------------------------------------------*/
+  template <typename T, typename Map, typename Reduce>
+  T parallel_reduce(int begin, int end, T identity,
+                    Map&& map, Reduce&& reduce)
+  {
+    return parallel_reduce( begin, end, grain_size_, identity,
+                            std::forward<Map>(map),
+                            std::forward<Reduce>(reduce) );
+  }
+
+  template <typename T, typename Map, typename Reduce>
+  T parallel_reduce(int begin, int end, int grain, T identity,
+                    Map&& map, Reduce&& reduce)
+  {
+    std::vector<T> partial ( n_chunks( end - begin, grain ), identity );
+
+    for_each_chunk( begin, end, grain,
+      [&map, &partial](int i0, int i1, int c)
+      { partial[c] = map( i0, i1 ); } );
+
+    T result = identity;
+
+    for ( const T& p : partial )
+      result = reduce( result, p );
+
+    return result;
+  }
+
+private:
+  /*------------------------------------------------------------------
+  | A task queue of a single thread
+  ------------------------------------------------------------------*/
+  struct TaskQueue
+  {
+    std::mutex       mutex;
+    std::deque<Task> tasks;
+  };
+
+  /*------------------------------------------------------------------
+  | Thread-local index of the calling thread
+  ------------------------------------------------------------------*/
+  static int& thread_index_ref()
+  {
+    static thread_local int index = 0;
+    return index;
+  }
+
+  /*------------------------------------------------------------------
+  | Split [begin, end) into chunks and call f(i0, i1, chunk) for
+  | each of them. Returns, once all chunks have been processed.
+  | The tasks refer to f and the counters on the stack of the
+  | caller, hence an exception of a chunk is stored and rethrown
+  | only after all chunks have finished.
+  ------------------------------------------------------------------*/
+  template <typename Function>
+  void for_each_chunk(int begin, int end, int grain, Function&& f)
+  {
+    const int n        = end - begin;
+    const int n_chunks = this->n_chunks( n, grain );
+
+    if ( n_chunks < 1 )
+      return;
+
+    if ( n_chunks == 1 )
+    {
+      f( begin, end, 0 );
+      return;
+    }
+
+    std::atomic<int>   remaining { n_chunks };
+    std::exception_ptr error     {};
+    std::mutex         error_mutex;
+
+    n_pending_.fetch_add( n_chunks );
+
+    for ( int c = 0; c < n_chunks; ++c )
+    {
+      const int i0 = begin + static_cast<int>(
+        static_cast<long long>(n) * c / n_chunks );
+      const int i1 = begin + static_cast<int>(
+        static_cast<long long>(n) * (c+1) / n_chunks );
+
+      TaskQueue& queue = *queues_[ c % n_threads_ ];
+
+      std::lock_guard<std::mutex> lock ( queue.mutex );
+      queue.tasks.emplace_back(
+        [&f, &remaining, &error, &error_mutex, i0, i1, c]()
+      {
+        try
+        {
+          f( i0, i1, c );
+        }
+        catch ( ... )
+        {
+          std::lock_guard<std::mutex> error_lock ( error_mutex );
+          if ( !error )
+            error = std::current_exception();
+        }
+
+        remaining.fetch_sub( 1, std::memory_order_release );
+      });
+    }
+
+    {
+      std::lock_guard<std::mutex> lock ( wake_mutex_ );
+    }
+    wake_.notify_all();
+
+    // The calling thread works until all chunks are done
+    const int self = thread_index();
+
+    while ( remaining.load( std::memory_order_acquire ) > 0 )
+    {
+      if ( !run_pending_task( self ) )
+        std::this_thread::yield();
+    }
+
+    if ( error )
+      std::rethrow_exception( error );
+
+  } // for_each_chunk()
+
+  /*------------------------------------------------------------------
+  | Run a task from the own queue or steal one from another queue.
+  | Returns false, if no task was available.
+  ------------------------------------------------------------------*/
+  bool run_pending_task(int self)
+  {
+    Task task;
+
+    for ( int k = 0; k < n_threads_; ++k )
+    {
+      TaskQueue& queue = *queues_[ (self + k) % n_threads_ ];
+
+      std::lock_guard<std::mutex> lock ( queue.mutex );
+
+      if ( queue.tasks.empty() )
+        continue;
+
+      // Own tasks are taken from the back, stolen from the front
+      if ( k == 0 )
+      {
+        task = std::move( queue.tasks.back() );
+        queue.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move( queue.tasks.front() );
+        queue.tasks.pop_front();
+      }
+
+      break;
+    }
+
+    if ( !task )
+      return false;
+
+    n_pending_.fetch_sub( 1 );
+    task();
+
+    return true;
+
+  } // run_pending_task()
+
+  /*------------------------------------------------------------------
+  | Main loop of the worker threads
+  ------------------------------------------------------------------*/
+  void worker_loop(int index)
+  {
+    thread_index_ref() = index;
+
+    while ( true )
+    {
+      if ( run_pending_task( index ) )
+        continue;
+
+      std::unique_lock<std::mutex> lock ( wake_mutex_ );
+
+      wake_.wait( lock, [this]
+      { return stop_ || n_pending_.load() > 0; } );
+
+      if ( stop_ && n_pending_.load() < 1 )
+        return;
+    }
+
+  } // worker_loop()
+
+  /*------------------------------------------------------------------
+  | Start the worker threads
+  ------------------------------------------------------------------*/
+  void start(int n_threads, bool pin_threads)
+  {
+    n_threads_   = ( n_threads < 1 ) ? 1 : n_threads;
+    pin_threads_ = pin_threads;
+    stop_        = false;
+
+    queues_.clear();
+    for ( int i = 0; i < n_threads_; ++i )
+      queues_.emplace_back( new TaskQueue {} );
+
+    for ( int i = 1; i < n_threads_; ++i )
+    {
+      workers_.emplace_back( &ThreadPool::worker_loop, this, i );
+
+      if ( pin_threads_ )
+        pin_to_core( workers_.back(), i );
+    }
+
+  } // start()
+
+  /*------------------------------------------------------------------
+  | Stop and join all worker threads
+  ------------------------------------------------------------------*/
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock ( wake_mutex_ );
+      stop_ = true;
+    }
+    wake_.notify_all();
+
+    for ( auto& worker : workers_ )
+      worker.join();
+
+    workers_.clear();
+
+  } // stop()
+
+  /*------------------------------------------------------------------
+  | Bind a worker thread to a single core
+  ------------------------------------------------------------------*/
+  static void pin_to_core(std::thread& thread, int index)
+  {
+#if defined(__linux__)
+    const unsigned n_cores = std::thread::hardware_concurrency();
+
+    if ( n_cores < 1 )
+      return;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO( &cpu_set );
+    CPU_SET( index % n_cores, &cpu_set );
+
+    pthread_setaffinity_np( thread.native_handle(),
+                            sizeof(cpu_set_t), &cpu_set );
+#else
+    (void) thread;
+    (void) index;
+#endif
+  } // pin_to_core()
+
+  /*------------------------------------------------------------------
+  | Attributes
+  ------------------------------------------------------------------*/
+  int                                     n_threads_         { 1 };
+  bool                                    pin_threads_       { false };
+  int                                     grain_size_        { 1024 };
+  int                                     chunks_per_thread_ { 4 };
+
+  std::vector<std::thread>                workers_;
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+
+  std::atomic<int>                        n_pending_         { 0 };
+  std::mutex                              wake_mutex_;
+  std::condition_variable                 wake_;
+  bool                                    stop_              { false };
+
+}; // ThreadPool
+
+/*********************************************************************
+* The global thread pool, which is used by all parallel kernels.
+* It runs serially until the number of threads is increased.
+*********************************************************************/
+inline ThreadPool THREAD_POOL {};
+
+} // namespace CppUtils